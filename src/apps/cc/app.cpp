@@ -27,7 +27,9 @@
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <exception>
 #include <ios>
@@ -46,9 +48,12 @@
 #include "config/detector.h"
 #include "config/exception.h"
 #include "config/validators.h"
+#include "correlation_engine_tuner.h"
 #include "detector/arrival.h"
 #include "detector/detector.h"
 #include "eventstore.h"
+#include "filter/detail/kernel.h"
+#include "filterstore.h"
 #include "log.h"
 #include "magnitude/regression.h"
 #include "magnitude_processor.h"
@@ -56,6 +61,7 @@
 #include "processing/timewindow_processor.h"
 #include "processing/waveform_processor.h"
 #include "resamplerstore.h"
+#include "samplestore.h"
 #include "util/horizontal_components.h"
 #include "util/memory.h"
 #include "util/util.h"
@@ -83,6 +89,13 @@ bool requiresMagnitude(const binding::Bindings &bindings,
   return false;
 }
 
+// Returns the time (in seconds) elapsed since `since`
+double secondsSince(const std::chrono::steady_clock::time_point &since) {
+  return std::chrono::duration<double>{std::chrono::steady_clock::now() -
+                                       since}
+      .count();
+}
+
 }  // namespace
 
 Application::Application(int argc, char **argv)
@@ -161,6 +174,42 @@ void Application::createCommandLineDescription() {
       "enables/disables the calculation of magnitudes regardless of the "
       "configuration provided on detector configuration level granularity",
       &_config.magnitudesForceMode, false);
+  commandline().addOption(
+      "Mode", "correlation-engine",
+      "forces the cross-correlation engine; 'auto' benchmarks the engines "
+      "at startup and selects the fastest one, possible values are: "
+      "auto, timeDomain, timeDomainScalar, timeDomainSSE2, timeDomainAVX2, "
+      "timeDomainAVX512, frequencyDomain",
+      &_config.correlationEngine);
+  commandline().addOption(
+      "Mode", "worker-threads",
+      "the number of worker threads detectors are executed by; 0 executes "
+      "the detectors by means of the main thread",
+      &_config.workerThreads, false);
+  commandline().addOption(
+      "Mode", "processor-threads",
+      "the number of threads template waveform processors of a detector are "
+      "evaluated in parallel with; 0 evaluates the processors sequentially",
+      &_config.processorThreads, false);
+  commandline().addOption(
+      "Mode", "processor-parallel-min-processors",
+      "the minimum number of template waveform processors of a detector per "
+      "stream required for evaluating the processors in parallel",
+      &_config.processorParallelMinProcessors, false);
+  commandline().addOption(
+      "Mode", "template-loading-threads",
+      "the number of threads template waveforms are loaded and detectors are "
+      "constructed with at startup; 0 constructs the detectors by means of "
+      "the main thread",
+      &_config.templateLoadingThreads, false);
+  commandline().addOption(
+      "Mode", "progressive-startup",
+      "construct detectors in the background; each detector starts "
+      "processing as soon as it is constructed (real-time input, only)");
+  commandline().addOption(
+      "Mode", "pipeline",
+      "process records by means of pipeline stages executed by separate "
+      "threads");
 
   commandline().addGroup("Monitor");
   commandline().addOption(
@@ -285,6 +334,147 @@ bool Application::validateParameters() {
 
     return false;
   }
+  if (!config::validatePrecision(_config.detectorConfig.precision)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'precision': %s. Must be one of: {%s}",
+        _config.detectorConfig.precision.c_str(),
+        boost::algorithm::join(config::kValidPrecisions, ",").c_str());
+
+    return false;
+  }
+  if (!config::validateCoarseSearchDecimationFactor(
+          _config.detectorConfig.coarseSearchDecimationFactor)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'coarseSearchDecimationFactor': %d. "
+        "Must be >= 1",
+        _config.detectorConfig.coarseSearchDecimationFactor);
+    return false;
+  }
+  if (!config::validateCoarseSearchThresholdFactor(
+          _config.detectorConfig.coarseSearchThresholdFactor)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'coarseSearchThresholdFactor': %f. "
+        "Must be in the range (0, 1]",
+        _config.detectorConfig.coarseSearchThresholdFactor);
+    return false;
+  }
+  if (!config::validateSubspaceEnergyFraction(
+          _config.detectorConfig.subspaceEnergyFraction)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'subspaceEnergyFraction': %f. "
+        "Must be in the range (0, 1]",
+        _config.detectorConfig.subspaceEnergyFraction);
+    return false;
+  }
+  if (!(_config.autoTargetSamplingFrequencyMargin > 2)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'autoTargetSamplingFrequencyMargin': %f. "
+        "Must be > 2",
+        _config.autoTargetSamplingFrequencyMargin);
+    return false;
+  }
+  if (_config.templateClusterSimilarity &&
+      !(*_config.templateClusterSimilarity > 0 &&
+        *_config.templateClusterSimilarity <= 1)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'templateClusterSimilarity': %f. "
+        "Must be in the range (0, 1]",
+        *_config.templateClusterSimilarity);
+    return false;
+  }
+  if (_config.templateClusterBoundMargin < 0) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'templateClusterBoundMargin': %f. "
+        "Must be >= 0",
+        _config.templateClusterBoundMargin);
+    return false;
+  }
+  if (!_config.correlationEngine.empty() &&
+      !config::validateCorrelationEngine(_config.correlationEngine)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'correlationEngine': %s. Must be one of: {%s}",
+        _config.correlationEngine.c_str(),
+        boost::algorithm::join(config::kValidCorrelationEngines, ",").c_str());
+    return false;
+  }
+  if (!_config.correlationEngine.empty() &&
+      _config.correlationEngine != "auto") {
+    const auto correlationEngineConfig{
+        parseCorrelationEngineConfig(_config.correlationEngine)};
+    if (!correlationEngineConfig || !isSupported(*correlationEngineConfig)) {
+      SCDETECT_LOG_ERROR(
+          "Invalid configuration: 'correlationEngine': %s. Instruction set "
+          "not supported by the host (supported: %s)",
+          _config.correlationEngine.c_str(),
+          filter::detail::to_string(filter::detail::detectInstructionSet())
+              .c_str());
+      return false;
+    }
+  }
+  if (_config.workerThreads < 0) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'workerThreads': %d. Must be >= 0",
+        _config.workerThreads);
+    return false;
+  }
+  if (_config.processorThreads < 0) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'processorThreads': %d. Must be >= 0",
+        _config.processorThreads);
+    return false;
+  }
+  if (_config.processorParallelMinProcessors < 1) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'processorParallelMinProcessors': %d. "
+        "Must be >= 1",
+        _config.processorParallelMinProcessors);
+    return false;
+  }
+  if (_config.templateLoadingThreads < 0) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'templateLoadingThreads': %d. Must be >= 0",
+        _config.templateLoadingThreads);
+    return false;
+  }
+  if (_config.pipelineQueueCapacity < 1) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'pipelineQueueCapacity': %d. Must be >= 1",
+        _config.pipelineQueueCapacity);
+    return false;
+  }
+  if (_config.fingerprintHop <= 0) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'fingerprintHop': %f. Must be > 0",
+        _config.fingerprintHop);
+    return false;
+  }
+  if (_config.fingerprintMinVotes < 1) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'fingerprintMinVotes': %d. Must be >= 1",
+        _config.fingerprintMinVotes);
+    return false;
+  }
+  if (!config::validateCascadeTriggerThreshold(
+          _config.detectorConfig.cascadeTriggerThreshold)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'cascadeTriggerThreshold': %f. Must be > 0",
+        _config.detectorConfig.cascadeTriggerThreshold);
+    return false;
+  }
+  if (!config::validateCascadeDuration(
+          _config.detectorConfig.cascadeLookBack)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'cascadeLookBack': %f. Must be >= 0",
+        _config.detectorConfig.cascadeLookBack);
+    return false;
+  }
+  if (!config::validateCascadeDuration(
+          _config.detectorConfig.cascadeHoldDuration)) {
+    SCDETECT_LOG_ERROR(
+        "Invalid configuration: 'cascadeHoldDuration': %f. Must be >= 0",
+        _config.detectorConfig.cascadeHoldDuration);
+    return false;
+  }
   if (_config.streamConfig.templateConfig.wfStart >=
       _config.streamConfig.templateConfig.wfEnd) {
     SCDETECT_LOG_ERROR(
@@ -330,6 +520,11 @@ bool Application::handleCommandLineOptions() {
     _config.noPublish = true;
   }
 
+  // templates are prepared by constructing the detectors at startup
+  if (_config.templatesPrepare) {
+    _config.progressiveStartup = false;
+  }
+
   bool magnitudesForcedEnabled{_config.magnitudesForceMode &&
                                *_config.magnitudesForceMode};
   bool amplitudesForcedDisabled{_config.amplitudesForceMode &&
@@ -378,6 +573,44 @@ bool Application::init() {
     SCDETECT_LOG_INFO("Playback mode enabled");
   }
 
+  // records fed before a detector is registered are discarded; hence,
+  // progressive startup would render processing archived data irreproducible
+  if (_config.progressiveStartup && !isRealTimeInput()) {
+    SCDETECT_LOG_WARNING(
+        "Progressive startup disabled: input is not real-time (%s)",
+        recordStreamURL().c_str());
+    _config.progressiveStartup = false;
+  }
+
+  if (_config.polyphaseResampling) {
+    RecordResamplerStore::Instance().setPolyphase(true);
+    SCDETECT_LOG_INFO("Polyphase resampling enabled");
+  }
+
+  SCDETECT_LOG_INFO(
+      "Cross-correlation kernel instruction set: %s",
+      filter::detail::to_string(filter::detail::detectInstructionSet())
+          .c_str());
+
+  if (_config.correlationEngine == "auto") {
+    auto &correlationEngineTuner{CorrelationEngineTuner::Instance()};
+    correlationEngineTuner.setAutoTune(true);
+    if (!_config.templatesNoCache) {
+      correlationEngineTuner.setCachePath(
+          (boost::filesystem::path(_config.pathFilesystemCache) /
+           settings::kCorrelationEngineCacheFile)
+              .string());
+    }
+    SCDETECT_LOG_INFO(
+        "Cross-correlation engine auto-tuning enabled (cpu_model=%s)",
+        CorrelationEngineTuner::cpuModel().c_str());
+  } else if (!_config.correlationEngine.empty()) {
+    CorrelationEngineTuner::Instance().setForced(
+        parseCorrelationEngineConfig(_config.correlationEngine));
+    SCDETECT_LOG_INFO("Cross-correlation engine forced: %s",
+                      _config.correlationEngine.c_str());
+  }
+
   // load event related data
   if (!loadEvents(_config.urlEventDb, query())) {
     SCDETECT_LOG_ERROR("Failed to load events");
@@ -407,6 +640,29 @@ bool Application::init() {
   waveformHandler =
       util::make_smart<InMemoryCache>(waveformHandler, /*raw=*/false);
 
+  if (_config.templateClusterSimilarity) {
+    detector::TemplateBankRegistry::ClusterConfig clusterConfig;
+    clusterConfig.similarity = *_config.templateClusterSimilarity;
+    clusterConfig.boundMargin = _config.templateClusterBoundMargin;
+    _templateBankRegistry.setClusterConfig(clusterConfig);
+  }
+  if (_config.fingerprintSearch) {
+    detector::TemplateBankRegistry::FingerprintConfig fingerprintConfig;
+    fingerprintConfig.hop = _config.fingerprintHop;
+    fingerprintConfig.minVotes =
+        static_cast<std::size_t>(_config.fingerprintMinVotes);
+    _templateBankRegistry.setFingerprintConfig(fingerprintConfig);
+  }
+
+  if (_config.processorThreads > 0) {
+    _workStealingPool = util::make_unique<util::WorkStealingPool>(
+        static_cast<std::size_t>(_config.processorThreads));
+    SCDETECT_LOG_INFO(
+        "Evaluating template waveform processors in parallel (threads=%lu, "
+        "min_processors=%d)",
+        _workStealingPool->size(), _config.processorParallelMinProcessors);
+  }
+
   // load template related data
   // TODO(damb):
   //
@@ -432,6 +688,22 @@ bool Application::init() {
     return false;
   }
 
+  if (!_templateBankRegistry.empty()) {
+    SCDETECT_LOG_INFO(
+        "Cross-correlating by means of template banks (template_banks=%lu)",
+        _templateBankRegistry.size());
+  }
+  if (!_preprocessingRegistry.empty()) {
+    SCDETECT_LOG_INFO(
+        "Sharing preprocessing by means of preprocessing chains "
+        "(preprocessing_chains=%lu, subscribers=%lu)",
+        _preprocessingRegistry.size(), _preprocessingRegistry.subscribers());
+  }
+  if (!_cascadeTriggerRegistry.empty()) {
+    SCDETECT_LOG_INFO("Cascaded detection enabled (cascade_triggers=%lu)",
+                      _cascadeTriggerRegistry.size());
+  }
+
   // load bindings
   if (configModule()) {
     _bindings.setDefault(_config.sensorLocationBindings);
@@ -459,8 +731,14 @@ bool Application::init() {
                                   _bindings, _config);
   }
 
-  // free memory after initialization
-  EventStore::Instance().reset();
+  if (_config.progressiveStartup) {
+    // the event parameters are required for constructing the detectors; thus,
+    // memory is freed once the detectors are constructed
+    startDetectorConstruction(waveformHandler);
+  } else {
+    // free memory after initialization
+    EventStore::Instance().reset();
+  }
 
   return true;
 }
@@ -474,10 +752,53 @@ bool Application::run() {
     return true;
   }
 
-  if (_detectors.empty()) {
+  if (_detectors.empty() && !_detectorConstructionThread.joinable()) {
     return false;
   }
 
+  if (_config.workerThreads > 0 && !_detectorWorkerPool) {
+    _detectorWorkerPool = util::make_unique<detector::WorkerPool>(
+        static_cast<std::size_t>(_config.workerThreads));
+    _detectorWorkerPool->add(_detectors, _detectorIdx);
+    _detectorWorkerPool->start();
+
+    SCDETECT_LOG_INFO("Executing %lu detectors by means of %lu worker threads",
+                      _detectors.size(), _detectorWorkerPool->size());
+    for (std::size_t i{0}; i < _detectorWorkerPool->size(); ++i) {
+      SCDETECT_LOG_DEBUG("Worker thread %lu: detectors=%lu", i,
+                         _detectorWorkerPool->detectors(i));
+    }
+  }
+
+  if (_config.pipeline && !_pipeline) {
+    _pipeline = util::make_unique<RecordPipeline>(
+        static_cast<std::size_t>(_config.pipelineQueueCapacity),
+        [this](const Record *record) {
+          RecordPipeline::Detections ret;
+          _detectionSink = &ret;
+          RecordPipeline::Detections detections;
+          try {
+            detections = processRecord(record);
+          } catch (...) {
+            _detectionSink = nullptr;
+            throw;
+          }
+          _detectionSink = nullptr;
+
+          std::move(std::begin(detections), std::end(detections),
+                    std::back_inserter(ret));
+          return ret;
+        },
+        [this](const Record *record, RecordPipeline::Detections &detections) {
+          assembleRecord(record, detections);
+          RecordSampleStore::Instance().unpin(record);
+        });
+    _pipeline->start();
+
+    SCDETECT_LOG_INFO("Processing records by means of a pipeline (capacity=%d)",
+                      _config.pipelineQueueCapacity);
+  }
+
   if (commandline().hasOption("ep")) {
     _ep = util::make_smart<DataModel::EventParameters>();
   }
@@ -498,6 +819,16 @@ bool Application::run() {
 }
 
 void Application::done() {
+  stopDetectorConstruction();
+  if (_pipeline) {
+    _pipeline->stop();
+    logPipelineMetrics();
+  }
+  if (_detectorWorkerPool) {
+    flushDetectorWorkerPool();
+    _detectorWorkerPool->stop();
+  }
+
   if (!_config.templatesPrepare) {
     // terminate detectors
     for (const auto &detector : _detectors) {
@@ -510,6 +841,26 @@ void Application::done() {
     }
     _detections.clear();
 
+    // report the work saved by means of template clustering and the
+    // fingerprint based similarity search
+    _templateBankRegistry.logClusterStatistics();
+    _templateBankRegistry.logFingerprintStatistics();
+
+    SCDETECT_LOG_DEBUG("Record samples: decoded=%lu, shared=%lu",
+                       RecordSampleStore::Instance().decoded(),
+                       RecordSampleStore::Instance().shared());
+    if (_workStealingPool) {
+      SCDETECT_LOG_DEBUG("Template waveform processor tasks stolen: %lu",
+                         _workStealingPool->steals());
+    }
+    SCDETECT_LOG_DEBUG("Filters: compiled=%lu",
+                       FilterStore::Instance().compiled());
+    for (const auto &instantiation :
+         FilterStore::Instance().instantiations()) {
+      SCDETECT_LOG_DEBUG("Filter instantiations: filter=\"%s\", count=%lu",
+                         instantiation.first.c_str(), instantiation.second);
+    }
+
     if (_ep) {
       IO::XMLArchive ar;
       ar.create(_config.pathEp.empty() ? "-" : _config.pathEp.c_str());
@@ -523,6 +874,7 @@ void Application::done() {
 
   EventStore::Instance().reset();
   RecordResamplerStore::Instance().reset();
+  FilterStore::Instance().reset();
   AmplitudeProcessor::Factory::reset();
   MagnitudeProcessor::Factory::reset();
 
@@ -537,6 +889,12 @@ bool Application::dispatch(Core::BaseObject *obj) {
 }
 
 void Application::handleTimeout() {
+  registerConstructedDetectors();
+  if (_pipeline) {
+    _pipeline->assemble();
+    logPipelineMetrics();
+  }
+
   auto runningMean{_averageObjectThroughputMonitor.value(Core::Time::GMT())};
   std::string msg{"Current object throughput per second (averaged): " +
                   std::to_string(runningMean)};
@@ -579,34 +937,76 @@ void Application::handleRecord(Record *rec) {
 
   if (!rec || !rec->data()) return;
 
+  // progressive startup: detectors start processing as soon as they are
+  // constructed
+  registerConstructedDetectors();
+
   bool waveformBufferingEnabled{_config.forcedWaveformBufferSize.value_or(
                                     Core::TimeSpan{0.0}) > Core::TimeSpan{0.0}};
   if (waveformBufferingEnabled && !_waveformBuffer.feed(rec)) return;
 
-  auto detectorRange{_detectorIdx.equal_range(std::string{rec->streamID()})};
+  if (_pipeline) {
+    // decode the record's samples once on behalf of both the processing and
+    // the assembly stage
+    RecordSampleStore::Instance().pin(rec);
+    _pipeline->push(rec);
+    return;
+  }
+
+  // decode the record's samples at most once and share them among all
+  // consumers
+  RecordSampleStore::Scope sampleScope{rec};
+
+  auto detections{processRecord(rec)};
+  assembleRecord(rec, detections);
+}
+
+RecordPipeline::Detections Application::processRecord(const Record *record) {
+  RecordPipeline::Detections ret;
+  // the registries are shared among the detectors executed by the detector
+  // workers (cascade triggers even across streams); thus, the records in
+  // flight must be processed before feeding the registries
+  if (_detectorWorkerPool &&
+      !(_templateBankRegistry.empty() && _preprocessingRegistry.empty() &&
+        _cascadeTriggerRegistry.empty())) {
+    ret = _detectorWorkerPool->flush();
+  }
+
+  // cross-correlate by means of template banks before feeding the detectors
+  _templateBankRegistry.feed(record);
+  // filter and resample once on behalf of the subscribed template waveform
+  // processors (which cross-correlate the data preprocessed when being fed
+  // by their detectors)
+  _preprocessingRegistry.feed(record);
+  // update the pre-triggers gating cascaded detectors
+  _cascadeTriggerRegistry.feed(record);
+
+  if (_detectorWorkerPool) {
+    auto detections{_detectorWorkerPool->feed(record)};
+    std::move(std::begin(detections), std::end(detections),
+              std::back_inserter(ret));
+    return ret;
+  }
+
+  auto detectorRange{
+      _detectorIdx.equal_range(std::string{record->streamID()})};
   for (auto it = detectorRange.first; it != detectorRange.second; ++it) {
-    auto &detector{_detectors[it->second]};
-    if (detector->enabled()) {
-      if (!detector->feed(rec)) {
-        logging::TaggedMessage msg{it->first,
-                                   "Failed to feed record into detector (" +
-                                       detector->id() + "). Resetting."};
-        SCDETECT_LOG_WARNING("%s", logging::to_string(msg).c_str());
-        detector->reset();
-        continue;
-      }
-    } else {
-      logging::TaggedMessage msg{
-          it->first, "Skip feeding record to detector (id=" + detector->id() +
-                         "). Reason: Disabled."};
-      SCDETECT_LOG_WARNING("%s", logging::to_string(msg).c_str());
-    }
+    detector::feed(*_detectors[it->second], record);
+  }
+  return ret;
+}
+
+void Application::assembleRecord(const Record *record,
+                                 RecordPipeline::Detections &detections) {
+  for (auto &result : detections) {
+    processDetection(result.detector, result.record.get(),
+                     std::move(result.detection));
   }
 
   {
     _timeWindowProcessorRegistrationBlocked = true;
 
-    auto range{_timeWindowProcessors.equal_range(rec->streamID())};
+    auto range{_timeWindowProcessors.equal_range(record->streamID())};
     for (auto it = range.first; it != range.second; ++it) {
       const auto &proc{it->second};
       // the time window processor must not be already on the removal list
@@ -624,7 +1024,7 @@ void Application::handleRecord(Record *rec) {
       if (it->second->finished()) {
         removeTimeWindowProcessor(it->second);
       } else {
-        it->second->feed(rec);
+        it->second->feed(record);
         if (it->second->finished()) {
           removeTimeWindowProcessor(it->second);
         }
@@ -655,7 +1055,7 @@ void Application::handleRecord(Record *rec) {
   {
     _detectionRegistrationBlocked = true;
 
-    auto range{_detections.equal_range(rec->streamID())};
+    auto range{_detections.equal_range(record->streamID())};
     for (auto it = range.first; it != range.second; ++it) {
       auto &detection{it->second};
       // the detection must not be already in the removal list
@@ -703,9 +1103,44 @@ const Application::Detectors &Application::detectors() const {
 }
 
 void Application::resetDetectors() {
+  if (_pipeline) {
+    _pipeline->flush();
+  }
+  if (_detectorWorkerPool) {
+    flushDetectorWorkerPool();
+  }
   for (auto &detector : _detectors) {
     detector->reset();
   }
+  _templateBankRegistry.reset();
+  _preprocessingRegistry.reset();
+  _cascadeTriggerRegistry.reset();
+}
+
+void Application::flushDetectorWorkerPool() {
+  auto detections{_detectorWorkerPool->flush()};
+  for (auto &result : detections) {
+    processDetection(result.detector, result.record.get(),
+                     std::move(result.detection));
+  }
+}
+
+void Application::logPipelineMetrics() const {
+  const auto metrics{_pipeline->metrics()};
+  const auto log = [](const char *stage,
+                      const RecordPipeline::StageMetrics &stageMetrics) {
+    SCDETECT_LOG_DEBUG(
+        "Pipeline stage metrics (stage=%s): records=%lu, depth=%lu, "
+        "max_depth=%lu, mean_wait=%f, max_wait=%f, mean_service=%f, "
+        "max_service=%f",
+        stage, stageMetrics.count, stageMetrics.depth, stageMetrics.maxDepth,
+        stageMetrics.meanWait, stageMetrics.maxWait, stageMetrics.meanService,
+        stageMetrics.maxService);
+  };
+  log("processing", metrics.processing);
+  log("assembly", metrics.assembly);
+  SCDETECT_LOG_DEBUG("Pipeline latency: mean=%f, max=%f", metrics.meanLatency,
+                     metrics.maxLatency);
 }
 
 void Application::processDetection(
@@ -1440,6 +1875,26 @@ bool Application::isEventDatabaseEnabled() const {
   return _config.urlEventDb.empty();
 }
 
+bool Application::isRealTimeInput() const {
+  if (_config.playbackConfig.enabled ||
+      !_config.playbackConfig.startTimeStr.empty() ||
+      !_config.playbackConfig.endTimeStr.empty()) {
+    return false;
+  }
+
+  // record stream services providing archived data (a URL without service
+  // refers to a file)
+  static const std::vector<std::string> archiveServices{"file", "sdsarchive",
+                                                        "fdsnws", "arclink"};
+  const auto &url{recordStreamURL()};
+  const auto pos{url.find("://")};
+  if (pos == std::string::npos) {
+    return false;
+  }
+  return std::find(archiveServices.begin(), archiveServices.end(),
+                   url.substr(0, pos)) == archiveServices.end();
+}
+
 bool Application::loadEvents(const std::string &eventDb,
                              DataModel::DatabaseQueryPtr db) {
   bool loaded{false};
@@ -1504,12 +1959,12 @@ std::set<util::WaveformStreamID> Application::collectStreams() const {
           ? Core::Time::GMT()
           : _config.playbackConfig.startTime};
 
-  for (const auto &detectorIdxPair : _detectorIdx) {
-    util::WaveformStreamID waveformStreamId{detectorIdxPair.first};
+  auto collect = [&](const std::string &streamId, bool createAmplitudes) {
+    util::WaveformStreamID waveformStreamId{streamId};
 
     ret.emplace(waveformStreamId);
 
-    if (_detectors[detectorIdxPair.second]->publishConfig().createAmplitudes) {
+    if (createAmplitudes) {
       try {
         auto amplitudeProcessingConfig{
             _bindings
@@ -1521,7 +1976,7 @@ std::set<util::WaveformStreamID> Application::collectStreams() const {
                                    std::end(amplitudeTypes),
                                    "MLx") == std::end(amplitudeTypes)};
         if (disabledMLx) {
-          continue;
+          return;
         }
 
         util::HorizontalComponents horizontalComponents{
@@ -1535,11 +1990,26 @@ std::set<util::WaveformStreamID> Application::collectStreams() const {
               horizontalComponents.locCode(), horizontalComponent->code()});
         }
       } catch (const Exception &) {
-        continue;
+        return;
       } catch (const std::out_of_range &) {
-        continue;
+        return;
       }
     }
+  };
+
+  for (const auto &detectorIdxPair : _detectorIdx) {
+    const auto &detector{_detectors[detectorIdxPair.second]};
+    collect(detectorIdxPair.first, detector->publishConfig().createAmplitudes);
+  }
+  // streams cannot be added to the record stream once acquisition started;
+  // thus, the streams of the detectors under construction are subscribed in
+  // advance
+  for (const auto &construction : _detectorConstructions) {
+    const auto &templateConfig{construction.templateConfig};
+    for (const auto &streamConfigPair : templateConfig) {
+      collect(streamConfigPair.first,
+              templateConfig.publishConfig().createAmplitudes);
+    }
   }
 
   return ret;
@@ -1563,9 +2033,12 @@ bool Application::initDetectors(std::ifstream &ifs,
                                 WaveformHandlerIface *waveformHandler,
                                 TemplateConfigs &templateConfigs) {
   try {
+    const auto start{std::chrono::steady_clock::now()};
+
     boost::property_tree::ptree pt;
     boost::property_tree::read_json(ifs, pt);
 
+    // configure the detector builders
     for (const auto &templateSettingPt : pt) {
       try {
         config::TemplateConfig tc{templateSettingPt.second,
@@ -1579,76 +2052,73 @@ bool Application::initDetectors(std::ifstream &ifs,
         SCDETECT_LOG_DEBUG("Creating detector processor (id=%s) ... ",
                            tc.detectorId().c_str());
 
-        auto detectorBuilder{
-            std::move(detector::Detector::Create(tc.originId())
-                          .setId(tc.detectorId())
-                          .setConfig(tc.publishConfig(), tc.detectorConfig(),
-                                     _config.playbackConfig.enabled))};
-
-        std::vector<WaveformStreamId> waveformStreamIds;
-        for (const auto &streamConfigPair : tc) {
-          try {
-            detectorBuilder.setStream(streamConfigPair.first,
-                                      streamConfigPair.second, waveformHandler);
-          } catch (builder::NoSensorLocation &e) {
-            if (_config.skipTemplateIfNoSensorLocationData) {
-              SCDETECT_LOG_WARNING(
-                  "%s. Skipping template waveform processor initialization.",
-                  e.what());
-              continue;
-            }
-            throw;
-          } catch (builder::NoStream &e) {
-            if (_config.skipTemplateIfNoStreamData) {
-              SCDETECT_LOG_WARNING(
-                  "%s. Skipping template waveform processor initialization.",
-                  e.what());
-              continue;
-            }
-            throw;
-          } catch (builder::NoPick &e) {
-            if (_config.skipTemplateIfNoPick) {
-              SCDETECT_LOG_WARNING(
-                  "%s. Skipping template waveform processor initialization.",
-                  e.what());
-              continue;
-            }
-            throw;
-          } catch (builder::NoWaveformData &e) {
-            if (_config.skipTemplateIfNoWaveformData) {
-              SCDETECT_LOG_WARNING(
-                  "%s. Skipping template waveform processor initialization.",
-                  e.what());
-              continue;
-            }
-            throw;
-          }
-          waveformStreamIds.push_back(streamConfigPair.first);
+        auto detectorBuilder{util::make_unique<detector::Detector::Builder>(
+            detector::Detector::Create(tc.originId()))};
+        detectorBuilder->setId(tc.detectorId())
+            .setConfig(tc.publishConfig(), tc.detectorConfig(),
+                       _config.playbackConfig.enabled);
+        // the subspace representation, template clustering and the fingerprint
+        // based similarity search are implemented by means of template banks
+        if (_config.templateBanks || _config.templateClusterSimilarity ||
+            _config.fingerprintSearch ||
+            !tc.detectorConfig().subspaceGroup.empty()) {
+          detectorBuilder->setTemplateBankRegistry(&_templateBankRegistry);
+        } else if (_config.sharedPreprocessing) {
+          detectorBuilder->setPreprocessingRegistry(&_preprocessingRegistry);
         }
-
-        auto detector{detectorBuilder.build()};
-        detector->setResultCallback(
-            [this](const detector::Detector *processor, const Record *record,
-                   std::unique_ptr<const detector::Detector::Detection>
-                       detection) {
-              processDetection(processor, record, std::move(detection));
-            });
-
-        _detectors.emplace_back(std::move(detector));
-        auto idx{_detectors.size() - 1};
-
-        for (const auto &waveformStreamId : waveformStreamIds) {
-          _detectorIdx.emplace(waveformStreamId, idx);
+        detectorBuilder->setCascadeTriggerRegistry(&_cascadeTriggerRegistry);
+        if (_config.autoTargetSamplingFrequency) {
+          detectorBuilder->setAutoTargetSamplingFrequency(
+              _config.autoTargetSamplingFrequencyMargin);
+        }
+        if (_workStealingPool) {
+          detectorBuilder->setWorkStealingPool(
+              _workStealingPool.get(),
+              static_cast<std::size_t>(
+                  _config.processorParallelMinProcessors));
         }
 
-        templateConfigs.push_back(tc);
-
+        _detectorConstructions.push_back(
+            DetectorConstruction{std::move(tc), std::move(detectorBuilder)});
       } catch (Exception &e) {
         SCDETECT_LOG_WARNING("Failed to create detector: %s. Skipping.",
                              e.what());
         continue;
       }
     }
+
+    if (_config.progressiveStartup) {
+      // the detectors are constructed in the background (see
+      // `startDetectorConstruction()`)
+      for (const auto &construction : _detectorConstructions) {
+        templateConfigs.push_back(construction.templateConfig);
+      }
+      return true;
+    }
+
+    constructDetectors(waveformHandler);
+    const auto loadingDuration{secondsSince(start)};
+
+    // finalize the detectors in the order of the template configuration
+    //
+    // - registering template waveform processors with the registries is not
+    // thread-safe and the order of registration defines the registries'
+    // layout
+    for (auto &construction : _detectorConstructions) {
+      if (registerDetector(construction)) {
+        templateConfigs.push_back(construction.templateConfig);
+      }
+    }
+
+    SCDETECT_LOG_INFO(
+        "Constructed %lu/%lu detectors in %.3fs (loading=%.3fs, threads=%d)",
+        templateConfigs.size(), _detectorConstructions.size(),
+        secondsSince(start), loadingDuration, _config.templateLoadingThreads);
+    if (auto *cached{dynamic_cast<Cached *>(waveformHandler)}) {
+      SCDETECT_LOG_DEBUG("Template waveform fetches deduplicated: %lu",
+                         cached->deduplicated());
+    }
+    _detectorConstructions.clear();
   } catch (boost::property_tree::json_parser::json_parser_error &e) {
     SCDETECT_LOG_ERROR(
         "Failed to parse JSON template configuration file (%s): %s",
@@ -1672,6 +2142,230 @@ bool Application::initDetectors(std::ifstream &ifs,
   return true;
 }
 
+void Application::constructDetectors(
+    WaveformHandlerIface *waveformHandler,
+    const std::function<void(std::size_t idx)> &onConstructed) {
+  const auto start{std::chrono::steady_clock::now()};
+  const auto total{_detectorConstructions.size()};
+  const auto progressInterval{std::max<std::size_t>(
+      1, total / settings::kTemplateLoadingProgressSteps)};
+  std::atomic<std::size_t> completed{0};
+  auto construct = [&](std::size_t idx) {
+    if (_detectorConstructionStopped) {
+      return;
+    }
+
+    constructDetector(_detectorConstructions[idx], waveformHandler);
+    if (onConstructed) {
+      onConstructed(idx);
+    }
+
+    const auto n{++completed};
+    if (n % progressInterval == 0 || n == total) {
+      SCDETECT_LOG_INFO(
+          "Loading templates: %lu/%lu detectors (%.0f%%, elapsed=%.3fs)", n,
+          total, 100.0 * n / total, secondsSince(start));
+    }
+  };
+
+  // loading the template waveforms (i.e. fetching, filtering, resampling and
+  // trimming) is by far the most expensive part of constructing a detector
+  if (_config.templateLoadingThreads > 0 && total > 1) {
+    util::WorkStealingPool pool{
+        static_cast<std::size_t>(_config.templateLoadingThreads)};
+    std::vector<util::WorkStealingPool::Task> tasks;
+    tasks.reserve(total);
+    for (std::size_t i{0}; i < total; ++i) {
+      tasks.emplace_back([&construct, i]() { construct(i); });
+    }
+    // exceptions other than `Exception` are rethrown in the order of the
+    // template configuration (i.e. as if constructed serially)
+    pool.run(tasks);
+  } else {
+    for (std::size_t i{0}; i < total; ++i) {
+      construct(i);
+    }
+  }
+}
+
+void Application::constructDetector(
+    DetectorConstruction &construction,
+    WaveformHandlerIface *waveformHandler) const {
+  try {
+    auto &detectorBuilder{*construction.builder};
+    for (const auto &streamConfigPair : construction.templateConfig) {
+      try {
+        detectorBuilder.setStream(streamConfigPair.first,
+                                  streamConfigPair.second, waveformHandler);
+      } catch (builder::NoSensorLocation &e) {
+        if (_config.skipTemplateIfNoSensorLocationData) {
+          SCDETECT_LOG_WARNING(
+              "%s. Skipping template waveform processor initialization.",
+              e.what());
+          continue;
+        }
+        throw;
+      } catch (builder::NoStream &e) {
+        if (_config.skipTemplateIfNoStreamData) {
+          SCDETECT_LOG_WARNING(
+              "%s. Skipping template waveform processor initialization.",
+              e.what());
+          continue;
+        }
+        throw;
+      } catch (builder::NoPick &e) {
+        if (_config.skipTemplateIfNoPick) {
+          SCDETECT_LOG_WARNING(
+              "%s. Skipping template waveform processor initialization.",
+              e.what());
+          continue;
+        }
+        throw;
+      } catch (builder::NoWaveformData &e) {
+        if (_config.skipTemplateIfNoWaveformData) {
+          SCDETECT_LOG_WARNING(
+              "%s. Skipping template waveform processor initialization.",
+              e.what());
+          continue;
+        }
+        throw;
+      }
+      construction.waveformStreamIds.push_back(streamConfigPair.first);
+    }
+  } catch (Exception &e) {
+    construction.error = e.what();
+  }
+}
+
+bool Application::registerDetector(DetectorConstruction &construction) {
+  try {
+    if (!construction.error.empty()) {
+      throw builder::BaseException{construction.error};
+    }
+
+    auto detector{construction.builder->build()};
+    construction.builder.reset();
+    detector->setResultCallback(
+        [this](const detector::Detector *processor, const Record *record,
+               std::unique_ptr<const detector::Detector::Detection>
+                   detection) {
+          // detections emitted by worker threads are processed by the main
+          // thread
+          if (_detectorWorkerPool &&
+              _detectorWorkerPool->collect(processor, record, detection)) {
+            return;
+          }
+          // detections emitted by the pipeline's processing stage are
+          // processed by the assembly stage
+          if (_detectionSink) {
+            _detectionSink->push_back(
+                {processor, record, std::move(detection)});
+            return;
+          }
+          processDetection(processor, record, std::move(detection));
+        });
+
+    _detectors.emplace_back(std::move(detector));
+    auto idx{_detectors.size() - 1};
+
+    for (const auto &waveformStreamId : construction.waveformStreamIds) {
+      _detectorIdx.emplace(waveformStreamId, idx);
+    }
+  } catch (Exception &e) {
+    construction.builder.reset();
+    SCDETECT_LOG_WARNING("Failed to create detector: %s. Skipping.",
+                         e.what());
+    return false;
+  }
+  return true;
+}
+
+void Application::startDetectorConstruction(
+    const WaveformHandlerIfacePtr &waveformHandler) {
+  SCDETECT_LOG_INFO(
+      "Constructing %lu detectors in the background (progressive startup)",
+      _detectorConstructions.size());
+
+  _detectorConstructionStart = std::chrono::steady_clock::now();
+  _detectorConstructionThread = std::thread{[this, waveformHandler]() {
+    try {
+      constructDetectors(waveformHandler.get(), [this](std::size_t idx) {
+        _constructedDetectors.push(idx);
+      });
+    } catch (std::exception &e) {
+      SCDETECT_LOG_ERROR("Failed to construct detectors: %s", e.what());
+    }
+    _detectorConstructionFinished.store(true, std::memory_order_release);
+  }};
+}
+
+void Application::registerConstructedDetectors() {
+  if (!_detectorConstructionThread.joinable()) {
+    return;
+  }
+
+  // load the flag before draining the queue such that the detectors constructed
+  // before finishing are registered, too
+  const auto finished{
+      _detectorConstructionFinished.load(std::memory_order_acquire)};
+
+  std::size_t idx;
+  bool flushed{false};
+  while (_constructedDetectors.tryPop(idx)) {
+    // the detectors and the registries are shared with the pipeline's
+    // processing stage and the detector workers
+    if (!flushed) {
+      if (_pipeline) {
+        _pipeline->flush();
+      }
+      if (_detectorWorkerPool) {
+        flushDetectorWorkerPool();
+      }
+      flushed = true;
+    }
+
+    auto &construction{_detectorConstructions[idx]};
+    if (!registerDetector(construction)) {
+      continue;
+    }
+
+    if (_detectorWorkerPool) {
+      _detectorWorkerPool->add(_detectors.back().get(),
+                               construction.waveformStreamIds);
+    }
+
+    SCDETECT_LOG_DEBUG("Registered detector (id=%s) after %.3fs",
+                       _detectors.back()->id().c_str(),
+                       secondsSince(_detectorConstructionStart));
+    if (_detectors.size() == 1) {
+      SCDETECT_LOG_INFO("First detector ready after %.3fs",
+                        secondsSince(_detectorConstructionStart));
+    }
+  }
+
+  if (!finished) {
+    return;
+  }
+
+  _detectorConstructionThread.join();
+  SCDETECT_LOG_INFO(
+      "Progressive startup finished: registered %lu/%lu detectors in %.3fs",
+      _detectors.size(), _detectorConstructions.size(),
+      secondsSince(_detectorConstructionStart));
+  _detectorConstructions.clear();
+  // free memory after initialization
+  EventStore::Instance().reset();
+}
+
+void Application::stopDetectorConstruction() {
+  if (!_detectorConstructionThread.joinable()) {
+    return;
+  }
+
+  _detectorConstructionStopped = true;
+  _detectorConstructionThread.join();
+}
+
 bool Application::initAmplitudeProcessors(
     std::shared_ptr<DetectionItem> &detectionItem,
     const detector::Detector &detectorProcessor) {
@@ -2221,6 +2915,88 @@ void Application::Config::init(const Client::Application *app) {
   } catch (...) {
   }
 
+  try {
+    templateBanks = app->configGetBool("processing.templateBanks");
+  } catch (...) {
+  }
+  try {
+    sharedPreprocessing =
+        app->configGetBool("processing.sharedPreprocessing");
+  } catch (...) {
+  }
+  try {
+    autoTargetSamplingFrequency =
+        app->configGetBool("processing.autoTargetSamplingFrequency");
+  } catch (...) {
+  }
+  try {
+    autoTargetSamplingFrequencyMargin =
+        app->configGetDouble("processing.autoTargetSamplingFrequencyMargin");
+  } catch (...) {
+  }
+  try {
+    polyphaseResampling =
+        app->configGetBool("processing.polyphaseResampling");
+  } catch (...) {
+  }
+  try {
+    templateClusterSimilarity =
+        app->configGetDouble("processing.templateClusterSimilarity");
+  } catch (...) {
+  }
+  try {
+    templateClusterBoundMargin =
+        app->configGetDouble("processing.templateClusterBoundMargin");
+  } catch (...) {
+  }
+  try {
+    correlationEngine = app->configGetString("processing.correlationEngine");
+  } catch (...) {
+  }
+  try {
+    workerThreads = app->configGetInt("processing.workerThreads");
+  } catch (...) {
+  }
+  try {
+    processorThreads = app->configGetInt("processing.processorThreads");
+  } catch (...) {
+  }
+  try {
+    processorParallelMinProcessors =
+        app->configGetInt("processing.processorParallelMinProcessors");
+  } catch (...) {
+  }
+  try {
+    templateLoadingThreads =
+        app->configGetInt("processing.templateLoadingThreads");
+  } catch (...) {
+  }
+  try {
+    progressiveStartup = app->configGetBool("processing.progressiveStartup");
+  } catch (...) {
+  }
+  try {
+    pipeline = app->configGetBool("processing.pipeline");
+  } catch (...) {
+  }
+  try {
+    pipelineQueueCapacity =
+        app->configGetInt("processing.pipelineQueueCapacity");
+  } catch (...) {
+  }
+  try {
+    fingerprintSearch = app->configGetBool("processing.fingerprintSearch");
+  } catch (...) {
+  }
+  try {
+    fingerprintHop = app->configGetDouble("processing.fingerprintHop");
+  } catch (...) {
+  }
+  try {
+    fingerprintMinVotes = app->configGetInt("processing.fingerprintMinVotes");
+  } catch (...) {
+  }
+
   try {
     streamConfig.filter = app->configGetString("processing.filter");
   } catch (...) {
@@ -2234,6 +3010,10 @@ void Application::Config::init(const Client::Application *app) {
         app->configGetBool("processing.gapInterpolation");
   } catch (...) {
   }
+  try {
+    detectorConfig.precision = app->configGetString("processing.precision");
+  } catch (...) {
+  }
   try {
     detectorConfig.gapThreshold =
         app->configGetDouble("processing.minGapLength");
@@ -2279,6 +3059,41 @@ void Application::Config::init(const Client::Application *app) {
         app->configGetString("detector.mergingStrategy");
   } catch (...) {
   }
+  try {
+    detectorConfig.coarseSearchDecimationFactor =
+        app->configGetInt("detector.coarseSearchDecimationFactor");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.coarseSearchThresholdFactor =
+        app->configGetDouble("detector.coarseSearchThresholdFactor");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.stackComponents =
+        app->configGetBool("detector.stackComponents");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.subspaceEnergyFraction =
+        app->configGetDouble("detector.subspaceEnergyFraction");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.cascadeTriggerThreshold =
+        app->configGetDouble("detector.cascadeTriggerThreshold");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.cascadeLookBack =
+        app->configGetDouble("detector.cascadeLookBack");
+  } catch (...) {
+  }
+  try {
+    detectorConfig.cascadeHoldDuration =
+        app->configGetDouble("detector.cascadeHoldDuration");
+  } catch (...) {
+  }
 
   try {
     sensorLocationBindings.amplitudeProcessingConfig.mlx.filter =
@@ -2310,6 +3125,30 @@ void Application::Config::init(const System::CommandLine &commandline) {
 
   offlineMode = commandline.hasOption("offline");
   noPublish = commandline.hasOption("no-publish");
+
+  if (commandline.hasOption("correlation-engine")) {
+    correlationEngine = commandline.option<std::string>("correlation-engine");
+  }
+  if (commandline.hasOption("worker-threads")) {
+    workerThreads = commandline.option<int>("worker-threads");
+  }
+  if (commandline.hasOption("pipeline")) {
+    pipeline = true;
+  }
+  if (commandline.hasOption("processor-threads")) {
+    processorThreads = commandline.option<int>("processor-threads");
+  }
+  if (commandline.hasOption("processor-parallel-min-processors")) {
+    processorParallelMinProcessors =
+        commandline.option<int>("processor-parallel-min-processors");
+  }
+  if (commandline.hasOption("template-loading-threads")) {
+    templateLoadingThreads =
+        commandline.option<int>("template-loading-threads");
+  }
+  if (commandline.hasOption("progressive-startup")) {
+    progressiveStartup = true;
+  }
 }
 
 }  // namespace detect
@@ -18,14 +18,18 @@
 #include <seiscomp/system/commandline.h>
 
 #include <boost/optional/optional.hpp>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -34,10 +38,14 @@
 #include "config/detector.h"
 #include "config/template_family.h"
 #include "detector/detector.h"
+#include "detector/worker_pool.h"
 #include "exception.h"
+#include "pipeline.h"
 #include "processing/timewindow_processor.h"
 #include "settings.h"
+#include "util/concurrent_queue.h"
 #include "util/waveform_stream_id.h"
+#include "util/work_stealing_pool.h"
 #include "waveform.h"
 
 namespace Seiscomp {
@@ -89,6 +97,76 @@ class Application : public Client::StreamApplication {
     boost::optional<Core::TimeSpan> forcedWaveformBufferSize{
         Core::TimeSpan{300.0}};
 
+    // Defines if template waveform processors sharing the same stream, filter
+    // and sampling frequency are cross-correlated by means of template banks
+    bool templateBanks{false};
+    // Defines if template waveform processors sharing the same stream, filter,
+    // target sampling frequency and gap configuration share the preprocessing
+    // (i.e. filtering and resampling) of the data, regardless of the detector
+    // they belong to
+    // - does not apply to template waveform processors delegating the
+    // cross-correlation to template banks
+    bool sharedPreprocessing{false};
+    // Defines if the target sampling frequency of template waveform
+    // processors is derived from the upper corner frequency of the filters
+    // configured (if no target sampling frequency is configured explicitly)
+    bool autoTargetSamplingFrequency{false};
+    // The ratio of the target sampling frequency derived and the filter's
+    // upper corner frequency
+    double autoTargetSamplingFrequencyMargin{
+        settings::kAutoTargetSamplingFrequencyMargin};
+    // Defines if data is resampled by means of the polyphase resampler (for
+    // sampling rate ratios with small terms) rather than by means of the
+    // Lanczos resampler
+    bool polyphaseResampling{false};
+    // The minimum similarity of the template waveforms of a template cluster
+    // (if not configured, template clustering is disabled)
+    // - template clustering is implemented by means of template banks
+    boost::optional<double> templateClusterSimilarity;
+    // The margin subtracted from the lower bounds w.r.t. template clustering
+    double templateClusterBoundMargin{0.02};
+    // Defines if template waveforms are searched for by means of waveform
+    // fingerprints (i.e. locality-sensitive hashing) prior to computing the
+    // cross-correlation
+    // - the fingerprint based similarity search is implemented by means of
+    // template banks
+    bool fingerprintSearch{false};
+    // The lag (in seconds) between subsequent data fingerprints
+    double fingerprintHop{0.1};
+    // The minimum number of votes required for a candidate match
+    int fingerprintMinVotes{2};
+
+    // The cross-correlation engine (if empty, the engine is selected by means
+    // of the cross-correlation filter's defaults); `"auto"` enables
+    // auto-tuning the engine at startup
+    std::string correlationEngine;
+
+    // The number of worker threads detectors are executed by (if `0`,
+    // detectors are executed by the main thread)
+    int workerThreads{0};
+    // The number of threads of the work stealing pool template waveform
+    // processors of a detector are evaluated in parallel with (if `0`, the
+    // processors are evaluated sequentially)
+    int processorThreads{0};
+    // The minimum number of template waveform processors per stream required
+    // for evaluating the processors in parallel
+    int processorParallelMinProcessors{
+        settings::kDetectorParallelMinProcessors};
+    // The number of threads template waveforms are loaded and detectors are
+    // constructed with at startup (if `0`, the detectors are constructed by
+    // the main thread)
+    int templateLoadingThreads{0};
+    // Defines if detectors are constructed in the background (i.e. each
+    // detector starts processing as soon as it is constructed)
+    bool progressiveStartup{false};
+
+    // Defines if records are processed by means of pipeline stages (i.e.
+    // processing the records is decoupled from ingesting the records and
+    // assembling the detections)
+    bool pipeline{false};
+    // The capacity of the queues connecting the pipeline stages
+    int pipelineQueueCapacity{settings::kPipelineQueueCapacity};
+
     // Defines if a detector should be initialized although template
     // processors could not be initialized due to missing waveform data.
     // XXX(damb): For the time being, this configuration parameter is not
@@ -323,6 +401,10 @@ class Application : public Client::StreamApplication {
       medianNetworkMagnitudeComputationStrategy;
 
   bool isEventDatabaseEnabled() const;
+  // Returns `true` if the records are acquired in real-time, else `false`
+  // (i.e. in case of playback or if the record stream refers to archived
+  // data)
+  bool isRealTimeInput() const;
 
   // Load events either from `eventDb` or `db`
   bool loadEvents(const std::string &eventDb, DataModel::DatabaseQueryPtr db);
@@ -376,6 +458,45 @@ class Application : public Client::StreamApplication {
   void removeTimeWindowProcessor(
       const std::shared_ptr<processing::TimeWindowProcessor> &processor);
 
+  // A detector under construction
+  struct DetectorConstruction {
+    config::TemplateConfig templateConfig;
+    std::unique_ptr<detector::Detector::Builder> builder;
+    // The streams the template waveform processors were set up for
+    std::vector<WaveformStreamId> waveformStreamIds;
+    // The reason why constructing the detector failed (if any)
+    std::string error;
+  };
+  using DetectorConstructions = std::vector<DetectorConstruction>;
+
+  // Loads the template waveforms and sets up the template waveform processors
+  // of the detectors under construction (concurrently, if
+  // `templateLoadingThreads` is configured). If set, `onConstructed` is
+  // called with the index of each detector constructed (possibly from
+  // multiple threads concurrently).
+  void constructDetectors(WaveformHandlerIface *waveformHandler,
+                          const std::function<void(std::size_t idx)>
+                              &onConstructed = nullptr);
+  // Sets up the template waveform processors of the detector under
+  // `construction` (thread-safe w.r.t. other detectors under construction)
+  void constructDetector(DetectorConstruction &construction,
+                         WaveformHandlerIface *waveformHandler) const;
+  // Finalizes the detector under `construction` and registers it for the
+  // streams it was set up for. Returns `true` on success, else `false`.
+  bool registerDetector(DetectorConstruction &construction);
+
+  // Starts constructing the detectors under construction in the background
+  // (progressive startup)
+  void startDetectorConstruction(
+      const WaveformHandlerIfacePtr &waveformHandler);
+  // Registers the detectors constructed in the background so far
+  //
+  // - must be called by the thread processing the records
+  void registerConstructedDetectors();
+  // Stops constructing detectors in the background (blocks until the
+  // background thread is joined)
+  void stopDetectorConstruction();
+
   // Registers a detection
   void registerDetection(const std::shared_ptr<DetectionItem> &detection);
   // Removes a detection
@@ -385,6 +506,19 @@ class Application : public Client::StreamApplication {
       const detector::Detector *processor, const Record *record,
       std::unique_ptr<const detector::Detector::Detection> detection);
 
+  // Processes `record` by means of the registries and the detectors. Returns
+  // the detections emitted which are not processed, yet.
+  RecordPipeline::Detections processRecord(const Record *record);
+  // Processes the `detections` emitted while processing `record` and feeds
+  // `record` to the time window processors
+  void assembleRecord(const Record *record,
+                      RecordPipeline::Detections &detections);
+  // Blocks until the detector workers processed the records in flight and
+  // processes the detections emitted
+  void flushDetectorWorkerPool();
+  // Logs the metrics of the record processing pipeline
+  void logPipelineMetrics() const;
+
   void publishDetection(const std::shared_ptr<DetectionItem> &detection);
   void publishDetection(const DetectionItem &detectionItem);
 
@@ -401,11 +535,30 @@ class Application : public Client::StreamApplication {
 
   DataModel::EventParametersPtr _ep;
 
+  // cascaded detectors refer to the pre-triggers owned by the registry; thus,
+  // the registry must be destroyed after the detectors
+  detector::CascadeTriggerRegistry _cascadeTriggerRegistry;
+
+  // detectors refer to the work stealing pool; thus, the pool must be destroyed
+  // after the detectors
+  std::unique_ptr<util::WorkStealingPool> _workStealingPool;
+
   Detectors _detectors;
 
   using DetectorIdx = std::unordered_multimap<WaveformStreamId, std::size_t>;
   DetectorIdx _detectorIdx;
 
+  // the worker pool refers to the detectors; thus, the pool must be destroyed
+  // first
+  std::unique_ptr<detector::WorkerPool> _detectorWorkerPool;
+
+  // template banks refer to the template waveform processors owned by the
+  // detectors; thus, the registry must be destroyed first
+  detector::TemplateBankRegistry _templateBankRegistry;
+  // preprocessing chains refer to the template waveform processors owned by the
+  // detectors; thus, the registry must be destroyed first
+  detector::PreprocessingRegistry _preprocessingRegistry;
+
   // Ringbuffer
   Processing::StreamBuffer _waveformBuffer;
 
@@ -443,6 +596,25 @@ class Application : public Client::StreamApplication {
   // Used to monitor the average object throughput
   Client::RunningAverage _averageObjectThroughputMonitor{
       settings::kObjectThroughputAverageTimeSpan};
+
+  // The detections emitted while processing a record by means of the
+  // pipeline (if any)
+  RecordPipeline::Detections *_detectionSink{nullptr};
+  // the pipeline refers to the facilities above; thus, the pipeline must be
+  // destroyed first
+  std::unique_ptr<RecordPipeline> _pipeline;
+
+  // The detectors under construction
+  DetectorConstructions _detectorConstructions;
+  // The indices of the detectors constructed in the background, but not
+  // registered, yet
+  util::MpscQueue<std::size_t> _constructedDetectors;
+  std::atomic<bool> _detectorConstructionFinished{false};
+  std::atomic<bool> _detectorConstructionStopped{false};
+  std::chrono::steady_clock::time_point _detectorConstructionStart;
+  // the background thread refers to the facilities above; thus, the thread must
+  // be joined first
+  std::thread _detectorConstructionThread;
 };
 
 }  // namespace detect
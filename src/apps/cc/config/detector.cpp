@@ -102,6 +102,7 @@ bool StreamConfig::isValid() const {
 }
 
 bool DetectorConfig::isValid(size_t numStreamConfigs) const {
+  std::string err;
   return (
       validateXCorrThreshold(triggerOn) && validateXCorrThreshold(triggerOff) &&
       (!gapInterpolation ||
@@ -109,7 +110,16 @@ bool DetectorConfig::isValid(size_t numStreamConfigs) const {
         util::isGeZero(gapTolerance) && gapThreshold < gapTolerance)) &&
       validateArrivalOffsetThreshold(arrivalOffsetThreshold) &&
       validateMinArrivals(minArrivals, static_cast<int>(numStreamConfigs)) &&
-      validateLinkerMergingStrategy(mergingStrategy));
+      validateLinkerMergingStrategy(mergingStrategy) &&
+      validatePrecision(precision) &&
+      validateCoarseSearchDecimationFactor(coarseSearchDecimationFactor) &&
+      validateCoarseSearchThresholdFactor(coarseSearchThresholdFactor) &&
+      validateSubspaceEnergyFraction(subspaceEnergyFraction) &&
+      (cascadeTriggerFilter.empty() ||
+       validateFilter(cascadeTriggerFilter, err)) &&
+      validateCascadeTriggerThreshold(cascadeTriggerThreshold) &&
+      validateCascadeDuration(cascadeLookBack) &&
+      validateCascadeDuration(cascadeHoldDuration));
 }
 
 TemplateConfig::TemplateConfig(const boost::property_tree::ptree &pt,
@@ -152,6 +162,30 @@ TemplateConfig::TemplateConfig(const boost::property_tree::ptree &pt,
       pt.get<int>("minimumArrivals", detectorDefaults.minArrivals);
   _detectorConfig.mergingStrategy =
       pt.get<std::string>("mergingStrategy", detectorDefaults.mergingStrategy);
+  _detectorConfig.precision =
+      pt.get<std::string>("precision", detectorDefaults.precision);
+  _detectorConfig.coarseSearchDecimationFactor =
+      pt.get<int>("coarseSearchDecimationFactor",
+                  detectorDefaults.coarseSearchDecimationFactor);
+  _detectorConfig.coarseSearchThresholdFactor =
+      pt.get<double>("coarseSearchThresholdFactor",
+                     detectorDefaults.coarseSearchThresholdFactor);
+  _detectorConfig.stackComponents =
+      pt.get<bool>("stackComponents", detectorDefaults.stackComponents);
+  _detectorConfig.subspaceGroup =
+      pt.get<std::string>("subspaceGroup", detectorDefaults.subspaceGroup);
+  _detectorConfig.subspaceEnergyFraction =
+      pt.get<double>("subspaceEnergyFraction",
+                     detectorDefaults.subspaceEnergyFraction);
+  _detectorConfig.cascadeTriggerFilter = pt.get<std::string>(
+      "cascadeTriggerFilter", detectorDefaults.cascadeTriggerFilter);
+  _detectorConfig.cascadeTriggerThreshold =
+      pt.get<double>("cascadeTriggerThreshold",
+                     detectorDefaults.cascadeTriggerThreshold);
+  _detectorConfig.cascadeLookBack =
+      pt.get<double>("cascadeLookBack", detectorDefaults.cascadeLookBack);
+  _detectorConfig.cascadeHoldDuration = pt.get<double>(
+      "cascadeHoldDuration", detectorDefaults.cascadeHoldDuration);
 
   // patch stream defaults with detector config globals
   auto patchedStreamDefaults{streamDefaults};
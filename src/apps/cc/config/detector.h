@@ -102,6 +102,45 @@ struct DetectorConfig {
   // criteria
   std::string mergingStrategy{"greaterEqualTriggerOnThreshold"};
 
+  // Defines the floating point precision the cross-correlation is computed
+  // with
+  // - "double" (default) or "float"
+  std::string precision{"double"};
+
+  // The decimation factor of the coarse-to-fine search
+  // - values less than 2 disable the coarse-to-fine search
+  int coarseSearchDecimationFactor{1};
+  // The fraction of `triggerOn` defining the coarse correlation coefficient
+  // threshold which selects the lags to be cross-correlated at full rate
+  double coarseSearchThresholdFactor{0.5};
+
+  // Flag indicating whether to stack the cross-correlation coefficients of the
+  // components (i.e. the streams of the same sensor location) such that a
+  // single match result is linked per sensor location
+  bool stackComponents{false};
+
+  // Identifies the group of templates (i.e. the template family) whose
+  // template waveforms are represented by means of a common subspace
+  // - an empty identifier disables the subspace representation (default)
+  std::string subspaceGroup;
+  // The fraction of the template waveforms' energy the subspace basis must
+  // capture
+  double subspaceEnergyFraction{0.99};
+
+  // The filter computing the characteristic function of the cheap pre-trigger
+  // gating the cross-correlation (cascaded detection), e.g. "STALTA(1,50)"
+  // - an empty filter identifier disables cascaded detection (default)
+  std::string cascadeTriggerFilter;
+  // The threshold the characteristic function must reach for the pre-trigger
+  // to fire
+  double cascadeTriggerThreshold{3};
+  // The duration in seconds of data preceding the pre-trigger onset which is
+  // cross-correlated when the detector is woken up
+  double cascadeLookBack{30};
+  // The duration in seconds after the pre-trigger fired for the last time
+  // until the detector becomes dormant, again
+  double cascadeHoldDuration{60};
+
   bool isValid(size_t numStreamConfigs) const;
 };
 
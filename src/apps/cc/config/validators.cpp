@@ -2,7 +2,7 @@
 
 #include <algorithm>
 
-#include "../processing/waveform_processor.h"
+#include "../filterstore.h"
 #include "../settings.h"
 
 namespace Seiscomp {
@@ -30,12 +30,7 @@ bool validateSamplingFrequency(double samplingFrequency) {
 }
 
 bool validateFilter(const std::string &filterId, std::string &err) {
-  auto filter{processing::WaveformProcessor::Filter::Create(filterId, &err)};
-  if (!filter) {
-    return false;
-  }
-  delete filter;
-  return true;
+  return FilterStore::Instance().validate(filterId, &err);
 }
 
 bool validateLinkerMergingStrategy(const std::string &mergingStrategy) {
@@ -53,6 +48,35 @@ bool validateAmplitudeType(const std::string &amplitudeType) {
   return validateMagnitudeType(amplitudeType);
 }
 
+bool validatePrecision(const std::string &precision) {
+  return std::find(kValidPrecisions.begin(), kValidPrecisions.end(),
+                   precision) != kValidPrecisions.end();
+}
+
+bool validateCorrelationEngine(const std::string &correlationEngine) {
+  return std::find(kValidCorrelationEngines.begin(),
+                   kValidCorrelationEngines.end(),
+                   correlationEngine) != kValidCorrelationEngines.end();
+}
+
+bool validateCoarseSearchDecimationFactor(int decimationFactor) {
+  return decimationFactor >= 1;
+}
+
+bool validateCoarseSearchThresholdFactor(double thresholdFactor) {
+  return thresholdFactor > 0 && thresholdFactor <= 1;
+}
+
+bool validateSubspaceEnergyFraction(double energyFraction) {
+  return energyFraction > 0 && energyFraction <= 1;
+}
+
+bool validateCascadeTriggerThreshold(double threshold) {
+  return threshold > 0;
+}
+
+bool validateCascadeDuration(double duration) { return duration >= 0; }
+
 }  // namespace config
 }  // namespace detect
 }  // namespace Seiscomp
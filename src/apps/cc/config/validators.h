@@ -13,6 +13,12 @@ static const std::vector<std::string> kValidLinkerMergingStrategies{
 
 static const std::vector<std::string> kValidMagnitudeTypes{"MRelative", "MLx"};
 
+static const std::vector<std::string> kValidPrecisions{"double", "float"};
+
+static const std::vector<std::string> kValidCorrelationEngines{
+    "auto",           "timeDomain",     "timeDomainScalar", "timeDomainSSE2",
+    "timeDomainAVX2", "timeDomainAVX512", "frequencyDomain"};
+
 bool validateXCorrThreshold(const double &thres);
 bool validateArrivalOffsetThreshold(double thres);
 bool validateMinArrivals(int n, int numStreamConfigs = 0);
@@ -21,6 +27,13 @@ bool validateFilter(const std::string &filterId, std::string &err);
 bool validateLinkerMergingStrategy(const std::string &mergingStrategy);
 bool validateMagnitudeType(const std::string &magnitudeType);
 bool validateAmplitudeType(const std::string &amplitudeType);
+bool validatePrecision(const std::string &precision);
+bool validateCorrelationEngine(const std::string &correlationEngine);
+bool validateCoarseSearchDecimationFactor(int decimationFactor);
+bool validateCoarseSearchThresholdFactor(double thresholdFactor);
+bool validateSubspaceEnergyFraction(double energyFraction);
+bool validateCascadeTriggerThreshold(double threshold);
+bool validateCascadeDuration(double duration);
 
 }  // namespace config
 }  // namespace detect
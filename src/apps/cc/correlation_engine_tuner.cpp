@@ -0,0 +1,381 @@
+#include "correlation_engine_tuner.h"
+
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "log.h"
+#include "settings.h"
+#include "util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+
+namespace {
+
+const std::string kTimeDomain{"timeDomain"};
+const std::string kFrequencyDomain{"frequencyDomain"};
+const char kCacheSep{'\t'};
+
+std::string to_string(filter::Precision precision) {
+  return precision == filter::Precision::kSingle ? "float" : "double";
+}
+
+// Returns the instruction sets supported by the host (in ascending order)
+std::vector<filter::detail::InstructionSet> supportedInstructionSets() {
+  std::vector<filter::detail::InstructionSet> ret;
+  const auto detected{filter::detail::detectInstructionSet()};
+  for (auto instructionSet : {filter::detail::InstructionSet::kScalar,
+                              filter::detail::InstructionSet::kSSE2,
+                              filter::detail::InstructionSet::kAVX2,
+                              filter::detail::InstructionSet::kAVX512}) {
+    if (static_cast<int>(instructionSet) <= static_cast<int>(detected)) {
+      ret.push_back(instructionSet);
+    }
+  }
+  return ret;
+}
+
+// Returns the runtime (in seconds) of cross-correlating a record of
+// `recordSize` samples with a template waveform of `templateSize` samples by
+// means of the engine configured by `config`
+template <typename TData>
+double benchmark(const CorrelationEngineConfig &config,
+                 std::size_t templateSize, std::size_t recordSize) {
+  // use a fixed seed such that the candidates are benchmarked w.r.t. the same
+  // data
+  std::mt19937 generator{42};
+  std::normal_distribution<double> distribution;
+
+  std::vector<double> templateData(templateSize);
+  for (auto &sample : templateData) {
+    sample = distribution(generator);
+  }
+  auto templateTrace{util::make_smart<GenericRecord>(
+      "NET", "STA", "LOC", "CHA", Core::Time::GMT(), 1.0)};
+  templateTrace->setData(static_cast<int>(templateData.size()),
+                         templateData.data(), Array::DOUBLE);
+
+  filter::CrossCorrelation<TData> crossCorrelation{templateTrace};
+  crossCorrelation.setEngine(config.engine);
+  crossCorrelation.setInstructionSet(config.instructionSet);
+  crossCorrelation.setSamplingFrequency(1.0);
+
+  std::vector<TData> record(recordSize);
+  for (auto &sample : record) {
+    sample = static_cast<TData>(distribution(generator));
+  }
+
+  std::vector<TData> data(recordSize);
+  using Clock = std::chrono::steady_clock;
+  const std::chrono::duration<double> budget{
+      settings::kCorrelationEngineTuneDuration};
+  double ret{std::numeric_limits<double>::max()};
+  // the first repetition warms up caches and scratch buffers
+  const auto start{Clock::now()};
+  for (std::size_t i = 0;
+       i <= settings::kCorrelationEngineTuneMinRepetitions ||
+       Clock::now() - start < budget;
+       ++i) {
+    std::copy(record.begin(), record.end(), data.begin());
+    const auto begin{Clock::now()};
+    crossCorrelation.apply(data.size(), data.data());
+    const std::chrono::duration<double> elapsed{Clock::now() - begin};
+    if (i > 0) {
+      ret = std::min(ret, elapsed.count());
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
+bool operator==(const CorrelationEngineConfig &lhs,
+                const CorrelationEngineConfig &rhs) {
+  return lhs.engine == rhs.engine &&
+         (lhs.engine == filter::CorrelationEngine::kFrequencyDomain ||
+          lhs.instructionSet == rhs.instructionSet);
+}
+
+bool operator!=(const CorrelationEngineConfig &lhs,
+                const CorrelationEngineConfig &rhs) {
+  return !(lhs == rhs);
+}
+
+std::string to_string(const CorrelationEngineConfig &config) {
+  if (config.engine == filter::CorrelationEngine::kFrequencyDomain) {
+    return kFrequencyDomain;
+  }
+
+  switch (config.instructionSet) {
+    case filter::detail::InstructionSet::kSSE2:
+      return kTimeDomain + "SSE2";
+    case filter::detail::InstructionSet::kAVX2:
+      return kTimeDomain + "AVX2";
+    case filter::detail::InstructionSet::kAVX512:
+      return kTimeDomain + "AVX512";
+    case filter::detail::InstructionSet::kScalar:
+    default:
+      return kTimeDomain + "Scalar";
+  }
+}
+
+boost::optional<CorrelationEngineConfig> parseCorrelationEngineConfig(
+    const std::string &str) {
+  CorrelationEngineConfig ret;
+  if (str == kFrequencyDomain) {
+    ret.engine = filter::CorrelationEngine::kFrequencyDomain;
+    ret.instructionSet = filter::detail::detectInstructionSet();
+    return ret;
+  }
+  if (str == kTimeDomain) {
+    ret.instructionSet = filter::detail::detectInstructionSet();
+    return ret;
+  }
+
+  for (auto instructionSet : {filter::detail::InstructionSet::kScalar,
+                              filter::detail::InstructionSet::kSSE2,
+                              filter::detail::InstructionSet::kAVX2,
+                              filter::detail::InstructionSet::kAVX512}) {
+    ret.instructionSet = instructionSet;
+    if (str == to_string(ret)) {
+      return ret;
+    }
+  }
+  return boost::none;
+}
+
+bool isSupported(const CorrelationEngineConfig &config) {
+  return config.engine == filter::CorrelationEngine::kFrequencyDomain ||
+         static_cast<int>(config.instructionSet) <=
+             static_cast<int>(filter::detail::detectInstructionSet());
+}
+
+CorrelationEngineTuner &CorrelationEngineTuner::Instance() {
+  // guaranteed to be destroyed; instantiated on first use
+  static CorrelationEngineTuner instance;
+  return instance;
+}
+
+void CorrelationEngineTuner::setAutoTune(bool enabled) {
+  _autoTune = enabled;
+}
+
+void CorrelationEngineTuner::setForced(
+    const boost::optional<CorrelationEngineConfig> &config) {
+  _forced = config;
+}
+
+void CorrelationEngineTuner::setCachePath(const std::string &path) {
+  _pathCache = path;
+  if (_pathCache.empty()) {
+    return;
+  }
+
+  std::ifstream ifs{_pathCache};
+  if (!ifs) {
+    return;
+  }
+
+  // cache file format (one entry per line, tab separated):
+  // cpuModel precision templateSize recordSize engine
+  const auto model{cpuModel()};
+  std::size_t loaded{0};
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::vector<std::string> tokens;
+    std::istringstream iss{line};
+    std::string token;
+    while (std::getline(iss, token, kCacheSep)) {
+      tokens.push_back(token);
+    }
+    if (tokens.size() != 5 || tokens[0] != model) {
+      continue;
+    }
+
+    try {
+      const auto precision{tokens[1] == to_string(filter::Precision::kSingle)
+                               ? filter::Precision::kSingle
+                               : filter::Precision::kDouble};
+      const Key key{precision, std::stoul(tokens[2]),
+                    recordSizeBucket(std::stoul(tokens[3]))};
+      const auto config{parseCorrelationEngineConfig(tokens[4])};
+      if (config) {
+        _selected[key] = *config;
+        ++loaded;
+      }
+    } catch (std::exception &) {
+      SCDETECT_LOG_WARNING(
+          "Invalid cross-correlation engine cache entry (%s): %s",
+          _pathCache.c_str(), line.c_str());
+    }
+  }
+
+  SCDETECT_LOG_DEBUG(
+      "Loaded %lu cached cross-correlation engine(s) (%s, cpu_model=%s)",
+      loaded, _pathCache.c_str(), model.c_str());
+}
+
+boost::optional<CorrelationEngineConfig> CorrelationEngineTuner::select(
+    filter::Precision precision, std::size_t templateSize,
+    std::size_t recordSize) {
+  if (_forced) {
+    return _forced;
+  }
+  if (!_autoTune || !templateSize || !recordSize) {
+    return boost::none;
+  }
+
+  const Key key{precision, templateSize, recordSizeBucket(recordSize)};
+  // benchmarking while holding the lock serializes tuning among detector
+  // workers
+  std::lock_guard<std::mutex> lock{_mutex};
+  auto it{_selected.find(key)};
+  bool cached{true};
+  if (it == _selected.end()) {
+    it = _selected.emplace(key, tune(key)).first;
+    store(key, it->second);
+    cached = false;
+  }
+
+  if (_reported.insert(key).second) {
+    SCDETECT_LOG_INFO(
+        "Cross-correlation engine selected (precision=%s, "
+        "template_size=%lu, record_size_bucket=%lu): %s (%s)",
+        to_string(precision).c_str(), templateSize, std::get<2>(key),
+        to_string(it->second).c_str(), cached ? "cached" : "benchmarked");
+  }
+  return it->second;
+}
+
+boost::optional<CorrelationEngineConfig> CorrelationEngineTuner::lookup(
+    filter::Precision precision, std::size_t templateSize,
+    std::size_t recordSize) {
+  if (_forced) {
+    return _forced;
+  }
+
+  const auto bucket{recordSizeBucket(recordSize)};
+  const auto matches = [precision, templateSize](const Key &key) {
+    return std::get<0>(key) == precision && std::get<1>(key) == templateSize;
+  };
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  auto it{_selected.lower_bound(Key{precision, templateSize, bucket})};
+  auto nearest{_selected.end()};
+  if (it != _selected.end() && matches(it->first)) {
+    nearest = it;
+  }
+  // buckets are powers of two i.e. the nearest bucket is the one with the
+  // smallest ratio
+  if (it != _selected.begin()) {
+    const auto prev{std::prev(it)};
+    if (matches(prev->first) &&
+        (nearest == _selected.end() ||
+         bucket / std::get<2>(prev->first) <
+             std::get<2>(nearest->first) / bucket)) {
+      nearest = prev;
+    }
+  }
+
+  if (nearest == _selected.end()) {
+    return boost::none;
+  }
+  return nearest->second;
+}
+
+void CorrelationEngineTuner::reset() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _selected.clear();
+  _reported.clear();
+}
+
+std::string CorrelationEngineTuner::cpuModel() {
+  std::ifstream ifs{"/proc/cpuinfo"};
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.compare(0, 10, "model name") != 0) {
+      continue;
+    }
+    const auto pos{line.find(':')};
+    if (pos == std::string::npos) {
+      break;
+    }
+    auto ret{line.substr(pos + 1)};
+    ret.erase(0, ret.find_first_not_of(" \t"));
+    std::replace(ret.begin(), ret.end(), kCacheSep, ' ');
+    return ret;
+  }
+  return "unknown";
+}
+
+std::size_t CorrelationEngineTuner::recordSizeBucket(std::size_t recordSize) {
+  std::size_t ret{1};
+  while (ret < recordSize) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+CorrelationEngineConfig CorrelationEngineTuner::tune(const Key &key) const {
+  const auto precision{std::get<0>(key)};
+  const auto templateSize{std::get<1>(key)};
+  const auto recordSize{std::get<2>(key)};
+
+  std::vector<CorrelationEngineConfig> candidates;
+  for (auto instructionSet : supportedInstructionSets()) {
+    candidates.push_back(CorrelationEngineConfig{
+        filter::CorrelationEngine::kTimeDomain, instructionSet});
+  }
+  candidates.push_back(
+      CorrelationEngineConfig{filter::CorrelationEngine::kFrequencyDomain,
+                              filter::detail::detectInstructionSet()});
+
+  CorrelationEngineConfig ret{candidates.front()};
+  double fastest{std::numeric_limits<double>::max()};
+  for (const auto &candidate : candidates) {
+    const double runtime{
+        precision == filter::Precision::kSingle
+            ? benchmark<float>(candidate, templateSize, recordSize)
+            : benchmark<double>(candidate, templateSize, recordSize)};
+    SCDETECT_LOG_DEBUG(
+        "Cross-correlation engine benchmark (precision=%s, template_size=%lu, "
+        "record_size=%lu): %s: %.3f us",
+        to_string(precision).c_str(), templateSize, recordSize,
+        to_string(candidate).c_str(), runtime * 1e6);
+    if (runtime < fastest) {
+      fastest = runtime;
+      ret = candidate;
+    }
+  }
+  return ret;
+}
+
+void CorrelationEngineTuner::store(
+    const Key &key, const CorrelationEngineConfig &config) const {
+  if (_pathCache.empty()) {
+    return;
+  }
+
+  std::ofstream ofs{_pathCache, std::ios::app};
+  if (!ofs) {
+    SCDETECT_LOG_WARNING(
+        "Failed to cache cross-correlation engine: failed to open file: %s",
+        _pathCache.c_str());
+    return;
+  }
+  ofs << cpuModel() << kCacheSep << to_string(std::get<0>(key)) << kCacheSep
+      << std::get<1>(key) << kCacheSep << std::get<2>(key) << kCacheSep
+      << to_string(config) << '\n';
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
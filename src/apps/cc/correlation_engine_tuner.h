@@ -0,0 +1,136 @@
+#ifndef SCDETECT_APPS_CC_CORRELATIONENGINETUNER_H_
+#define SCDETECT_APPS_CC_CORRELATIONENGINETUNER_H_
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include "filter/crosscorrelation.h"
+#include "filter/detail/kernel.h"
+
+namespace Seiscomp {
+namespace detect {
+
+// Cross-correlation engine configuration
+struct CorrelationEngineConfig {
+  filter::CorrelationEngine engine{filter::CorrelationEngine::kTimeDomain};
+  // The instruction set of the dot products kernel (taken into account by the
+  // time domain engine, only)
+  filter::detail::InstructionSet instructionSet{
+      filter::detail::InstructionSet::kScalar};
+
+  friend bool operator==(const CorrelationEngineConfig &lhs,
+                         const CorrelationEngineConfig &rhs);
+  friend bool operator!=(const CorrelationEngineConfig &lhs,
+                         const CorrelationEngineConfig &rhs);
+};
+
+// Returns the identifier of `config` (e.g. `"timeDomainAVX2"` or
+// `"frequencyDomain"`)
+std::string to_string(const CorrelationEngineConfig &config);
+// Parses the cross-correlation engine configuration identified by `str`.
+// Besides of the identifiers returned by `to_string()`, `"timeDomain"`
+// refers to the time domain engine with the most capable instruction set
+// supported by the host. Returns `boost::none` if `str` is not a valid
+// identifier.
+boost::optional<CorrelationEngineConfig> parseCorrelationEngineConfig(
+    const std::string &str);
+
+// Returns `true` if the host supports the engine configuration `config`
+// (i.e. the instruction set of the time domain engine), else `false`
+bool isSupported(const CorrelationEngineConfig &config);
+
+// A global store for the cross-correlation engine configurations selected
+// - implements the Singleton Design Pattern
+// - if auto-tuning is enabled, the candidate engines (i.e. the time domain
+// engine w.r.t. each of the instruction sets supported by the host and the
+// frequency domain engine) are benchmarked once per distinct triple of
+// precision, template waveform size and record size bucket; the fastest
+// engine is selected
+// - record sizes are bucketed (see `recordSizeBucket()`) since the size of
+// records (e.g. Steim compressed miniSEED records) varies
+// - the engines selected are cached on disk keyed by the host's CPU model
+// - if an engine is forced, the forced engine is selected, regardless
+// - both `select()` and `lookup()` are thread-safe
+class CorrelationEngineTuner {
+ public:
+  static CorrelationEngineTuner &Instance();
+
+  CorrelationEngineTuner(const CorrelationEngineTuner &) = delete;
+  CorrelationEngineTuner &operator=(const CorrelationEngineTuner &) = delete;
+
+  // Enables (`true`) or disables (`false`) auto-tuning
+  void setAutoTune(bool enabled);
+  // Forces the engine configuration `config`. If `boost::none`, no engine is
+  // forced.
+  void setForced(const boost::optional<CorrelationEngineConfig> &config);
+  // Sets the path to the cache file and loads the engines cached w.r.t. the
+  // host's CPU model. If `path` is empty, the engines selected are not
+  // cached.
+  void setCachePath(const std::string &path);
+
+  // Returns the engine configuration for cross-correlating template waveforms
+  // of `templateSize` samples with records of `recordSize` samples in
+  // `precision`. Returns `boost::none` if neither auto-tuning is enabled nor
+  // an engine is forced (i.e. the engine is selected by means of the
+  // cross-correlation filter's defaults).
+  //
+  // - benchmarks the candidate engines if the engine is neither cached nor
+  // forced; hence, intended to be used when setting up detectors rather than
+  // while processing data (see also `lookup()`)
+  boost::optional<CorrelationEngineConfig> select(filter::Precision precision,
+                                                  std::size_t templateSize,
+                                                  std::size_t recordSize);
+  // Returns the engine configuration previously selected for cross-correlating
+  // template waveforms of `templateSize` samples with records of `recordSize`
+  // samples in `precision`. If there is no engine selected w.r.t. the record
+  // size bucket of `recordSize`, the engine selected w.r.t. the nearest record
+  // size bucket is returned. Returns `boost::none` if no engine was selected
+  // for `precision` and `templateSize`, at all, and no engine is forced.
+  //
+  // - never benchmarks the candidate engines
+  boost::optional<CorrelationEngineConfig> lookup(filter::Precision precision,
+                                                  std::size_t templateSize,
+                                                  std::size_t recordSize);
+
+  // Reset the store
+  void reset();
+
+  // Returns the host's CPU model
+  static std::string cpuModel();
+  // Returns the record size bucket of `recordSize` i.e. the smallest power of
+  // two greater than or equal to `recordSize`
+  static std::size_t recordSizeBucket(std::size_t recordSize);
+
+ private:
+  CorrelationEngineTuner() = default;
+
+  using Key = std::tuple<filter::Precision, std::size_t, std::size_t>;
+
+  // Benchmarks the candidate engines w.r.t. `key` and returns the fastest
+  CorrelationEngineConfig tune(const Key &key) const;
+  // Appends the engine configuration `config` selected w.r.t. `key` to the
+  // cache file
+  void store(const Key &key, const CorrelationEngineConfig &config) const;
+
+  using Selected = std::map<Key, CorrelationEngineConfig>;
+  Selected _selected;
+  // The keys the engine selected has been reported for
+  std::set<Key> _reported;
+
+  std::string _pathCache;
+
+  boost::optional<CorrelationEngineConfig> _forced;
+  bool _autoTune{false};
+
+  std::mutex _mutex;
+};
+
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_CORRELATIONENGINETUNER_H_
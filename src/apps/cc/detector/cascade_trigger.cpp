@@ -0,0 +1,118 @@
+#include "cascade_trigger.h"
+
+#include "../log.h"
+#include "../processing/waveform_operator.h"
+#include "../settings.h"
+#include "../util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+CascadeTrigger::CascadeTrigger(const std::string &filterId, double threshold)
+    : _threshold{threshold} {
+  _streamState.filter = processing::createFilter(filterId);
+}
+
+const boost::optional<Core::Time> &CascadeTrigger::onset() const {
+  return _onset;
+}
+
+const boost::optional<Core::Time> &CascadeTrigger::lastTriggered() const {
+  return _lastTriggered;
+}
+
+void CascadeTrigger::reset() {
+  WaveformProcessor::reset(_streamState);
+  _triggered = false;
+  WaveformProcessor::reset();
+}
+
+std::string CascadeTrigger::key(const std::string &waveformStreamId,
+                                const std::string &filterId,
+                                double threshold) {
+  return waveformStreamId + settings::kProcessorIdSep + filterId +
+         settings::kProcessorIdSep + std::to_string(threshold);
+}
+
+processing::WaveformProcessor::StreamState *CascadeTrigger::streamState(
+    const Record *record) {
+  return &_streamState;
+}
+
+void CascadeTrigger::process(StreamState &streamState, const Record *record,
+                             const DoubleArray &filteredData) {
+  const auto n{filteredData.size()};
+  setStatus(Status::kInProgress, 1);
+
+  const auto &tw{record->timeWindow()};
+  for (int i = 0; i < n; ++i) {
+    if (!(filteredData[i] >= _threshold)) {
+      _triggered = false;
+      continue;
+    }
+
+    const auto t{static_cast<double>(i) / n};
+    const Core::Time time{tw.startTime() + Core::TimeSpan{tw.length() * t}};
+    if (!_triggered) {
+      SCDETECT_LOG_DEBUG_PROCESSOR(this, "%s: triggered (onset=%s)",
+                                   record->streamID().c_str(),
+                                   time.iso().c_str());
+      _onset = time;
+      _triggered = true;
+    }
+    _lastTriggered = time;
+  }
+}
+
+bool CascadeTrigger::store(const Record *record) {
+  processing::WaveformProcessor::store(record);
+
+  return !finished();
+}
+
+const CascadeTrigger *CascadeTriggerRegistry::add(
+    const std::string &waveformStreamId, const std::string &filterId,
+    double threshold) {
+  const auto key{CascadeTrigger::key(waveformStreamId, filterId, threshold)};
+
+  auto it{_cascadeTriggers.find(key)};
+  if (it == _cascadeTriggers.end()) {
+    auto cascadeTrigger{util::make_unique<CascadeTrigger>(filterId, threshold)};
+    cascadeTrigger->setId(key);
+    _cascadeTriggerIdx.emplace(waveformStreamId, cascadeTrigger.get());
+    it = _cascadeTriggers.emplace(key, std::move(cascadeTrigger)).first;
+  }
+
+  return it->second.get();
+}
+
+void CascadeTriggerRegistry::feed(const Record *record) {
+  auto range{_cascadeTriggerIdx.equal_range(record->streamID())};
+  for (auto it = range.first; it != range.second; ++it) {
+    auto *cascadeTrigger{it->second};
+    if (!cascadeTrigger->feed(record)) {
+      SCDETECT_LOG_WARNING_PROCESSOR(
+          cascadeTrigger,
+          "%s: Failed to feed record into cascade trigger. Resetting.",
+          record->streamID().c_str());
+      cascadeTrigger->reset();
+    }
+  }
+}
+
+void CascadeTriggerRegistry::reset() {
+  for (auto &cascadeTriggerPair : _cascadeTriggers) {
+    cascadeTriggerPair.second->reset();
+  }
+}
+
+std::size_t CascadeTriggerRegistry::size() const {
+  return _cascadeTriggers.size();
+}
+
+bool CascadeTriggerRegistry::empty() const { return _cascadeTriggers.empty(); }
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,102 @@
+#ifndef SCDETECT_APPS_CC_DETECTOR_CASCADETRIGGER_H_
+#define SCDETECT_APPS_CC_DETECTOR_CASCADETRIGGER_H_
+
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/record.h>
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "../processing/waveform_processor.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+// Cheap pre-trigger gating the cross-correlation of cascaded detectors
+//
+// - computes a characteristic function (e.g. STA/LTA) of the records of a
+// single waveform stream by means of a filter (e.g. `"STALTA(1,50)"`)
+// - the trigger fires as long as the characteristic function is greater than
+// or equal to the threshold configured
+// - shared by all cascaded detectors processing the same stream (see also
+// `CascadeTriggerRegistry`)
+class CascadeTrigger : public processing::WaveformProcessor {
+ public:
+  // Creates a `CascadeTrigger` computing the characteristic function by means
+  // of the filter identified by `filterId`
+  CascadeTrigger(const std::string &filterId, double threshold);
+
+  // Returns the time of the first sample of the most recent trigger
+  const boost::optional<Core::Time> &onset() const;
+  // Returns the time of the most recent sample the trigger fired for
+  const boost::optional<Core::Time> &lastTriggered() const;
+
+  void reset() override;
+
+  // Returns the key identifying the trigger processing the records identified
+  // by `waveformStreamId`
+  static std::string key(const std::string &waveformStreamId,
+                         const std::string &filterId, double threshold);
+
+ protected:
+  WaveformProcessor::StreamState *streamState(const Record *record) override;
+
+  void process(StreamState &streamState, const Record *record,
+               const DoubleArray &filteredData) override;
+
+  bool store(const Record *record) override;
+
+ private:
+  StreamState _streamState;
+
+  double _threshold;
+
+  bool _triggered{false};
+  boost::optional<Core::Time> _onset;
+  boost::optional<Core::Time> _lastTriggered;
+};
+
+// Registry of cascade pre-triggers
+class CascadeTriggerRegistry {
+ public:
+  // Returns the trigger processing the records identified by
+  // `waveformStreamId` w.r.t. `filterId` and `threshold`. If there is no
+  // matching trigger, yet, the trigger is created.
+  //
+  // - throws a `processing::WaveformProcessor::BaseException` if `filterId`
+  // cannot be compiled
+  const CascadeTrigger *add(const std::string &waveformStreamId,
+                            const std::string &filterId, double threshold);
+
+  // Feeds `record` to the triggers processing the corresponding stream
+  void feed(const Record *record);
+
+  // Resets all triggers
+  void reset();
+
+  // Returns the number of triggers
+  std::size_t size() const;
+  // Returns `true` if there are no triggers registered, else `false`
+  bool empty() const;
+
+ private:
+  using CascadeTriggers =
+      std::unordered_map<std::string, std::unique_ptr<CascadeTrigger>>;
+  // Triggers by key
+  CascadeTriggers _cascadeTriggers;
+
+  using CascadeTriggerIdx =
+      std::unordered_multimap<std::string, CascadeTrigger *>;
+  // Triggers by waveform stream identifier
+  CascadeTriggerIdx _cascadeTriggerIdx;
+};
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_DETECTOR_CASCADETRIGGER_H_
@@ -2,9 +2,18 @@
 
 #include <seiscomp/client/inventory.h>
 
+#include <algorithm>
+#include <boost/algorithm/string/join.hpp>
+#include <cassert>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #include "../eventstore.h"
 #include "../log.h"
 #include "../settings.h"
+#include "../util/filter.h"
 #include "../util/memory.h"
 #include "../util/waveform_stream_id.h"
 #include "linker/association.h"
@@ -13,6 +22,14 @@ namespace Seiscomp {
 namespace detect {
 namespace detector {
 
+namespace {
+
+// Serializes the event parameter and inventory lookups of builders running
+// concurrently (the lookups are not thread-safe)
+std::mutex metadataMutex;
+
+}  // namespace
+
 Detector::Builder::Builder(const std::string &originId) : _originId{originId} {
   DataModel::OriginCPtr origin{
       EventStore::Instance().getWithChildren<DataModel::Origin>(originId)};
@@ -61,6 +78,38 @@ Detector::Builder &Detector::Builder::setConfig(
   return *this;
 }
 
+Detector::Builder &Detector::Builder::setTemplateBankRegistry(
+    TemplateBankRegistry *registry) {
+  _templateBankRegistry = registry;
+  return *this;
+}
+
+Detector::Builder &Detector::Builder::setPreprocessingRegistry(
+    PreprocessingRegistry *registry) {
+  _preprocessingRegistry = registry;
+  return *this;
+}
+
+Detector::Builder &Detector::Builder::setCascadeTriggerRegistry(
+    CascadeTriggerRegistry *registry) {
+  _cascadeTriggerRegistry = registry;
+  return *this;
+}
+
+Detector::Builder &Detector::Builder::setAutoTargetSamplingFrequency(
+    double margin) {
+  assert((margin > 2));
+  _autoTargetSamplingFrequencyMargin = margin;
+  return *this;
+}
+
+Detector::Builder &Detector::Builder::setWorkStealingPool(
+    util::WorkStealingPool *pool, std::size_t minProcessors) {
+  assert((minProcessors > 0));
+  product()->_detectorImpl.setWorkStealingPool(pool, minProcessors);
+  return *this;
+}
+
 Detector::Builder &Detector::Builder::setStream(
     const std::string &streamId, const config::StreamConfig &streamConfig,
     WaveformHandlerIface *waveformHandler) {
@@ -68,6 +117,7 @@ Detector::Builder &Detector::Builder::setStream(
   util::WaveformStreamID templateWfStreamId{templateStreamId};
 
   logging::TaggedMessage msg{streamId + " (" + templateStreamId + ")"};
+  std::unique_lock<std::mutex> metadataLock{metadataMutex};
   // configure pick from arrival
   DataModel::PickPtr pick;
   DataModel::WaveformStreamID pickWaveformId;
@@ -147,6 +197,7 @@ Detector::Builder &Detector::Builder::setStream(
                 ", end=" + templateWaveformEndTime.iso());
     throw builder::NoStream{logging::to_string(msg)};
   }
+  metadataLock.unlock();
 
   msg.setText("loaded stream from inventory for epoch: start=" +
               templateWaveformStartTime.iso() +
@@ -208,8 +259,7 @@ Detector::Builder &Detector::Builder::setStream(
   if (!rtFilterId.empty()) {
     util::replaceEscapedXMLFilterIdChars(rtFilterId);
     try {
-      templateWaveformProcessor->setFilter(processing::createFilter(rtFilterId),
-                                           streamConfig.initTime);
+      templateWaveformProcessor->setFilter(rtFilterId, streamConfig.initTime);
     } catch (processing::WaveformProcessor::BaseException &e) {
       msg.setText(e.what());
       throw builder::BaseException{logging::to_string(msg)};
@@ -219,6 +269,39 @@ Detector::Builder &Detector::Builder::setStream(
   if (streamConfig.targetSamplingFrequency) {
     templateWaveformProcessor->setTargetSamplingFrequency(
         *streamConfig.targetSamplingFrequency);
+  } else if (_autoTargetSamplingFrequencyMargin) {
+    boost::optional<double> samplingFrequency;
+    try {
+      samplingFrequency = stream->sampleRateNumerator() /
+                          static_cast<double>(stream->sampleRateDenominator());
+    } catch (Core::ValueException &) {
+    }
+
+    boost::optional<double> targetSamplingFrequency;
+    if (samplingFrequency) {
+      // restrict to integer decimation factors, i.e. the polyphase resampler
+      // is used (if enabled)
+      targetSamplingFrequency = util::targetSamplingFrequency(
+          *samplingFrequency, {rtFilterId, templateWfFilterId},
+          *_autoTargetSamplingFrequencyMargin,
+          settings::kPolyphaseResamplerMaxFactor);
+    }
+    if (targetSamplingFrequency) {
+      templateWaveformProcessor->setTargetSamplingFrequency(
+          *targetSamplingFrequency);
+      msg.setText("target sampling frequency derived from filter: " +
+                  std::to_string(*targetSamplingFrequency) +
+                  " Hz (sampling_frequency=" +
+                  std::to_string(*samplingFrequency) + " Hz)");
+      SCDETECT_LOG_INFO_PROCESSOR(templateWaveformProcessor, "%s",
+                                  logging::to_string(msg).c_str());
+    } else {
+      msg.setText(
+          "failed to derive target sampling frequency from filter; using the "
+          "stream's sampling frequency");
+      SCDETECT_LOG_DEBUG_PROCESSOR(templateWaveformProcessor, "%s",
+                                   logging::to_string(msg).c_str());
+    }
   }
 
   std::string text{"filters configured: filter=\"" + rtFilterId + "\""};
@@ -270,48 +353,147 @@ void Detector::Builder::finalize() {
     product()->_detectorImpl.setMinArrivals(cfg.minArrivals);
   }
 
-  std::unordered_set<std::string> usedPicks;
-  for (auto &procConfigPair : _processorConfigs) {
-    const auto &streamId{procConfigPair.first};
-    auto &procConfig{procConfigPair.second};
-
-    const auto &meta{procConfig.metadata};
+  const auto createArrival = [this](const TemplateProcessorConfig &c) {
+    const auto &meta{c.metadata};
     boost::optional<std::string> phase_hint;
     try {
       phase_hint = meta.pick->phaseHint();
     } catch (Core::ValueException &e) {
     }
+    return detector::Arrival{
+        {meta.pick->time().value(), meta.pick->waveformID(), phase_hint,
+         meta.pick->time().value() - product()->_origin->time().value()},
+        meta.arrival->phase(),
+        meta.arrival->weight(),
+    };
+  };
+  const auto createSensorLocation = [](const TemplateProcessorConfig &c) {
+    const auto &sensorLocation{c.metadata.sensorLocation};
+    return detector::DetectorImpl::SensorLocation{
+        sensorLocation->latitude(), sensorLocation->longitude(),
+        sensorLocation->station()->publicID()};
+  };
+
+  // local maxima less than the lowest correlation coefficient taken into
+  // account by the linker (w.r.t. the merging strategy configured) are not
+  // published at all
+  const auto localMaximaThreshold =
+      [&cfg](const boost::optional<double> &mergingThreshold)
+      -> boost::optional<double> {
+    if ("greaterEqualTriggerOnThreshold" == cfg.mergingStrategy) {
+      return cfg.triggerOn;
+    }
+    if ("greaterEqualMergingThreshold" == cfg.mergingStrategy) {
+      return mergingThreshold.value_or(cfg.triggerOn);
+    }
+    return boost::none;
+  };
+
+  // group the streams to be stacked by sensor location (including both the
+  // band and the source code)
+  std::map<std::string, std::vector<std::string>> stacks;
+  if (cfg.stackComponents) {
+    for (const auto &procConfigPair : _processorConfigs) {
+      stacks[util::getSensorLocationStreamId(procConfigPair.first, true)]
+          .push_back(procConfigPair.first);
+    }
+  }
+  std::unordered_set<std::string> stackedStreamIds;
+  for (auto it{stacks.begin()}; it != stacks.end();) {
+    if (it->second.size() < 2) {
+      it = stacks.erase(it);
+      continue;
+    }
+    stackedStreamIds.insert(it->second.begin(), it->second.end());
+    ++it;
+  }
 
+  std::vector<std::pair<std::string, TemplateWaveformProcessor *>> processors;
+  std::unordered_set<std::string> usedPicks;
+  for (auto &procConfigPair : _processorConfigs) {
+    const auto &streamId{procConfigPair.first};
+    auto &procConfig{procConfigPair.second};
+
+    const auto &meta{procConfig.metadata};
     procConfig.processor->setGapThreshold(
         Core::TimeSpan{product()->_config.gapThreshold});
     procConfig.processor->setGapTolerance(
         Core::TimeSpan{product()->_config.gapTolerance});
     procConfig.processor->setGapInterpolation(
         product()->_config.gapInterpolation);
+    procConfig.processor->setPrecision(product()->_config.precision == "float"
+                                           ? filter::Precision::kSingle
+                                           : filter::Precision::kDouble);
+    procConfig.processor->setLocalMaximaThreshold(
+        localMaximaThreshold(procConfig.mergingThreshold));
+    procConfig.processor->selectCorrelationEngine();
+    if (cfg.coarseSearchDecimationFactor > 1) {
+      procConfig.processor->setCoarseSearch(
+          static_cast<std::size_t>(cfg.coarseSearchDecimationFactor),
+          cfg.coarseSearchThresholdFactor * cfg.triggerOn);
+    }
+
+    processors.emplace_back(streamId, procConfig.processor.get());
+    usedPicks.emplace(meta.pick->publicID());
+    if (stackedStreamIds.find(streamId) != stackedStreamIds.end()) {
+      continue;
+    }
 
     // initialize detection processing
-    product()->_detectorImpl.add(
-        std::move(procConfig.processor), streamId,
-        detector::Arrival{
-            {meta.pick->time().value(), meta.pick->waveformID(), phase_hint,
-             meta.pick->time().value() - product()->_origin->time().value()},
-            meta.arrival->phase(),
-            meta.arrival->weight(),
-        },
-        detector::DetectorImpl::SensorLocation{
-            meta.sensorLocation->latitude(), meta.sensorLocation->longitude(),
-            meta.sensorLocation->station()->publicID()},
-        procConfig.mergingThreshold);
+    product()->_detectorImpl.add(std::move(procConfig.processor), streamId,
+                                 createArrival(procConfig),
+                                 createSensorLocation(procConfig),
+                                 procConfig.mergingThreshold);
+  }
 
-    usedPicks.emplace(meta.pick->publicID());
+  for (auto &stackPair : stacks) {
+    auto &streamIds{stackPair.second};
+    std::sort(streamIds.begin(), streamIds.end());
+    // use the vertical component as the reference component (if available)
+    auto referenceIt{std::find_if(
+        streamIds.begin(), streamIds.end(), [](const std::string &streamId) {
+          const util::WaveformStreamID waveformStreamId{streamId};
+          const auto &chaCode{waveformStreamId.chaCode()};
+          return !chaCode.empty() && chaCode.back() == 'Z';
+        })};
+    if (referenceIt != streamIds.end()) {
+      std::rotate(streamIds.begin(), referenceIt, std::next(referenceIt));
+    }
+
+    std::vector<detector::Arrival> arrivals;
+    for (const auto &streamId : streamIds) {
+      arrivals.push_back(createArrival(_processorConfigs.at(streamId)));
+    }
+
+    auto &referenceConfig{_processorConfigs.at(streamIds.front())};
+    const auto referenceId{referenceConfig.processor->id()};
+    auto stacked{util::make_unique<StackedTemplateWaveformProcessor>(
+        std::move(referenceConfig.processor), streamIds.front())};
+    for (auto it{std::next(streamIds.begin())}; it != streamIds.end(); ++it) {
+      stacked->add(std::move(_processorConfigs.at(*it).processor), *it);
+    }
+    stacked->setId(referenceId);
+    stacked->setLocalMaximaThreshold(
+        localMaximaThreshold(referenceConfig.mergingThreshold));
+
+    SCDETECT_LOG_DEBUG_PROCESSOR(
+        stacked, "Stacking components: %s",
+        boost::algorithm::join(streamIds, ", ").c_str());
+    // initialize detection processing
+    product()->_detectorImpl.add(std::move(stacked), arrivals,
+                                 createSensorLocation(referenceConfig),
+                                 referenceConfig.mergingThreshold);
   }
 
   // attach reference theoretical template arrivals to the product
   if (product()->_publishConfig.createTemplateArrivals) {
     for (size_t i = 0; i < product()->_origin->arrivalCount(); ++i) {
       const auto &arrival{product()->_origin->arrival(i)};
-      const auto &pick{
-          EventStore::Instance().get<DataModel::Pick>(arrival->pickID())};
+      DataModel::PickPtr pick;
+      {
+        std::lock_guard<std::mutex> lock{metadataMutex};
+        pick = EventStore::Instance().get<DataModel::Pick>(arrival->pickID());
+      }
 
       bool isDetectorArrival{usedPicks.find(arrival->pickID()) !=
                              usedPicks.end()};
@@ -355,6 +537,86 @@ void Detector::Builder::finalize() {
            arrival->weight()});
     }
   }
+
+  // configure cascaded detection
+  const bool cascaded{_cascadeTriggerRegistry &&
+                      !cfg.cascadeTriggerFilter.empty()};
+  if (cascaded) {
+    auto triggerFilterId{cfg.cascadeTriggerFilter};
+    util::replaceEscapedXMLFilterIdChars(triggerFilterId);
+    for (const auto &streamStatePair : product()->_streamStates) {
+      try {
+        product()->_cascadeTriggers.push_back(_cascadeTriggerRegistry->add(
+            streamStatePair.first, triggerFilterId,
+            cfg.cascadeTriggerThreshold));
+      } catch (processing::WaveformProcessor::BaseException &e) {
+        throw builder::BaseException{
+            "failed to create cascade trigger: " + std::string{e.what()}};
+      }
+    }
+
+    product()->_cascadeLookBack = Core::TimeSpan{cfg.cascadeLookBack};
+    product()->_cascadeHoldDuration = Core::TimeSpan{cfg.cascadeHoldDuration};
+    product()->_cascadeInitTime = Core::TimeSpan{0.0};
+    for (const auto &processorPair : processors) {
+      product()->_cascadeInitTime = std::max(
+          product()->_cascadeInitTime, processorPair.second->initTime());
+    }
+
+    product()->_cascadeBuffer =
+        util::make_unique<waveform_operator::RingBufferOperator>(
+            product(), product()->_cascadeLookBack +
+                           product()->_cascadeInitTime +
+                           Core::TimeSpan{settings::kCascadeBufferMargin});
+    product()->setupCascadeBuffer();
+
+    SCDETECT_LOG_DEBUG_PROCESSOR(
+        product(),
+        "Cascaded detection enabled: trigger_filter=\"%s\", "
+        "trigger_threshold=%f, look_back=%f, hold_duration=%f",
+        triggerFilterId.c_str(), cfg.cascadeTriggerThreshold,
+        cfg.cascadeLookBack, cfg.cascadeHoldDuration);
+  }
+
+  // delegate the cross-correlation to template banks
+  //
+  // - the template waveform processors of cascaded detectors cross-correlate
+  // by themselves (i.e. only while being awake)
+  // - template waveform processors whose configuration template banks cannot
+  // honour cross-correlate by themselves, too
+  if (_templateBankRegistry && !cascaded) {
+    boost::optional<TemplateBankRegistry::SubspaceConfig> subspaceConfig;
+    if (!cfg.subspaceGroup.empty()) {
+      subspaceConfig =
+          TemplateBankRegistry::SubspaceConfig{cfg.subspaceGroup,
+                                               cfg.subspaceEnergyFraction};
+    }
+
+    std::vector<std::pair<std::string, TemplateWaveformProcessor *>>
+        remaining;
+    for (const auto &processorPair : processors) {
+      if (!_templateBankRegistry->add(processorPair.first,
+                                      processorPair.second, subspaceConfig)) {
+        SCDETECT_LOG_WARNING_PROCESSOR(
+            processorPair.second,
+            "Not added to a template bank (%s). Cross-correlating by itself.",
+            TemplateBank::incompatibility(*processorPair.second)->c_str());
+        remaining.push_back(processorPair);
+      }
+    }
+    processors = std::move(remaining);
+  }
+  if (_preprocessingRegistry && !cascaded) {
+    // delegate filtering and resampling to shared preprocessing chains
+    for (const auto &processorPair : processors) {
+      if (!_preprocessingRegistry->add(processorPair.first,
+                                       processorPair.second)) {
+        SCDETECT_LOG_DEBUG_PROCESSOR(
+            processorPair.second,
+            "Not subscribed to a preprocessing chain: filter not shareable");
+      }
+    }
+  }
 }
 
 void Detector::Builder::setMergingStrategy(const std::string &strategyId) {
@@ -432,6 +694,15 @@ void Detector::reset() {
 
   _detectorImpl.reset();
 
+  if (_cascadeBuffer) {
+    _cascadeBuffer->reset();
+    setupCascadeBuffer();
+    // do not wake up due to pre-triggers handled, already
+    _cascadeDormant = true;
+    _cascadeDormantSince = cascadeLastTriggered();
+    _cascadeProcessedUntil = boost::none;
+  }
+
   WaveformProcessor::reset();
 }
 
@@ -461,7 +732,11 @@ processing::WaveformProcessor::StreamState *Detector::streamState(
 void Detector::process(StreamState &streamState, const Record *record,
                        const DoubleArray &filteredData) {
   try {
-    _detectorImpl.feed(record);
+    if (_cascadeBuffer) {
+      processCascaded(record);
+    } else {
+      _detectorImpl.feed(record);
+    }
   } catch (detector::DetectorImpl::ProcessingError &e) {
     SCDETECT_LOG_WARNING_PROCESSOR(this, "%s: %s. Resetting.",
                                    record->streamID().c_str(), e.what());
@@ -484,6 +759,14 @@ void Detector::process(StreamState &streamState, const Record *record,
 }
 
 bool Detector::store(const Record *record) {
+  if (_cascadeBuffer && _cascadeBuffer->feed(record) ==
+                            WaveformProcessor::Status::kError) {
+    SCDETECT_LOG_DEBUG_PROCESSOR(
+        this, "%s: failed to buffer record (start=%s, end=%s)",
+        record->streamID().c_str(), record->startTime().iso().c_str(),
+        record->endTime().iso().c_str());
+  }
+
   processing::WaveformProcessor::store(record);
 
   return !finished();
@@ -506,8 +789,13 @@ bool Detector::fill(processing::StreamState &streamState, const Record *record,
   return true;
 }
 
+bool Detector::modifiesData() const {
+  // the data is neither filtered nor processed by the detector, itself
+  return false;
+}
+
 bool Detector::handleGap(processing::StreamState &streamState,
-                         const Record *record, DoubleArrayPtr &data) {
+                         const Record *record, const DoubleArray &data) {
   // XXX(damb): do not perform any gap handling. Instead, the underlying
   // `TemplateWaveformProcessor`s are performing the gap handling by
   // themselves.
@@ -576,6 +864,114 @@ void Detector::processDetections(const Record *record) {
   }
 }
 
+void Detector::processCascaded(const Record *record) {
+  const auto lastTriggered{cascadeLastTriggered()};
+  if (_cascadeDormant) {
+    const bool fired{lastTriggered &&
+                     (!_cascadeDormantSince ||
+                      *lastTriggered > *_cascadeDormantSince)};
+    if (!fired) {
+      // keep buffering, only
+      return;
+    }
+
+    // the earliest onset of the pre-triggers fired since the detector became
+    // dormant
+    boost::optional<Core::Time> onset;
+    for (const auto *trigger : _cascadeTriggers) {
+      const auto &triggerLastTriggered{trigger->lastTriggered()};
+      if (!triggerLastTriggered ||
+          (_cascadeDormantSince &&
+           *triggerLastTriggered <= *_cascadeDormantSince)) {
+        continue;
+      }
+      if (!onset || *trigger->onset() < *onset) {
+        onset = trigger->onset();
+      }
+    }
+
+    wakeUp(*onset);
+    return;
+  }
+
+  _detectorImpl.feed(record);
+  updateCascadeProcessedUntil(record);
+
+  if (!_detectorImpl.triggered() &&
+      record->startTime() >= *lastTriggered + _cascadeHoldDuration) {
+    fallAsleep();
+  }
+}
+
+void Detector::wakeUp(const Core::Time &onset) {
+  // do not cross-correlate data which was cross-correlated before becoming
+  // dormant, again; otherwise, detections would be emitted twice
+  auto lookBackStart{onset - _cascadeLookBack};
+  if (_cascadeProcessedUntil && lookBackStart < *_cascadeProcessedUntil) {
+    lookBackStart = *_cascadeProcessedUntil;
+  }
+  const auto start{lookBackStart - _cascadeInitTime};
+  SCDETECT_LOG_DEBUG_PROCESSOR(
+      this, "Waking up (pre-trigger onset=%s): cross-correlating from %s",
+      onset.iso().c_str(), start.iso().c_str());
+
+  // replay the buffered records in chronological order (w.r.t. all streams)
+  // such that the linker is fed as if the data was fed in real-time
+  std::vector<RecordCPtr> records;
+  for (const auto &streamStatePair : _streamStates) {
+    const auto &buffer{_cascadeBuffer->get(streamStatePair.first)};
+    for (const auto &buffered : *buffer) {
+      if (buffered->endTime() > start) {
+        records.push_back(buffered);
+      }
+    }
+  }
+  std::stable_sort(records.begin(), records.end(),
+                   [](const RecordCPtr &lhs, const RecordCPtr &rhs) {
+                     return lhs->endTime() < rhs->endTime();
+                   });
+
+  _cascadeDormant = false;
+  for (const auto &buffered : records) {
+    _detectorImpl.feed(buffered.get());
+    updateCascadeProcessedUntil(buffered.get());
+  }
+}
+
+void Detector::fallAsleep() {
+  SCDETECT_LOG_DEBUG_PROCESSOR(this, "Pre-triggers off. Becoming dormant.");
+
+  _detectorImpl.flush();
+  // the pending detections are processed by the caller
+  _detectorImpl.reset();
+
+  _cascadeDormant = true;
+  _cascadeDormantSince = cascadeLastTriggered();
+}
+
+void Detector::updateCascadeProcessedUntil(const Record *record) {
+  if (!_cascadeProcessedUntil || *_cascadeProcessedUntil < record->endTime()) {
+    _cascadeProcessedUntil = record->endTime();
+  }
+}
+
+void Detector::setupCascadeBuffer() {
+  for (const auto &streamStatePair : _streamStates) {
+    _cascadeBuffer->add(streamStatePair.first);
+  }
+}
+
+boost::optional<Core::Time> Detector::cascadeLastTriggered() const {
+  boost::optional<Core::Time> ret;
+  for (const auto *trigger : _cascadeTriggers) {
+    const auto &lastTriggered{trigger->lastTriggered()};
+    if (lastTriggered && (!ret || *ret < *lastTriggered)) {
+      ret = lastTriggered;
+    }
+  }
+  return ret;
+}
+
 }  // namespace detector
 }  // namespace detect
 }  // namespace Seiscomp
@@ -10,17 +10,23 @@
 #include <seiscomp/datamodel/sensorlocation.h>
 
 #include <boost/optional/optional.hpp>
+#include <cstddef>
 #include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../builder.h"
 #include "../config/detector.h"
+#include "../operator/ringbuffer.h"
 #include "../processing/waveform_processor.h"
 #include "../waveform.h"
+#include "cascade_trigger.h"
 #include "detector_impl.h"
+#include "preprocessing_chain.h"
 #include "seiscomp/core/typedarray.h"
+#include "template_bank.h"
 #include "template_waveform_processor.h"
 
 namespace Seiscomp {
@@ -68,10 +74,58 @@ class Detector : public processing::WaveformProcessor {
 
     // Set stream related template configuration where `streamId` refers to the
     // waveform stream identifier of the stream to be processed.
+    //
+    // - builders of different detectors may set streams concurrently (given
+    // `waveformHandler` is thread-safe); the registries are used by
+    // `build()`, only
     Builder &setStream(const std::string &streamId,
                        const config::StreamConfig &streamConfig,
                        WaveformHandlerIface *waveformHandler);
 
+    // Sets the template bank `registry`. If set, the cross-correlation of the
+    // detector's template waveform processors is delegated to the template
+    // banks of `registry`.
+    //
+    // - the builder does not take ownership; the detector must outlive
+    // `registry`
+    Builder &setTemplateBankRegistry(TemplateBankRegistry *registry);
+
+    // Sets the preprocessing `registry`. If set, filtering and resampling of
+    // the detector's template waveform processors is delegated to the shared
+    // preprocessing chains of `registry`.
+    //
+    // - template waveform processors delegating the cross-correlation to
+    // template banks are not subscribed to preprocessing chains
+    // - the builder does not take ownership; the detector must outlive
+    // `registry`
+    Builder &setPreprocessingRegistry(PreprocessingRegistry *registry);
+
+    // Sets the cascade trigger `registry`. If set and the detector is
+    // configured for cascaded detection, the detector's template waveform
+    // processors are dormant until a pre-trigger of `registry` fires.
+    //
+    // - the builder does not take ownership; `registry` must outlive the
+    // detector
+    Builder &setCascadeTriggerRegistry(CascadeTriggerRegistry *registry);
+
+    // Enables deriving the target sampling frequency of template waveform
+    // processors from the upper corner frequency of the filters configured
+    // (if no target sampling frequency is configured explicitly). The target
+    // sampling frequency derived is the lowest integer fraction of the
+    // stream's sampling frequency which is greater than or equal to `margin`
+    // times the upper corner frequency.
+    //
+    // - must be called before `setStream()`
+    Builder &setAutoTargetSamplingFrequency(double margin);
+
+    // Enables evaluating the detector's template waveform processors in
+    // parallel by means of the work stealing `pool` for streams with at least
+    // `minProcessors` template waveform processors registered
+    //
+    // - the builder does not take ownership; `pool` must outlive the detector
+    Builder &setWorkStealingPool(util::WorkStealingPool *pool,
+                                 std::size_t minProcessors);
+
    protected:
     void finalize() override;
 
@@ -99,6 +153,15 @@ class Detector : public processing::WaveformProcessor {
 
     std::string _originId;
 
+    TemplateBankRegistry *_templateBankRegistry{nullptr};
+    PreprocessingRegistry *_preprocessingRegistry{nullptr};
+    CascadeTriggerRegistry *_cascadeTriggerRegistry{nullptr};
+
+    // The ratio of the target sampling frequency derived automatically and
+    // the filter's upper corner frequency (if not set, deriving the target
+    // sampling frequency is disabled)
+    boost::optional<double> _autoTargetSamplingFrequencyMargin;
+
     using TemplateProcessorConfigs =
         std::unordered_map<std::string, TemplateProcessorConfig>;
     TemplateProcessorConfigs _processorConfigs;
@@ -145,8 +208,10 @@ class Detector : public processing::WaveformProcessor {
   bool fill(processing::StreamState &streamState, const Record *record,
             DoubleArrayPtr &data) override;
 
+  bool modifiesData() const override;
+
   bool handleGap(processing::StreamState &streamState, const Record *record,
-                 DoubleArrayPtr &data) override;
+                 const DoubleArray &data) override;
 
   // Callback function storing `res`
   void storeDetection(const DetectorImpl::Result &res);
@@ -162,6 +227,24 @@ class Detector : public processing::WaveformProcessor {
  private:
   void processDetections(const Record *record);
 
+  // Processes `record` w.r.t. cascaded detection i.e. feeds `record` to the
+  // detector implementation only if the detector is awake
+  void processCascaded(const Record *record);
+  // Wakes up the detector and cross-correlates the buffered data starting
+  // from `onset` minus the look-back duration (but not before the end of the
+  // data cross-correlated before becoming dormant)
+  void wakeUp(const Core::Time &onset);
+  // Makes the detector dormant after flushing pending detections
+  void fallAsleep();
+  // Keeps track of the data cross-correlated w.r.t. cascaded detection
+  void updateCascadeProcessedUntil(const Record *record);
+  // Subscribes the detector's streams for buffering
+  void setupCascadeBuffer();
+
+  // Returns the time of the most recent sample any of the pre-triggers fired
+  // for
+  boost::optional<Core::Time> cascadeLastTriggered() const;
+
   using WaveformStreamID = std::string;
   using StreamStates =
       std::unordered_map<WaveformStreamID,
@@ -181,6 +264,28 @@ class Detector : public processing::WaveformProcessor {
   DataModel::OriginCPtr _origin;
 
   config::PublishConfig _publishConfig;
+
+  // Cascaded detection facilities
+  // - cascaded detection is enabled if the buffer is available
+  std::vector<const CascadeTrigger *> _cascadeTriggers;
+  // Buffers the records fed while the detector is dormant
+  std::unique_ptr<waveform_operator::RingBufferOperator> _cascadeBuffer;
+  // The duration of data preceding the pre-trigger onset which is
+  // cross-correlated
+  Core::TimeSpan _cascadeLookBack;
+  // The duration after the most recent pre-trigger until the detector becomes
+  // dormant
+  Core::TimeSpan _cascadeHoldDuration;
+  // The duration of data required by the template waveform processors before
+  // cross-correlation results are available
+  Core::TimeSpan _cascadeInitTime;
+  bool _cascadeDormant{true};
+  // The time of the most recent pre-trigger handled before the detector
+  // became dormant
+  boost::optional<Core::Time> _cascadeDormantSince;
+  // The end time of the most recent record cross-correlated before the
+  // detector became dormant
+  boost::optional<Core::Time> _cascadeProcessedUntil;
 };
 
 }  // namespace detector
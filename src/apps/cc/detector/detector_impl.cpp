@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -105,11 +106,12 @@ boost::optional<Core::TimeSpan> DetectorImpl::arrivalOffsetThreshold() const {
 }
 
 void DetectorImpl::setMinArrivals(const boost::optional<size_t> &n) {
-  _linker.setMinArrivals(n);
+  _minArrivals = n;
+  updateMinArrivals();
 }
 
 boost::optional<size_t> DetectorImpl::minArrivals() const {
-  return _linker.minArrivals();
+  return _minArrivals;
 }
 
 void DetectorImpl::setMergingStrategy(Linker::MergingStrategy mergingStrategy) {
@@ -125,6 +127,12 @@ boost::optional<Core::TimeSpan> DetectorImpl::maxLatency() const {
   return _maxLatency;
 }
 
+void DetectorImpl::setWorkStealingPool(util::WorkStealingPool *pool,
+                                       std::size_t minProcessors) {
+  _workStealingPool = pool;
+  _parallelMinProcessors = minProcessors;
+}
+
 size_t DetectorImpl::processorCount() const { return _processors.size(); }
 
 const TemplateWaveformProcessor *DetectorImpl::processor(
@@ -133,6 +141,15 @@ const TemplateWaveformProcessor *DetectorImpl::processor(
     return _processors.at(processorId).processor.get();
   } catch (std::out_of_range &) {
   }
+  // the component processors of stacked processors are looked up rarely (i.e.
+  // when creating amplitudes); hence, search linearly
+  for (const auto &procPair : _processors) {
+    for (const auto &component : procPair.second.components) {
+      if (component.processor->id() == processorId) {
+        return component.processor;
+      }
+    }
+  }
   return nullptr;
 }
 
@@ -145,6 +162,13 @@ void DetectorImpl::add(std::unique_ptr<TemplateWaveformProcessor> proc,
       [this](const TemplateWaveformProcessor *processor, const Record *record,
              std::unique_ptr<const TemplateWaveformProcessor::MatchResult>
                  result) {
+        // results emitted while being evaluated in parallel are stored by the
+        // thread feeding the detector
+        if (_deferResults) {
+          _processors.at(processor->id())
+              .deferredResults.push_back(std::move(result));
+          return;
+        }
         storeTemplateResult(processor, record, std::move(result));
       });
 
@@ -167,6 +191,34 @@ void DetectorImpl::add(std::unique_ptr<TemplateWaveformProcessor> proc,
   _processors.emplace(procId, std::move(p));
 
   _processorIdx.emplace(waveformStreamId, procId);
+
+  updateMinArrivals();
+}
+
+void DetectorImpl::add(std::unique_ptr<StackedTemplateWaveformProcessor> proc,
+                       const std::vector<Arrival> &arrivals,
+                       const DetectorImpl::SensorLocation &loc,
+                       const boost::optional<double> &mergingThreshold) {
+  const auto waveformStreamIds{proc->waveformStreamIds()};
+  assert(!waveformStreamIds.empty());
+  assert((arrivals.size() == waveformStreamIds.size()));
+
+  std::vector<detail::ComponentState> components;
+  for (std::size_t i = 1; i < waveformStreamIds.size(); ++i) {
+    components.push_back({waveformStreamIds[i], arrivals[i],
+                          proc->component(waveformStreamIds[i])});
+  }
+
+  const auto procId{proc->id()};
+  // the pseudo arrival is associated with the reference component
+  add(std::move(proc), waveformStreamIds.front(), arrivals.front(), loc,
+      mergingThreshold);
+  for (const auto &component : components) {
+    _processorIdx.emplace(component.waveformStreamId, procId);
+  }
+  _processors.at(procId).components = std::move(components);
+
+  updateMinArrivals();
 }
 
 void DetectorImpl::remove(const std::string &waveformStreamId) {
@@ -177,6 +229,7 @@ void DetectorImpl::remove(const std::string &waveformStreamId) {
     _processorIdx.erase(rit);
     _processors.erase(rit->second);
   }
+  updateMinArrivals();
 
   // update linker
   using pair_type = detail::ProcessorStatesType::value_type;
@@ -265,23 +318,81 @@ void DetectorImpl::setResultCallback(const PublishResultCallback &callback) {
 
 bool DetectorImpl::process(const Record *record) {
   auto range{_processorIdx.equal_range(record->streamID())};
+  if (_workStealingPool) {
+    std::vector<detail::ProcessorState *> procStates;
+    for (auto rit{range.first}; rit != range.second; ++rit) {
+      procStates.push_back(&_processors.at(rit->second));
+    }
+    if (procStates.size() >= _parallelMinProcessors) {
+      return processParallel(record, procStates);
+    }
+  }
+
   for (auto rit{range.first}; rit != range.second; ++rit) {
     const auto &procId{rit->second};
     auto &procState{_processors.at(procId)};
 
     if (!procState.processor->feed(record)) {
-      const auto &status{procState.processor->status()};
-      const auto &statusValue{procState.processor->statusValue()};
-      logging::TaggedMessage msg{
-          record->streamID(),
-          "failed to feed data (tw.start=" + record->startTime().iso() +
-              ", tw.end=" + record->endTime().iso() +
-              ") to processor. Reason: status=" +
-              std::to_string(util::asInteger(status)) +
-              ", status_value=" + std::to_string(statusValue)};
-      SCDETECT_LOG_ERROR_TAGGED(procState.processor->id(), "%s",
-                                logging::to_string(msg).c_str());
+      logFeedError(record, procState);
+      return false;
+    }
+
+    if (!procState.dataTimeWindowFed) {
+      procState.dataTimeWindowFed.setStartTime(record->startTime());
+    }
+    procState.dataTimeWindowFed.setEndTime(record->endTime());
+  }
+
+  return true;
+}
+
+bool DetectorImpl::processParallel(
+    const Record *record,
+    const std::vector<detail::ProcessorState *> &procStates) {
+  // `std::vector<bool>` does not allow for concurrent writes
+  std::vector<char> fed(procStates.size(), 0);
+  std::vector<util::WorkStealingPool::Task> tasks;
+  tasks.reserve(procStates.size());
+  for (std::size_t i{0}; i < procStates.size(); ++i) {
+    auto *procState{procStates[i]};
+    tasks.emplace_back([record, procState, &fed, i]() {
+      fed[i] = procState->processor->feed(record);
+    });
+  }
 
+  // collect the results deferred before storing them (in order to not keep
+  // stale results if storing fails)
+  std::vector<std::vector<
+      std::unique_ptr<const TemplateWaveformProcessor::MatchResult>>>
+      deferred(procStates.size());
+  auto collectDeferred = [&procStates, &deferred]() {
+    for (std::size_t i{0}; i < procStates.size(); ++i) {
+      deferred[i] = std::move(procStates[i]->deferredResults);
+      procStates[i]->deferredResults.clear();
+    }
+  };
+
+  _deferResults = true;
+  try {
+    _workStealingPool->run(tasks);
+  } catch (...) {
+    _deferResults = false;
+    collectDeferred();
+    throw;
+  }
+  _deferResults = false;
+  collectDeferred();
+
+  // store the results in the order of the sequential evaluation
+  for (std::size_t i{0}; i < procStates.size(); ++i) {
+    auto &procState{*procStates[i]};
+    for (auto &result : deferred[i]) {
+      storeTemplateResult(procState.processor.get(), record,
+                          std::move(result));
+    }
+
+    if (!fed[i]) {
+      logFeedError(record, procState);
       return false;
     }
 
@@ -294,6 +405,21 @@ bool DetectorImpl::process(const Record *record) {
   return true;
 }
 
+void DetectorImpl::logFeedError(const Record *record,
+                                const detail::ProcessorState &procState) const {
+  const auto &status{procState.processor->status()};
+  const auto &statusValue{procState.processor->statusValue()};
+  logging::TaggedMessage msg{
+      record->streamID(),
+      "failed to feed data (tw.start=" + record->startTime().iso() +
+          ", tw.end=" + record->endTime().iso() +
+          ") to processor. Reason: status=" +
+          std::to_string(util::asInteger(status)) +
+          ", status_value=" + std::to_string(statusValue)};
+  SCDETECT_LOG_ERROR_TAGGED(procState.processor->id(), "%s",
+                            logging::to_string(msg).c_str());
+}
+
 bool DetectorImpl::hasAcceptableLatency(const Record *record) {
   if (_maxLatency) {
     return record->endTime() > Core::Time::GMT() - *_maxLatency;
@@ -410,6 +536,25 @@ void DetectorImpl::prepareResult(const linker::Association &linkerResult,
                                 proc.templateWaveformReferenceTime, procId});
     usedChas.emplace(templateResult.arrival.pick.waveformStreamId);
     usedStas.emplace(proc.sensorLocation.stationId);
+
+    // the arrival offsets between the components of a stacked processor are
+    // fixed; thus, the components' arrivals are shifted by the same amount
+    const auto shift{templateResult.arrival.pick.time -
+                     proc.templateWaveformReferenceTime};
+    for (const auto &component : proc.components) {
+      Arrival arrival{component.arrival};
+      arrival.pick.time = component.arrival.pick.time + shift;
+      arrival.pick.waveformStreamId = component.waveformStreamId;
+
+      templateResults.emplace(
+          component.waveformStreamId,
+          DetectorImpl::Result::TemplateResult{
+              arrival, proc.sensorLocation,
+              component.processor->templateWaveform().startTime(),
+              component.processor->templateWaveform().endTime(),
+              component.arrival.pick.time, component.processor->id()});
+      usedChas.emplace(component.waveformStreamId);
+    }
   }
 
   auto sorted{sortByArrivalTime(linkerResult)};
@@ -428,7 +573,12 @@ void DetectorImpl::prepareResult(const linker::Association &linkerResult,
   for (const auto &procPair : _processors) {
     associatedStations.emplace(procPair.second.sensorLocation.stationId);
   }
-  result.numChannelsAssociated = _linker.channelCount();
+  // the components of stacked processors are not registered with the linker
+  std::unordered_set<std::string> associatedChannels;
+  for (const auto &idxPair : _processorIdx) {
+    associatedChannels.emplace(idxPair.first);
+  }
+  result.numChannelsAssociated = associatedChannels.size();
   result.numStationsAssociated = associatedStations.size();
 }
 
@@ -453,6 +603,33 @@ void DetectorImpl::resetProcessors() {
                 });
 }
 
+void DetectorImpl::updateMinArrivals() {
+  if (!_minArrivals) {
+    _linker.setMinArrivals(boost::none);
+    return;
+  }
+
+  // the number of arrivals contributed per processor
+  std::vector<std::size_t> numArrivals;
+  for (const auto &procPair : _processors) {
+    numArrivals.push_back(procPair.second.components.size() + 1);
+  }
+  std::sort(numArrivals.begin(), numArrivals.end(),
+            std::greater<std::size_t>());
+
+  // the minimum number of processors providing the arrivals required
+  std::size_t n{0};
+  std::size_t sum{0};
+  for (const auto &v : numArrivals) {
+    if (sum >= *_minArrivals) {
+      break;
+    }
+    sum += v;
+    ++n;
+  }
+  _linker.setMinArrivals(n);
+}
+
 void DetectorImpl::storeTemplateResult(
     const TemplateWaveformProcessor *processor, const Record *record,
     std::unique_ptr<const TemplateWaveformProcessor::MatchResult> result) {
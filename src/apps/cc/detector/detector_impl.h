@@ -19,10 +19,12 @@
 #include "../exception.h"
 #include "../processing/processor.h"
 #include "../processing/waveform_operator.h"
+#include "../util/work_stealing_pool.h"
 #include "arrival.h"
 #include "detail.h"
 #include "linker.h"
 #include "linker/association.h"
+#include "stacked_template_waveform_processor.h"
 #include "template_waveform_processor.h"
 
 namespace Seiscomp {
@@ -38,6 +40,16 @@ struct SensorLocation {
   std::string stationId;
 };
 
+// A component (other than the reference component) of a stacked template
+// waveform processor
+struct ComponentState {
+  std::string waveformStreamId;
+  // The template arrival w.r.t. the component
+  Arrival arrival;
+  // The component processor (owned by the stacked processor)
+  const TemplateWaveformProcessor *processor;
+};
+
 struct ProcessorState {
   ProcessorState(ProcessorState &&other) = default;
   ProcessorState &operator=(ProcessorState &&other) = default;
@@ -55,6 +67,13 @@ struct ProcessorState {
   Core::Time templateWaveformReferenceTime;
 
   std::unique_ptr<TemplateWaveformProcessor> processor;
+  // The match results emitted by `processor` while being evaluated in
+  // parallel (not stored, yet)
+  std::vector<std::unique_ptr<const TemplateWaveformProcessor::MatchResult>>
+      deferredResults;
+  // The components of `processor` other than the reference component (if
+  // `processor` is a stacked processor, else empty)
+  std::vector<ComponentState> components;
 };
 
 using ProcessorStatesType = std::unordered_map<ProcessorIdType, ProcessorState>;
@@ -140,6 +159,10 @@ class DetectorImpl : public detect::processing::Processor {
   boost::optional<Core::TimeSpan> arrivalOffsetThreshold() const;
   // Configures the detector with a minimum number of arrivals required to
   // declare an event as a detection
+  //
+  // - stacked processors contribute an arrival per component; hence, the
+  // linker is configured with the minimum number of processors required to
+  // provide `n` arrivals
   void setMinArrivals(const boost::optional<size_t> &n);
   // Returns the minimum number of arrivals required in order to declare an
   // event as a detection
@@ -151,10 +174,21 @@ class DetectorImpl : public detect::processing::Processor {
   void setMaxLatency(const boost::optional<Core::TimeSpan> &latency);
   // Returns the maximum allowed data latency configured
   boost::optional<Core::TimeSpan> maxLatency() const;
+  // Enables evaluating the template waveform processors in parallel by means
+  // of the work stealing `pool` if at least `minProcessors` processors are
+  // registered for the stream of the record fed. Results are stored in the
+  // order of the sequential evaluation. If `pool` is `nullptr`, the
+  // processors are evaluated sequentially.
+  //
+  // - the detector does not take ownership; `pool` must outlive the detector
+  void setWorkStealingPool(util::WorkStealingPool *pool,
+                           std::size_t minProcessors);
+
   // Returns the number of registered template processors
   size_t processorCount() const;
 
   // Returns the template waveform processor identified by `processorId`
+  // (including the component processors of stacked processors)
   //
   // - returns `nullptr` if there is no processor with `processorId` registered
   const TemplateWaveformProcessor *processor(
@@ -174,6 +208,15 @@ class DetectorImpl : public detect::processing::Processor {
            const std::string &waveformStreamId, const Arrival &arrival,
            const DetectorImpl::SensorLocation &loc,
            const boost::optional<double> &mergingThreshold);
+  // Register the stacked template waveform processor `proc`. Records are
+  // identified by the waveform stream identifiers of `proc`'s components.
+  // `proc` is registered together with the template arrivals `arrivals` of
+  // the components (in the order of `proc->waveformStreamIds()`) and the
+  // sensor location `loc`. Detections provide an arrival per component.
+  void add(std::unique_ptr<StackedTemplateWaveformProcessor> proc,
+           const std::vector<Arrival> &arrivals,
+           const DetectorImpl::SensorLocation &loc,
+           const boost::optional<double> &mergingThreshold);
   // Removes the processors processing streams identified by `waveformStreamId`
   void remove(const std::string &waveformStreamId);
 
@@ -190,6 +233,13 @@ class DetectorImpl : public detect::processing::Processor {
  protected:
   // Process data with underlying template processors
   bool process(const Record *record);
+  // Process data with the template processors `procStates` in parallel by
+  // means of the work stealing pool
+  bool processParallel(const Record *record,
+                       const std::vector<detail::ProcessorState *> &procStates);
+  // Logs that feeding `record` to the processor of `procState` failed
+  void logFeedError(const Record *record,
+                    const detail::ProcessorState &procState) const;
   // Returns `true` if `record` has an acceptable latency, else `false`
   bool hasAcceptableLatency(const Record *record);
 
@@ -209,6 +259,9 @@ class DetectorImpl : public detect::processing::Processor {
   void resetTrigger();
   // Reset the currently enabled processors
   void resetProcessors();
+  // Configures the linker with the minimum number of processors w.r.t. the
+  // minimum number of arrivals configured
+  void updateMinArrivals();
 
  private:
   // Callback storing results from `TemplateWaveformProcessor`
@@ -248,6 +301,9 @@ class DetectorImpl : public detect::processing::Processor {
   boost::optional<Core::TimeSpan> _triggerDuration;
   boost::optional<Core::Time> _triggerEnd;
 
+  // The minimum number of arrivals configured
+  boost::optional<size_t> _minArrivals;
+
   // The linker required for associating arrivals
   Linker _linker;
   using ResultQueue = std::deque<linker::Association>;
@@ -259,6 +315,15 @@ class DetectorImpl : public detect::processing::Processor {
   boost::optional<Core::TimeSpan> _chunkSize;
 
   DataModel::OriginCPtr _origin;
+
+  // The work stealing pool template processors are evaluated with (if any)
+  util::WorkStealingPool *_workStealingPool{nullptr};
+  // The minimum number of template processors per stream required for the
+  // parallel evaluation
+  std::size_t _parallelMinProcessors{0};
+  // Defines if results emitted by template processors are deferred (i.e.
+  // while the processors are evaluated in parallel)
+  bool _deferResults{false};
 };
 
 }  // namespace detector
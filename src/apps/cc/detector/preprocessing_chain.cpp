@@ -0,0 +1,193 @@
+#include "preprocessing_chain.h"
+
+#include <cassert>
+
+#include "../log.h"
+#include "../operator/resample.h"
+#include "../resamplerstore.h"
+#include "../settings.h"
+#include "../util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+PreprocessingChain::PreprocessingChain(
+    const TemplateWaveformProcessor &processor)
+    : _targetSamplingFrequency{processor.targetSamplingFrequency()} {
+  if (!processor.filterId().empty()) {
+    _streamState.filter = processing::createFilter(processor.filterId());
+  }
+
+  setGapThreshold(processor.gapThreshold());
+  setGapTolerance(processor.gapTolerance());
+  setGapInterpolation(processor.gapInterpolation());
+}
+
+PreprocessingChain::~PreprocessingChain() {
+  for (auto *subscriber : _subscribers) {
+    subscriber->_preprocessingChain = nullptr;
+  }
+}
+
+void PreprocessingChain::subscribe(TemplateWaveformProcessor *processor) {
+  assert(processor);
+
+  processor->_preprocessingChain = this;
+  _subscribers.push_back(processor);
+
+  reset();
+}
+
+std::size_t PreprocessingChain::size() const { return _subscribers.size(); }
+
+bool PreprocessingChain::feed(const Record *record) {
+  _fed = record;
+  _preprocessed.clear();
+
+  return WaveformProcessor::feed(record);
+}
+
+void PreprocessingChain::reset() {
+  WaveformProcessor::reset(_streamState);
+  WaveformProcessor::reset();
+
+  _preprocessed.clear();
+  _setup = false;
+}
+
+const PreprocessingChain::PreprocessedChunks &PreprocessingChain::preprocessed(
+    const Record *record) const {
+  static const PreprocessedChunks empty;
+  return record == _fed ? _preprocessed : empty;
+}
+
+std::string PreprocessingChain::key(
+    const std::string &waveformStreamId,
+    const TemplateWaveformProcessor &processor) {
+  std::string ret{waveformStreamId + settings::kProcessorIdSep +
+                  processor.filterId() + settings::kProcessorIdSep};
+  if (processor.targetSamplingFrequency()) {
+    ret += std::to_string(*processor.targetSamplingFrequency());
+  }
+
+  ret += settings::kProcessorIdSep +
+         std::to_string(static_cast<double>(processor.gapThreshold())) +
+         settings::kProcessorIdSep +
+         std::to_string(static_cast<double>(processor.gapTolerance())) +
+         settings::kProcessorIdSep +
+         std::to_string(processor.gapInterpolation());
+  return ret;
+}
+
+processing::WaveformProcessor::StreamState *PreprocessingChain::streamState(
+    const Record *record) {
+  return &_streamState;
+}
+
+void PreprocessingChain::process(StreamState &streamState,
+                                 const Record *record,
+                                 const DoubleArray &filteredData) {
+  setStatus(Status::kInProgress, 1);
+
+  // the filtered data is a scratch buffer; thus, keep a copy
+  _preprocessed.push_back(
+      {_setup, streamState.samplingFrequency, record,
+       util::make_smart<DoubleArray>(filteredData.size(),
+                                     filteredData.typedData())});
+  _setup = false;
+}
+
+bool PreprocessingChain::store(const Record *record) {
+  processing::WaveformProcessor::store(record);
+
+  return !finished();
+}
+
+void PreprocessingChain::setupStream(StreamState &streamState,
+                                     const Record *record) {
+  WaveformProcessor::setupStream(streamState, record);
+  const auto f{streamState.samplingFrequency};
+  SCDETECT_LOG_DEBUG_PROCESSOR(
+      this, "Initialize stream: sampling_frequency=%f, subscribers=%lu", f,
+      _subscribers.size());
+  if (_targetSamplingFrequency && *_targetSamplingFrequency != f) {
+    SCDETECT_LOG_DEBUG_PROCESSOR(this,
+                                 "Reinitialize stream: sampling_frequency=%f",
+                                 *_targetSamplingFrequency);
+    setOperator(util::make_unique<waveform_operator::ResamplingOperator>(
+        RecordResamplerStore::Instance().get(record,
+                                             *_targetSamplingFrequency)));
+
+    streamState.samplingFrequency = *_targetSamplingFrequency;
+    if (streamState.filter) {
+      streamState.filter->setSamplingFrequency(*_targetSamplingFrequency);
+    }
+  }
+
+  // the subscribers are set up when processing the next chunk preprocessed
+  _setup = true;
+}
+
+bool PreprocessingRegistry::add(const std::string &waveformStreamId,
+                                TemplateWaveformProcessor *processor) {
+  assert(processor);
+
+  // filters which are not identified by means of a filter identifier cannot be
+  // shared
+  if (processor->filter() && processor->filterId().empty()) {
+    return false;
+  }
+
+  const auto key{PreprocessingChain::key(waveformStreamId, *processor)};
+  auto it{_preprocessingChains.find(key)};
+  if (it == _preprocessingChains.end()) {
+    auto preprocessingChain{util::make_unique<PreprocessingChain>(*processor)};
+    preprocessingChain->setId(key);
+    _preprocessingChainIdx.emplace(waveformStreamId, preprocessingChain.get());
+    it = _preprocessingChains.emplace(key, std::move(preprocessingChain)).first;
+  }
+
+  it->second->subscribe(processor);
+  return true;
+}
+
+void PreprocessingRegistry::feed(const Record *record) {
+  auto range{_preprocessingChainIdx.equal_range(record->streamID())};
+  for (auto it = range.first; it != range.second; ++it) {
+    auto *preprocessingChain{it->second};
+    if (!preprocessingChain->feed(record)) {
+      SCDETECT_LOG_WARNING_PROCESSOR(
+          preprocessingChain,
+          "%s: Failed to feed record into preprocessing chain. Resetting.",
+          record->streamID().c_str());
+      preprocessingChain->reset();
+    }
+  }
+}
+
+void PreprocessingRegistry::reset() {
+  for (auto &preprocessingChainPair : _preprocessingChains) {
+    preprocessingChainPair.second->reset();
+  }
+}
+
+std::size_t PreprocessingRegistry::size() const {
+  return _preprocessingChains.size();
+}
+
+std::size_t PreprocessingRegistry::subscribers() const {
+  std::size_t ret{0};
+  for (const auto &preprocessingChainPair : _preprocessingChains) {
+    ret += preprocessingChainPair.second->size();
+  }
+  return ret;
+}
+
+bool PreprocessingRegistry::empty() const {
+  return _preprocessingChains.empty();
+}
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
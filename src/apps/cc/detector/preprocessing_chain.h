@@ -0,0 +1,153 @@
+#ifndef SCDETECT_APPS_CC_DETECTOR_PREPROCESSINGCHAIN_H_
+#define SCDETECT_APPS_CC_DETECTOR_PREPROCESSINGCHAIN_H_
+
+#include <seiscomp/core/record.h>
+#include <seiscomp/core/typedarray.h>
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../processing/waveform_processor.h"
+#include "template_waveform_processor.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+// Shared preprocessing chain implementation
+//
+// - filters and resamples the records of a single waveform stream once on
+// behalf of multiple `TemplateWaveformProcessor`s (i.e. the chain's
+// subscribers), possibly belonging to different detectors
+// - the data preprocessed w.r.t. the record fed most recently is kept and
+// shared read-only with the subscribers; when being fed the record, the
+// subscribers cross-correlate the data and compute and publish their match
+// results by themselves (i.e. within the execution context of their
+// detectors)
+// - subscribers are required to share the same configuration w.r.t.
+// filtering, resampling and gap handling (see also `PreprocessingChain::key()`)
+// - subscribers keep track of their initialization by themselves; the chain
+// itself does not require any initialization time
+// - the data preprocessed may be accessed concurrently as long as the chain
+// is not fed at the same time
+class PreprocessingChain : public processing::WaveformProcessor {
+ public:
+  // A chunk of data preprocessed
+  struct Preprocessed {
+    // `true` if the stream was (re-)initialized before preprocessing the
+    // chunk, else `false`
+    bool setup;
+    // The sampling frequency of the stream preprocessed
+    double samplingFrequency;
+    // The (possibly resampled) record the chunk refers to
+    RecordCPtr record;
+    DoubleArrayCPtr data;
+  };
+  using PreprocessedChunks = std::vector<Preprocessed>;
+
+  // Creates a `PreprocessingChain` configured according to `processor`
+  explicit PreprocessingChain(const TemplateWaveformProcessor &processor);
+
+  ~PreprocessingChain() override;
+
+  // Subscribes `processor` to the chain. Afterwards, `processor` delegates
+  // filtering and resampling to the chain.
+  //
+  // - it is a bug if `processor` is not a valid pointer
+  // - the chain does not take ownership; `processor` must outlive the chain
+  void subscribe(TemplateWaveformProcessor *processor);
+  // Returns the number of subscribers
+  std::size_t size() const;
+
+  // Feeds `record` to the chain. The data preprocessed w.r.t. the record fed
+  // previously is dropped.
+  bool feed(const Record *record) override;
+
+  void reset() override;
+
+  // Returns the chunks of data preprocessed w.r.t. `record` (in the order of
+  // preprocessing). If `record` is not the record fed most recently, no
+  // chunks are returned.
+  const PreprocessedChunks &preprocessed(const Record *record) const;
+
+  // Returns the key identifying the preprocessing chain `processor`
+  // (processing the records identified by `waveformStreamId`) may subscribe
+  // to
+  static std::string key(const std::string &waveformStreamId,
+                         const TemplateWaveformProcessor &processor);
+
+ protected:
+  WaveformProcessor::StreamState *streamState(const Record *record) override;
+
+  void process(StreamState &streamState, const Record *record,
+               const DoubleArray &filteredData) override;
+
+  bool store(const Record *record) override;
+
+  void setupStream(StreamState &streamState, const Record *record) override;
+
+ private:
+  StreamState _streamState;
+
+  // The optional target sampling frequency (used for on-the-fly resampling)
+  boost::optional<double> _targetSamplingFrequency;
+
+  using Subscribers = std::vector<TemplateWaveformProcessor *>;
+  Subscribers _subscribers;
+
+  // The record fed most recently
+  const Record *_fed{nullptr};
+  // The chunks of data preprocessed w.r.t. `_fed`
+  PreprocessedChunks _preprocessed;
+  // Defines if the stream was (re-)initialized since preprocessing the
+  // previous chunk
+  bool _setup{false};
+};
+
+// Registry of shared preprocessing chains
+class PreprocessingRegistry {
+ public:
+  // Subscribes `processor` (processing the records identified by
+  // `waveformStreamId`) to the matching preprocessing chain. If there is no
+  // matching preprocessing chain, yet, the preprocessing chain is created.
+  // Returns `true` if `processor` was subscribed, else `false` (i.e. the
+  // processor's filter is not identified by means of a filter identifier).
+  bool add(const std::string &waveformStreamId,
+           TemplateWaveformProcessor *processor);
+
+  // Feeds `record` to the preprocessing chains processing the corresponding
+  // stream
+  void feed(const Record *record);
+
+  // Resets all preprocessing chains
+  void reset();
+
+  // Returns the number of preprocessing chains
+  std::size_t size() const;
+  // Returns the total number of subscribers
+  std::size_t subscribers() const;
+  // Returns `true` if there are no preprocessing chains registered, else
+  // `false`
+  bool empty() const;
+
+ private:
+  using PreprocessingChains =
+      std::unordered_map<std::string, std::unique_ptr<PreprocessingChain>>;
+  // Preprocessing chains by key
+  PreprocessingChains _preprocessingChains;
+
+  using PreprocessingChainIdx =
+      std::unordered_multimap<std::string, PreprocessingChain *>;
+  // Preprocessing chains by waveform stream identifier
+  PreprocessingChainIdx _preprocessingChainIdx;
+};
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_DETECTOR_PREPROCESSINGCHAIN_H_
@@ -0,0 +1,288 @@
+#include "stacked_template_waveform_processor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "../log.h"
+#include "../util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+StackedTemplateWaveformProcessor::StackedTemplateWaveformProcessor(
+    std::unique_ptr<TemplateWaveformProcessor> processor,
+    const std::string &waveformStreamId)
+    : TemplateWaveformProcessor{processor->templateWaveform()} {
+  add(std::move(processor), waveformStreamId);
+}
+
+void StackedTemplateWaveformProcessor::add(
+    std::unique_ptr<TemplateWaveformProcessor> processor,
+    const std::string &waveformStreamId) {
+  assert(processor);
+
+  const auto componentIdx{_components.size()};
+  // the components' correlation coefficients are stacked; thus, all of them are
+  // of interest
+  processor->setLocalMaximaThreshold(boost::none);
+  processor->setCoefficientsCallback(
+      [this, componentIdx](const TemplateWaveformProcessor *,
+                           const Record *record,
+                           const TemplateWaveformProcessor::Coefficients &c) {
+        storeCoefficients(componentIdx, record, c);
+      });
+
+  Component component;
+  component.processor = std::move(processor);
+  component.waveformStreamId = waveformStreamId;
+  _components.push_back(std::move(component));
+
+  reset();
+}
+
+std::size_t StackedTemplateWaveformProcessor::size() const {
+  return _components.size();
+}
+
+std::vector<std::string> StackedTemplateWaveformProcessor::waveformStreamIds()
+    const {
+  std::vector<std::string> ret;
+  for (const auto &component : _components) {
+    ret.push_back(component.waveformStreamId);
+  }
+  return ret;
+}
+
+const TemplateWaveformProcessor *StackedTemplateWaveformProcessor::component(
+    const std::string &waveformStreamId) const {
+  for (const auto &component : _components) {
+    if (component.waveformStreamId == waveformStreamId) {
+      return component.processor.get();
+    }
+  }
+  return nullptr;
+}
+
+bool StackedTemplateWaveformProcessor::feed(const Record *record) {
+  for (auto &component : _components) {
+    if (component.waveformStreamId != record->streamID()) {
+      continue;
+    }
+
+    if (!component.processor->feed(record)) {
+      setStatus(component.processor->status(),
+                component.processor->statusValue());
+      return false;
+    }
+    break;
+  }
+
+  return !finished();
+}
+
+void StackedTemplateWaveformProcessor::reset() {
+  for (auto &component : _components) {
+    component.processor->reset();
+    component.coefficients.clear();
+    component.startTime = boost::none;
+    component.samplingFrequency = 0;
+  }
+  _maxima.reset();
+  _stackedEndTime = boost::none;
+
+  TemplateWaveformProcessor::reset();
+}
+
+void StackedTemplateWaveformProcessor::setGapInterpolation(
+    bool gapInterpolation) {
+  TemplateWaveformProcessor::setGapInterpolation(gapInterpolation);
+  for (auto &component : _components) {
+    component.processor->setGapInterpolation(gapInterpolation);
+  }
+}
+
+void StackedTemplateWaveformProcessor::setGapThreshold(
+    const Core::TimeSpan &duration) {
+  TemplateWaveformProcessor::setGapThreshold(duration);
+  for (auto &component : _components) {
+    component.processor->setGapThreshold(duration);
+  }
+}
+
+void StackedTemplateWaveformProcessor::setGapTolerance(
+    const Core::TimeSpan &duration) {
+  TemplateWaveformProcessor::setGapTolerance(duration);
+  for (auto &component : _components) {
+    component.processor->setGapTolerance(duration);
+  }
+}
+
+Core::TimeSpan StackedTemplateWaveformProcessor::initTime() const {
+  Core::TimeSpan ret{0.0};
+  for (const auto &component : _components) {
+    ret = std::max(ret, component.processor->initTime());
+  }
+  return ret;
+}
+
+const StackedTemplateWaveformProcessor::Filter *
+StackedTemplateWaveformProcessor::filter() const {
+  return reference().processor->filter();
+}
+
+const Core::TimeWindow &StackedTemplateWaveformProcessor::processed() const {
+  return reference().processor->processed();
+}
+
+const TemplateWaveform &StackedTemplateWaveformProcessor::templateWaveform()
+    const {
+  return reference().processor->templateWaveform();
+}
+
+void StackedTemplateWaveformProcessor::storeCoefficients(
+    std::size_t componentIdx, const Record *record,
+    const TemplateWaveformProcessor::Coefficients &c) {
+  auto &component{_components[componentIdx]};
+  const auto f{c.samplingFrequency};
+  if (component.samplingFrequency != f) {
+    component.coefficients.clear();
+    component.startTime = boost::none;
+    component.samplingFrequency = f;
+  }
+
+  const auto startTime{c.startTime - offset(componentIdx)};
+  if (component.startTime) {
+    // a discontinuity (e.g. due to a gap or a reset of the component
+    // processor) invalidates the coefficients buffered
+    const auto expected{*component.startTime +
+                        Core::TimeSpan{component.coefficients.size() / f}};
+    if (std::abs(static_cast<double>(startTime - expected)) > 0.5 / f) {
+      component.coefficients.clear();
+    }
+  }
+  // anchor the buffered coefficients to the most recent chunk of data such that
+  // rounding errors do not accumulate
+  component.startTime =
+      startTime - Core::TimeSpan{component.coefficients.size() / f};
+  component.coefficients.insert(component.coefficients.end(), c.data,
+                                c.data + c.size);
+
+  stack(record);
+}
+
+void StackedTemplateWaveformProcessor::stack(const Record *record) {
+  const auto &ref{reference()};
+  for (const auto &component : _components) {
+    if (!component.startTime) {
+      return;
+    }
+    if (component.samplingFrequency != ref.samplingFrequency) {
+      SCDETECT_LOG_WARNING_PROCESSOR(
+          this,
+          "%s: sampling frequency mismatch (sampling_frequency=%f, "
+          "reference_sampling_frequency=%f)",
+          component.waveformStreamId.c_str(), component.samplingFrequency,
+          ref.samplingFrequency);
+      setStatus(Status::kInvalidSamplingFreq, component.samplingFrequency);
+      return;
+    }
+  }
+
+  const auto f{ref.samplingFrequency};
+  // the time of the first coefficient available for all components
+  Core::Time startTime{*ref.startTime};
+  for (const auto &component : _components) {
+    startTime = std::max(startTime, *component.startTime);
+  }
+
+  const auto skipped = [&startTime, f](const Component &component) {
+    const auto ret{std::lround(
+        static_cast<double>(startTime - *component.startTime) * f)};
+    return std::min(static_cast<std::size_t>(std::max(ret, 0L)),
+                    component.coefficients.size());
+  };
+
+  std::size_t n{std::numeric_limits<std::size_t>::max()};
+  for (const auto &component : _components) {
+    n = std::min(n, component.coefficients.size() - skipped(component));
+  }
+
+  _stacked.assign(n, 0);
+  for (auto &component : _components) {
+    const auto skip{skipped(component)};
+    const double *coefficients{component.coefficients.data() + skip};
+    for (std::size_t i = 0; i < n; ++i) {
+      _stacked[i] += coefficients[i];
+    }
+
+    component.coefficients.erase(
+        component.coefficients.begin(),
+        component.coefficients.begin() + static_cast<std::ptrdiff_t>(skip + n));
+    *component.startTime += Core::TimeSpan{(skip + n) / f};
+  }
+
+  if (!n) {
+    return;
+  }
+
+  setStatus(Status::kInProgress, 1);
+
+  // a discontinuity of the stacked coefficients invalidates the detection
+  // state carried over from the previous chunk
+  if (_stackedEndTime &&
+      std::abs(static_cast<double>(startTime - *_stackedEndTime)) > 0.5 / f) {
+    _maxima.reset();
+  }
+  _stackedEndTime = startTime + Core::TimeSpan{n / f};
+
+  _maxima.values.clear();
+  _maxima.threshold =
+      localMaximaThreshold().value_or(std::numeric_limits<double>::lowest());
+  const auto numComponents{static_cast<double>(_components.size())};
+  for (std::size_t i = 0; i < n; ++i) {
+    _stacked[i] /= numComponents;
+    // offset the lag index by one such that a local maximum at the last
+    // coefficient of the previous chunk is detected with lag index zero
+    _maxima.feed(_stacked[i], i + 1);
+  }
+
+  if (_maxima.values.empty()) {
+    return;
+  }
+
+  const auto templateWaveformSize{
+      static_cast<int>(ref.processor->templateWaveform().size())};
+  auto result{util::make_unique<MatchResult>()};
+  for (const auto &m : _maxima.values) {
+    // take cross-correlation filter delay into account i.e. the result is
+    // referring to a time window shifted to the past (a negative index refers
+    // to the previous chunk)
+    const auto matchIdx{static_cast<int>(m.lagIdx) - templateWaveformSize};
+    result->localMaxima.push_back(
+        MatchResult::Value{Core::TimeSpan{matchIdx / f}, m.coefficient});
+  }
+  result->timeWindow =
+      Core::TimeWindow{startTime, startTime + Core::TimeSpan{n / f}};
+
+  emitResult(record, std::move(result));
+}
+
+Core::TimeSpan StackedTemplateWaveformProcessor::offset(
+    std::size_t componentIdx) const {
+  return _components[componentIdx].processor->templateWaveform().endTime() -
+         reference().processor->templateWaveform().endTime();
+}
+
+const StackedTemplateWaveformProcessor::Component &
+StackedTemplateWaveformProcessor::reference() const {
+  assert(!_components.empty());
+  return _components.front();
+}
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,124 @@
+#ifndef SCDETECT_APPS_CC_DETECTOR_STACKEDTEMPLATEWAVEFORMPROCESSOR_H_
+#define SCDETECT_APPS_CC_DETECTOR_STACKEDTEMPLATEWAVEFORMPROCESSOR_H_
+
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/record.h>
+#include <seiscomp/core/timewindow.h>
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../filter/local_maxima.h"
+#include "../template_waveform.h"
+#include "template_waveform_processor.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+// Multi-component (e.g. three-component) template waveform processor
+//
+// - cross-correlates the records of multiple waveform streams of a single
+// sensor location (i.e. the components) with their template waveforms by
+// means of the component processors and stacks (i.e. averages) the resulting
+// correlation coefficients in lockstep
+// - the arrival offsets between the components are fixed and given by the
+// template waveforms; hence, a single match result (w.r.t. the stacked
+// correlation coefficients) is published per chunk of data instead of
+// publishing match results per component
+// - match results refer to the reference component (i.e. the first component
+// added), exclusively; the processor's template waveform, filter and time
+// window processed correspond to the reference component's
+// - the components are required to be processed with the same sampling
+// frequency
+class StackedTemplateWaveformProcessor : public TemplateWaveformProcessor {
+ public:
+  // Creates a `StackedTemplateWaveformProcessor` with the reference component
+  // processor `processor` processing the records identified by
+  // `waveformStreamId`
+  StackedTemplateWaveformProcessor(
+      std::unique_ptr<TemplateWaveformProcessor> processor,
+      const std::string &waveformStreamId);
+
+  // Adds the component processor `processor` processing the records
+  // identified by `waveformStreamId`
+  //
+  // - the processor is reset
+  void add(std::unique_ptr<TemplateWaveformProcessor> processor,
+           const std::string &waveformStreamId);
+  // Returns the number of components (including the reference component)
+  std::size_t size() const;
+  // Returns the waveform stream identifiers of the components where the
+  // first identifier refers to the reference component
+  std::vector<std::string> waveformStreamIds() const;
+  // Returns the component processor processing the records identified by
+  // `waveformStreamId` (if any, else `nullptr`)
+  const TemplateWaveformProcessor *component(
+      const std::string &waveformStreamId) const;
+
+  // Feeds `record` to the component processor processing the records
+  // identified by `record->streamID()`
+  bool feed(const Record *record) override;
+
+  void reset() override;
+
+  void setGapInterpolation(bool gapInterpolation) override;
+  void setGapThreshold(const Core::TimeSpan &duration) override;
+  void setGapTolerance(const Core::TimeSpan &duration) override;
+
+  Core::TimeSpan initTime() const override;
+
+  const Filter *filter() const override;
+
+  const Core::TimeWindow &processed() const override;
+
+  const TemplateWaveform &templateWaveform() const override;
+
+ private:
+  struct Component {
+    std::unique_ptr<TemplateWaveformProcessor> processor;
+    std::string waveformStreamId;
+
+    // The coefficients not stacked, yet
+    std::vector<double> coefficients;
+    // The time of the first coefficient buffered w.r.t. the reference
+    // component (if initialized)
+    boost::optional<Core::Time> startTime;
+    double samplingFrequency{0};
+  };
+
+  // Buffers the `coefficients` computed by the component identified by
+  // `componentIdx` and stacks the coefficients available for all components
+  void storeCoefficients(std::size_t componentIdx, const Record *record,
+                         const TemplateWaveformProcessor::Coefficients &c);
+  // Stacks the coefficients buffered for all components and publishes the
+  // match result
+  void stack(const Record *record);
+
+  // Returns the time offset of the component identified by `componentIdx`
+  // w.r.t. the reference component, i.e. the offset between the data samples
+  // the last template waveform samples are aligned with
+  Core::TimeSpan offset(std::size_t componentIdx) const;
+
+  const Component &reference() const;
+
+  std::vector<Component> _components;
+
+  // Scratch buffer for the stacked coefficients
+  std::vector<double> _stacked;
+  // The local maxima of the stacked coefficients (the detection state is
+  // carried over from chunk to chunk)
+  filter::LocalMaxima _maxima;
+  // The time of the coefficient following the coefficients stacked most
+  // recently
+  boost::optional<Core::Time> _stackedEndTime;
+};
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_DETECTOR_STACKEDTEMPLATEWAVEFORMPROCESSOR_H_
@@ -0,0 +1,311 @@
+#include "template_bank.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <string>
+
+#include "../log.h"
+#include "../operator/resample.h"
+#include "../resamplerstore.h"
+#include "../settings.h"
+#include "../util/memory.h"
+#include "preprocessing_chain.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+TemplateBank::TemplateBank(const TemplateWaveformProcessor &processor)
+    : _targetSamplingFrequency{processor.targetSamplingFrequency()} {
+  if (!processor.filterId().empty()) {
+    _streamState.filter = processing::createFilter(processor.filterId());
+  }
+
+  setGapThreshold(processor.gapThreshold());
+  setGapTolerance(processor.gapTolerance());
+  setGapInterpolation(processor.gapInterpolation());
+}
+
+TemplateBank::~TemplateBank() {
+  for (auto *member : _members) {
+    member->_templateBank = nullptr;
+  }
+}
+
+void TemplateBank::add(TemplateWaveformProcessor *processor) {
+  assert(processor);
+  assert(!incompatibility(*processor));
+
+  const auto idx{_crossCorrelationBank.add(processor->templateWaveform())};
+  // correlation coefficients less than the processor's local maxima threshold
+  // are not of interest
+  _crossCorrelationBank.setThreshold(idx, processor->localMaximaThreshold());
+  processor->_templateBank = this;
+  processor->_templateBankIdx = idx;
+  _members.push_back(processor);
+
+  _initTime = std::max(_initTime, processor->initTime());
+
+  reset();
+}
+
+std::size_t TemplateBank::size() const { return _members.size(); }
+
+const TemplateWaveform &TemplateBank::templateWaveform(std::size_t idx) const {
+  return _crossCorrelationBank.templateWaveform(idx);
+}
+
+void TemplateBank::setSubspaceEnergyFraction(
+    const boost::optional<double> &energyFraction) {
+  _crossCorrelationBank.setSubspaceEnergyFraction(energyFraction);
+  reset();
+}
+
+void TemplateBank::setClustering(const boost::optional<double> &similarity,
+                                 double boundMargin) {
+  _crossCorrelationBank.setClustering(similarity, boundMargin);
+  reset();
+}
+
+void TemplateBank::logClusterStatistics() const {
+  for (const auto &cluster : _crossCorrelationBank.clusterStatistics()) {
+    const auto numTemplates{cluster.members.size() + 1};
+    const auto coefficients{cluster.lags * numTemplates};
+    const double saved{
+        coefficients ? 100.0 * (1.0 - static_cast<double>(
+                                          cluster.coefficientsComputed) /
+                                          coefficients)
+                     : 0.0};
+    SCDETECT_LOG_INFO_PROCESSOR(
+        this,
+        "Template cluster (representative=%s, templates=%lu, "
+        "min_similarity=%f): lags=%lu, coefficients_computed=%lu, "
+        "saved=%.1f%%",
+        _members[cluster.representative]->id().c_str(), numTemplates,
+        cluster.minSimilarity, cluster.lags, cluster.coefficientsComputed,
+        saved);
+  }
+}
+
+void TemplateBank::setFingerprintSearch(const boost::optional<double> &hop,
+                                        std::size_t minVotes) {
+  _crossCorrelationBank.setFingerprintSearch(hop, minVotes);
+  reset();
+}
+
+void TemplateBank::logFingerprintStatistics() const {
+  for (const auto &statistics :
+       _crossCorrelationBank.fingerprintStatistics()) {
+    const auto coefficients{statistics.lags * statistics.members.size()};
+    const double saved{
+        coefficients ? 100.0 * (1.0 - static_cast<double>(
+                                          statistics.coefficientsComputed) /
+                                          coefficients)
+                     : 0.0};
+    SCDETECT_LOG_INFO_PROCESSOR(
+        this,
+        "Fingerprint search (templates=%lu): lags=%lu, fingerprints=%lu, "
+        "candidates=%lu, coefficients_computed=%lu, saved=%.1f%%",
+        statistics.members.size(), statistics.lags, statistics.fingerprints,
+        statistics.candidates, statistics.coefficientsComputed, saved);
+  }
+}
+
+void TemplateBank::reset() {
+  WaveformProcessor::reset(_streamState);
+  _crossCorrelationBank.reset();
+  WaveformProcessor::reset();
+}
+
+std::string TemplateBank::key(const std::string &waveformStreamId,
+                              const TemplateWaveformProcessor &processor) {
+  // template banks implement preprocessing on behalf of their members
+  return PreprocessingChain::key(waveformStreamId, processor);
+}
+
+boost::optional<std::string> TemplateBank::incompatibility(
+    const TemplateWaveformProcessor &processor) {
+  if (processor.precision() != filter::Precision::kDouble) {
+    return std::string{"single precision"};
+  }
+  if (processor.coarseSearch()) {
+    return std::string{"coarse-to-fine search"};
+  }
+  const auto &correlationEngine{processor.correlationEngine()};
+  if (correlationEngine &&
+      correlationEngine->engine != filter::CorrelationEngine::kTimeDomain) {
+    return "correlation engine: " + to_string(*correlationEngine);
+  }
+  return boost::none;
+}
+
+processing::WaveformProcessor::StreamState *TemplateBank::streamState(
+    const Record *record) {
+  return &_streamState;
+}
+
+void TemplateBank::process(StreamState &streamState, const Record *record,
+                           const DoubleArray &filteredData) {
+  const auto n{filteredData.size()};
+  setStatus(Status::kInProgress, 1);
+
+  for (auto *member : _members) {
+    DoubleArray coefficients{
+        n, _crossCorrelationBank.coefficients(member->_templateBankIdx)};
+    try {
+      member->processCorrelated(streamState, record, coefficients);
+    } catch (std::exception &e) {
+      SCDETECT_LOG_WARNING_PROCESSOR(
+          member, "%s: failed to process cross-correlation results: %s",
+          record->streamID().c_str(), e.what());
+    }
+  }
+}
+
+bool TemplateBank::store(const Record *record) {
+  processing::WaveformProcessor::store(record);
+
+  return !finished();
+}
+
+bool TemplateBank::fill(processing::StreamState &streamState,
+                        const Record *record, DoubleArrayPtr &data) {
+  if (WaveformProcessor::fill(streamState, record, data)) {
+    // cross-correlate filtered data with all members
+    _crossCorrelationBank.apply(data->size(), data->typedData());
+    return true;
+  }
+  return false;
+}
+
+void TemplateBank::setupStream(StreamState &streamState,
+                               const Record *record) {
+  WaveformProcessor::setupStream(streamState, record);
+  const auto f{streamState.samplingFrequency};
+  SCDETECT_LOG_DEBUG_PROCESSOR(
+      this, "Initialize stream: sampling_frequency=%f, members=%lu", f,
+      _members.size());
+  if (_targetSamplingFrequency && *_targetSamplingFrequency != f) {
+    SCDETECT_LOG_DEBUG_PROCESSOR(this,
+                                 "Reinitialize stream: sampling_frequency=%f",
+                                 *_targetSamplingFrequency);
+    setOperator(util::make_unique<waveform_operator::ResamplingOperator>(
+        RecordResamplerStore::Instance().get(record,
+                                             *_targetSamplingFrequency)));
+
+    streamState.samplingFrequency = *_targetSamplingFrequency;
+    if (streamState.filter) {
+      streamState.filter->setSamplingFrequency(*_targetSamplingFrequency);
+    }
+  }
+
+  _crossCorrelationBank.setSamplingFrequency(
+      _targetSamplingFrequency.value_or(f));
+}
+
+bool TemplateBankRegistry::add(
+    const std::string &waveformStreamId, TemplateWaveformProcessor *processor,
+    const boost::optional<SubspaceConfig> &subspaceConfig) {
+  assert(processor);
+  if (TemplateBank::incompatibility(*processor)) {
+    return false;
+  }
+
+  auto key{TemplateBank::key(waveformStreamId, *processor)};
+  if (subspaceConfig) {
+    key += settings::kProcessorIdSep + subspaceConfig->groupId +
+           settings::kProcessorIdSep +
+           std::to_string(subspaceConfig->energyFraction);
+  }
+
+  auto it{_templateBanks.find(key)};
+  if (it == _templateBanks.end()) {
+    auto templateBank{util::make_unique<TemplateBank>(*processor)};
+    templateBank->setId(key);
+    if (subspaceConfig) {
+      templateBank->setSubspaceEnergyFraction(subspaceConfig->energyFraction);
+    }
+    if (_clusterConfig) {
+      templateBank->setClustering(_clusterConfig->similarity,
+                                  _clusterConfig->boundMargin);
+    }
+    if (_fingerprintConfig) {
+      templateBank->setFingerprintSearch(_fingerprintConfig->hop,
+                                         _fingerprintConfig->minVotes);
+    }
+    _templateBankIdx.emplace(waveformStreamId, templateBank.get());
+    it = _templateBanks.emplace(key, std::move(templateBank)).first;
+  }
+
+  it->second->add(processor);
+  return true;
+}
+
+void TemplateBankRegistry::setClusterConfig(
+    const boost::optional<ClusterConfig> &clusterConfig) {
+  _clusterConfig = clusterConfig;
+  for (auto &templateBankPair : _templateBanks) {
+    if (_clusterConfig) {
+      templateBankPair.second->setClustering(_clusterConfig->similarity,
+                                             _clusterConfig->boundMargin);
+    } else {
+      templateBankPair.second->setClustering(boost::none);
+    }
+  }
+}
+
+void TemplateBankRegistry::setFingerprintConfig(
+    const boost::optional<FingerprintConfig> &fingerprintConfig) {
+  _fingerprintConfig = fingerprintConfig;
+  for (auto &templateBankPair : _templateBanks) {
+    if (_fingerprintConfig) {
+      templateBankPair.second->setFingerprintSearch(
+          _fingerprintConfig->hop, _fingerprintConfig->minVotes);
+    } else {
+      templateBankPair.second->setFingerprintSearch(boost::none);
+    }
+  }
+}
+
+void TemplateBankRegistry::feed(const Record *record) {
+  auto range{_templateBankIdx.equal_range(record->streamID())};
+  for (auto it = range.first; it != range.second; ++it) {
+    auto *templateBank{it->second};
+    if (!templateBank->feed(record)) {
+      SCDETECT_LOG_WARNING_PROCESSOR(
+          templateBank,
+          "%s: Failed to feed record into template bank. Resetting.",
+          record->streamID().c_str());
+      templateBank->reset();
+    }
+  }
+}
+
+void TemplateBankRegistry::reset() {
+  for (auto &templateBankPair : _templateBanks) {
+    templateBankPair.second->reset();
+  }
+}
+
+void TemplateBankRegistry::logClusterStatistics() const {
+  for (const auto &templateBankPair : _templateBanks) {
+    templateBankPair.second->logClusterStatistics();
+  }
+}
+
+void TemplateBankRegistry::logFingerprintStatistics() const {
+  for (const auto &templateBankPair : _templateBanks) {
+    templateBankPair.second->logFingerprintStatistics();
+  }
+}
+
+std::size_t TemplateBankRegistry::size() const {
+  return _templateBanks.size();
+}
+
+bool TemplateBankRegistry::empty() const { return _templateBanks.empty(); }
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
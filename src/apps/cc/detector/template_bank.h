@@ -0,0 +1,216 @@
+#ifndef SCDETECT_APPS_CC_DETECTOR_TEMPLATEBANK_H_
+#define SCDETECT_APPS_CC_DETECTOR_TEMPLATEBANK_H_
+
+#include <seiscomp/core/record.h>
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../filter/crosscorrelation_bank.h"
+#include "../processing/waveform_processor.h"
+#include "../template_waveform.h"
+#include "template_waveform_processor.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+// Template bank implementation
+//
+// - cross-correlates the records of a single waveform stream with the
+// template waveforms of multiple `TemplateWaveformProcessor`s (i.e. the bank's
+// members) by means of a single `filter::CrossCorrelationBank`
+// - implements resampling and filtering on behalf of its members
+// - the members still compute and publish their match results by themselves
+// - members are required to share the same configuration w.r.t. filtering,
+// resampling and gap handling (see also `TemplateBank::key()`)
+// - optionally, the members' template waveforms are represented by means of a
+// truncated subspace basis (see also
+// `filter::CrossCorrelationBank::setSubspaceEnergyFraction()`)
+// - optionally, the members' template waveforms are clustered such that only
+// the cluster representatives are cross-correlated continuously (see also
+// `filter::CrossCorrelationBank::setClustering()`)
+// - optionally, the members' template waveforms are searched for by means of
+// waveform fingerprints such that the members are cross-correlated in the
+// vicinity of candidate matches, only (see also
+// `filter::CrossCorrelationBank::setFingerprintSearch()`)
+class TemplateBank : public processing::WaveformProcessor {
+ public:
+  // Creates a `TemplateBank` configured according to `processor`
+  explicit TemplateBank(const TemplateWaveformProcessor &processor);
+
+  ~TemplateBank() override;
+
+  // Adds `processor` to the bank. Afterwards, `processor` delegates the
+  // cross-correlation to the bank.
+  //
+  // - it is a bug if `processor` is not a valid pointer
+  // - it is a bug if the bank cannot honour the configuration of `processor`
+  // (see `incompatibility()`)
+  // - the bank does not take ownership; `processor` must outlive the bank
+  void add(TemplateWaveformProcessor *processor);
+  // Returns the number of members
+  std::size_t size() const;
+
+  // Returns the template waveform of the member identified by `idx`
+  const TemplateWaveform &templateWaveform(std::size_t idx) const;
+
+  // Sets the fraction of the template waveforms' energy the subspace basis
+  // must capture. If `boost::none`, the subspace representation is disabled.
+  void setSubspaceEnergyFraction(
+      const boost::optional<double> &energyFraction);
+
+  // Enables template clustering where `similarity` refers to the minimum
+  // similarity of the template waveforms of a cluster. If `boost::none`,
+  // template clustering is disabled.
+  //
+  // - the members' local maxima thresholds (see
+  // `TemplateWaveformProcessor::localMaximaThreshold()`) must be configured
+  // before the members are added
+  void setClustering(const boost::optional<double> &similarity,
+                     double boundMargin = 0);
+  // Logs the statistics of the template clusters (i.e. the work saved)
+  void logClusterStatistics() const;
+
+  // Enables the fingerprint based similarity search where `hop` refers to the
+  // lag (in seconds) between subsequent data fingerprints. If `boost::none`,
+  // the fingerprint based similarity search is disabled.
+  void setFingerprintSearch(const boost::optional<double> &hop,
+                            std::size_t minVotes = 2);
+  // Logs the statistics of the fingerprint based similarity search (i.e. the
+  // work saved)
+  void logFingerprintStatistics() const;
+
+  void reset() override;
+
+  // Returns the key identifying the template bank `processor` (processing the
+  // records identified by `waveformStreamId`) may be added to
+  static std::string key(const std::string &waveformStreamId,
+                         const TemplateWaveformProcessor &processor);
+  // Returns the reason why a template bank cannot honour the configuration of
+  // `processor` (i.e. template banks cross-correlate in double precision by
+  // means of the time domain engine and do not implement the coarse-to-fine
+  // search). Returns `boost::none` if `processor` may be added to a template
+  // bank.
+  static boost::optional<std::string> incompatibility(
+      const TemplateWaveformProcessor &processor);
+
+ protected:
+  WaveformProcessor::StreamState *streamState(const Record *record) override;
+
+  void process(StreamState &streamState, const Record *record,
+               const DoubleArray &filteredData) override;
+
+  bool store(const Record *record) override;
+
+  bool fill(processing::StreamState &streamState, const Record *record,
+            DoubleArrayPtr &data) override;
+
+  void setupStream(StreamState &streamState, const Record *record) override;
+
+ private:
+  StreamState _streamState;
+
+  // The optional target sampling frequency (used for on-the-fly resampling)
+  boost::optional<double> _targetSamplingFrequency;
+
+  using Members = std::vector<TemplateWaveformProcessor *>;
+  Members _members;
+
+  // The cross-correlation filter bank
+  filter::CrossCorrelationBank<double> _crossCorrelationBank;
+};
+
+// Registry of template banks
+class TemplateBankRegistry {
+ public:
+  // Subspace configuration of a template bank
+  struct SubspaceConfig {
+    // Identifies the group of template waveforms (i.e. the template family)
+    // represented by means of a common subspace
+    std::string groupId;
+    // The fraction of the template waveforms' energy the subspace basis must
+    // capture
+    double energyFraction{0.99};
+  };
+
+  // Template clustering configuration
+  struct ClusterConfig {
+    // The minimum similarity of the template waveforms of a cluster
+    double similarity{0.8};
+    // The margin subtracted from the lower bounds derived
+    double boundMargin{0.02};
+  };
+
+  // Sets the template clustering configuration of both the template banks
+  // registered and the ones created afterwards. If `boost::none`, template
+  // clustering is disabled.
+  void setClusterConfig(const boost::optional<ClusterConfig> &clusterConfig);
+
+  // Fingerprint based similarity search configuration
+  struct FingerprintConfig {
+    // The lag (in seconds) between subsequent data fingerprints
+    double hop{0.1};
+    // The minimum number of votes required for a candidate match
+    std::size_t minVotes{2};
+  };
+
+  // Sets the fingerprint based similarity search configuration of both the
+  // template banks registered and the ones created afterwards. If
+  // `boost::none`, the fingerprint based similarity search is disabled.
+  void setFingerprintConfig(
+      const boost::optional<FingerprintConfig> &fingerprintConfig);
+
+  // Adds `processor` (processing the records identified by
+  // `waveformStreamId`) to the matching template bank. If there is no matching
+  // template bank, yet, the template bank is created. Returns `false` if
+  // template banks cannot honour the configuration of `processor` (see
+  // `TemplateBank::incompatibility()`), i.e. `processor` is not added, else
+  // `true`.
+  //
+  // - if `subspaceConfig` is provided, the processor is added to a template
+  // bank exclusively made up of the members of the subspace group
+  bool add(const std::string &waveformStreamId,
+           TemplateWaveformProcessor *processor,
+           const boost::optional<SubspaceConfig> &subspaceConfig = boost::none);
+
+  // Feeds `record` to the template banks processing the corresponding stream
+  void feed(const Record *record);
+
+  // Resets all template banks
+  void reset();
+
+  // Logs the template cluster statistics of all template banks
+  void logClusterStatistics() const;
+  // Logs the fingerprint based similarity search statistics of all template
+  // banks
+  void logFingerprintStatistics() const;
+
+  // Returns the number of template banks
+  std::size_t size() const;
+  // Returns `true` if there are no template banks registered, else `false`
+  bool empty() const;
+
+ private:
+  using TemplateBanks =
+      std::unordered_map<std::string, std::unique_ptr<TemplateBank>>;
+  // Template banks by key
+  TemplateBanks _templateBanks;
+
+  using TemplateBankIdx = std::unordered_multimap<std::string, TemplateBank *>;
+  // Template banks by waveform stream identifier
+  TemplateBankIdx _templateBankIdx;
+
+  boost::optional<ClusterConfig> _clusterConfig;
+  boost::optional<FingerprintConfig> _fingerprintConfig;
+};
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_DETECTOR_TEMPLATEBANK_H_
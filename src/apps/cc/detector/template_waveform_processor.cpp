@@ -3,66 +3,89 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
 
+#include "../correlation_engine_tuner.h"
 #include "../log.h"
 #include "../operator/resample.h"
 #include "../resamplerstore.h"
 #include "../settings.h"
 #include "../util/memory.h"
 #include "../waveform.h"
+#include "preprocessing_chain.h"
+#include "template_bank.h"
 
 namespace Seiscomp {
 namespace detect {
 namespace detector {
 
-namespace detail {
-
-void LocalMaxima::feed(double coefficient, std::size_t lagIdx) {
-  if (!std::isfinite(coefficient)) {
-    return;
-  }
-
-  if (coefficient < prevCoefficient && notDecreasing) {
-    values.push_back({prevCoefficient, --lagIdx});
-  }
-
-  notDecreasing = coefficient >= prevCoefficient;
-  prevCoefficient = coefficient;
-}
-
-}  // namespace detail
-
 TemplateWaveformProcessor::TemplateWaveformProcessor(
     TemplateWaveform templateWaveform)
-    : _crossCorrelation{std::move(templateWaveform)} {}
+    : _crossCorrelation{std::move(templateWaveform)} {
+  setupLocalMaxima();
+}
 
 void TemplateWaveformProcessor::setFilter(std::unique_ptr<Filter> filter,
                                           const Core::TimeSpan &initTime) {
   _streamState.filter = std::move(filter);
+  _filterId.clear();
   _initTime = std::max(initTime, templateWaveform().configuredEndTime() -
                                      templateWaveform().configuredStartTime());
 }
 
+void TemplateWaveformProcessor::setFilter(const std::string &filterId,
+                                          const Core::TimeSpan &initTime) {
+  setFilter(processing::createFilter(filterId), initTime);
+  _filterId = filterId;
+}
+
 const TemplateWaveformProcessor::Filter *TemplateWaveformProcessor::filter()
     const {
   return _streamState.filter.get();
 }
 
+const std::string &TemplateWaveformProcessor::filterId() const {
+  return _filterId;
+}
+
 void TemplateWaveformProcessor::setResultCallback(
     const PublishMatchResultCallback &callback) {
   _resultCallback = callback;
 }
 
+void TemplateWaveformProcessor::setCoefficientsCallback(
+    const PublishCoefficientsCallback &callback) {
+  _coefficientsCallback = callback;
+  setupLocalMaxima();
+}
+
 const Core::TimeWindow &TemplateWaveformProcessor::processed() const {
   return _streamState.dataTimeWindow;
 }
 
+bool TemplateWaveformProcessor::feed(const Record *record) {
+  if (_templateBank) {
+    return !finished();
+  }
+  if (_preprocessingChain) {
+    return feedPreprocessed(record);
+  }
+
+  return WaveformProcessor::feed(record);
+}
+
 void TemplateWaveformProcessor::reset() {
   WaveformProcessor::reset(_streamState);
   _crossCorrelation.reset();
+  if (_crossCorrelationSingle) {
+    _crossCorrelationSingle->reset();
+  }
+  if (_coarseSearch) {
+    _coarseSearch->reset();
+  }
   WaveformProcessor::reset();
 }
 
@@ -84,7 +107,82 @@ boost::optional<double> TemplateWaveformProcessor::targetSamplingFrequency()
   return _targetSamplingFrequency;
 }
 
+void TemplateWaveformProcessor::setPrecision(filter::Precision precision) {
+  if (precision == this->precision()) {
+    return;
+  }
+
+  if (precision == filter::Precision::kSingle) {
+    _crossCorrelationSingle =
+        util::make_unique<filter::CrossCorrelation<float>>(
+            _crossCorrelation.templateWaveform());
+  } else {
+    _crossCorrelationSingle.reset();
+    _samplesSingle.clear();
+  }
+  setupLocalMaxima();
+  reset();
+}
+
+filter::Precision TemplateWaveformProcessor::precision() const {
+  return _crossCorrelationSingle ? filter::Precision::kSingle
+                                 : filter::Precision::kDouble;
+}
+
+void TemplateWaveformProcessor::selectCorrelationEngine() {
+  // the template waveform size w.r.t. the sampling frequency the data is
+  // cross-correlated with
+  auto templateSize{templateWaveform().size()};
+  if (_targetSamplingFrequency &&
+      *_targetSamplingFrequency != templateWaveform().samplingFrequency()) {
+    TemplateWaveform resampled{templateWaveform()};
+    resampled.setSamplingFrequency(*_targetSamplingFrequency);
+    templateSize = resampled.size();
+  }
+
+  _correlationEngine = CorrelationEngineTuner::Instance().select(
+      precision(), templateSize, settings::kCorrelationEngineTuneRecordSize);
+}
+
+const boost::optional<CorrelationEngineConfig> &
+TemplateWaveformProcessor::correlationEngine() const {
+  return _correlationEngine;
+}
+
+void TemplateWaveformProcessor::setCoarseSearch(std::size_t decimationFactor,
+                                                double threshold) {
+  if (decimationFactor < 2) {
+    _coarseSearch.reset();
+  } else {
+    _coarseSearch = util::make_unique<filter::CoarseSearch>(
+        _crossCorrelation.templateWaveform(), decimationFactor, threshold);
+  }
+  setupLocalMaxima();
+  reset();
+}
+
+const filter::CoarseSearch *TemplateWaveformProcessor::coarseSearch() const {
+  return _coarseSearch.get();
+}
+
+void TemplateWaveformProcessor::setLocalMaximaThreshold(
+    const boost::optional<double> &threshold) {
+  _localMaximaThreshold = threshold;
+  setupLocalMaxima();
+}
+
+const boost::optional<double> &
+TemplateWaveformProcessor::localMaximaThreshold() const {
+  return _localMaximaThreshold;
+}
+
 const TemplateWaveform &TemplateWaveformProcessor::templateWaveform() const {
+  if (_templateBank) {
+    return _templateBank->templateWaveform(_templateBankIdx);
+  }
+  if (_crossCorrelationSingle) {
+    return _crossCorrelationSingle->templateWaveform();
+  }
   return _crossCorrelation.templateWaveform();
 }
 
@@ -111,9 +209,52 @@ void TemplateWaveformProcessor::process(StreamState &streamState,
         record->startTime() + Core::TimeSpan{record->timeWindow().length() * t};
   }
 
-  detail::LocalMaxima maxima;
-  for (auto i{static_cast<size_t>(startIdx)}; i < n; ++i) {
-    maxima.feed(filteredData[i], i);
+  if (_coefficientsCallback) {
+    if (enabled()) {
+      _coefficientsCallback(
+          this, record,
+          Coefficients{start, streamState.samplingFrequency,
+                       filteredData.typedData() + startIdx, n - startIdx});
+    }
+    return;
+  }
+
+  filter::LocalMaxima maxima;
+  if (_localMaximaThreshold) {
+    maxima.threshold = *_localMaximaThreshold;
+  }
+
+  if (_coarseSearch && !_templateBank) {
+    // the coefficients are computed for the lags selected by the coarse
+    // search, exclusively; thus, local maxima are searched for within these
+    // lag ranges, only
+    for (const auto &lagRange : _coarseSearch->lagRanges()) {
+      filter::LocalMaxima lagRangeMaxima;
+      lagRangeMaxima.threshold = maxima.threshold;
+      for (auto i{std::max(static_cast<size_t>(startIdx), lagRange.first)};
+           i < lagRange.second; ++i) {
+        lagRangeMaxima.feed(filteredData[i], i);
+      }
+      maxima.values.insert(maxima.values.end(), lagRangeMaxima.values.begin(),
+                           lagRangeMaxima.values.end());
+    }
+  } else if (!_templateBank && _streamState.initialized) {
+    // the local maxima were detected while cross-correlating
+    const auto &detected{_crossCorrelationSingle
+                             ? _crossCorrelationSingle->localMaxima()
+                             : _crossCorrelation.localMaxima()};
+    for (const auto &m : detected) {
+      if (m.lagIdx >= static_cast<size_t>(startIdx)) {
+        maxima.values.push_back(m);
+      }
+    }
+  } else {
+    // with regard to the first record processed the local maxima detected while
+    // cross-correlating depend on the coefficients preceding `startIdx`; hence,
+    // start searching from scratch at `startIdx`
+    for (auto i{static_cast<size_t>(startIdx)}; i < n; ++i) {
+      maxima.feed(filteredData[i], i);
+    }
   }
 
   if (maxima.values.empty()) {
@@ -148,8 +289,7 @@ bool TemplateWaveformProcessor::fill(processing::StreamState &streamState,
                                      const Record *record,
                                      DoubleArrayPtr &data) {
   if (WaveformProcessor::fill(streamState, record, data)) {
-    // cross-correlate filtered data
-    _crossCorrelation.apply(data->size(), data->typedData());
+    crossCorrelate(static_cast<std::size_t>(data->size()), data->typedData());
     return true;
   }
   return false;
@@ -175,7 +315,171 @@ void TemplateWaveformProcessor::setupStream(StreamState &streamState,
     }
   }
 
-  _crossCorrelation.setSamplingFrequency(_targetSamplingFrequency.value_or(f));
+  setupCrossCorrelation(streamState, record);
+}
+
+void TemplateWaveformProcessor::setupCrossCorrelation(
+    const StreamState &streamState, const Record *record) {
+  const auto f{streamState.samplingFrequency};
+  if (_crossCorrelationSingle) {
+    _crossCorrelationSingle->setSamplingFrequency(f);
+  } else {
+    _crossCorrelation.setSamplingFrequency(f);
+  }
+
+  // look up the cross-correlation engine w.r.t. the (resampled) record size;
+  // the engines are selected when setting up the processor (see
+  // `selectCorrelationEngine()`)
+  const auto recordSize{static_cast<std::size_t>(
+      std::lround(record->sampleCount() * f / record->samplingFrequency()))};
+  const auto engineConfig{CorrelationEngineTuner::Instance().lookup(
+      precision(), templateWaveform().size(), recordSize)};
+  if (engineConfig) {
+    SCDETECT_LOG_DEBUG_PROCESSOR(this, "Cross-correlation engine: %s",
+                                 to_string(*engineConfig).c_str());
+    if (_crossCorrelationSingle) {
+      _crossCorrelationSingle->setEngine(engineConfig->engine);
+      _crossCorrelationSingle->setInstructionSet(
+          engineConfig->instructionSet);
+    } else {
+      _crossCorrelation.setEngine(engineConfig->engine);
+      _crossCorrelation.setInstructionSet(engineConfig->instructionSet);
+    }
+  }
+
+  if (_coarseSearch) {
+    _coarseSearch->setSamplingFrequency(f);
+    if (!_coarseSearch->enabled()) {
+      SCDETECT_LOG_DEBUG_PROCESSOR(
+          this,
+          "Coarse-to-fine search disabled: template waveform too short "
+          "(decimation_factor=%lu)",
+          _coarseSearch->decimationFactor());
+    }
+  }
+}
+
+void TemplateWaveformProcessor::crossCorrelate(std::size_t n,
+                                               double *samples) {
+  if (_coarseSearch) {
+    // search before the data is cross-correlated in place
+    _coarseSearch->search(n, samples);
+  }
+
+  if (_crossCorrelationSingle) {
+    _samplesSingle.assign(samples, samples + n);
+    if (_coarseSearch) {
+      _crossCorrelationSingle->apply(n, _samplesSingle.data(),
+                                     _coarseSearch->lagRanges());
+    } else {
+      _crossCorrelationSingle->apply(_samplesSingle);
+    }
+    std::copy(_samplesSingle.begin(), _samplesSingle.end(), samples);
+  } else if (_coarseSearch) {
+    _crossCorrelation.apply(n, samples, _coarseSearch->lagRanges());
+  } else {
+    _crossCorrelation.apply(n, samples);
+  }
+}
+
+void TemplateWaveformProcessor::processCorrelated(
+    const StreamState &streamState, const Record *record,
+    const DoubleArray &coefficients) {
+  // the stream state is maintained by the template bank
+  adoptStreamState(streamState);
+
+  process(_streamState, record, coefficients);
+}
+
+bool TemplateWaveformProcessor::feedPreprocessed(const Record *record) {
+  if (finished()) {
+    return false;
+  }
+
+  try {
+    for (const auto &chunk : _preprocessingChain->preprocessed(record)) {
+      // the processor keeps track of its initialization by itself, i.e. a
+      // processor reset while the chain keeps on preprocessing is initialized,
+      // again
+      if (chunk.setup || !_streamState.lastRecord) {
+        setupPreprocessed(chunk.samplingFrequency, chunk.record.get());
+      } else {
+        _streamState.dataTimeWindow.setEndTime(chunk.record->endTime());
+      }
+
+      processPreprocessed(chunk.record.get(), *chunk.data);
+      if (finished()) {
+        return false;
+      }
+
+      _streamState.lastRecord = chunk.record;
+    }
+  } catch (std::exception &e) {
+    SCDETECT_LOG_WARNING_PROCESSOR(
+        this, "%s: failed to process preprocessed data: %s",
+        record->streamID().c_str(), e.what());
+    return false;
+  }
+  return true;
+}
+
+void TemplateWaveformProcessor::setupPreprocessed(double f,
+                                                  const Record *record) {
+  SCDETECT_LOG_DEBUG_PROCESSOR(
+      this, "Initialize stream (preprocessed): sampling_frequency=%f", f);
+
+  WaveformProcessor::reset(_streamState);
+  _streamState.samplingFrequency = f;
+  _streamState.neededSamples = std::lround(_initTime * f);
+  _streamState.dataTimeWindow = record->timeWindow();
+
+  // previously correlated data must not be taken into account
+  _crossCorrelation.reset();
+  if (_crossCorrelationSingle) {
+    _crossCorrelationSingle->reset();
+  }
+  if (_coarseSearch) {
+    _coarseSearch->reset();
+  }
+
+  setupCrossCorrelation(_streamState, record);
+}
+
+void TemplateWaveformProcessor::processPreprocessed(
+    const Record *record, const DoubleArray &filteredData) {
+  // the preprocessed data is shared with other subscribers; thus,
+  // cross-correlate a copy in place
+  _preprocessedData.setData(filteredData.size(), filteredData.typedData());
+  crossCorrelate(static_cast<std::size_t>(_preprocessedData.size()),
+                 _preprocessedData.typedData());
+
+  _streamState.receivedSamples +=
+      static_cast<std::size_t>(_preprocessedData.size());
+  processIfEnoughDataReceived(_streamState, record, _preprocessedData);
+}
+
+void TemplateWaveformProcessor::adoptStreamState(
+    const StreamState &streamState) {
+  _streamState.dataTimeWindow = streamState.dataTimeWindow;
+  _streamState.samplingFrequency = streamState.samplingFrequency;
+  _streamState.receivedSamples = streamState.receivedSamples;
+  _streamState.neededSamples = streamState.neededSamples;
+  _streamState.initialized = streamState.initialized;
+}
+
+void TemplateWaveformProcessor::setupLocalMaxima() {
+  // if the coefficients are published or the coarse-to-fine search is enabled,
+  // the local maxima are searched for by the processor itself
+  boost::optional<double> threshold;
+  if (!_coefficientsCallback && !_coarseSearch) {
+    threshold = _localMaximaThreshold.value_or(
+        std::numeric_limits<double>::lowest());
+  }
+
+  _crossCorrelation.setLocalMaximaThreshold(threshold);
+  if (_crossCorrelationSingle) {
+    _crossCorrelationSingle->setLocalMaximaThreshold(threshold);
+  }
 }
 
 void TemplateWaveformProcessor::emitResult(
@@ -11,7 +11,10 @@
 #include <string>
 #include <vector>
 
+#include "../correlation_engine_tuner.h"
+#include "../filter/coarse_search.h"
 #include "../filter/crosscorrelation.h"
+#include "../filter/local_maxima.h"
 #include "../processing/waveform_processor.h"
 #include "../template_waveform.h"
 
@@ -19,29 +22,18 @@ namespace Seiscomp {
 namespace detect {
 namespace detector {
 
-namespace detail {
-
-struct LocalMaxima {
-  struct Value {
-    double coefficient;
-    size_t lagIdx;
-  };
-
-  using Values = std::vector<Value>;
-  Values values;
-
-  double prevCoefficient{-1};
-  bool notDecreasing{false};
-
-  void feed(double coefficient, std::size_t lagIdx);
-};
-
-}  // namespace detail
+class PreprocessingChain;
+class TemplateBank;
 
 // Template waveform processor implementation
 //
 // - implements resampling and filtering
 // - applies the cross-correlation algorithm
+// - if added to a `TemplateBank`, both filtering and the cross-correlation
+// are delegated to the template bank
+// - if subscribed to a `PreprocessingChain`, filtering and resampling are
+// delegated to the preprocessing chain; the data preprocessed is still
+// cross-correlated by the processor itself
 class TemplateWaveformProcessor : public processing::WaveformProcessor {
  public:
   // Creates a `TemplateWaveformProcessor`. Waveform related parameters are
@@ -64,17 +56,49 @@ class TemplateWaveformProcessor : public processing::WaveformProcessor {
       std::function<void(const TemplateWaveformProcessor *, const Record *,
                          std::unique_ptr<const MatchResult>)>;
 
+  // The cross-correlation coefficients computed w.r.t. a chunk of data
+  struct Coefficients {
+    // The time of the data sample the first coefficient refers to (i.e. the
+    // data sample the template waveform's last sample is aligned with)
+    Core::Time startTime;
+    double samplingFrequency;
+
+    const double *data;
+    std::size_t size;
+  };
+  using PublishCoefficientsCallback =
+      std::function<void(const TemplateWaveformProcessor *, const Record *,
+                         const Coefficients &)>;
+
   // Sets `filter` with the corresponding filter `initTime`
   void setFilter(std::unique_ptr<Filter> filter,
                  const Core::TimeSpan &initTime = Core::TimeSpan{0.0});
+  // Sets the filter identified by `filterId` with the corresponding filter
+  // `initTime`
+  void setFilter(const std::string &filterId,
+                 const Core::TimeSpan &initTime = Core::TimeSpan{0.0});
   // Returns the configured filter or `nullptr` if no filter has been configured
-  const Filter *filter() const;
+  virtual const Filter *filter() const;
+  // Returns the identifier of the configured filter. Returns an empty string
+  // if no filter has been configured by means of its identifier.
+  const std::string &filterId() const;
 
   // Sets the `callback` in order to publish detections
   void setResultCallback(const PublishMatchResultCallback &callback);
+  // Sets the `callback` in order to publish the cross-correlation
+  // coefficients. If set, the processor publishes the coefficients instead of
+  // searching for local maxima and publishing match results.
+  void setCoefficientsCallback(const PublishCoefficientsCallback &callback);
 
   // Returns the time window processed and correlated
-  const Core::TimeWindow &processed() const;
+  virtual const Core::TimeWindow &processed() const;
+
+  // Feeds `record` to the processor. If the processor is a member of a
+  // template bank, the record is processed by means of the template bank,
+  // instead. If subscribed to a preprocessing chain, the data preprocessed by
+  // the chain w.r.t. `record` is cross-correlated (i.e. the chain must have
+  // been fed with `record`, before).
+  bool feed(const Record *record) override;
 
   void reset() override;
 
@@ -84,8 +108,60 @@ class TemplateWaveformProcessor : public processing::WaveformProcessor {
   void setTargetSamplingFrequency(double f);
   boost::optional<double> targetSamplingFrequency() const;
 
+  // Sets the floating point `precision` the cross-correlation is computed
+  // with
+  //
+  // - if the precision changes, the processor is reset
+  // - template banks cross-correlate in double precision; thus, processors
+  // computing the cross-correlation in single precision are not added to
+  // template banks (see `TemplateBank::incompatibility()`)
+  void setPrecision(filter::Precision precision);
+  // Returns the floating point precision the cross-correlation is computed
+  // with
+  filter::Precision precision() const;
+
+  // Selects the cross-correlation engine by means of the
+  // `CorrelationEngineTuner` w.r.t. both the precision and the target sampling
+  // frequency configured. Since selecting the engine might require
+  // benchmarking the candidate engines, it must be called when setting up the
+  // processor i.e. before feeding records. While processing, the engine
+  // selected w.r.t. the nearest record size bucket is used.
+  //
+  // - template banks cross-correlate by means of the time domain engine;
+  // thus, processors the frequency domain engine is selected for are not
+  // added to template banks (see `TemplateBank::incompatibility()`)
+  void selectCorrelationEngine();
+  // Returns the cross-correlation engine configuration selected by means of
+  // `selectCorrelationEngine()` (if any)
+  const boost::optional<CorrelationEngineConfig> &correlationEngine() const;
+
+  // Enables the coarse-to-fine search, i.e. the cross-correlation is computed
+  // at full rate exclusively for those lags for which the coarse (i.e.
+  // decimated by `decimationFactor`) correlation coefficient is greater or
+  // equal to `threshold`
+  //
+  // - a `decimationFactor` less than 2 disables the coarse-to-fine search
+  // - the processor is reset
+  // - template banks do not implement the coarse-to-fine search; thus,
+  // processors with the coarse-to-fine search enabled are not added to
+  // template banks (see `TemplateBank::incompatibility()`)
+  void setCoarseSearch(std::size_t decimationFactor, double threshold);
+  // Returns the coarse search (if enabled, else `nullptr`)
+  const filter::CoarseSearch *coarseSearch() const;
+
+  // Sets the floor of the local maxima published, i.e. local maxima less
+  // than `threshold` are not part of the match results published. If
+  // `boost::none`, all local maxima are published.
+  //
+  // - unless the processor is a member of a template bank or the
+  // coarse-to-fine search is enabled, the local maxima are detected while
+  // computing the correlation coefficients
+  void setLocalMaximaThreshold(const boost::optional<double> &threshold);
+  // Returns the floor of the local maxima published (if any)
+  const boost::optional<double> &localMaximaThreshold() const;
+
   // Returns the underlying template waveform
-  const TemplateWaveform &templateWaveform() const;
+  virtual const TemplateWaveform &templateWaveform() const;
 
  protected:
   WaveformProcessor::StreamState *streamState(const Record *record) override;
@@ -104,14 +180,67 @@ class TemplateWaveformProcessor : public processing::WaveformProcessor {
                   std::unique_ptr<const MatchResult> result);
 
  private:
+  friend class PreprocessingChain;
+  friend class TemplateBank;
+
+  // Processes the cross-correlation `coefficients` computed by a template bank
+  // w.r.t. the template bank's `streamState`
+  void processCorrelated(const StreamState &streamState, const Record *record,
+                         const DoubleArray &coefficients);
+  // Feeds the data preprocessed by the preprocessing chain w.r.t. `record`
+  bool feedPreprocessed(const Record *record);
+  // (Re-)initializes the processor's stream w.r.t. the data preprocessed by
+  // a preprocessing chain with the sampling frequency `f`
+  void setupPreprocessed(double f, const Record *record);
+  // Cross-correlates and processes the `filteredData` preprocessed by a
+  // preprocessing chain
+  void processPreprocessed(const Record *record,
+                           const DoubleArray &filteredData);
+  // Adopts the `streamState` maintained by a template bank
+  void adoptStreamState(const StreamState &streamState);
+
+  // Sets up the cross-correlation filters (and the coarse search) w.r.t. the
+  // (resampled) `streamState`
+  void setupCrossCorrelation(const StreamState &streamState,
+                             const Record *record);
+  // Cross-correlates `samples` in place
+  void crossCorrelate(std::size_t n, double *samples);
+
+  // Configures the local maxima detection of the cross-correlation filters
+  void setupLocalMaxima();
+
   StreamState _streamState;
+  // The identifier of the configured filter (if any)
+  std::string _filterId;
 
   PublishMatchResultCallback _resultCallback;
+  PublishCoefficientsCallback _coefficientsCallback;
 
   // The optional target sampling frequency (used for on-the-fly resampling)
   boost::optional<double> _targetSamplingFrequency;
   // The in-place cross-correlation filter
   filter::CrossCorrelation<double> _crossCorrelation;
+  // The in-place cross-correlation filter used if the cross-correlation is
+  // computed in single precision (else `nullptr`)
+  std::unique_ptr<filter::CrossCorrelation<float>> _crossCorrelationSingle;
+  // Scratch buffer for the data converted to single precision
+  std::vector<float> _samplesSingle;
+  // The cross-correlation engine configuration selected (if any)
+  boost::optional<CorrelationEngineConfig> _correlationEngine;
+  // The coarse search (if the coarse-to-fine search is enabled)
+  std::unique_ptr<filter::CoarseSearch> _coarseSearch;
+  // The floor of the local maxima published (if any)
+  boost::optional<double> _localMaximaThreshold;
+
+  // The template bank the cross-correlation is delegated to (if any)
+  TemplateBank *_templateBank{nullptr};
+  // The member index w.r.t. `_templateBank`
+  std::size_t _templateBankIdx{0};
+
+  // The preprocessing chain filtering and resampling is delegated to (if any)
+  PreprocessingChain *_preprocessingChain{nullptr};
+  // Scratch buffer for the data preprocessed by `_preprocessingChain`
+  DoubleArray _preprocessedData;
 };
 
 }  // namespace detector
@@ -0,0 +1,295 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include "../log.h"
+#include "../settings.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+namespace {
+
+// The worker the current thread corresponds to (if any)
+thread_local bool isWorkerThread{false};
+// The sequence number of the record currently processed by the worker
+thread_local std::size_t currentRecordSequence{0};
+// The position of the detector currently executed by the worker
+thread_local std::size_t currentPosition{0};
+// The sequence number of the next detection emitted by the worker
+thread_local std::size_t currentSequence{0};
+
+}  // namespace
+
+void feed(processing::WaveformProcessor &detector, const Record *record) {
+  if (!detector.enabled()) {
+    logging::TaggedMessage msg{
+        record->streamID(), "Skip feeding record to detector (id=" +
+                                detector.id() + "). Reason: Disabled."};
+    SCDETECT_LOG_WARNING("%s", logging::to_string(msg).c_str());
+    return;
+  }
+
+  if (!detector.feed(record)) {
+    logging::TaggedMessage msg{record->streamID(),
+                               "Failed to feed record into detector (" +
+                                   detector.id() + "). Resetting."};
+    SCDETECT_LOG_WARNING("%s", logging::to_string(msg).c_str());
+    detector.reset();
+  }
+}
+
+WorkerPool::Worker::Worker()
+    : queue{settings::kDetectorWorkerQueueCapacity} {}
+
+WorkerPool::WorkerPool(std::size_t numWorkers) {
+  assert((numWorkers > 0));
+  for (std::size_t i{0}; i < numWorkers; ++i) {
+    _workers.emplace_back(new Worker{});
+  }
+}
+
+WorkerPool::~WorkerPool() { stop(); }
+
+void WorkerPool::start() {
+  if (!_stopped) {
+    return;
+  }
+
+  _stopped = false;
+  for (auto &worker : _workers) {
+    auto *w{worker.get()};
+    worker->thread = std::thread{[this, w]() { run(*w); }};
+  }
+}
+
+void WorkerPool::stop() {
+  if (_stopped) {
+    return;
+  }
+
+  wait();
+
+  _stopped = true;
+  for (auto &worker : _workers) {
+    {
+      std::lock_guard<std::mutex> lock{worker->mutex};
+    }
+    worker->cv.notify_one();
+  }
+  for (auto &worker : _workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+WorkerPool::Results WorkerPool::feed(const Record *record) {
+  auto it{_streams.find(record->streamID())};
+  if (it == _streams.end()) {
+    return release();
+  }
+
+  InFlight inFlight{record, {}};
+  const auto sequence{_sequence + _inFlight.size()};
+  for (auto *worker : it->second) {
+    Task task{record, sequence, &worker->streams.at(it->first)};
+    _pending.fetch_add(1, std::memory_order_acq_rel);
+    while (!worker->queue.tryPush(task)) {
+      std::this_thread::yield();
+    }
+    inFlight.tasks.emplace_back(worker, worker->pushed++);
+    {
+      std::lock_guard<std::mutex> lock{worker->mutex};
+    }
+    worker->cv.notify_one();
+  }
+  _inFlight.push_back(std::move(inFlight));
+
+  return release();
+}
+
+WorkerPool::Results WorkerPool::flush() {
+  wait();
+  return release();
+}
+
+bool WorkerPool::collect(
+    const Detector *detector, const Record *record,
+    std::unique_ptr<const Detector::Detection> &detection) {
+  if (!isWorkerThread) {
+    return false;
+  }
+
+  Collected c;
+  c.key = std::make_tuple(currentRecordSequence, currentPosition,
+                          currentSequence++);
+  c.detector = detector;
+  c.record = record;
+  c.detection = std::move(detection);
+  _results.push(std::move(c));
+  return true;
+}
+
+std::size_t WorkerPool::size() const { return _workers.size(); }
+
+std::size_t WorkerPool::detectors(std::size_t idx) const {
+  return _workers.at(idx)->numDetectors;
+}
+
+std::size_t WorkerPool::computeLoad(const Detector &detector) {
+  // the load corresponds to the number of template waveform processors
+  return static_cast<std::size_t>(std::max<std::ptrdiff_t>(
+      1, std::distance(detector.begin(), detector.end())));
+}
+
+std::size_t WorkerPool::assign(std::size_t load) {
+  auto it{std::min_element(std::begin(_workers), std::end(_workers),
+                           [](const std::unique_ptr<Worker> &lhs,
+                              const std::unique_ptr<Worker> &rhs) {
+                             return lhs->load < rhs->load;
+                           })};
+  (*it)->load += load;
+  ++(*it)->numDetectors;
+  return static_cast<std::size_t>(std::distance(std::begin(_workers), it));
+}
+
+void WorkerPool::add(std::size_t workerIdx, const std::string &streamId,
+                     std::size_t position,
+                     processing::WaveformProcessor *detector) {
+  assert(detector);
+  auto *worker{_workers.at(workerIdx).get()};
+  auto &entries{worker->streams[streamId]};
+  if (entries.empty()) {
+    _streams[streamId].push_back(worker);
+  }
+  entries.push_back({position, detector});
+}
+
+void WorkerPool::run(Worker &worker) {
+  isWorkerThread = true;
+
+  Task task;
+  while (true) {
+    bool popped{false};
+    for (std::size_t i{0}; i < settings::kDetectorWorkerSpinCount; ++i) {
+      if ((popped = worker.queue.tryPop(task))) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+
+    if (!popped) {
+      std::unique_lock<std::mutex> lock{worker.mutex};
+      worker.cv.wait(lock, [this, &worker]() {
+        return !worker.queue.empty() || _stopped;
+      });
+      if (worker.queue.empty()) {
+        // stopped
+        return;
+      }
+      continue;
+    }
+
+    process(task);
+
+    worker.processed.fetch_add(1, std::memory_order_release);
+    if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      {
+        std::lock_guard<std::mutex> lock{_mutex};
+      }
+      _cv.notify_one();
+    }
+  }
+}
+
+void WorkerPool::process(const Task &task) {
+  currentRecordSequence = task.sequence;
+  currentSequence = 0;
+  for (const auto &entry : *task.entries) {
+    currentPosition = entry.position;
+    try {
+      detector::feed(*entry.detector, task.record);
+    } catch (std::exception &e) {
+      SCDETECT_LOG_ERROR("%s: failed to feed record into detector (%s): %s",
+                         task.record->streamID().c_str(),
+                         entry.detector->id().c_str(), e.what());
+      entry.detector->reset();
+    }
+  }
+}
+
+WorkerPool::Results WorkerPool::release() {
+  // the records processed completely (i.e. by all workers involved)
+  std::size_t numCompleted{0};
+  for (const auto &inFlight : _inFlight) {
+    const auto completed{std::all_of(
+        std::begin(inFlight.tasks), std::end(inFlight.tasks),
+        [](const std::pair<Worker *, std::size_t> &task) {
+          return task.first->processed.load(std::memory_order_acquire) >
+                 task.second;
+        })};
+    if (!completed) {
+      break;
+    }
+    ++numCompleted;
+  }
+
+  Collected c;
+  while (_results.tryPop(c)) {
+    _collected.push_back(std::move(c));
+  }
+
+  // merge the detections of the records completed back in a deterministic
+  // order; the detections of records still in flight are kept
+  const auto sequence{_sequence + numCompleted};
+  auto it{std::stable_partition(std::begin(_collected), std::end(_collected),
+                                [sequence](const Collected &collected) {
+                                  return std::get<0>(collected.key) <
+                                         sequence;
+                                })};
+  std::sort(std::begin(_collected), it,
+            [](const Collected &lhs, const Collected &rhs) {
+              return lhs.key < rhs.key;
+            });
+
+  Results ret;
+  ret.reserve(static_cast<std::size_t>(std::distance(std::begin(_collected),
+                                                     it)));
+  for (auto cit = std::begin(_collected); cit != it; ++cit) {
+    ret.push_back({cit->detector, cit->record, std::move(cit->detection)});
+  }
+  _collected.erase(std::begin(_collected), it);
+
+  // release the records completed
+  for (std::size_t i{0}; i < numCompleted; ++i) {
+    _inFlight.pop_front();
+  }
+  _sequence = sequence;
+  return ret;
+}
+
+void WorkerPool::wait() {
+  for (std::size_t i{0}; i < settings::kDetectorWorkerSpinCount; ++i) {
+    if (_pending.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+
+  std::unique_lock<std::mutex> lock{_mutex};
+  _cv.wait(lock, [this]() {
+    return _pending.load(std::memory_order_acquire) == 0;
+  });
+}
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,245 @@
+#ifndef SCDETECT_APPS_CC_DETECTOR_WORKERPOOL_H_
+#define SCDETECT_APPS_CC_DETECTOR_WORKERPOOL_H_
+
+#include <seiscomp/core/record.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../processing/waveform_processor.h"
+#include "../util/concurrent_queue.h"
+#include "detector.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace detector {
+
+// Feeds `record` to `detector`. If feeding fails, the detector is reset.
+// Records are not fed to disabled detectors.
+void feed(processing::WaveformProcessor &detector, const Record *record);
+
+// Executes detectors by means of a pool of worker threads
+//
+// - detectors are partitioned across the workers, i.e. each detector is
+// executed by exactly one worker (the partitioning takes the number of
+// template waveform processors per detector into account)
+// - records are dispatched to the workers executing detectors for the
+// record's stream by means of lock-free SPSC queues; thus, each detector
+// processes the records in the order they were fed
+// - `feed()` does not wait for the workers, i.e. the workers process the
+// records fed (of both the same and different streams) concurrently while
+// further records are dispatched. Blocks only if the queue of a worker
+// involved is full (backpressure).
+// - detections emitted by the detectors while being executed by workers are
+// collected by means of a lock-free MPSC queue. They are merged
+// asynchronously, i.e. `feed()` returns the detections of the records
+// processed completely so far, and `flush()` waits for the remaining ones.
+// Detections are returned in the order they would be emitted if the
+// detectors were fed sequentially (i.e. the results are identical to the
+// single-threaded execution).
+// - the pool keeps the records fed alive until processed
+class WorkerPool {
+ public:
+  struct Result {
+    const Detector *detector{nullptr};
+    RecordCPtr record;
+    std::unique_ptr<const Detector::Detection> detection;
+  };
+  using Results = std::vector<Result>;
+
+  explicit WorkerPool(std::size_t numWorkers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // Registers the `detectors` where `detectorIdx` maps stream identifiers to
+  // the index of the detectors (w.r.t. `detectors`) processing the stream
+  //
+  // - must be called before `start()`
+  // - the order of the detectors w.r.t. a stream is taken from `detectorIdx`
+  // - the pool does not take ownership; the detectors must outlive the pool
+  template <typename TDetectors, typename TDetectorIdx>
+  void add(const TDetectors &detectors, const TDetectorIdx &detectorIdx);
+  // Registers `detector` processing the streams identified by `streamIds`
+  // (in addition to the detectors registered so far)
+  //
+  // - must not be called while records are in flight (i.e. call `flush()`
+  // before)
+  // - w.r.t. a stream, the detector is executed after the detectors
+  // registered before
+  // - the pool does not take ownership; `detector` must outlive the pool
+  template <typename TStreamIds>
+  void add(Detector *detector, const TStreamIds &streamIds);
+  // Registers the waveform `processor` processing the streams identified by
+  // `streamIds` where `load` refers to the processor's relative cost
+  //
+  // - same as registering a detector, otherwise
+  template <typename TStreamIds>
+  void add(processing::WaveformProcessor *processor,
+           const TStreamIds &streamIds, std::size_t load);
+
+  // Starts the workers
+  void start();
+  // Waits for the records in flight and stops the workers (blocks until the
+  // workers are joined). Detections not returned by `flush()`, before, are
+  // discarded.
+  void stop();
+
+  // Dispatches `record` to the workers executing the detectors registered for
+  // the record's stream. Returns the detections of the records (fed so far)
+  // processed completely, i.e. without waiting for `record` being processed.
+  Results feed(const Record *record);
+  // Blocks until all records fed are processed and returns the remaining
+  // detections
+  Results flush();
+
+  // Collects the `detection` emitted by `detector` while processing `record`
+  // if called on a worker thread (in that case ownership is transferred and
+  // `true` is returned); otherwise, `false` is returned.
+  bool collect(const Detector *detector, const Record *record,
+               std::unique_ptr<const Detector::Detection> &detection);
+
+  // Returns the number of workers
+  std::size_t size() const;
+  // Returns the number of detectors executed by the worker `idx`
+  std::size_t detectors(std::size_t idx) const;
+
+ private:
+  // A detector registered w.r.t. a stream
+  struct Entry {
+    // The position of the detector w.r.t. the stream's detectors
+    std::size_t position;
+    processing::WaveformProcessor *detector;
+  };
+
+  struct Task {
+    const Record *record{nullptr};
+    // The sequence number of the record
+    std::size_t sequence{0};
+    const std::vector<Entry> *entries{nullptr};
+  };
+
+  struct Worker {
+    Worker();
+
+    util::SpscQueue<Task> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread thread;
+
+    // The number of tasks pushed to the queue (modified by the thread
+    // feeding records)
+    std::size_t pushed{0};
+    // The number of tasks processed (modified by the worker)
+    std::atomic<std::size_t> processed{0};
+
+    // The detectors to be executed per stream
+    std::unordered_map<std::string, std::vector<Entry>> streams;
+    std::size_t numDetectors{0};
+    std::size_t load{0};
+  };
+
+  // A record in flight, i.e. not processed completely, yet
+  struct InFlight {
+    RecordCPtr record;
+    // The workers involved and the index of the corresponding task w.r.t.
+    // the tasks pushed to the worker's queue
+    std::vector<std::pair<Worker *, std::size_t>> tasks;
+  };
+
+  struct Collected {
+    // The sort key (i.e. the record's sequence number, the detector's
+    // position and the emission sequence number)
+    std::tuple<std::size_t, std::size_t, std::size_t> key;
+    const Detector *detector{nullptr};
+    const Record *record{nullptr};
+    std::unique_ptr<const Detector::Detection> detection;
+  };
+
+  static std::size_t computeLoad(const Detector &detector);
+
+  // Assigns a detector with `load` to the least loaded worker
+  std::size_t assign(std::size_t load);
+  void add(std::size_t workerIdx, const std::string &streamId,
+           std::size_t position, processing::WaveformProcessor *detector);
+
+  void run(Worker &worker);
+  void process(const Task &task);
+  // Returns the detections of the records in flight processed completely
+  Results release();
+  // Blocks until all records fed are processed
+  void wait();
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  // The workers involved per stream
+  std::unordered_map<std::string, std::vector<Worker *>> _streams;
+  // The number of detectors registered per stream
+  std::unordered_map<std::string, std::size_t> _positions;
+
+  // The records in flight (ordered by sequence number)
+  std::deque<InFlight> _inFlight;
+  // The sequence number of the first record in flight
+  std::size_t _sequence{0};
+
+  util::MpscQueue<Collected> _results;
+  // The detections collected, but not released, yet
+  std::vector<Collected> _collected;
+
+  // The number of tasks pushed, but not processed, yet
+  std::atomic<std::size_t> _pending{0};
+  std::mutex _mutex;
+  std::condition_variable _cv;
+
+  std::atomic<bool> _stopped{true};
+};
+
+template <typename TDetectors, typename TDetectorIdx>
+void WorkerPool::add(const TDetectors &detectors,
+                     const TDetectorIdx &detectorIdx) {
+  // partition the detectors
+  std::vector<std::size_t> workerIdxs(detectors.size());
+  for (std::size_t i{0}; i < detectors.size(); ++i) {
+    workerIdxs[i] = assign(computeLoad(*detectors[i]));
+  }
+
+  for (const auto &pair : detectorIdx) {
+    auto &position{_positions[pair.first]};
+    add(workerIdxs[pair.second], pair.first, position,
+        detectors[pair.second].get());
+    ++position;
+  }
+}
+
+template <typename TStreamIds>
+void WorkerPool::add(Detector *detector, const TStreamIds &streamIds) {
+  add(static_cast<processing::WaveformProcessor *>(detector), streamIds,
+      computeLoad(*detector));
+}
+
+template <typename TStreamIds>
+void WorkerPool::add(processing::WaveformProcessor *processor,
+                     const TStreamIds &streamIds, std::size_t load) {
+  const auto workerIdx{assign(load)};
+  for (const auto &streamId : streamIds) {
+    auto &position{_positions[streamId]};
+    add(workerIdx, streamId, position, processor);
+    ++position;
+  }
+}
+
+}  // namespace detector
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_DETECTOR_WORKERPOOL_H_
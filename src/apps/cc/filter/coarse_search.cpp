@@ -0,0 +1,165 @@
+#include "coarse_search.h"
+
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/core/typedarray.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "../settings.h"
+#include "../util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+
+CoarseSearch::CoarseSearch(TemplateWaveform templateWaveform,
+                           std::size_t decimationFactor, double threshold)
+    : _templateWaveform{std::move(templateWaveform)},
+      _decimationFactor{decimationFactor},
+      _threshold{threshold} {
+  assert((_decimationFactor > 1));
+}
+
+const CoarseSearch::LagRanges &CoarseSearch::search(std::size_t nData,
+                                                    const double *data) {
+  _lagRanges.clear();
+  if (!enabled()) {
+    _lagRanges.emplace_back(0, nData);
+    return _lagRanges;
+  }
+
+  const auto AppendLagRange = [this](const LagRange &lagRange) {
+    if (lagRange.first >= lagRange.second) {
+      return;
+    }
+    // merge overlapping lag ranges
+    if (!_lagRanges.empty() && lagRange.first <= _lagRanges.back().second) {
+      _lagRanges.back().second =
+          std::max(_lagRanges.back().second, lagRange.second);
+    } else {
+      _lagRanges.push_back(lagRange);
+    }
+  };
+
+  // lags carried over from coarse hits close to the end of the previous chunk
+  const auto numCarriedOver{std::min(nData, _numPendingLags)};
+  AppendLagRange({0, numCarriedOver});
+  _numPendingLags -= numCarriedOver;
+
+  // decimate
+  _decimated.clear();
+  _decimatedIdx.clear();
+  for (std::size_t i = 0; i < nData; ++i) {
+    _blockSum += data[i];
+    if (++_blockSize == _decimationFactor) {
+      _decimated.push_back(_blockSum / _decimationFactor);
+      _decimatedIdx.push_back(i);
+      _blockSum = 0;
+      _blockSize = 0;
+    }
+  }
+
+  if (!_decimated.empty()) {
+    _crossCorrelation->apply(_decimated);
+  }
+
+  // select the lags to be refined
+  const auto margin{settings::kCoarseSearchRefinementMargin *
+                    _decimationFactor};
+  for (std::size_t j = 0; j < _decimated.size(); ++j) {
+    if (_decimated[j] < _threshold) {
+      continue;
+    }
+
+    const auto idx{_decimatedIdx[j]};
+    // lags before the chunk were either refined due to the pending lags of the
+    // previous chunk (see below) or already included in the lag ranges of the
+    // previous chunk
+    AppendLagRange({idx > margin ? idx - margin : 0,
+                    std::min(nData, idx + margin + 1)});
+    // carry lags beyond the end of the chunk over to the next chunk
+    if (idx + margin + 1 > nData) {
+      _numPendingLags = std::max(_numPendingLags, idx + margin + 1 - nData);
+    }
+  }
+
+  // the coarse correlation coefficient of the next (still incomplete) block
+  // is not known, yet, while the corresponding lag range would include lags
+  // of this chunk; refine these lags unconditionally, such that no lag is
+  // missed which would have been refined if processed within a single chunk
+  const auto nextIdx{nData - 1 + _decimationFactor - _blockSize};
+  AppendLagRange({nextIdx > margin ? nextIdx - margin : 0, nData});
+
+  return _lagRanges;
+}
+
+const CoarseSearch::LagRanges &CoarseSearch::lagRanges() const {
+  return _lagRanges;
+}
+
+void CoarseSearch::reset() {
+  if (_crossCorrelation) {
+    _crossCorrelation->reset();
+  }
+  _blockSum = 0;
+  _blockSize = 0;
+  _numPendingLags = 0;
+  _lagRanges.clear();
+}
+
+void CoarseSearch::setSamplingFrequency(double samplingFrequency) {
+  assert((samplingFrequency > 0));
+
+  _samplingFrequency = samplingFrequency;
+  _templateWaveform.setSamplingFrequency(samplingFrequency);
+  _crossCorrelation.reset();
+
+  const auto &waveform{_templateWaveform.waveform()};
+  const auto n{static_cast<std::size_t>(waveform.data()->size())};
+  const auto nDecimated{n / _decimationFactor};
+  if (nDecimated >= settings::kCoarseSearchMinDecimatedTemplateSize) {
+    // align the blocks w.r.t. the end of the template waveform (i.e. the lag
+    // the correlation coefficients are referring to)
+    const auto offset{n - nDecimated * _decimationFactor};
+    const double *samples{
+        DoubleArray::ConstCast(waveform.data())->typedData() + offset};
+    std::vector<double> decimated(nDecimated, 0);
+    for (std::size_t k = 0; k < nDecimated; ++k) {
+      for (std::size_t l = 0; l < _decimationFactor; ++l) {
+        decimated[k] += samples[k * _decimationFactor + l];
+      }
+      decimated[k] /= _decimationFactor;
+    }
+
+    auto decimatedWaveform{util::make_smart<GenericRecord>(
+        waveform.networkCode(), waveform.stationCode(),
+        waveform.locationCode(), waveform.channelCode(),
+        waveform.startTime() + Core::TimeSpan{offset / samplingFrequency},
+        samplingFrequency / _decimationFactor)};
+    decimatedWaveform->setData(static_cast<int>(nDecimated),
+                               decimated.data(), Array::DOUBLE);
+
+    _crossCorrelation =
+        util::make_unique<CrossCorrelation<double>>(decimatedWaveform);
+  }
+
+  reset();
+}
+
+double CoarseSearch::samplingFrequency() const { return _samplingFrequency; }
+
+std::size_t CoarseSearch::decimationFactor() const {
+  return _decimationFactor;
+}
+
+double CoarseSearch::threshold() const { return _threshold; }
+
+bool CoarseSearch::enabled() const {
+  return static_cast<bool>(_crossCorrelation);
+}
+
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,102 @@
+#ifndef SCDETECT_APPS_CC_FILTER_COARSESEARCH_H_
+#define SCDETECT_APPS_CC_FILTER_COARSESEARCH_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "../template_waveform.h"
+#include "crosscorrelation.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+
+// Coarse (i.e. decimated) cross-correlation search
+//
+// - cross-correlates decimated copies of both the template waveform and the
+// data; lags where the coarse correlation coefficient is greater or equal to
+// the configured threshold are selected to be refined (i.e. cross-correlated
+// at full rate)
+// - decimation is implemented by means of block averaging (i.e. a boxcar
+// anti-alias filter followed by downsampling); thus, the position of the
+// decimated samples w.r.t. the full rate data is known exactly (i.e. the
+// decimation does not introduce any delay)
+// - meant for long, band-limited template waveforms
+class CoarseSearch {
+ public:
+  using LagRange = CrossCorrelation<double>::LagRange;
+  using LagRanges = CrossCorrelation<double>::LagRanges;
+
+  // Creates a `CoarseSearch` for `templateWaveform`. The search is
+  // initialized by means of `setSamplingFrequency()`.
+  //
+  // - it is a bug if `decimationFactor` is less than 2
+  CoarseSearch(TemplateWaveform templateWaveform,
+               std::size_t decimationFactor, double threshold);
+
+  // Searches the (previously filtered) full rate `data` and returns the
+  // (sorted) lag ranges to be refined
+  //
+  // - lag ranges of coarse hits close to the end of `data` are carried over
+  // to the subsequent call; lags whose coarse correlation coefficient is not
+  // known at the end of `data`, yet, (i.e. the lags of the incomplete block
+  // including the refinement margin) are refined unconditionally. Thus, lags
+  // which would be refined if the data was searched at once are refined
+  // regardless of how the data is chunked.
+  const LagRanges &search(std::size_t nData, const double *data);
+  // Returns the lag ranges to be refined computed by the most recent call to
+  // `search()`
+  const LagRanges &lagRanges() const;
+
+  // Resets the coarse search
+  void reset();
+
+  // Sets the (full rate) sampling frequency in Hz
+  void setSamplingFrequency(double samplingFrequency);
+  // Returns the configured (full rate) sampling frequency
+  double samplingFrequency() const;
+
+  // Returns the decimation factor
+  std::size_t decimationFactor() const;
+  // Returns the coarse correlation coefficient threshold
+  double threshold() const;
+  // Returns `true` if the coarse search is enabled, else `false`. The
+  // coarse search is disabled if the decimated template waveform is too
+  // short (see also `settings::kCoarseSearchMinDecimatedTemplateSize`). If
+  // disabled, all lags are refined.
+  bool enabled() const;
+
+ private:
+  // The full rate template waveform
+  TemplateWaveform _templateWaveform;
+  // The cross-correlation filter operating on the decimated samples (if
+  // enabled, else `nullptr`)
+  std::unique_ptr<CrossCorrelation<double>> _crossCorrelation;
+
+  std::size_t _decimationFactor;
+  double _threshold;
+  double _samplingFrequency{0};
+
+  // The sum of the samples of the current (incomplete) block
+  double _blockSum{0};
+  // The number of samples of the current (incomplete) block
+  std::size_t _blockSize{0};
+  // The number of lags at the beginning of the subsequent chunk of data to be
+  // refined due to coarse hits close to the end of the previous chunk
+  std::size_t _numPendingLags{0};
+
+  // Scratch buffer for the decimated samples
+  std::vector<double> _decimated;
+  // Scratch buffer for the full rate sample indices of the decimated samples
+  // (i.e. the index of the last sample of the corresponding block)
+  std::vector<std::size_t> _decimatedIdx;
+
+  LagRanges _lagRanges;
+};
+
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_COARSESEARCH_H_
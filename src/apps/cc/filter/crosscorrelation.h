@@ -5,24 +5,62 @@
 #include <seiscomp/core/genericrecord.h>
 #include <seiscomp/core/typedarray.h>
 
-#include <boost/circular_buffer.hpp>
 #include <boost/optional/optional.hpp>
+#include <complex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "../template_waveform.h"
+#include "../util/fft.h"
+#include "../util/math.h"
+#include "../util/sample_window.h"
+#include "detail/diagnostics.h"
+#include "detail/kernel.h"
+#include "local_maxima.h"
 
 namespace Seiscomp {
 namespace detect {
 namespace filter {
 
+// Floating point precision the cross-correlation is computed with
+enum class Precision {
+  // Double precision (i.e. `CrossCorrelation<double>`)
+  kDouble,
+  // Single precision (i.e. `CrossCorrelation<float>`); halves the memory
+  // traffic and doubles the SIMD width of the dot products kernel at the cost
+  // of a correlation coefficient deviation in the order of 1e-5
+  kSingle,
+};
+
+// Cross-correlation engine
+enum class CorrelationEngine {
+  // Evaluates the dot product between the template waveform and the data for
+  // each lag explicitly (by means of a vectorized kernel, if supported by the
+  // host)
+  kTimeDomain,
+  // Evaluates the dot products block-wise by means of FFT overlap-save
+  kFrequencyDomain,
+};
+
 // Cross-correlation filter implementation
 //
 // - the filter delay corresponds to the length of the template waveform
 // - automatically adopts to different sampling frequencies (i.e. implements
 // template waveform resampling facilities)
+// - `TData` refers to the precision of the samples (i.e. both the template
+// waveform and the data) the dot products are computed with; the rolling
+// statistics and the correlation coefficients are computed in double
+// precision, regardless
 template <typename TData>
 class CrossCorrelation {
  public:
+  // Range of lags `[first, second)` w.r.t. the data passed to `apply()`
+  using LagRange = std::pair<size_t, size_t>;
+  using LagRanges = std::vector<LagRange>;
+
+  using Engine = CorrelationEngine;
+
   // Creates a `CrossCorrelation` filter from `waveform`. The filter is
   // configured to the sampling frequency provided by `waveform`.
   //
@@ -40,6 +78,15 @@ class CrossCorrelation {
   void apply(std::vector<TData> &data);
 
   void apply(TypedArray<TData> &data);
+  // Apply the cross-correlation in place, however, compute the correlation
+  // coefficients for the lags within `lagRanges`, exclusively. The
+  // coefficients of the remaining lags are set to zero.
+  //
+  // - `lagRanges` must be sorted and must not overlap
+  // - if the frequency domain engine is configured, it is used for lag ranges
+  // long enough to amortize the transforms, exclusively; the dot products of
+  // short lag ranges are computed by means of the time domain engine
+  void apply(size_t nData, TData *data, const LagRanges &lagRanges);
   // Reset the cross-correlation filter
   virtual void reset();
 
@@ -51,6 +98,32 @@ class CrossCorrelation {
 
   const TemplateWaveform &templateWaveform() const;
 
+  // Forces the cross-correlation engine to be used. If not set, the engine is
+  // selected automatically based on the size of the template waveform.
+  void setEngine(const boost::optional<Engine> &engine);
+  // Returns the cross-correlation engine in use
+  Engine engine() const;
+
+  // Forces the instruction set of the dot products kernel used by the time
+  // domain engine. If not set, the most capable instruction set supported by
+  // the host is used.
+  void setInstructionSet(
+      const boost::optional<detail::InstructionSet> &instructionSet);
+  // Returns the instruction set of the dot products kernel
+  detail::InstructionSet instructionSet() const;
+
+  // Enables detecting the local maxima of the correlation coefficients while
+  // computing the coefficients (i.e. without rescanning the coefficients)
+  // where local maxima less than `threshold` are dropped. If `boost::none`,
+  // local maxima are not detected.
+  //
+  // - local maxima are detected per call to `apply()`; they are not detected
+  // if applied w.r.t. lag ranges
+  void setLocalMaximaThreshold(const boost::optional<double> &threshold);
+  // Returns the local maxima detected by the most recent call to `apply()`
+  // (where the lag indices refer to the data passed)
+  const LocalMaxima::Values &localMaxima() const;
+
  protected:
   // Compute the actual cross-correlation
   virtual void correlate(size_t nData, TData *data);
@@ -58,10 +131,36 @@ class CrossCorrelation {
   virtual void setupFilter(double samplingFrequency);
 
  private:
+  // Computes the dot products between the template waveform and `segment`
+  // for `nData` subsequent lags. `segment` must provide `n + nData - 1`
+  // samples where `n` refers to the template waveform size. The results are
+  // stored in `_dotProducts`.
+  void computeDotProducts(size_t nData, const TData *segment);
+  // Computes the dot products for the lags within `lagRanges`, exclusively
+  void computeDotProducts(size_t nData, const TData *segment,
+                          const LagRanges &lagRanges);
+  // Computes the dot products by means of FFT overlap-save and stores the
+  // results in `dotProducts`
+  void computeDotProductsFrequencyDomain(size_t nData, const TData *segment,
+                                         double *dotProducts);
+  // Computes the correlation coefficients (in place) based on the dot
+  // products previously computed. `samples` refers to the samples of the
+  // window before pushing the new samples followed by the new samples.
+  // If `maxima` is a valid pointer, the local maxima are detected, too.
+  void computeCoefficients(size_t nData, const TData *samples, TData *data,
+                           LocalMaxima *maxima = nullptr);
+  // Sets up the frequency domain engine i.e. precomputes the template
+  // waveform spectrum
+  void setupFrequencyDomain();
+  // Sets up the frequency domain engine w.r.t. a FFT of size `fftSize`
+  void setupFrequencyDomain(size_t fftSize);
+
   // The template waveform
   TemplateWaveform _templateWaveform;
-  // Buffer for data to be cross-correlated
-  boost::circular_buffer<TData> _buffer;
+  // The template waveform samples (converted to `TData`)
+  std::vector<TData> _samplesTemplateWaveform;
+  // Window of the most recent data samples to be cross-correlated
+  util::SampleWindow<TData> _window;
 
   // Template waveform samples squared summed
   double _sumSquaredTemplateWaveform{0};
@@ -70,10 +169,37 @@ class CrossCorrelation {
 
   double _denominatorTemplateWaveform{0};
 
-  // The data samples squared summed
-  double _sumSquaredData{0};
-  // The data samples summed
-  double _sumData{0};
+  // The data samples squared summed (compensated since computed in a rolling
+  // fashion)
+  util::CompensatedSum _sumSquaredData;
+  // The data samples summed (compensated since computed in a rolling fashion)
+  util::CompensatedSum _sumData;
+
+  // The engine forced to be used
+  boost::optional<Engine> _engine;
+  // The instruction set of the dot products kernel forced to be used
+  boost::optional<detail::InstructionSet> _instructionSet;
+
+  // The kernel used by the time domain engine
+  detail::DotProductsKernel<TData> _dotProductsKernel{
+      detail::dotProductsKernel<TData>()};
+
+  // The FFT used by the frequency domain engine; its size is chosen w.r.t.
+  // both the template waveform size and the length of the data
+  util::Fft _fft;
+  // The conjugated spectrum of the zero-padded template waveform
+  std::vector<std::complex<double>> _spectrumTemplateWaveform;
+  // Scratch buffer for the spectrum of the data
+  std::vector<std::complex<double>> _spectrumData;
+  // Scratch buffer for the dot products computed block-wise
+  std::vector<double> _dotProducts;
+
+  // The local maxima detected w.r.t. the most recent chunk of data
+  LocalMaxima _localMaxima;
+  bool _detectLocalMaxima{false};
+
+  // Floating point diagnostics w.r.t. the most recent chunk of data
+  detail::CorrelationDiagnostics _diagnostics;
 
   bool _initialized{false};
 };
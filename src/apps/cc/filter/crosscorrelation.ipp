@@ -4,12 +4,13 @@
 #include <seiscomp/core/strings.h>
 #include <seiscomp/core/timewindow.h>
 
-#include <boost/algorithm/string/join.hpp>
-#include <cfenv>
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 
 #include "../filter.h"
 #include "../log.h"
+#include "../settings.h"
 #include "../util/math.h"
 
 namespace Seiscomp {
@@ -47,30 +48,29 @@ void CrossCorrelation<TData>::apply(TypedArray<TData> &data) {
 
 template <typename TData>
 void CrossCorrelation<TData>::reset() {
-  _buffer.clear();
-
-  _sumSquaredData = 0;
-  _sumData = 0;
+  _sumSquaredData.reset();
+  _sumData.reset();
 
   const double *samples_template_wf{
-      TypedArray<TData>::ConstCast(_templateWaveform.waveform().data())
+      DoubleArray::ConstCast(_templateWaveform.waveform().data())
           ->typedData()};
   const int n{_templateWaveform.waveform().data()->size()};
+  _samplesTemplateWaveform.assign(samples_template_wf,
+                                  samples_template_wf + n);
   _sumTemplateWaveform = 0;
   _sumSquaredTemplateWaveform = 0;
   for (int i = 0; i < n; ++i) {
-    _sumTemplateWaveform += samples_template_wf[i];
-    _sumSquaredTemplateWaveform += util::square(samples_template_wf[i]);
+    const double sample{_samplesTemplateWaveform[i]};
+    _sumTemplateWaveform += sample;
+    _sumSquaredTemplateWaveform += util::square(sample);
   }
 
   _denominatorTemplateWaveform =
       std::sqrt(n * _sumSquaredTemplateWaveform -
                 _sumTemplateWaveform * _sumTemplateWaveform);
 
-  _buffer.set_capacity(n);
-  while (!_buffer.full()) {
-    _buffer.push_back(0);
-  }
+  _window.reset(n, 0);
+  _localMaxima.reset();
 }
 
 template <typename TData>
@@ -88,6 +88,54 @@ double CrossCorrelation<TData>::samplingFrequency() const {
   return _templateWaveform.samplingFrequency();
 }
 
+template <typename TData>
+void CrossCorrelation<TData>::setEngine(const boost::optional<Engine> &engine) {
+  _engine = engine;
+  if (_initialized) {
+    setupFrequencyDomain();
+  }
+}
+
+template <typename TData>
+typename CrossCorrelation<TData>::Engine CrossCorrelation<TData>::engine()
+    const {
+  if (_engine) {
+    return *_engine;
+  }
+
+  return _window.size() >=
+                 settings::kCrossCorrelationFrequencyDomainMinTemplateSize
+             ? Engine::kFrequencyDomain
+             : Engine::kTimeDomain;
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::setInstructionSet(
+    const boost::optional<detail::InstructionSet> &instructionSet) {
+  _instructionSet = instructionSet;
+  _dotProductsKernel = detail::dotProductsKernel<TData>(this->instructionSet());
+}
+
+template <typename TData>
+detail::InstructionSet CrossCorrelation<TData>::instructionSet() const {
+  return _instructionSet.value_or(detail::detectInstructionSet());
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::setLocalMaximaThreshold(
+    const boost::optional<double> &threshold) {
+  _detectLocalMaxima = static_cast<bool>(threshold);
+  _localMaxima = LocalMaxima{};
+  if (threshold) {
+    _localMaxima.threshold = *threshold;
+  }
+}
+
+template <typename TData>
+const LocalMaxima::Values &CrossCorrelation<TData>::localMaxima() const {
+  return _localMaxima.values;
+}
+
 template <typename TData>
 void CrossCorrelation<TData>::correlate(size_t nData, TData *data) {
   /*
@@ -116,10 +164,13 @@ void CrossCorrelation<TData>::correlate(size_t nData, TData *data) {
    *   _denominatorTemplateWaveform = \
    *     sqrt(n*_sumSquaredTemplateWaveform-(_sumTemplateWaveform)^2)
    *
-   * For the parts that involve the data trace (extracted from the circular
-   * buffer) exclusively, compute the components in a rolling fashion (removing
+   * For the parts that involve the data trace (extracted from the sample
+   * window) exclusively, compute the components in a rolling fashion (removing
    * first sample of previous iteration and adding the last sample of the
-   * current iteration):
+   * current iteration). Since the rolling sums are updated for each sample
+   * processed over the entire lifetime of the filter, they are computed by
+   * means of compensated summation (in double precision), preventing
+   * rounding errors from accumulating:
    *
    *   _sumData = sum(Yi)
    *   _sumSquaredData = sum(Yi^2)
@@ -132,9 +183,16 @@ void CrossCorrelation<TData>::correlate(size_t nData, TData *data) {
    * cc = --------------------------------------------------
    *       _denominatorTemplateWaveform * denominator_data
    *
-   * Unfortunately, further optimization of sum(Xi*Yi) is not possible which
-   * requires to be computed within an inner loop inside the main
-   * cross-correlation loop.
+   * The term sum(Xi*Yi) cannot be computed in a rolling fashion. Therefore,
+   * it is computed for all lags of a chunk of data in advance, either by
+   * means of a (vectorized) dot products kernel which computes multiple
+   * subsequent lags per pass (time domain engine) or block-wise by means of
+   * FFT overlap-save (frequency domain engine).
+   *
+   * Degenerate denominators (e.g. due to constant data) and non-finite
+   * coefficients are masked (i.e. result in a coefficient of zero) without
+   * branching. Floating point anomalies are detected once per chunk of data
+   * (see also `detail::CorrelationDiagnostics`).
    */
 
   if (!_initialized) {
@@ -142,52 +200,88 @@ void CrossCorrelation<TData>::correlate(size_t nData, TData *data) {
         "failed to apply cross-correlation filter: not initialized"};
   }
 
-  std::feclearexcept(FE_ALL_EXCEPT);
+  _window.push(data, nData);
+  // the samples which were part of the window before pushing the new samples
+  // followed by the new samples
+  const TData *samples{_window.data() - nData};
+  computeDotProducts(nData, samples + 1);
+  computeCoefficients(nData, samples, data,
+                      _detectLocalMaxima ? &_localMaxima : nullptr);
+}
 
-  const auto n{_buffer.capacity()};
-  const TData *samplesTemplateWf{
-      TypedArray<TData>::ConstCast(_templateWaveform.waveform().data())
-          ->typedData()};
+template <typename TData>
+void CrossCorrelation<TData>::apply(size_t nData, TData *data,
+                                    const LagRanges &lagRanges) {
+  if (!_initialized) {
+    throw BaseException{
+        "failed to apply cross-correlation filter: not initialized"};
+  }
+
+  _window.push(data, nData);
+  const TData *samples{_window.data() - nData};
+  // the rolling statistics of the data must be computed for all lags,
+  // regardless
+  computeDotProducts(nData, samples + 1, lagRanges);
+  computeCoefficients(nData, samples, data);
+  _localMaxima.reset();
+
+  size_t begin{0};
+  for (const auto &lagRange : lagRanges) {
+    assert((lagRange.first >= begin && lagRange.second <= nData));
+    std::fill(data + begin, data + lagRange.first, TData{0});
+    begin = lagRange.second;
+  }
+  std::fill(data + begin, data + nData, TData{0});
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::computeCoefficients(size_t nData,
+                                                  const TData *samples,
+                                                  TData *data,
+                                                  LocalMaxima *maxima) {
+  _diagnostics.start(nData);
+  if (maxima) {
+    maxima->reset();
+  }
+
+  const auto n{_window.size()};
   // cross-correlation loop
   for (size_t i = 0; i < nData; ++i) {
-    const TData newSample{data[i]};
-    const TData lastSample{_buffer.front()};
-    _sumData += newSample - lastSample;
-    _sumSquaredData += util::square(newSample) - util::square(lastSample);
-    const double denominatorData{
-        std::sqrt(n * _sumSquaredData - _sumData * _sumData)};
-
-    _buffer.push_back(newSample);
-
-    double sumTemplateData{0};
-    for (size_t k = 0; k < n; ++k) {
-      sumTemplateData += samplesTemplateWf[k] * _buffer[k];
-    }
-
+    const double newSample{samples[n + i]};
+    const double lastSample{samples[i]};
+    _sumData.add(newSample);
+    _sumData.add(-lastSample);
+    _sumSquaredData.add(util::square(newSample));
+    _sumSquaredData.add(-util::square(lastSample));
+    const double sumData{_sumData.value()};
+    // clamp to zero since rounding errors might result in a (slightly) negative
+    // variance
+    const double denominatorData{std::sqrt(
+        std::max(0.0, n * _sumSquaredData.value() - sumData * sumData))};
+
+    const double sumTemplateData{_dotProducts[i]};
+    const double denominator{_denominatorTemplateWaveform * denominatorData};
+    const bool degenerate{!(denominator > 0)};
     const double pearsonCoeff{
-        (n * sumTemplateData - _sumTemplateWaveform * _sumData) /
-        (_denominatorTemplateWaveform * denominatorData)};
-
-    int fe{std::fetestexcept(FE_ALL_EXCEPT)};
-    if ((fe & ~FE_INEXACT) != 0)  // we don't care about FE_INEXACT
-    {
-      std::vector<std::string> exceptions;
-      if (fe & FE_DIVBYZERO) exceptions.push_back("FE_DIVBYZERO");
-      if (fe & FE_INVALID) exceptions.push_back("FE_INVALID");
-      if (fe & FE_OVERFLOW) exceptions.push_back("FE_OVERFLOW");
-      if (fe & FE_UNDERFLOW) exceptions.push_back("FE_UNDERFLOW");
-
-      std::string msg{
-          "Floating point exception during cross-correlation (sample_idx=" +
-          std::to_string(i) + ", sample=" + std::to_string(newSample) + "): "};
-      msg += boost::algorithm::join(exceptions, ", ");
-      SCDETECT_LOG_WARNING("%s", msg.c_str());
-
-      std::feclearexcept(FE_ALL_EXCEPT);
+        (n * sumTemplateData - _sumTemplateWaveform * sumData) /
+        (degenerate ? 1.0 : denominator)};
+    const bool nonFinite{!std::isfinite(pearsonCoeff)};
+
+    _diagnostics.record(i, degenerate, nonFinite);
+    data[i] = static_cast<TData>(degenerate || nonFinite ? 0 : pearsonCoeff);
+    // detect local maxima w.r.t. the coefficient stored (i.e. masked and
+    // converted to `TData`) such that the local maxima correspond to the ones
+    // detected by rescanning `data`
+    if (maxima) {
+      maxima->feed(data[i], i);
     }
+  }
 
-    data[i] =
-        static_cast<TData>(std::isfinite(pearsonCoeff) ? pearsonCoeff : 0);
+  _diagnostics.stop();
+  if (_diagnostics.anomalous()) {
+    SCDETECT_LOG_WARNING(
+        "Floating point anomalies during cross-correlation (%s)",
+        detail::to_string(_diagnostics).c_str());
   }
 }
 
@@ -198,9 +292,144 @@ void CrossCorrelation<TData>::setupFilter(double samplingFrequency) {
   _initialized = false;
   _templateWaveform.setSamplingFrequency(samplingFrequency);
   reset();
+  setupFrequencyDomain();
   _initialized = true;
 }
 
+template <typename TData>
+void CrossCorrelation<TData>::setupFrequencyDomain() {
+  _spectrumTemplateWaveform.clear();
+  _spectrumData.clear();
+  _dotProducts.clear();
+  if (engine() != Engine::kFrequencyDomain) {
+    _fft = util::Fft{};
+    return;
+  }
+
+  // the block size (i.e. the number of lags computed per FFT) corresponds to
+  // `fftSize - n + 1`; start with the smallest FFT size possible and grow it
+  // with the length of the data (see also `computeDotProductsFrequencyDomain`)
+  setupFrequencyDomain(util::nextPowerOfTwo(2 * _window.size()));
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::setupFrequencyDomain(size_t fftSize) {
+  const auto n{_window.size()};
+  _fft = util::Fft{fftSize};
+
+  _spectrumTemplateWaveform.assign(_fft.size(), 0);
+  std::copy(_samplesTemplateWaveform.begin(),
+            _samplesTemplateWaveform.begin() + n,
+            _spectrumTemplateWaveform.begin());
+  _fft.forward(_spectrumTemplateWaveform.data());
+  // the cross-correlation corresponds to the multiplication with the complex
+  // conjugate spectrum; additionally, apply the inverse FFT normalization
+  const double normalization{1.0 / _fft.size()};
+  for (auto &c : _spectrumTemplateWaveform) {
+    c = std::conj(c) * normalization;
+  }
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::computeDotProducts(size_t nData,
+                                                 const TData *segment) {
+  _dotProducts.resize(nData);
+
+  if (engine() == Engine::kFrequencyDomain) {
+    computeDotProductsFrequencyDomain(nData, segment, _dotProducts.data());
+    return;
+  }
+
+  _dotProductsKernel(_samplesTemplateWaveform.data(), _window.size(), segment,
+                     nData, _dotProducts.data());
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::computeDotProducts(size_t nData,
+                                                 const TData *segment,
+                                                 const LagRanges &lagRanges) {
+  _dotProducts.assign(nData, 0);
+
+  const auto n{_window.size()};
+  const bool frequencyDomain{engine() == Engine::kFrequencyDomain};
+  for (const auto &lagRange : lagRanges) {
+    const auto numLags{lagRange.second - lagRange.first};
+    // lag ranges are usually short; a single overlap-save transform pair
+    // requires ~ `2 * N * log2(N)` operations (where `N` refers to the FFT
+    // size) while the time domain engine requires `n` operations per lag.
+    // Therefore, use the frequency domain engine only if it is cheaper for the
+    // lag range at hand.
+    if (frequencyDomain) {
+      const auto fftSize{_fft.size()};
+      const auto costFrequencyDomain{
+          fftSize * (2 * std::log2(static_cast<double>(fftSize)) + 1)};
+      if (static_cast<double>(numLags) * n > costFrequencyDomain) {
+        computeDotProductsFrequencyDomain(numLags, segment + lagRange.first,
+                                          _dotProducts.data() + lagRange.first);
+        continue;
+      }
+    }
+
+    _dotProductsKernel(_samplesTemplateWaveform.data(), n,
+                       segment + lagRange.first, numLags,
+                       _dotProducts.data() + lagRange.first);
+  }
+}
+
+template <typename TData>
+void CrossCorrelation<TData>::computeDotProductsFrequencyDomain(
+    size_t nData, const TData *segment, double *dotProducts) {
+  const auto n{_window.size()};
+  const auto nSegment{n - 1 + nData};
+  // grow the FFT size only (i.e. never shrink it) such that varying record
+  // lengths do not result in the template waveform spectrum being recomputed
+  // over and over again
+  const auto optimalFftSize{util::overlapSaveFftSize(
+      n, nData, settings::kCrossCorrelationFrequencyDomainMaxFftSize)};
+  if (optimalFftSize > _fft.size()) {
+    setupFrequencyDomain(optimalFftSize);
+  }
+  const auto fftSize{_fft.size()};
+  const auto blockSize{fftSize - n + 1};
+
+  _spectrumData.resize(fftSize);
+
+  const auto Sample = [segment, nSegment](size_t idx) -> double {
+    return idx < nSegment ? segment[idx] : 0;
+  };
+
+  // overlap-save; since both the template waveform and the data are real
+  // valued, two subsequent blocks are packed into the real and the imaginary
+  // part, respectively, of a single complex FFT
+  for (size_t offset = 0; offset < nData; offset += 2 * blockSize) {
+    const auto offsetSecond{offset + blockSize};
+    const bool hasSecond{offsetSecond < nData};
+    for (size_t j = 0; j < fftSize; ++j) {
+      _spectrumData[j] = std::complex<double>{
+          Sample(offset + j), hasSecond ? Sample(offsetSecond + j) : 0};
+    }
+
+    _fft.forward(_spectrumData.data());
+    for (size_t j = 0; j < fftSize; ++j) {
+      const auto &x{_spectrumData[j]};
+      const auto &t{_spectrumTemplateWaveform[j]};
+      _spectrumData[j] =
+          std::complex<double>{x.real() * t.real() - x.imag() * t.imag(),
+                               x.real() * t.imag() + x.imag() * t.real()};
+    }
+    _fft.inverse(_spectrumData.data());
+
+    for (size_t j = 0; j < blockSize && offset + j < nData; ++j) {
+      dotProducts[offset + j] = _spectrumData[j].real();
+    }
+    if (hasSecond) {
+      for (size_t j = 0; j < blockSize && offsetSecond + j < nData; ++j) {
+        dotProducts[offsetSecond + j] = _spectrumData[j].imag();
+      }
+    }
+  }
+}
+
 }  // namespace filter
 }  // namespace detect
 }  // namespace Seiscomp
@@ -0,0 +1,317 @@
+#ifndef SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_H_
+#define SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_H_
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../template_waveform.h"
+#include "../util/math.h"
+#include "../util/memory.h"
+#include "../util/sample_window.h"
+#include "detail/diagnostics.h"
+#include "detail/fingerprint.h"
+#include "detail/kernel.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+
+// Cross-correlation filter bank implementation
+//
+// - cross-correlates the same data with multiple template waveforms (i.e. the
+// bank's members) in a single pass
+// - a single window of the most recent data samples is shared by all members;
+// the rolling statistics of the data are computed once per distinct template
+// waveform size
+// - template waveforms of equal size are stored row-wise (i.e.
+// structure-of-arrays), padded and aligned such that computing the dot
+// products corresponds to a matrix-vector product per lag
+// - in contrast to `CrossCorrelation`, the dot products are computed in the
+// time domain, exclusively
+// - optionally, the template waveforms of equal size are represented by means
+// of a truncated subspace basis (see `setSubspaceEnergyFraction()`); then,
+// the data is cross-correlated with the basis vectors, only, and the dot
+// products of the members are reconstructed from the basis vectors' dot
+// products
+// - optionally, the template waveforms of equal size are clustered (see
+// `setClustering()`); then, only the cluster representatives are
+// cross-correlated continuously
+// - optionally, the template waveforms of equal size are searched for by
+// means of waveform fingerprints (see `setFingerprintSearch()`); then, the
+// members are cross-correlated only in the vicinity of candidate matches
+template <typename TData>
+class CrossCorrelationBank {
+ public:
+  CrossCorrelationBank() = default;
+
+  // Adds `templateWaveform` to the bank. Returns the member index.
+  //
+  // - the filter must be reinitialized by means of `setSamplingFrequency()`
+  std::size_t add(TemplateWaveform templateWaveform);
+  // Returns the number of members
+  std::size_t size() const;
+  // Returns the template waveform of the member identified by `idx`
+  const TemplateWaveform &templateWaveform(std::size_t idx) const;
+
+  // Cross-correlates the (previously filtered) `data` with the template
+  // waveforms of all members. The resulting correlation coefficients are
+  // accessible by means of `coefficients()` until `apply()` is called again.
+  void apply(std::size_t nData, const TData *data);
+  // Returns the correlation coefficients of the member identified by `idx`
+  // computed by the most recent call to `apply()`
+  const TData *coefficients(std::size_t idx) const;
+
+  // Reset the cross-correlation filter bank
+  void reset();
+
+  // Set the sampling frequency in Hz
+  void setSamplingFrequency(double samplingFrequency);
+  // Returns the configured sampling frequency
+  double samplingFrequency() const;
+
+  // Sets the fraction (range: (0, 1]) of the template waveforms' energy the
+  // subspace basis must capture. If `boost::none`, the members are
+  // cross-correlated with their template waveforms directly.
+  //
+  // - the correlation coefficients computed refer to the members' template
+  // waveforms projected onto the subspace
+  // - the subspace representation is used for groups of members whose
+  // subspace dimension is small enough to reduce the computational costs,
+  // only
+  // - the filter must be reinitialized by means of `setSamplingFrequency()`
+  void setSubspaceEnergyFraction(
+      const boost::optional<double> &energyFraction);
+  // Returns the subspace dimension used for the member identified by `idx`.
+  // Returns `0` if the member is cross-correlated with its template waveform
+  // directly.
+  std::size_t subspaceDimension(std::size_t idx) const;
+
+  // Sets the minimum correlation coefficient of interest of the member
+  // identified by `idx`. If `boost::none` (default), all correlation
+  // coefficients of the member are of interest.
+  //
+  // - only taken into account if template clustering is enabled
+  // - the filter must be reinitialized by means of `setSamplingFrequency()`
+  void setThreshold(std::size_t idx, const boost::optional<double> &threshold);
+
+  // Enables template clustering where `similarity` refers to the minimum
+  // similarity (i.e. the zero-lag correlation coefficient) of all pairs of
+  // template waveforms of a cluster. If `boost::none`, template clustering is
+  // disabled.
+  //
+  // - the template waveforms of equal size are clustered hierarchically (see
+  // also `detail::clusterHierarchically()`)
+  // - the cluster representatives are cross-correlated continuously; the
+  // remaining members are cross-correlated only for those lags where the
+  // representative's correlation coefficient is greater than or equal to the
+  // member specific lower bound. The lower bound is derived from the
+  // similarity between the representative and the member such that the
+  // member's correlation coefficient cannot reach the member's threshold (see
+  // `setThreshold()`) for the lags skipped. `boundMargin` is subtracted from
+  // the lower bound in order to account for rounding errors.
+  // - correlation coefficients not computed are set to NaN
+  // - groups represented by means of a subspace are not clustered
+  // - the filter must be reinitialized by means of `setSamplingFrequency()`
+  void setClustering(const boost::optional<double> &similarity,
+                     double boundMargin = 0);
+
+  // Statistics w.r.t. a template cluster
+  struct ClusterStatistics {
+    // The member index of the representative
+    std::size_t representative{0};
+    // The member indices of the remaining members
+    std::vector<std::size_t> members;
+    // The minimum similarity between the representative and the remaining
+    // members
+    double minSimilarity{1};
+    // The number of lags processed
+    std::size_t lags{0};
+    // The number of correlation coefficients computed (including the ones of
+    // the representative)
+    std::size_t coefficientsComputed{0};
+  };
+
+  // Returns the statistics of the template clusters with more than a single
+  // member
+  std::vector<ClusterStatistics> clusterStatistics() const;
+
+  // Enables the fingerprint based similarity search where `hop` refers to the
+  // lag (in seconds) between subsequent data fingerprints. If `boost::none`,
+  // the fingerprint based similarity search is disabled.
+  //
+  // - the fingerprints (see also `detail::FingerprintExtractor`) of the
+  // template waveforms are indexed by means of locality-sensitive hashing
+  // (see also `detail::LshIndex`) per group
+  // - every `hop` seconds the fingerprint of the most recent data window is
+  // computed and looked up in the index. Members with at least `minVotes`
+  // votes are candidates and cross-correlated exactly for the lags within
+  // `hop` seconds around the fingerprint's lag.
+  // - correlation coefficients not computed are set to NaN
+  // - in contrast to template clustering, the search is approximate i.e.
+  // matches may be missed
+  // - groups represented by means of a subspace or clustered are not searched
+  // for by means of fingerprints; neither are groups with template waveforms
+  // shorter than `detail::FingerprintExtractor::minWindowSize()`
+  // - the filter must be reinitialized by means of `setSamplingFrequency()`
+  void setFingerprintSearch(const boost::optional<double> &hop,
+                            std::size_t minVotes = 2);
+
+  // Statistics w.r.t. the fingerprint based similarity search of a group
+  struct FingerprintStatistics {
+    // The member indices
+    std::vector<std::size_t> members;
+    // The number of lags processed
+    std::size_t lags{0};
+    // The number of data fingerprints computed
+    std::size_t fingerprints{0};
+    // The number of candidates (summed over all data fingerprints)
+    std::size_t candidates{0};
+    // The number of correlation coefficients computed (summed over all
+    // members)
+    std::size_t coefficientsComputed{0};
+  };
+
+  // Returns the statistics of the groups searched for by means of
+  // fingerprints
+  std::vector<FingerprintStatistics> fingerprintStatistics() const;
+
+ private:
+  // The number of bytes template waveforms are aligned to
+  static constexpr std::size_t kAlignment{64};
+
+  using AlignedSamples =
+      std::vector<double, util::AlignedAllocator<double, kAlignment>>;
+
+  // Members with template waveforms of equal size
+  struct Group {
+    // The template waveform size
+    std::size_t n{0};
+    // The padded template waveform size
+    std::size_t stride{0};
+    // The member indices
+    std::vector<std::size_t> members;
+    // The zero-padded template waveforms (row-wise)
+    AlignedSamples templateWaveforms;
+
+    // The subspace dimension (`0` if the subspace representation is not
+    // used)
+    std::size_t subspaceDimension{0};
+    // The zero-padded subspace basis vectors (row-wise)
+    AlignedSamples basis;
+    // The coefficients of the members w.r.t. the basis vectors (row-wise)
+    std::vector<double> subspaceCoefficients;
+
+    // The number of cluster representatives which are stored in the first
+    // rows (`0` if template clustering is not used)
+    std::size_t representatives{0};
+    // The row of the cluster representative (per member)
+    std::vector<std::size_t> representativeRow;
+    // The similarity w.r.t. the cluster representative (per member)
+    std::vector<double> similarity;
+    // The lower bound of the representative's correlation coefficient
+    // required for cross-correlating the member (per member)
+    std::vector<double> lowerBound;
+    // The number of correlation coefficients computed (per member)
+    std::vector<std::size_t> coefficientsComputed;
+    // The number of lags processed
+    std::size_t lags{0};
+
+    // The fingerprint extractor (`nullptr` if the fingerprint based
+    // similarity search is not used)
+    std::unique_ptr<detail::FingerprintExtractor> fingerprintExtractor;
+    // The index of the template waveforms' fingerprints
+    std::unique_ptr<detail::LshIndex> lshIndex;
+    // The lag (in samples) between subsequent data fingerprints
+    std::size_t hop{0};
+    // The lag (absolute, exclusive) until which the members must be
+    // cross-correlated (per member)
+    std::vector<std::size_t> correlateUntil;
+    // The number of data fingerprints computed
+    std::size_t fingerprints{0};
+    // The number of candidates
+    std::size_t candidates{0};
+
+    // Template waveform samples summed (per member)
+    std::vector<double> sumTemplateWaveform;
+    // Template waveform denominators (per member)
+    std::vector<double> denominatorTemplateWaveform;
+
+    // The data samples squared summed (compensated)
+    util::CompensatedSum sumSquaredData;
+    // The data samples summed (compensated)
+    util::CompensatedSum sumData;
+  };
+
+  void setupFilter(double samplingFrequency);
+  // Sets up the subspace representation of `group` (if beneficial)
+  void setupSubspace(Group &group);
+  // Sets up the template clusters of `group` (if beneficial)
+  void setupClusters(Group &group);
+  // Sets up the fingerprint based similarity search of `group` (if enabled)
+  void setupFingerprints(Group &group);
+
+  // Computes the correlation coefficients of the members of `group`
+  void correlate(Group &group, std::size_t nData, const TData *samples);
+  // Determines the lags (per member) to be cross-correlated by means of the
+  // fingerprint based similarity search
+  void search(Group &group, std::size_t nData, const TData *groupSamples);
+
+  std::vector<TemplateWaveform> _templateWaveforms;
+  std::vector<Group> _groups;
+
+  // Window of the most recent data samples to be cross-correlated (shared by
+  // all members)
+  util::SampleWindow<TData> _window;
+
+  // The correlation coefficients (member-wise)
+  std::vector<TData> _coefficients;
+  // Scratch buffer for the dot products of a group (row-wise)
+  std::vector<double> _dotProducts;
+  // Scratch buffer for the dot products of the basis vectors of a group
+  // (row-wise)
+  std::vector<double> _basisDotProducts;
+  // Scratch buffer for the denominators of the data
+  std::vector<double> _denominatorData;
+  // Scratch buffer for the data samples summed
+  std::vector<double> _sumData;
+  // Scratch buffer for the lag ranges `[begin, end)` to be cross-correlated
+  // (per member)
+  std::vector<std::vector<std::pair<std::size_t, std::size_t>>> _lagRanges;
+  // Scratch buffer for the candidates of a data fingerprint
+  std::vector<std::size_t> _candidates;
+  // Scratch buffer for the data window fingerprinted
+  std::vector<double> _fingerprintWindow;
+
+  // Floating point diagnostics w.r.t. the most recent chunk of data
+  detail::CorrelationDiagnostics _diagnostics;
+
+  // The kernel computing the dot products
+  detail::MatrixDotProductsKernel _matrixDotProductsKernel{
+      detail::matrixDotProductsKernel()};
+
+  boost::optional<double> _subspaceEnergyFraction;
+
+  // The minimum correlation coefficients of interest (member-wise)
+  std::vector<boost::optional<double>> _thresholds;
+  boost::optional<double> _clusterSimilarity;
+  double _clusterBoundMargin{0};
+
+  boost::optional<double> _fingerprintHop;
+  std::size_t _fingerprintMinVotes{2};
+
+  double _samplingFrequency{0};
+  std::size_t _nData{0};
+
+  bool _initialized{false};
+};
+
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#include "crosscorrelation_bank.ipp"
+
+#endif  // SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_H_
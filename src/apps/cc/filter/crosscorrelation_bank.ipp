@@ -0,0 +1,633 @@
+#ifndef SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_IPP_
+#define SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_IPP_
+
+#include <seiscomp/core/typedarray.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include "../filter.h"
+#include "../log.h"
+#include "../util/math.h"
+#include "detail/cluster.h"
+#include "detail/subspace.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+
+template <typename TData>
+std::size_t CrossCorrelationBank<TData>::add(
+    TemplateWaveform templateWaveform) {
+  _templateWaveforms.push_back(std::move(templateWaveform));
+  _thresholds.emplace_back();
+  _initialized = false;
+  return _templateWaveforms.size() - 1;
+}
+
+template <typename TData>
+std::size_t CrossCorrelationBank<TData>::size() const {
+  return _templateWaveforms.size();
+}
+
+template <typename TData>
+const TemplateWaveform &CrossCorrelationBank<TData>::templateWaveform(
+    std::size_t idx) const {
+  return _templateWaveforms.at(idx);
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::apply(std::size_t nData, const TData *data) {
+  if (!_initialized) {
+    throw BaseException{
+        "failed to apply cross-correlation filter bank: not initialized"};
+  }
+
+  _nData = nData;
+  _coefficients.resize(size() * nData);
+  _denominatorData.resize(nData);
+  _sumData.resize(nData);
+
+  _window.push(data, nData);
+  // the samples which were part of the window before pushing the new samples
+  // followed by the new samples
+  const TData *samples{_window.data() - nData};
+
+  // the diagnostics are aggregated over all members
+  _diagnostics.start(nData);
+
+  for (auto &group : _groups) {
+    correlate(group, nData, samples);
+  }
+
+  _diagnostics.stop();
+  if (_diagnostics.anomalous()) {
+    SCDETECT_LOG_WARNING(
+        "Floating point anomalies during cross-correlation (filter bank, %s)",
+        detail::to_string(_diagnostics).c_str());
+  }
+}
+
+template <typename TData>
+const TData *CrossCorrelationBank<TData>::coefficients(std::size_t idx) const {
+  assert((idx < size()));
+  return _coefficients.data() + idx * _nData;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::reset() {
+  std::size_t n{0};
+  for (auto &group : _groups) {
+    group.sumData.reset();
+    group.sumSquaredData.reset();
+    std::fill(group.correlateUntil.begin(), group.correlateUntil.end(), 0);
+    n = std::max(n, group.n);
+  }
+
+  _window.reset(n, 0);
+  _nData = 0;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setSamplingFrequency(
+    double samplingFrequency) {
+  setupFilter(samplingFrequency);
+}
+
+template <typename TData>
+double CrossCorrelationBank<TData>::samplingFrequency() const {
+  return _samplingFrequency;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setSubspaceEnergyFraction(
+    const boost::optional<double> &energyFraction) {
+  assert((!energyFraction || (*energyFraction > 0 && *energyFraction <= 1)));
+  _subspaceEnergyFraction = energyFraction;
+  _initialized = false;
+}
+
+template <typename TData>
+std::size_t CrossCorrelationBank<TData>::subspaceDimension(
+    std::size_t idx) const {
+  for (const auto &group : _groups) {
+    if (std::find(group.members.begin(), group.members.end(), idx) !=
+        group.members.end()) {
+      return group.subspaceDimension;
+    }
+  }
+  return 0;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setThreshold(
+    std::size_t idx, const boost::optional<double> &threshold) {
+  _thresholds.at(idx) = threshold;
+  _initialized = false;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setClustering(
+    const boost::optional<double> &similarity, double boundMargin) {
+  assert((boundMargin >= 0));
+  _clusterSimilarity = similarity;
+  _clusterBoundMargin = boundMargin;
+  _initialized = false;
+}
+
+template <typename TData>
+std::vector<typename CrossCorrelationBank<TData>::ClusterStatistics>
+CrossCorrelationBank<TData>::clusterStatistics() const {
+  std::vector<ClusterStatistics> ret;
+  for (const auto &group : _groups) {
+    if (!group.representatives) {
+      continue;
+    }
+
+    std::vector<ClusterStatistics> clusters(group.representatives);
+    for (std::size_t r = 0; r < group.members.size(); ++r) {
+      auto &cluster{clusters[group.representativeRow[r]]};
+      if (r < group.representatives) {
+        cluster.representative = group.members[r];
+        cluster.lags = group.lags;
+      } else {
+        cluster.members.push_back(group.members[r]);
+        cluster.minSimilarity =
+            std::min(cluster.minSimilarity, group.similarity[r]);
+      }
+      cluster.coefficientsComputed += group.coefficientsComputed[r];
+    }
+
+    for (auto &cluster : clusters) {
+      if (!cluster.members.empty()) {
+        ret.push_back(std::move(cluster));
+      }
+    }
+  }
+  return ret;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setFingerprintSearch(
+    const boost::optional<double> &hop, std::size_t minVotes) {
+  assert((!hop || *hop > 0));
+  assert((minVotes > 0));
+  _fingerprintHop = hop;
+  _fingerprintMinVotes = minVotes;
+  _initialized = false;
+}
+
+template <typename TData>
+std::vector<typename CrossCorrelationBank<TData>::FingerprintStatistics>
+CrossCorrelationBank<TData>::fingerprintStatistics() const {
+  std::vector<FingerprintStatistics> ret;
+  for (const auto &group : _groups) {
+    if (!group.fingerprintExtractor) {
+      continue;
+    }
+
+    FingerprintStatistics statistics;
+    statistics.members = group.members;
+    statistics.lags = group.lags;
+    statistics.fingerprints = group.fingerprints;
+    statistics.candidates = group.candidates;
+    for (const auto coefficientsComputed : group.coefficientsComputed) {
+      statistics.coefficientsComputed += coefficientsComputed;
+    }
+    ret.push_back(std::move(statistics));
+  }
+  return ret;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setupFilter(double samplingFrequency) {
+  assert((samplingFrequency > 0));
+
+  _initialized = false;
+  _samplingFrequency = samplingFrequency;
+
+  // group the members by template waveform size
+  std::map<std::size_t, std::vector<std::size_t>> membersBySize;
+  for (std::size_t i = 0; i < _templateWaveforms.size(); ++i) {
+    auto &templateWaveform{_templateWaveforms[i]};
+    templateWaveform.setSamplingFrequency(samplingFrequency);
+    membersBySize[templateWaveform.size()].push_back(i);
+  }
+
+  constexpr std::size_t samplesPerAlignment{kAlignment / sizeof(double)};
+  _groups.clear();
+  for (const auto &membersBySizePair : membersBySize) {
+    Group group;
+    group.n = membersBySizePair.first;
+    group.stride = (group.n + samplesPerAlignment - 1) / samplesPerAlignment *
+                   samplesPerAlignment;
+    group.members = membersBySizePair.second;
+    group.templateWaveforms.assign(group.members.size() * group.stride, 0);
+
+    for (std::size_t r = 0; r < group.members.size(); ++r) {
+      const double *samplesTemplateWf{
+          DoubleArray::ConstCast(
+              _templateWaveforms[group.members[r]].waveform().data())
+              ->typedData()};
+      std::copy(samplesTemplateWf, samplesTemplateWf + group.n,
+                group.templateWaveforms.begin() + r * group.stride);
+    }
+
+    setupSubspace(group);
+    setupClusters(group);
+    setupFingerprints(group);
+
+    for (std::size_t r = 0; r < group.members.size(); ++r) {
+      // if the subspace representation is used, the members' template waveforms
+      // are replaced by their projections such that the correlation
+      // coefficients are consistent with the dot products reconstructed
+      const double *samplesTemplateWf{group.templateWaveforms.data() +
+                                      r * group.stride};
+
+      double sumTemplateWaveform{0};
+      double sumSquaredTemplateWaveform{0};
+      for (std::size_t k = 0; k < group.n; ++k) {
+        sumTemplateWaveform += samplesTemplateWf[k];
+        sumSquaredTemplateWaveform += util::square(samplesTemplateWf[k]);
+      }
+      group.sumTemplateWaveform.push_back(sumTemplateWaveform);
+      group.denominatorTemplateWaveform.push_back(
+          std::sqrt(group.n * sumSquaredTemplateWaveform -
+                    sumTemplateWaveform * sumTemplateWaveform));
+    }
+
+    _groups.push_back(std::move(group));
+  }
+
+  reset();
+  _initialized = true;
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setupSubspace(Group &group) {
+  const auto m{group.members.size()};
+  if (!_subspaceEnergyFraction || m < 2) {
+    return;
+  }
+
+  auto subspace{detail::computeSubspace(group.templateWaveforms.data(), m,
+                                        group.stride, group.n,
+                                        *_subspaceEnergyFraction)};
+  const auto dimension{subspace.dimension};
+  // the costs per lag are proportional to `dimension * (n + m)` compared to
+  // `m * n` if cross-correlating with the template waveforms directly
+  if (!dimension || dimension * (group.n + m) >= m * group.n) {
+    SCDETECT_LOG_DEBUG(
+        "Cross-correlation filter bank: subspace representation not "
+        "beneficial (members=%lu, template_waveform_size=%lu, dimension=%lu)",
+        m, group.n, dimension);
+    return;
+  }
+
+  SCDETECT_LOG_DEBUG(
+      "Cross-correlation filter bank: subspace representation (members=%lu, "
+      "template_waveform_size=%lu, dimension=%lu, energy_fraction=%f)",
+      m, group.n, dimension, subspace.energyFraction);
+
+  group.subspaceDimension = dimension;
+  group.basis.assign(subspace.basis.begin(), subspace.basis.end());
+  group.subspaceCoefficients = std::move(subspace.coefficients);
+
+  // project the template waveforms onto the subspace
+  std::fill(group.templateWaveforms.begin(), group.templateWaveforms.end(), 0);
+  for (std::size_t r = 0; r < m; ++r) {
+    double *projected{group.templateWaveforms.data() + r * group.stride};
+    for (std::size_t j = 0; j < dimension; ++j) {
+      const double coefficient{group.subspaceCoefficients[r * dimension + j]};
+      const double *basisVector{group.basis.data() + j * group.stride};
+      for (std::size_t k = 0; k < group.n; ++k) {
+        projected[k] += coefficient * basisVector[k];
+      }
+    }
+  }
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setupClusters(Group &group) {
+  const auto m{group.members.size()};
+  if (!_clusterSimilarity || group.subspaceDimension || m < 2) {
+    return;
+  }
+
+  const auto clusters{detail::clusterHierarchically(
+      group.templateWaveforms.data(), m, group.stride, group.n,
+      *_clusterSimilarity)};
+  if (clusters.size() == m) {
+    SCDETECT_LOG_DEBUG(
+        "Cross-correlation filter bank: no template clusters (members=%lu, "
+        "template_waveform_size=%lu, similarity=%f)",
+        m, group.n, *_clusterSimilarity);
+    return;
+  }
+
+  SCDETECT_LOG_DEBUG(
+      "Cross-correlation filter bank: template clusters (members=%lu, "
+      "template_waveform_size=%lu, clusters=%lu, similarity=%f)",
+      m, group.n, clusters.size(), *_clusterSimilarity);
+
+  // reorder the rows such that the representatives are stored first
+  std::vector<std::size_t> rows;
+  for (std::size_t c = 0; c < clusters.size(); ++c) {
+    rows.push_back(clusters[c].representative);
+    group.representativeRow.push_back(c);
+    group.similarity.push_back(1);
+  }
+  for (std::size_t c = 0; c < clusters.size(); ++c) {
+    const auto &cluster{clusters[c]};
+    for (std::size_t k = 0; k < cluster.members.size(); ++k) {
+      rows.push_back(cluster.members[k]);
+      group.representativeRow.push_back(c);
+      group.similarity.push_back(cluster.similarities[k]);
+    }
+  }
+
+  std::vector<std::size_t> members(m);
+  AlignedSamples templateWaveforms(group.templateWaveforms.size());
+  for (std::size_t r = 0; r < m; ++r) {
+    members[r] = group.members[rows[r]];
+    std::copy(group.templateWaveforms.begin() + rows[r] * group.stride,
+              group.templateWaveforms.begin() + (rows[r] + 1) * group.stride,
+              templateWaveforms.begin() + r * group.stride);
+  }
+  group.members = std::move(members);
+  group.templateWaveforms = std::move(templateWaveforms);
+  group.representatives = clusters.size();
+
+  // both the member's and the representative's correlation coefficients are
+  // Pearson correlation coefficients w.r.t. the same data window i.e. cosines
+  // of angles between demeaned vectors. Since angles obey the triangle
+  // inequality, the representative's coefficient is greater than or equal to
+  // `cos(acos(similarity) + acos(threshold))` if the member's coefficient is
+  // greater than or equal to `threshold`.
+  const double pi{std::acos(-1.0)};
+  const auto clamp = [](double v) { return std::max(-1.0, std::min(1.0, v)); };
+  group.lowerBound.assign(m, std::numeric_limits<double>::lowest());
+  group.coefficientsComputed.assign(m, 0);
+  group.lags = 0;
+  for (std::size_t r = group.representatives; r < m; ++r) {
+    const auto &threshold{_thresholds[group.members[r]]};
+    if (!threshold) {
+      continue;
+    }
+    const double angle{std::acos(clamp(group.similarity[r])) +
+                       std::acos(clamp(*threshold))};
+    if (angle < pi) {
+      group.lowerBound[r] = std::cos(angle) - _clusterBoundMargin;
+    }
+  }
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::setupFingerprints(Group &group) {
+  const auto m{group.members.size()};
+  if (!_fingerprintHop || group.subspaceDimension || group.representatives) {
+    return;
+  }
+
+  if (group.n < detail::FingerprintExtractor::minWindowSize()) {
+    SCDETECT_LOG_DEBUG(
+        "Cross-correlation filter bank: template waveforms too short for the "
+        "fingerprint based similarity search (members=%lu, "
+        "template_waveform_size=%lu)",
+        m, group.n);
+    return;
+  }
+
+  group.hop = std::max(std::size_t{1},
+                       static_cast<std::size_t>(std::round(
+                           *_fingerprintHop * _samplingFrequency)));
+  group.fingerprintExtractor =
+      util::make_unique<detail::FingerprintExtractor>(group.n);
+  group.lshIndex = util::make_unique<detail::LshIndex>();
+  for (std::size_t r = 0; r < m; ++r) {
+    group.lshIndex->add(
+        (*group.fingerprintExtractor)(group.templateWaveforms.data() +
+                                      r * group.stride),
+        r);
+  }
+  group.correlateUntil.assign(m, 0);
+  group.coefficientsComputed.assign(m, 0);
+  group.lags = 0;
+  group.fingerprints = 0;
+  group.candidates = 0;
+
+  SCDETECT_LOG_DEBUG(
+      "Cross-correlation filter bank: fingerprint based similarity search "
+      "(members=%lu, template_waveform_size=%lu, hop=%lu, min_votes=%lu)",
+      m, group.n, group.hop, _fingerprintMinVotes);
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::search(Group &group, std::size_t nData,
+                                         const TData *groupSamples) {
+  const auto m{group.members.size()};
+  const auto n{group.n};
+  const auto hop{group.hop};
+  // the absolute lag of the first lag of the chunk
+  const auto offset{group.lags};
+
+  _lagRanges.resize(m);
+  for (std::size_t r = 0; r < m; ++r) {
+    _lagRanges[r].clear();
+    // continue cross-correlating members of candidate matches found while
+    // processing the previous chunk
+    if (group.correlateUntil[r] > offset) {
+      _lagRanges[r].emplace_back(
+          0, std::min(nData, group.correlateUntil[r] - offset));
+    }
+  }
+
+  _fingerprintWindow.resize(n);
+  for (std::size_t i = (hop - offset % hop) % hop; i < nData; i += hop) {
+    std::copy(groupSamples + 1 + i, groupSamples + 1 + i + n,
+              _fingerprintWindow.begin());
+    _candidates.clear();
+    group.lshIndex->query(
+        (*group.fingerprintExtractor)(_fingerprintWindow.data()),
+        _fingerprintMinVotes, _candidates);
+    ++group.fingerprints;
+    group.candidates += _candidates.size();
+
+    // the lags preceding the current chunk are not revisited
+    const std::size_t begin{i >= hop ? i - hop : 0};
+    const std::size_t end{std::min(nData, i + hop + 1)};
+    for (const auto r : _candidates) {
+      auto &lagRanges{_lagRanges[r]};
+      if (!lagRanges.empty() && begin <= lagRanges.back().second) {
+        lagRanges.back().second = std::max(lagRanges.back().second, end);
+      } else {
+        lagRanges.emplace_back(begin, end);
+      }
+      group.correlateUntil[r] =
+          std::max(group.correlateUntil[r], offset + i + hop + 1);
+    }
+  }
+}
+
+template <typename TData>
+void CrossCorrelationBank<TData>::correlate(Group &group, std::size_t nData,
+                                            const TData *samples) {
+  // for the details w.r.t. computing the Pearson correlation coefficient refer
+  // to `CrossCorrelation::correlate()`
+
+  const auto n{group.n};
+  // the window is sized w.r.t. the largest template waveform; thus, skip the
+  // samples not required for the group
+  const TData *groupSamples{samples + (_window.size() - n)};
+
+  const auto m{group.members.size()};
+  if (group.subspaceDimension) {
+    // cross-correlate with the basis vectors and reconstruct the dot products
+    // of the members
+    const auto dimension{group.subspaceDimension};
+    _basisDotProducts.resize(dimension * nData);
+    _matrixDotProductsKernel(group.basis.data(), dimension, group.stride, n,
+                             groupSamples + 1, nData,
+                             _basisDotProducts.data());
+
+    _dotProducts.assign(m * nData, 0);
+    for (std::size_t r = 0; r < m; ++r) {
+      double *dotProducts{_dotProducts.data() + r * nData};
+      for (std::size_t j = 0; j < dimension; ++j) {
+        const double coefficient{
+            group.subspaceCoefficients[r * dimension + j]};
+        const double *basisDotProducts{_basisDotProducts.data() + j * nData};
+        for (std::size_t i = 0; i < nData; ++i) {
+          dotProducts[i] += coefficient * basisDotProducts[i];
+        }
+      }
+    }
+  } else if (group.fingerprintExtractor) {
+    // the members are cross-correlated for the lags determined by means of
+    // the fingerprint based similarity search, only
+    _dotProducts.resize(m * nData);
+  } else {
+    // if the members are clustered, only the representatives are
+    // cross-correlated for all lags
+    _dotProducts.resize(m * nData);
+    _matrixDotProductsKernel(
+        group.templateWaveforms.data(),
+        group.representatives ? group.representatives : m, group.stride, n,
+        groupSamples + 1, nData, _dotProducts.data());
+  }
+
+  // the rolling statistics of the data are shared by all members of the
+  // group
+  for (std::size_t i = 0; i < nData; ++i) {
+    const double newSample{groupSamples[n + i]};
+    const double lastSample{groupSamples[i]};
+    group.sumData.add(newSample);
+    group.sumData.add(-lastSample);
+    group.sumSquaredData.add(util::square(newSample));
+    group.sumSquaredData.add(-util::square(lastSample));
+    const double sumData{group.sumData.value()};
+    _denominatorData[i] = std::sqrt(
+        std::max(0.0, n * group.sumSquaredData.value() - sumData * sumData));
+    _sumData[i] = sumData;
+  }
+
+  // computes the correlation coefficients of row `r` for the lags in the
+  // range [`begin`, `end`)
+  const auto computeCoefficients = [this, &group, n, nData](
+                                       std::size_t r, std::size_t begin,
+                                       std::size_t end) {
+    const double *dotProducts{_dotProducts.data() + r * nData};
+    const double sumTemplateWaveform{group.sumTemplateWaveform[r]};
+    const double denominatorTemplateWaveform{
+        group.denominatorTemplateWaveform[r]};
+
+    TData *coefficients{_coefficients.data() + group.members[r] * nData};
+    for (std::size_t i = begin; i < end; ++i) {
+      const double denominator{denominatorTemplateWaveform *
+                               _denominatorData[i]};
+      const bool degenerate{!(denominator > 0)};
+      const double pearsonCoeff{
+          (n * dotProducts[i] - sumTemplateWaveform * _sumData[i]) /
+          (degenerate ? 1.0 : denominator)};
+      const bool nonFinite{!std::isfinite(pearsonCoeff)};
+
+      _diagnostics.record(i, degenerate, nonFinite);
+      coefficients[i] =
+          static_cast<TData>(degenerate || nonFinite ? 0 : pearsonCoeff);
+    }
+  };
+
+  if (group.fingerprintExtractor) {
+    search(group, nData, groupSamples);
+    for (std::size_t r = 0; r < m; ++r) {
+      TData *coefficients{_coefficients.data() + group.members[r] * nData};
+      std::fill(coefficients, coefficients + nData,
+                std::numeric_limits<TData>::quiet_NaN());
+      for (const auto &lagRange : _lagRanges[r]) {
+        const auto begin{lagRange.first};
+        const auto end{lagRange.second};
+        _matrixDotProductsKernel(
+            group.templateWaveforms.data() + r * group.stride, 1,
+            group.stride, n, groupSamples + 1 + begin, end - begin,
+            _dotProducts.data() + r * nData + begin);
+        computeCoefficients(r, begin, end);
+        group.coefficientsComputed[r] += end - begin;
+      }
+    }
+    group.lags += nData;
+    return;
+  }
+
+  if (!group.representatives) {
+    for (std::size_t r = 0; r < m; ++r) {
+      computeCoefficients(r, 0, nData);
+    }
+    return;
+  }
+
+  for (std::size_t r = 0; r < group.representatives; ++r) {
+    computeCoefficients(r, 0, nData);
+    group.coefficientsComputed[r] += nData;
+  }
+  group.lags += nData;
+
+  // cross-correlate the remaining members for those lags where the
+  // representative's correlation coefficient reaches the lower bound, only
+  for (std::size_t r = group.representatives; r < m; ++r) {
+    const TData *representativeCoefficients{
+        _coefficients.data() +
+        group.members[group.representativeRow[r]] * nData};
+    const double lowerBound{group.lowerBound[r]};
+    TData *coefficients{_coefficients.data() + group.members[r] * nData};
+    std::fill(coefficients, coefficients + nData,
+              std::numeric_limits<TData>::quiet_NaN());
+
+    std::size_t i{0};
+    while (i < nData) {
+      if (!(representativeCoefficients[i] >= lowerBound)) {
+        ++i;
+        continue;
+      }
+      const std::size_t begin{i};
+      while (i < nData && representativeCoefficients[i] >= lowerBound) {
+        ++i;
+      }
+
+      _matrixDotProductsKernel(
+          group.templateWaveforms.data() + r * group.stride, 1, group.stride,
+          n, groupSamples + 1 + begin, i - begin,
+          _dotProducts.data() + r * nData + begin);
+      computeCoefficients(r, begin, i);
+      group.coefficientsComputed[r] += i - begin;
+    }
+  }
+}
+
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_CROSSCORRELATIONBANK_IPP_
@@ -0,0 +1,249 @@
+#include "cluster.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+namespace {
+
+// Normalization of the template waveforms such that the Pearson correlation
+// coefficient can be computed without copying the template waveforms
+struct Normalization {
+  std::vector<double> means;
+  // The inverse norms of the demeaned template waveforms (zero if the norm
+  // vanishes)
+  std::vector<double> inverseNorms;
+};
+
+Normalization normalize(const double *templateWfs, std::size_t nTemplates,
+                        std::size_t stride, std::size_t n) {
+  Normalization ret;
+  ret.means.resize(nTemplates, 0);
+  ret.inverseNorms.resize(nTemplates, 0);
+  for (std::size_t r = 0; r < nTemplates; ++r) {
+    const double *row{templateWfs + r * stride};
+    double mean{0};
+    for (std::size_t k = 0; k < n; ++k) {
+      mean += row[k];
+    }
+    mean /= static_cast<double>(n);
+
+    double norm{0};
+    for (std::size_t k = 0; k < n; ++k) {
+      norm += (row[k] - mean) * (row[k] - mean);
+    }
+    norm = std::sqrt(norm);
+
+    ret.means[r] = mean;
+    ret.inverseNorms[r] = norm > 0 ? 1 / norm : 0;
+  }
+  return ret;
+}
+
+double similarity(const double *templateWfs, std::size_t stride,
+                  std::size_t n, const Normalization &normalization,
+                  std::size_t i, std::size_t j) {
+  const double *lhs{templateWfs + i * stride};
+  const double *rhs{templateWfs + j * stride};
+  const double lhsMean{normalization.means[i]};
+  const double rhsMean{normalization.means[j]};
+  double ret{0};
+  for (std::size_t k = 0; k < n; ++k) {
+    ret += (lhs[k] - lhsMean) * (rhs[k] - rhsMean);
+  }
+  ret *= normalization.inverseNorms[i] * normalization.inverseNorms[j];
+  return std::max(-1.0, std::min(1.0, ret));
+}
+
+// Disjoint-set forest over the template waveform indices
+class DisjointSets {
+ public:
+  explicit DisjointSets(std::size_t n) : _parents(n) {
+    std::iota(_parents.begin(), _parents.end(), 0);
+  }
+
+  std::size_t find(std::size_t i) {
+    while (_parents[i] != i) {
+      _parents[i] = _parents[_parents[i]];
+      i = _parents[i];
+    }
+    return i;
+  }
+
+  void unite(std::size_t i, std::size_t j) { _parents[find(i)] = find(j); }
+
+ private:
+  std::vector<std::size_t> _parents;
+};
+
+}  // namespace
+
+std::size_t condensedIndex(std::size_t i, std::size_t j,
+                           std::size_t nTemplates) {
+  assert((i != j));
+  if (i > j) {
+    std::swap(i, j);
+  }
+  return i * nTemplates - i * (i + 1) / 2 + j - i - 1;
+}
+
+std::vector<float> computeSimilarities(const double *templateWfs,
+                                       std::size_t nTemplates,
+                                       std::size_t stride, std::size_t n) {
+  assert((stride >= n));
+  if (nTemplates < 2) {
+    return {};
+  }
+
+  const auto normalization{normalize(templateWfs, nTemplates, stride, n)};
+  std::vector<float> ret(nTemplates * (nTemplates - 1) / 2);
+  std::size_t idx{0};
+  for (std::size_t i = 0; i < nTemplates; ++i) {
+    for (std::size_t j = i + 1; j < nTemplates; ++j) {
+      ret[idx++] = static_cast<float>(
+          similarity(templateWfs, stride, n, normalization, i, j));
+    }
+  }
+  return ret;
+}
+
+std::vector<Cluster> clusterHierarchically(const double *templateWfs,
+                                           std::size_t nTemplates,
+                                           std::size_t stride, std::size_t n,
+                                           double threshold) {
+  // complete linkage i.e. the minimum similarity between the template
+  // waveforms of two clusters; a cluster is identified by one of its template
+  // waveform indices
+  auto linkage{computeSimilarities(templateWfs, nTemplates, stride, n)};
+
+  // complete linkage is reducible i.e. merging two clusters does not increase
+  // their linkage w.r.t. any other cluster. Hence, the dendrogram is built by
+  // merging reciprocal nearest neighbors (the nearest-neighbor chain algorithm)
+  // rather than by searching for the globally most similar pair of clusters.
+  // Moreover, cutting the dendrogram at `threshold` corresponds to uniting the
+  // clusters of all merges with a linkage greater than or equal to `threshold`,
+  // regardless of the order the merges are found.
+  DisjointSets sets{nTemplates};
+  std::vector<bool> active(nTemplates, true);
+  std::vector<std::size_t> chain;
+  std::size_t remaining{nTemplates};
+  std::size_t next{0};
+  while (remaining > 1) {
+    if (chain.empty()) {
+      while (!active[next]) {
+        ++next;
+      }
+      chain.push_back(next);
+    }
+
+    // grow the chain until reaching reciprocal nearest neighbors; prefer the
+    // predecessor in case of ties in order to guarantee termination
+    std::size_t lhs;
+    std::size_t rhs;
+    float maxLinkage;
+    while (true) {
+      lhs = chain.back();
+      const bool hasPredecessor{chain.size() > 1};
+      rhs = hasPredecessor ? chain[chain.size() - 2] : lhs;
+      maxLinkage = hasPredecessor
+                       ? linkage[condensedIndex(lhs, rhs, nTemplates)]
+                       : std::numeric_limits<float>::lowest();
+      for (std::size_t k = 0; k < nTemplates; ++k) {
+        if (k == lhs || !active[k]) {
+          continue;
+        }
+        const auto l{linkage[condensedIndex(lhs, k, nTemplates)]};
+        if (l > maxLinkage) {
+          maxLinkage = l;
+          rhs = k;
+        }
+      }
+
+      if (hasPredecessor && rhs == chain[chain.size() - 2]) {
+        break;
+      }
+      chain.push_back(rhs);
+    }
+    chain.resize(chain.size() - 2);
+
+    // merge `lhs` into `rhs`
+    active[lhs] = false;
+    --remaining;
+    for (std::size_t k = 0; k < nTemplates; ++k) {
+      if (k == rhs || !active[k]) {
+        continue;
+      }
+      auto &l{linkage[condensedIndex(rhs, k, nTemplates)]};
+      l = std::min(l, linkage[condensedIndex(lhs, k, nTemplates)]);
+    }
+
+    if (maxLinkage >= threshold) {
+      sets.unite(lhs, rhs);
+    }
+  }
+  linkage.clear();
+  linkage.shrink_to_fit();
+
+  // the template waveform indices per cluster (ordered by the smallest index)
+  std::vector<std::vector<std::size_t>> clusters;
+  std::vector<std::size_t> clusterIdx(nTemplates, nTemplates);
+  for (std::size_t i = 0; i < nTemplates; ++i) {
+    auto &idx{clusterIdx[sets.find(i)]};
+    if (idx == nTemplates) {
+      idx = clusters.size();
+      clusters.emplace_back();
+    }
+    clusters[idx].push_back(i);
+  }
+
+  // the similarities are recomputed in double precision (rather than being
+  // stored per cluster) since the cluster size is not bounded
+  const auto normalization{normalize(templateWfs, nTemplates, stride, n)};
+  std::vector<Cluster> ret;
+  for (const auto &cluster : clusters) {
+    // select the medoid w.r.t. the minimum similarity
+    std::size_t representative{cluster.front()};
+    double maxMinSimilarity{std::numeric_limits<double>::lowest()};
+    for (const auto candidate : cluster) {
+      double minSimilarity{std::numeric_limits<double>::max()};
+      for (const auto other : cluster) {
+        if (other != candidate) {
+          minSimilarity =
+              std::min(minSimilarity, similarity(templateWfs, stride, n,
+                                                 normalization, candidate,
+                                                 other));
+        }
+      }
+      if (minSimilarity > maxMinSimilarity) {
+        maxMinSimilarity = minSimilarity;
+        representative = candidate;
+      }
+    }
+
+    Cluster c;
+    c.representative = representative;
+    for (const auto member : cluster) {
+      if (member != representative) {
+        c.members.push_back(member);
+        c.similarities.push_back(similarity(templateWfs, stride, n,
+                                            normalization, representative,
+                                            member));
+      }
+    }
+    ret.push_back(std::move(c));
+  }
+  return ret;
+}
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
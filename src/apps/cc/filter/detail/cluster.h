@@ -0,0 +1,66 @@
+#ifndef SCDETECT_APPS_CC_FILTER_DETAIL_CLUSTER_H_
+#define SCDETECT_APPS_CC_FILTER_DETAIL_CLUSTER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+// A cluster of similar template waveforms
+struct Cluster {
+  // The index of the representative template waveform
+  std::size_t representative{0};
+  // The indices of the remaining template waveforms of the cluster
+  std::vector<std::size_t> members;
+  // The similarity (i.e. the zero-lag correlation coefficient) between the
+  // representative and each of the `members`
+  std::vector<double> similarities;
+};
+
+// Returns the index of the similarity between the template waveforms `i` and
+// `j` (where `i != j`) w.r.t. a condensed similarity matrix of `nTemplates`
+// template waveforms (see also `computeSimilarities()`)
+std::size_t condensedIndex(std::size_t i, std::size_t j,
+                           std::size_t nTemplates);
+
+// Computes the pairwise similarities of the `nTemplates` template waveforms
+// (of length `n`) stored row-wise in `templateWfs` (with `stride` samples
+// between subsequent rows). The similarity corresponds to the Pearson
+// correlation coefficient at zero lag.
+//
+// - returns the condensed similarity matrix i.e. the strict upper triangle of
+// the `nTemplates` x `nTemplates` similarity matrix (row-major) with
+// `nTemplates * (nTemplates - 1) / 2` elements
+// - the similarities are stored in single precision in order to halve the
+// memory footprint
+std::vector<float> computeSimilarities(const double *templateWfs,
+                                       std::size_t nTemplates,
+                                       std::size_t stride, std::size_t n);
+
+// Clusters the `nTemplates` template waveforms (of length `n`) stored
+// row-wise in `templateWfs` (with `stride` samples between subsequent rows)
+// by means of agglomerative hierarchical clustering (complete linkage) w.r.t.
+// their pairwise similarities (see also `computeSimilarities()`). Clusters
+// are merged as long as the similarity of all pairs of template waveforms of
+// the merged cluster is greater than or equal to `threshold`.
+//
+// - the dendrogram is built by means of the nearest-neighbor chain algorithm
+// i.e. in `O(nTemplates^2)` time based on a single condensed similarity
+// matrix
+// - the representative of a cluster is the template waveform with the largest
+// minimum similarity w.r.t. the remaining members
+// - single template waveforms form clusters without members
+std::vector<Cluster> clusterHierarchically(const double *templateWfs,
+                                           std::size_t nTemplates,
+                                           std::size_t stride, std::size_t n,
+                                           double threshold);
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_DETAIL_CLUSTER_H_
@@ -0,0 +1,55 @@
+#include "diagnostics.h"
+
+#include <boost/algorithm/string/join.hpp>
+#include <cfenv>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+constexpr std::size_t CorrelationDiagnostics::kNoIdx;
+
+void CorrelationDiagnostics::start(std::size_t n) {
+  *this = CorrelationDiagnostics{};
+  _n = n;
+  std::feclearexcept(FE_ALL_EXCEPT);
+}
+
+void CorrelationDiagnostics::stop() {
+  // we don't care about FE_INEXACT
+  _floatingPointExceptions = std::fetestexcept(FE_ALL_EXCEPT & ~FE_INEXACT);
+  std::feclearexcept(FE_ALL_EXCEPT);
+}
+
+bool CorrelationDiagnostics::anomalous() const {
+  return _numDegenerate > 0 || _numNonFinite > 0 ||
+         _floatingPointExceptions != 0;
+}
+
+std::string to_string(const CorrelationDiagnostics &diagnostics) {
+  std::string ret{"samples=" + std::to_string(diagnostics.size())};
+  if (diagnostics.numDegenerate() > 0 || diagnostics.numNonFinite() > 0) {
+    ret += ", sample_range=[" + std::to_string(diagnostics.firstIdx()) + ", " +
+           std::to_string(diagnostics.lastIdx()) +
+           "], degenerate=" + std::to_string(diagnostics.numDegenerate()) +
+           ", non_finite=" + std::to_string(diagnostics.numNonFinite());
+  }
+
+  const auto fe{diagnostics.floatingPointExceptions()};
+  std::vector<std::string> exceptions;
+  if (fe & FE_DIVBYZERO) exceptions.push_back("FE_DIVBYZERO");
+  if (fe & FE_INVALID) exceptions.push_back("FE_INVALID");
+  if (fe & FE_OVERFLOW) exceptions.push_back("FE_OVERFLOW");
+  if (fe & FE_UNDERFLOW) exceptions.push_back("FE_UNDERFLOW");
+  if (!exceptions.empty()) {
+    ret += ", exceptions=" + boost::algorithm::join(exceptions, "|");
+  }
+  return ret;
+}
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,77 @@
+#ifndef SCDETECT_APPS_CC_FILTER_DETAIL_DIAGNOSTICS_H_
+#define SCDETECT_APPS_CC_FILTER_DETAIL_DIAGNOSTICS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+// Aggregated floating point diagnostics w.r.t. a block of correlation
+// coefficients
+//
+// - the floating point exception flags are tested once per block, only;
+// i.e. the floating point environment is not polled per sample
+// - anomalous coefficients are recorded by means of masks (i.e. without
+// branching) such that the coefficient loop remains vectorizable
+class CorrelationDiagnostics {
+ public:
+  // Starts monitoring a block of `n` samples. Clears the floating point
+  // exception flags.
+  void start(std::size_t n);
+  // Records the masks of the coefficient at sample index `idx` where
+  // `degenerate` refers to a coefficient with a zero (or non-finite)
+  // denominator and `nonFinite` to a non-finite coefficient
+  void record(std::size_t idx, bool degenerate, bool nonFinite) {
+    const bool anomalous{degenerate || nonFinite};
+    _numDegenerate += degenerate;
+    _numNonFinite += nonFinite;
+    _firstIdx = std::min(_firstIdx, anomalous ? idx : kNoIdx);
+    _lastIdx = std::max(_lastIdx, anomalous ? idx : std::size_t{0});
+  }
+  // Stops monitoring the block. Tests the floating point exception flags
+  // raised while monitoring (`FE_INEXACT` is ignored).
+  void stop();
+
+  // Returns `true` if either anomalous coefficients were recorded or floating
+  // point exceptions were raised, else `false`
+  bool anomalous() const;
+
+  // Returns the number of samples of the block
+  std::size_t size() const { return _n; }
+  // Returns the number of coefficients with a degenerate denominator
+  std::size_t numDegenerate() const { return _numDegenerate; }
+  // Returns the number of non-finite coefficients
+  std::size_t numNonFinite() const { return _numNonFinite; }
+  // Returns the index of the first anomalous coefficient
+  std::size_t firstIdx() const { return _firstIdx; }
+  // Returns the index of the last anomalous coefficient
+  std::size_t lastIdx() const { return _lastIdx; }
+  // Returns the floating point exception flags raised
+  int floatingPointExceptions() const { return _floatingPointExceptions; }
+
+ private:
+  static constexpr std::size_t kNoIdx{std::numeric_limits<std::size_t>::max()};
+
+  std::size_t _n{0};
+  std::size_t _numDegenerate{0};
+  std::size_t _numNonFinite{0};
+  std::size_t _firstIdx{kNoIdx};
+  std::size_t _lastIdx{0};
+
+  int _floatingPointExceptions{0};
+};
+
+// Returns a string describing the anomalies recorded by `diagnostics`
+std::string to_string(const CorrelationDiagnostics &diagnostics);
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_DETAIL_DIAGNOSTICS_H_
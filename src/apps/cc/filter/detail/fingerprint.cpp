@@ -0,0 +1,245 @@
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+namespace {
+
+// Computes the (full) Haar wavelet decomposition of the `n` samples of
+// `data` (with `stride` samples between subsequent samples) in place. `n`
+// must be a power of two.
+void haar(double *data, std::size_t n, std::size_t stride,
+          std::vector<double> &scratch) {
+  static const double kInvSqrt2{1 / std::sqrt(2.0)};
+  scratch.resize(n);
+  for (std::size_t length = n; length > 1; length /= 2) {
+    const auto half{length / 2};
+    for (std::size_t k = 0; k < half; ++k) {
+      const double lhs{data[2 * k * stride]};
+      const double rhs{data[(2 * k + 1) * stride]};
+      scratch[k] = (lhs + rhs) * kInvSqrt2;
+      scratch[half + k] = (lhs - rhs) * kInvSqrt2;
+    }
+    for (std::size_t k = 0; k < length; ++k) {
+      data[k * stride] = scratch[k];
+    }
+  }
+}
+
+}  // namespace
+
+constexpr std::size_t FingerprintExtractor::kFrames;
+constexpr std::size_t FingerprintExtractor::kBins;
+constexpr std::size_t FingerprintExtractor::kTopCoefficients;
+constexpr std::size_t FingerprintExtractor::kBits;
+
+FingerprintExtractor::FingerprintExtractor(std::size_t n)
+    : _n{n},
+      _frameLength{2 * (n / (kFrames + 1))},
+      _frameHop{n / (kFrames + 1)},
+      _fft{std::max(util::nextPowerOfTwo(_frameLength), 2 * kBins)},
+      _taper(_frameLength),
+      _frame(_fft.size()),
+      _image(kFrames * kBins) {
+  assert((n >= minWindowSize()));
+
+  const double pi{std::acos(-1.0)};
+  for (std::size_t k = 0; k < _frameLength; ++k) {
+    _taper[k] = 0.5 - 0.5 * std::cos(2 * pi * (k + 0.5) / _frameLength);
+  }
+}
+
+std::size_t FingerprintExtractor::windowSize() const { return _n; }
+
+std::size_t FingerprintExtractor::minWindowSize() {
+  return 2 * (kFrames + 1);
+}
+
+Fingerprint FingerprintExtractor::operator()(const double *samples) {
+  double mean{0};
+  for (std::size_t k = 0; k < _n; ++k) {
+    mean += samples[k];
+  }
+  mean /= static_cast<double>(_n);
+
+  // compute the spectral image; the positive frequencies (excluding the DC
+  // component) are averaged into `kBins` bins
+  const auto fftSize{_fft.size()};
+  const auto binWidth{fftSize / 2 / kBins};
+  for (std::size_t f = 0; f < kFrames; ++f) {
+    const double *frame{samples + f * _frameHop};
+    for (std::size_t k = 0; k < _frameLength; ++k) {
+      _frame[k] = util::Fft::Complex{(frame[k] - mean) * _taper[k], 0};
+    }
+    std::fill(_frame.begin() + _frameLength, _frame.end(),
+              util::Fft::Complex{0, 0});
+    _fft.forward(_frame.data());
+
+    double *row{_image.data() + f * kBins};
+    for (std::size_t b = 0; b < kBins; ++b) {
+      double amplitude{0};
+      for (std::size_t k = 0; k < binWidth; ++k) {
+        amplitude += std::abs(_frame[1 + b * binWidth + k]);
+      }
+      row[b] = amplitude;
+    }
+  }
+
+  // in contrast to FAST, the wavelet coefficients are not standardized w.r.t.
+  // the statistics of the data. Instead, the spectral image is demeaned per
+  // frequency bin (i.e. over time) such that the fingerprint reflects temporal
+  // changes of the spectral content rather than its (stationary) background.
+  for (std::size_t b = 0; b < kBins; ++b) {
+    double binMean{0};
+    for (std::size_t f = 0; f < kFrames; ++f) {
+      binMean += _image[f * kBins + b];
+    }
+    binMean /= static_cast<double>(kFrames);
+    for (std::size_t f = 0; f < kFrames; ++f) {
+      _image[f * kBins + b] -= binMean;
+    }
+  }
+
+  // two-dimensional (standard) Haar wavelet decomposition
+  for (std::size_t f = 0; f < kFrames; ++f) {
+    haar(_image.data() + f * kBins, kBins, 1, _haar);
+  }
+  for (std::size_t b = 0; b < kBins; ++b) {
+    haar(_image.data() + b, kFrames, kBins, _haar);
+  }
+
+  // select the coefficients with the largest magnitude
+  _indices.resize(_image.size());
+  for (std::size_t i = 0; i < _indices.size(); ++i) {
+    _indices[i] = static_cast<std::uint32_t>(i);
+  }
+  std::nth_element(_indices.begin(), _indices.begin() + kTopCoefficients,
+                   _indices.end(),
+                   [this](std::uint32_t lhs, std::uint32_t rhs) {
+                     return std::abs(_image[lhs]) > std::abs(_image[rhs]);
+                   });
+
+  Fingerprint ret;
+  ret.reserve(kTopCoefficients);
+  for (std::size_t i = 0; i < kTopCoefficients; ++i) {
+    const auto idx{_indices[i]};
+    if (_image[idx] > 0) {
+      ret.push_back(2 * idx);
+    } else if (_image[idx] < 0) {
+      ret.push_back(2 * idx + 1);
+    }
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+double jaccardSimilarity(const Fingerprint &lhs, const Fingerprint &rhs) {
+  std::size_t intersection{0};
+  auto lhsIt{lhs.begin()};
+  auto rhsIt{rhs.begin()};
+  while (lhsIt != lhs.end() && rhsIt != rhs.end()) {
+    if (*lhsIt < *rhsIt) {
+      ++lhsIt;
+    } else if (*rhsIt < *lhsIt) {
+      ++rhsIt;
+    } else {
+      ++intersection;
+      ++lhsIt;
+      ++rhsIt;
+    }
+  }
+
+  const auto unionSize{lhs.size() + rhs.size() - intersection};
+  return unionSize ? static_cast<double>(intersection) / unionSize : 1.0;
+}
+
+LshIndex::LshIndex(std::size_t hashTables, std::size_t hashFunctionsPerTable)
+    : _hashTables{hashTables},
+      _hashFunctionsPerTable{hashFunctionsPerTable},
+      _tables(hashTables),
+      _keys(hashTables) {
+  assert((hashTables > 0 && hashFunctionsPerTable > 0));
+
+  // use a fixed seed such that the hash functions are reproducible
+  constexpr std::uint64_t p{(std::uint64_t{1} << 31) - 1};
+  std::mt19937_64 generator{20150101};
+  std::uniform_int_distribution<std::uint64_t> distribution{1, p - 1};
+  const auto numHashFunctions{hashTables * hashFunctionsPerTable};
+  for (std::size_t j = 0; j < numHashFunctions; ++j) {
+    _a.push_back(distribution(generator));
+    _b.push_back(distribution(generator));
+  }
+}
+
+void LshIndex::add(const Fingerprint &fingerprint, std::size_t id) {
+  computeKeys(fingerprint);
+  for (std::size_t t = 0; t < _hashTables; ++t) {
+    auto &ids{_tables[t][_keys[t]]};
+    if (ids.empty() || ids.back() != id) {
+      ids.push_back(id);
+    }
+  }
+  _votes.resize(std::max(_votes.size(), id + 1), 0);
+  ++_size;
+}
+
+std::size_t LshIndex::size() const { return _size; }
+
+void LshIndex::query(const Fingerprint &fingerprint, std::size_t minVotes,
+                     std::vector<std::size_t> &candidates) {
+  computeKeys(fingerprint);
+
+  const auto begin{candidates.size()};
+  for (std::size_t t = 0; t < _hashTables; ++t) {
+    const auto it{_tables[t].find(_keys[t])};
+    if (it == _tables[t].end()) {
+      continue;
+    }
+    for (const auto id : it->second) {
+      if (++_votes[id] == minVotes) {
+        candidates.push_back(id);
+      }
+    }
+  }
+
+  // reset the votes
+  for (std::size_t t = 0; t < _hashTables; ++t) {
+    const auto it{_tables[t].find(_keys[t])};
+    if (it == _tables[t].end()) {
+      continue;
+    }
+    for (const auto id : it->second) {
+      _votes[id] = 0;
+    }
+  }
+  std::sort(candidates.begin() + begin, candidates.end());
+}
+
+void LshIndex::computeKeys(const Fingerprint &fingerprint) {
+  constexpr std::uint64_t p{(std::uint64_t{1} << 31) - 1};
+  for (std::size_t t = 0; t < _hashTables; ++t) {
+    std::uint64_t key{0};
+    for (std::size_t j = t * _hashFunctionsPerTable;
+         j < (t + 1) * _hashFunctionsPerTable; ++j) {
+      std::uint64_t minHash{p};
+      for (const auto bit : fingerprint) {
+        minHash = std::min(minHash, (_a[j] * bit + _b[j]) % p);
+      }
+      // combine the hash values (boost::hash_combine like)
+      key ^= minHash + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+    }
+    _keys[t] = key;
+  }
+}
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
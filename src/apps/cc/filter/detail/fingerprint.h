@@ -0,0 +1,121 @@
+#ifndef SCDETECT_APPS_CC_FILTER_DETAIL_FINGERPRINT_H_
+#define SCDETECT_APPS_CC_FILTER_DETAIL_FINGERPRINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/fft.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+// A binary waveform fingerprint represented by means of the (ascending)
+// indices of the bits set
+using Fingerprint = std::vector<std::uint32_t>;
+
+// Computes binary fingerprints of waveform windows (in the style of FAST,
+// Yoon et al., 2015)
+//
+// - the spectral image (i.e. the amplitude spectrogram) of the window is
+// computed by means of overlapping Hann tapered frames; the spectral image is
+// demeaned per frequency bin
+// - the spectral image is transformed by means of a two-dimensional Haar
+// wavelet transform; the fingerprint is made up of the signs of the
+// `kTopCoefficients` wavelet coefficients with the largest magnitude (two bits
+// per coefficient)
+// - fingerprints are invariant w.r.t. the waveform's amplitude
+class FingerprintExtractor {
+ public:
+  // The number of frames of the spectral image (power of two)
+  static constexpr std::size_t kFrames{32};
+  // The number of frequency bins of the spectral image (power of two)
+  static constexpr std::size_t kBins{32};
+  // The number of wavelet coefficients making up the fingerprint
+  static constexpr std::size_t kTopCoefficients{50};
+  // The number of bits of a fingerprint
+  static constexpr std::size_t kBits{2 * kFrames * kBins};
+
+  // Creates a fingerprint extractor for windows of `n` samples. It is a bug
+  // if `n` is less than `minWindowSize()`.
+  explicit FingerprintExtractor(std::size_t n);
+
+  // Returns the window size in samples
+  std::size_t windowSize() const;
+  // Returns the minimum window size in samples
+  static std::size_t minWindowSize();
+
+  // Computes the fingerprint of the window starting at `samples`
+  Fingerprint operator()(const double *samples);
+
+ private:
+  std::size_t _n;
+  std::size_t _frameLength;
+  std::size_t _frameHop;
+
+  util::Fft _fft;
+  std::vector<double> _taper;
+
+  // Scratch buffers
+  std::vector<util::Fft::Complex> _frame;
+  std::vector<double> _image;
+  std::vector<double> _haar;
+  std::vector<std::uint32_t> _indices;
+};
+
+// Returns the Jaccard similarity of the fingerprints `lhs` and `rhs`
+double jaccardSimilarity(const Fingerprint &lhs, const Fingerprint &rhs);
+
+// Locality-sensitive hashing (LSH) index of fingerprints based on MinHash
+//
+// - the MinHash signature of a fingerprint is split into `hashTables` bands
+// of `hashFunctionsPerTable` hash values; a band is used as key of its hash
+// table
+// - fingerprints sharing the key of a hash table vote for each other; the
+// probability of sharing a key is `J^hashFunctionsPerTable` where `J` refers
+// to the Jaccard similarity of the fingerprints
+class LshIndex {
+ public:
+  LshIndex(std::size_t hashTables = 100, std::size_t hashFunctionsPerTable = 3);
+
+  // Adds `fingerprint` identified by `id` to the index
+  void add(const Fingerprint &fingerprint, std::size_t id);
+  // Returns the number of fingerprints indexed
+  std::size_t size() const;
+
+  // Queries the index for `fingerprint`. Appends the identifiers of the
+  // fingerprints indexed with at least `minVotes` votes to `candidates`.
+  void query(const Fingerprint &fingerprint, std::size_t minVotes,
+             std::vector<std::size_t> &candidates);
+
+ private:
+  // Computes the keys (per hash table) of `fingerprint`
+  void computeKeys(const Fingerprint &fingerprint);
+
+  std::size_t _hashTables;
+  std::size_t _hashFunctionsPerTable;
+
+  // The parameters of the universal hash functions (`h(x) = (a * x + b) mod
+  // p`) approximating random permutations
+  std::vector<std::uint64_t> _a;
+  std::vector<std::uint64_t> _b;
+
+  using HashTable =
+      std::unordered_map<std::uint64_t, std::vector<std::size_t>>;
+  std::vector<HashTable> _tables;
+  std::size_t _size{0};
+
+  // Scratch buffers
+  std::vector<std::uint64_t> _keys;
+  std::vector<std::size_t> _votes;
+};
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_DETAIL_FINGERPRINT_H_
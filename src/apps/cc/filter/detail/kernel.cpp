@@ -0,0 +1,682 @@
+#include "kernel.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define SCDETECT_CC_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+namespace {
+
+// The number of subsequent lags computed per pass (register blocking) which
+// amortizes loading the template waveform samples
+constexpr std::size_t kLagBlockSize{4};
+// The number of template waveforms evaluated per pass (register blocking)
+// which amortizes loading the data samples
+constexpr std::size_t kTemplateBlockSize{4};
+
+double dotProduct(const double *templateWf, std::size_t n, const double *data) {
+  double ret{0};
+  for (std::size_t k = 0; k < n; ++k) {
+    ret += templateWf[k] * data[k];
+  }
+  return ret;
+}
+
+void dotProductsScalar(const double *templateWf, std::size_t n,
+                       const double *data, std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const double *d{data + j};
+    double s0{0};
+    double s1{0};
+    double s2{0};
+    double s3{0};
+    for (std::size_t k = 0; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+double dotProduct(const float *templateWf, std::size_t n, const float *data) {
+  double ret{0};
+  for (std::size_t k = 0; k < n; ++k) {
+    ret += static_cast<double>(templateWf[k]) * data[k];
+  }
+  return ret;
+}
+
+void dotProductsScalar(const float *templateWf, std::size_t n,
+                       const float *data, std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const float *d{data + j};
+    double s0{0};
+    double s1{0};
+    double s2{0};
+    double s3{0};
+    for (std::size_t k = 0; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+void matrixDotProductsScalar(const double *templateWfs, std::size_t nTemplates,
+                             std::size_t stride, std::size_t n,
+                             const double *data, std::size_t nLags,
+                             double *out) {
+  std::size_t i{0};
+  for (; i + kTemplateBlockSize <= nTemplates; i += kTemplateBlockSize) {
+    const double *t0{templateWfs + i * stride};
+    const double *t1{t0 + stride};
+    const double *t2{t1 + stride};
+    const double *t3{t2 + stride};
+    double *o{out + i * nLags};
+    for (std::size_t j = 0; j < nLags; ++j) {
+      const double *d{data + j};
+      double s0{0};
+      double s1{0};
+      double s2{0};
+      double s3{0};
+      for (std::size_t k = 0; k < n; ++k) {
+        const double x{d[k]};
+        s0 += t0[k] * x;
+        s1 += t1[k] * x;
+        s2 += t2[k] * x;
+        s3 += t3[k] * x;
+      }
+      o[j] = s0;
+      o[j + nLags] = s1;
+      o[j + 2 * nLags] = s2;
+      o[j + 3 * nLags] = s3;
+    }
+  }
+
+  for (; i < nTemplates; ++i) {
+    dotProductsScalar(templateWfs + i * stride, n, data, nLags,
+                      out + i * nLags);
+  }
+}
+
+#ifdef SCDETECT_CC_KERNEL_X86
+
+__attribute__((target("sse2"))) inline double horizontalSum(__m128d v) {
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("sse2"))) void dotProductsSSE2(const double *templateWf,
+                                                     std::size_t n,
+                                                     const double *data,
+                                                     std::size_t nLags,
+                                                     double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const double *d{data + j};
+    __m128d acc0{_mm_setzero_pd()};
+    __m128d acc1{_mm_setzero_pd()};
+    __m128d acc2{_mm_setzero_pd()};
+    __m128d acc3{_mm_setzero_pd()};
+    std::size_t k{0};
+    for (; k + 2 <= n; k += 2) {
+      const __m128d t{_mm_loadu_pd(templateWf + k)};
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(t, _mm_loadu_pd(d + k)));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(t, _mm_loadu_pd(d + k + 1)));
+      acc2 = _mm_add_pd(acc2, _mm_mul_pd(t, _mm_loadu_pd(d + k + 2)));
+      acc3 = _mm_add_pd(acc3, _mm_mul_pd(t, _mm_loadu_pd(d + k + 3)));
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("sse2"))) inline double horizontalSum(__m128 v) {
+  alignas(64) float tmp[4];
+  _mm_store_ps(tmp, v);
+  double ret{0};
+  for (std::size_t i = 0; i < 4; ++i) {
+    ret += tmp[i];
+  }
+  return ret;
+}
+
+__attribute__((target("sse2"))) void dotProductsSSE2(const float *templateWf,
+                                                     std::size_t n,
+                                                     const float *data,
+                                                     std::size_t nLags,
+                                                     double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const float *d{data + j};
+    __m128 acc0{_mm_setzero_ps()};
+    __m128 acc1{_mm_setzero_ps()};
+    __m128 acc2{_mm_setzero_ps()};
+    __m128 acc3{_mm_setzero_ps()};
+    std::size_t k{0};
+    for (; k + 4 <= n; k += 4) {
+      const __m128 t{_mm_loadu_ps(templateWf + k)};
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(t, _mm_loadu_ps(d + k)));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(t, _mm_loadu_ps(d + k + 1)));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(t, _mm_loadu_ps(d + k + 2)));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(t, _mm_loadu_ps(d + k + 3)));
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("sse2"))) void matrixDotProductsSSE2(
+    const double *templateWfs, std::size_t nTemplates, std::size_t stride,
+    std::size_t n, const double *data, std::size_t nLags, double *out) {
+  std::size_t i{0};
+  for (; i + kTemplateBlockSize <= nTemplates; i += kTemplateBlockSize) {
+    const double *t0{templateWfs + i * stride};
+    const double *t1{t0 + stride};
+    const double *t2{t1 + stride};
+    const double *t3{t2 + stride};
+    double *o{out + i * nLags};
+    for (std::size_t j = 0; j < nLags; ++j) {
+      const double *d{data + j};
+      __m128d acc0{_mm_setzero_pd()};
+      __m128d acc1{_mm_setzero_pd()};
+      __m128d acc2{_mm_setzero_pd()};
+      __m128d acc3{_mm_setzero_pd()};
+      std::size_t k{0};
+      for (; k + 2 <= n; k += 2) {
+        const __m128d x{_mm_loadu_pd(d + k)};
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(t0 + k), x));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(t1 + k), x));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(t2 + k), x));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(t3 + k), x));
+      }
+      double s0{horizontalSum(acc0)};
+      double s1{horizontalSum(acc1)};
+      double s2{horizontalSum(acc2)};
+      double s3{horizontalSum(acc3)};
+      for (; k < n; ++k) {
+        const double x{d[k]};
+        s0 += t0[k] * x;
+        s1 += t1[k] * x;
+        s2 += t2[k] * x;
+        s3 += t3[k] * x;
+      }
+      o[j] = s0;
+      o[j + nLags] = s1;
+      o[j + 2 * nLags] = s2;
+      o[j + 3 * nLags] = s3;
+    }
+  }
+
+  for (; i < nTemplates; ++i) {
+    dotProductsSSE2(templateWfs + i * stride, n, data, nLags, out + i * nLags);
+  }
+}
+
+__attribute__((target("avx2,fma"))) inline double horizontalSum(__m256d v) {
+  const __m128d sum{
+      _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1))};
+  return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+__attribute__((target("avx2,fma"))) void dotProductsAVX2(
+    const double *templateWf, std::size_t n, const double *data,
+    std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const double *d{data + j};
+    __m256d acc0{_mm256_setzero_pd()};
+    __m256d acc1{_mm256_setzero_pd()};
+    __m256d acc2{_mm256_setzero_pd()};
+    __m256d acc3{_mm256_setzero_pd()};
+    std::size_t k{0};
+    for (; k + 4 <= n; k += 4) {
+      const __m256d t{_mm256_loadu_pd(templateWf + k)};
+      acc0 = _mm256_fmadd_pd(t, _mm256_loadu_pd(d + k), acc0);
+      acc1 = _mm256_fmadd_pd(t, _mm256_loadu_pd(d + k + 1), acc1);
+      acc2 = _mm256_fmadd_pd(t, _mm256_loadu_pd(d + k + 2), acc2);
+      acc3 = _mm256_fmadd_pd(t, _mm256_loadu_pd(d + k + 3), acc3);
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("avx2,fma"))) inline double horizontalSum(__m256 v) {
+  alignas(64) float tmp[8];
+  _mm256_store_ps(tmp, v);
+  double ret{0};
+  for (std::size_t i = 0; i < 8; ++i) {
+    ret += tmp[i];
+  }
+  return ret;
+}
+
+__attribute__((target("avx2,fma"))) void dotProductsAVX2(
+    const float *templateWf, std::size_t n, const float *data,
+    std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const float *d{data + j};
+    __m256 acc0{_mm256_setzero_ps()};
+    __m256 acc1{_mm256_setzero_ps()};
+    __m256 acc2{_mm256_setzero_ps()};
+    __m256 acc3{_mm256_setzero_ps()};
+    std::size_t k{0};
+    for (; k + 8 <= n; k += 8) {
+      const __m256 t{_mm256_loadu_ps(templateWf + k)};
+      acc0 = _mm256_fmadd_ps(t, _mm256_loadu_ps(d + k), acc0);
+      acc1 = _mm256_fmadd_ps(t, _mm256_loadu_ps(d + k + 1), acc1);
+      acc2 = _mm256_fmadd_ps(t, _mm256_loadu_ps(d + k + 2), acc2);
+      acc3 = _mm256_fmadd_ps(t, _mm256_loadu_ps(d + k + 3), acc3);
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("avx2,fma"))) void matrixDotProductsAVX2(
+    const double *templateWfs, std::size_t nTemplates, std::size_t stride,
+    std::size_t n, const double *data, std::size_t nLags, double *out) {
+  std::size_t i{0};
+  for (; i + kTemplateBlockSize <= nTemplates; i += kTemplateBlockSize) {
+    const double *t0{templateWfs + i * stride};
+    const double *t1{t0 + stride};
+    const double *t2{t1 + stride};
+    const double *t3{t2 + stride};
+    double *o{out + i * nLags};
+    for (std::size_t j = 0; j < nLags; ++j) {
+      const double *d{data + j};
+      __m256d acc0{_mm256_setzero_pd()};
+      __m256d acc1{_mm256_setzero_pd()};
+      __m256d acc2{_mm256_setzero_pd()};
+      __m256d acc3{_mm256_setzero_pd()};
+      std::size_t k{0};
+      for (; k + 4 <= n; k += 4) {
+        const __m256d x{_mm256_loadu_pd(d + k)};
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(t0 + k), x, acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(t1 + k), x, acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(t2 + k), x, acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(t3 + k), x, acc3);
+      }
+      double s0{horizontalSum(acc0)};
+      double s1{horizontalSum(acc1)};
+      double s2{horizontalSum(acc2)};
+      double s3{horizontalSum(acc3)};
+      for (; k < n; ++k) {
+        const double x{d[k]};
+        s0 += t0[k] * x;
+        s1 += t1[k] * x;
+        s2 += t2[k] * x;
+        s3 += t3[k] * x;
+      }
+      o[j] = s0;
+      o[j + nLags] = s1;
+      o[j + 2 * nLags] = s2;
+      o[j + 3 * nLags] = s3;
+    }
+  }
+
+  for (; i < nTemplates; ++i) {
+    dotProductsAVX2(templateWfs + i * stride, n, data, nLags, out + i * nLags);
+  }
+}
+
+__attribute__((target("avx512f"))) inline double horizontalSum(__m512d v) {
+  alignas(64) double tmp[8];
+  _mm512_store_pd(tmp, v);
+  return ((tmp[0] + tmp[1]) + (tmp[2] + tmp[3])) +
+         ((tmp[4] + tmp[5]) + (tmp[6] + tmp[7]));
+}
+
+__attribute__((target("avx512f"))) void dotProductsAVX512(
+    const double *templateWf, std::size_t n, const double *data,
+    std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const double *d{data + j};
+    __m512d acc0{_mm512_setzero_pd()};
+    __m512d acc1{_mm512_setzero_pd()};
+    __m512d acc2{_mm512_setzero_pd()};
+    __m512d acc3{_mm512_setzero_pd()};
+    std::size_t k{0};
+    for (; k + 8 <= n; k += 8) {
+      const __m512d t{_mm512_loadu_pd(templateWf + k)};
+      acc0 = _mm512_fmadd_pd(t, _mm512_loadu_pd(d + k), acc0);
+      acc1 = _mm512_fmadd_pd(t, _mm512_loadu_pd(d + k + 1), acc1);
+      acc2 = _mm512_fmadd_pd(t, _mm512_loadu_pd(d + k + 2), acc2);
+      acc3 = _mm512_fmadd_pd(t, _mm512_loadu_pd(d + k + 3), acc3);
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("avx512f"))) inline double horizontalSum(__m512 v) {
+  alignas(64) float tmp[16];
+  _mm512_store_ps(tmp, v);
+  double ret{0};
+  for (std::size_t i = 0; i < 16; ++i) {
+    ret += tmp[i];
+  }
+  return ret;
+}
+
+__attribute__((target("avx512f"))) void dotProductsAVX512(
+    const float *templateWf, std::size_t n, const float *data,
+    std::size_t nLags, double *out) {
+  std::size_t j{0};
+  for (; j + kLagBlockSize <= nLags; j += kLagBlockSize) {
+    const float *d{data + j};
+    __m512 acc0{_mm512_setzero_ps()};
+    __m512 acc1{_mm512_setzero_ps()};
+    __m512 acc2{_mm512_setzero_ps()};
+    __m512 acc3{_mm512_setzero_ps()};
+    std::size_t k{0};
+    for (; k + 16 <= n; k += 16) {
+      const __m512 t{_mm512_loadu_ps(templateWf + k)};
+      acc0 = _mm512_fmadd_ps(t, _mm512_loadu_ps(d + k), acc0);
+      acc1 = _mm512_fmadd_ps(t, _mm512_loadu_ps(d + k + 1), acc1);
+      acc2 = _mm512_fmadd_ps(t, _mm512_loadu_ps(d + k + 2), acc2);
+      acc3 = _mm512_fmadd_ps(t, _mm512_loadu_ps(d + k + 3), acc3);
+    }
+    double s0{horizontalSum(acc0)};
+    double s1{horizontalSum(acc1)};
+    double s2{horizontalSum(acc2)};
+    double s3{horizontalSum(acc3)};
+    for (; k < n; ++k) {
+      const double t{templateWf[k]};
+      s0 += t * d[k];
+      s1 += t * d[k + 1];
+      s2 += t * d[k + 2];
+      s3 += t * d[k + 3];
+    }
+    out[j] = s0;
+    out[j + 1] = s1;
+    out[j + 2] = s2;
+    out[j + 3] = s3;
+  }
+
+  for (; j < nLags; ++j) {
+    out[j] = dotProduct(templateWf, n, data + j);
+  }
+}
+
+__attribute__((target("avx512f"))) void matrixDotProductsAVX512(
+    const double *templateWfs, std::size_t nTemplates, std::size_t stride,
+    std::size_t n, const double *data, std::size_t nLags, double *out) {
+  std::size_t i{0};
+  for (; i + kTemplateBlockSize <= nTemplates; i += kTemplateBlockSize) {
+    const double *t0{templateWfs + i * stride};
+    const double *t1{t0 + stride};
+    const double *t2{t1 + stride};
+    const double *t3{t2 + stride};
+    double *o{out + i * nLags};
+    for (std::size_t j = 0; j < nLags; ++j) {
+      const double *d{data + j};
+      __m512d acc0{_mm512_setzero_pd()};
+      __m512d acc1{_mm512_setzero_pd()};
+      __m512d acc2{_mm512_setzero_pd()};
+      __m512d acc3{_mm512_setzero_pd()};
+      std::size_t k{0};
+      for (; k + 8 <= n; k += 8) {
+        const __m512d x{_mm512_loadu_pd(d + k)};
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(t0 + k), x, acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(t1 + k), x, acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(t2 + k), x, acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(t3 + k), x, acc3);
+      }
+      double s0{horizontalSum(acc0)};
+      double s1{horizontalSum(acc1)};
+      double s2{horizontalSum(acc2)};
+      double s3{horizontalSum(acc3)};
+      for (; k < n; ++k) {
+        const double x{d[k]};
+        s0 += t0[k] * x;
+        s1 += t1[k] * x;
+        s2 += t2[k] * x;
+        s3 += t3[k] * x;
+      }
+      o[j] = s0;
+      o[j + nLags] = s1;
+      o[j + 2 * nLags] = s2;
+      o[j + 3 * nLags] = s3;
+    }
+  }
+
+  for (; i < nTemplates; ++i) {
+    dotProductsAVX512(templateWfs + i * stride, n, data, nLags,
+                      out + i * nLags);
+  }
+}
+
+#endif
+
+InstructionSet detectInstructionSetImpl() {
+#ifdef SCDETECT_CC_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return InstructionSet::kAVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return InstructionSet::kAVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return InstructionSet::kSSE2;
+  }
+#endif
+  return InstructionSet::kScalar;
+}
+
+template <typename T>
+DotProductsKernel<T> dotProductsKernelImpl(InstructionSet instructionSet) {
+  if (static_cast<int>(instructionSet) >
+      static_cast<int>(detectInstructionSet())) {
+    return dotProductsScalar;
+  }
+
+#ifdef SCDETECT_CC_KERNEL_X86
+  switch (instructionSet) {
+    case InstructionSet::kSSE2:
+      return dotProductsSSE2;
+    case InstructionSet::kAVX2:
+      return dotProductsAVX2;
+    case InstructionSet::kAVX512:
+      return dotProductsAVX512;
+    default:
+      break;
+  }
+#endif
+  return dotProductsScalar;
+}
+
+}  // namespace
+
+std::string to_string(InstructionSet instructionSet) {
+  switch (instructionSet) {
+    case InstructionSet::kSSE2:
+      return "SSE2";
+    case InstructionSet::kAVX2:
+      return "AVX2";
+    case InstructionSet::kAVX512:
+      return "AVX-512";
+    case InstructionSet::kScalar:
+    default:
+      return "scalar";
+  }
+}
+
+InstructionSet detectInstructionSet() {
+  static const InstructionSet ret{detectInstructionSetImpl()};
+  return ret;
+}
+
+template <>
+DotProductsKernel<double> dotProductsKernel<double>(
+    InstructionSet instructionSet) {
+  return dotProductsKernelImpl<double>(instructionSet);
+}
+
+template <>
+DotProductsKernel<double> dotProductsKernel<double>() {
+  static const DotProductsKernel<double> ret{
+      dotProductsKernel<double>(detectInstructionSet())};
+  return ret;
+}
+
+template <>
+DotProductsKernel<float> dotProductsKernel<float>(
+    InstructionSet instructionSet) {
+  return dotProductsKernelImpl<float>(instructionSet);
+}
+
+template <>
+DotProductsKernel<float> dotProductsKernel<float>() {
+  static const DotProductsKernel<float> ret{
+      dotProductsKernel<float>(detectInstructionSet())};
+  return ret;
+}
+
+MatrixDotProductsKernel matrixDotProductsKernel(InstructionSet instructionSet) {
+  if (static_cast<int>(instructionSet) >
+      static_cast<int>(detectInstructionSet())) {
+    return matrixDotProductsScalar;
+  }
+
+#ifdef SCDETECT_CC_KERNEL_X86
+  switch (instructionSet) {
+    case InstructionSet::kSSE2:
+      return matrixDotProductsSSE2;
+    case InstructionSet::kAVX2:
+      return matrixDotProductsAVX2;
+    case InstructionSet::kAVX512:
+      return matrixDotProductsAVX512;
+    default:
+      break;
+  }
+#endif
+  return matrixDotProductsScalar;
+}
+
+MatrixDotProductsKernel matrixDotProductsKernel() {
+  static const MatrixDotProductsKernel ret{
+      matrixDotProductsKernel(detectInstructionSet())};
+  return ret;
+}
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,88 @@
+#ifndef SCDETECT_APPS_CC_FILTER_DETAIL_KERNEL_H_
+#define SCDETECT_APPS_CC_FILTER_DETAIL_KERNEL_H_
+
+#include <cstddef>
+#include <string>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+// Computes the dot products between `templateWf` (of length `n`) and `data`
+// for `nLags` subsequent lags, i.e.
+//
+//   out[j] = sum(templateWf[k] * data[j + k]) for k=0 until k=n-1
+//
+// - `data` must provide at least `n + nLags - 1` samples
+// - vectorized kernels operating on single precision samples accumulate the
+// products in single precision, too; the partial sums are reduced in double
+// precision
+template <typename T>
+using DotProductsKernel = void (*)(const T *templateWf, std::size_t n,
+                                   const T *data, std::size_t nLags,
+                                   double *out);
+
+// Computes the dot products between each of the `nTemplates` template
+// waveforms (of length `n`) and `data` for `nLags` subsequent lags, i.e.
+//
+//   out[i * nLags + j] = sum(templateWfs[i * stride + k] * data[j + k])
+//     for k=0 until k=n-1
+//
+// - the template waveforms are stored row-wise where `stride` refers to the
+// number of samples between subsequent rows (`stride >= n`)
+// - `data` must provide at least `n + nLags - 1` samples
+using MatrixDotProductsKernel = void (*)(const double *templateWfs,
+                                         std::size_t nTemplates,
+                                         std::size_t stride, std::size_t n,
+                                         const double *data, std::size_t nLags,
+                                         double *out);
+
+// Instruction set a kernel is implemented with
+enum class InstructionSet {
+  // Portable implementation
+  kScalar,
+  kSSE2,
+  kAVX2,
+  kAVX512,
+};
+
+std::string to_string(InstructionSet instructionSet);
+
+// Returns the most capable instruction set supported by both the host CPU and
+// the compiler. The CPU features are detected once.
+InstructionSet detectInstructionSet();
+
+// Returns the dot products kernel implemented with `instructionSet`. If
+// `instructionSet` is not supported, the portable kernel is returned.
+template <typename T>
+DotProductsKernel<T> dotProductsKernel(InstructionSet instructionSet);
+// Returns the dot products kernel for the instruction set detected by means
+// of `detectInstructionSet()`
+template <typename T>
+DotProductsKernel<T> dotProductsKernel();
+
+template <>
+DotProductsKernel<double> dotProductsKernel<double>(
+    InstructionSet instructionSet);
+template <>
+DotProductsKernel<double> dotProductsKernel<double>();
+template <>
+DotProductsKernel<float> dotProductsKernel<float>(
+    InstructionSet instructionSet);
+template <>
+DotProductsKernel<float> dotProductsKernel<float>();
+
+// Returns the matrix dot products kernel implemented with `instructionSet`.
+// If `instructionSet` is not supported, the portable kernel is returned.
+MatrixDotProductsKernel matrixDotProductsKernel(InstructionSet instructionSet);
+// Returns the matrix dot products kernel for the instruction set detected by
+// means of `detectInstructionSet()`
+MatrixDotProductsKernel matrixDotProductsKernel();
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_DETAIL_KERNEL_H_
@@ -0,0 +1,351 @@
+#include "subspace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+namespace {
+
+// Reduces the symmetric matrix `v` to tridiagonal form by means of Householder
+// transformations (`d`: diagonal, `e`: subdiagonal) and accumulates the
+// transformations in `v`
+//
+// - adopted from the public domain JAMA library (which in turn is derived
+// from the EISPACK routine `tred2`)
+void tridiagonalize(std::vector<double> &v, std::ptrdiff_t n,
+                    std::vector<double> &d, std::vector<double> &e) {
+  const auto at = [&v, n](std::ptrdiff_t i, std::ptrdiff_t j) -> double & {
+    return v[i * n + j];
+  };
+
+  for (std::ptrdiff_t j = 0; j < n; ++j) {
+    d[j] = at(n - 1, j);
+  }
+
+  for (std::ptrdiff_t i = n - 1; i > 0; --i) {
+    double scale{0};
+    double h{0};
+    for (std::ptrdiff_t k = 0; k < i; ++k) {
+      scale += std::abs(d[k]);
+    }
+
+    if (scale == 0) {
+      e[i] = d[i - 1];
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        d[j] = at(i - 1, j);
+        at(i, j) = 0;
+        at(j, i) = 0;
+      }
+    } else {
+      for (std::ptrdiff_t k = 0; k < i; ++k) {
+        d[k] /= scale;
+        h += d[k] * d[k];
+      }
+      double f{d[i - 1]};
+      double g{std::sqrt(h)};
+      if (f > 0) {
+        g = -g;
+      }
+      e[i] = scale * g;
+      h -= f * g;
+      d[i - 1] = f - g;
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        e[j] = 0;
+      }
+
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        f = d[j];
+        at(j, i) = f;
+        g = e[j] + at(j, j) * f;
+        for (std::ptrdiff_t k = j + 1; k <= i - 1; ++k) {
+          g += at(k, j) * d[k];
+          e[k] += at(k, j) * f;
+        }
+        e[j] = g;
+      }
+      f = 0;
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        e[j] /= h;
+        f += e[j] * d[j];
+      }
+      const double hh{f / (h + h)};
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        e[j] -= hh * d[j];
+      }
+      for (std::ptrdiff_t j = 0; j < i; ++j) {
+        f = d[j];
+        g = e[j];
+        for (std::ptrdiff_t k = j; k <= i - 1; ++k) {
+          at(k, j) -= (f * e[k] + g * d[k]);
+        }
+        d[j] = at(i - 1, j);
+        at(i, j) = 0;
+      }
+    }
+    d[i] = h;
+  }
+
+  // accumulate the transformations
+  for (std::ptrdiff_t i = 0; i < n - 1; ++i) {
+    at(n - 1, i) = at(i, i);
+    at(i, i) = 1;
+    const double h{d[i + 1]};
+    if (h != 0) {
+      for (std::ptrdiff_t k = 0; k <= i; ++k) {
+        d[k] = at(k, i + 1) / h;
+      }
+      for (std::ptrdiff_t j = 0; j <= i; ++j) {
+        double g{0};
+        for (std::ptrdiff_t k = 0; k <= i; ++k) {
+          g += at(k, i + 1) * at(k, j);
+        }
+        for (std::ptrdiff_t k = 0; k <= i; ++k) {
+          at(k, j) -= g * d[k];
+        }
+      }
+    }
+    for (std::ptrdiff_t k = 0; k <= i; ++k) {
+      at(k, i + 1) = 0;
+    }
+  }
+  for (std::ptrdiff_t j = 0; j < n; ++j) {
+    d[j] = at(n - 1, j);
+    at(n - 1, j) = 0;
+  }
+  at(n - 1, n - 1) = 1;
+  e[0] = 0;
+}
+
+// Computes the eigenvalues `d` and eigenvectors `v` of the symmetric
+// tridiagonal matrix (`d`: diagonal, `e`: subdiagonal) by means of the
+// implicit QL algorithm
+//
+// - adopted from the public domain JAMA library (which in turn is derived
+// from the EISPACK routine `tql2`)
+void diagonalize(std::vector<double> &v, std::ptrdiff_t n,
+                 std::vector<double> &d, std::vector<double> &e) {
+  const auto at = [&v, n](std::ptrdiff_t i, std::ptrdiff_t j) -> double & {
+    return v[i * n + j];
+  };
+
+  for (std::ptrdiff_t i = 1; i < n; ++i) {
+    e[i - 1] = e[i];
+  }
+  e[n - 1] = 0;
+
+  double f{0};
+  double tst1{0};
+  const double eps{std::numeric_limits<double>::epsilon()};
+  for (std::ptrdiff_t l = 0; l < n; ++l) {
+    // find small subdiagonal element
+    tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+    std::ptrdiff_t m{l};
+    while (m < n - 1 && std::abs(e[m]) > eps * tst1) {
+      ++m;
+    }
+
+    // if m == l, d[l] is an eigenvalue; else, iterate
+    if (m > l) {
+      do {
+        // compute implicit shift
+        double g{d[l]};
+        double p{(d[l + 1] - g) / (2 * e[l])};
+        double r{std::hypot(p, 1.0)};
+        if (p < 0) {
+          r = -r;
+        }
+        d[l] = e[l] / (p + r);
+        d[l + 1] = e[l] * (p + r);
+        const double dl1{d[l + 1]};
+        double h{g - d[l]};
+        for (std::ptrdiff_t i = l + 2; i < n; ++i) {
+          d[i] -= h;
+        }
+        f += h;
+
+        // implicit QL transformation
+        p = d[m];
+        double c{1};
+        double c2{c};
+        double c3{c};
+        const double el1{e[l + 1]};
+        double s{0};
+        double s2{0};
+        for (std::ptrdiff_t i = m - 1; i >= l; --i) {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          h = c * p;
+          r = std::hypot(p, e[i]);
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = p / r;
+          p = c * d[i] - s * g;
+          d[i + 1] = h + s * (c * g + s * d[i]);
+
+          // accumulate transformation
+          for (std::ptrdiff_t k = 0; k < n; ++k) {
+            h = at(k, i + 1);
+            at(k, i + 1) = s * at(k, i) + c * h;
+            at(k, i) = c * at(k, i) - s * h;
+          }
+        }
+        p = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * p;
+        d[l] = c * p;
+      } while (std::abs(e[l]) > eps * tst1);
+    }
+    d[l] += f;
+    e[l] = 0;
+  }
+}
+
+}  // namespace
+
+Subspace computeSubspace(const double *templateWfs, std::size_t nTemplates,
+                         std::size_t stride, std::size_t n,
+                         double energyFraction) {
+  assert((stride >= n));
+  assert((energyFraction > 0 && energyFraction <= 1));
+
+  Subspace ret;
+  if (!nTemplates || !n) {
+    return ret;
+  }
+
+  const auto dot = [n](const double *lhs, const double *rhs) {
+    double ret{0};
+    for (std::size_t k = 0; k < n; ++k) {
+      ret += lhs[k] * rhs[k];
+    }
+    return ret;
+  };
+
+  // the right singular vectors are computed by means of the eigendecomposition
+  // of the smaller one of the Gram matrices (i.e. either A * A^T or A^T * A)
+  const bool byTemplates{nTemplates <= n};
+  const std::size_t m{byTemplates ? nTemplates : n};
+  std::vector<double> gram(m * m);
+  if (byTemplates) {
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t j = 0; j <= i; ++j) {
+        gram[i * m + j] = gram[j * m + i] =
+            dot(templateWfs + i * stride, templateWfs + j * stride);
+      }
+    }
+  } else {
+    for (std::size_t r = 0; r < nTemplates; ++r) {
+      const double *row{templateWfs + r * stride};
+      for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j <= i; ++j) {
+          gram[i * m + j] += row[i] * row[j];
+        }
+      }
+    }
+    for (std::size_t i = 0; i < m; ++i) {
+      for (std::size_t j = 0; j < i; ++j) {
+        gram[j * m + i] = gram[i * m + j];
+      }
+    }
+  }
+
+  std::vector<double> eigenvalues;
+  symmetricEigen(gram, m, eigenvalues);
+  for (auto &eigenvalue : eigenvalues) {
+    eigenvalue = std::max(0.0, eigenvalue);
+  }
+
+  const double energy{
+      std::accumulate(eigenvalues.begin(), eigenvalues.end(), 0.0)};
+  if (!(energy > 0)) {
+    return ret;
+  }
+
+  // eigenvalues below the tolerance are due to rounding errors, only
+  const double tolerance{eigenvalues.front() * static_cast<double>(m) *
+                         std::numeric_limits<double>::epsilon()};
+  double captured{0};
+  while (ret.dimension < m && eigenvalues[ret.dimension] > tolerance &&
+         captured < energyFraction * energy) {
+    captured += eigenvalues[ret.dimension];
+    ++ret.dimension;
+  }
+  ret.energyFraction = captured / energy;
+
+  ret.basis.assign(ret.dimension * stride, 0);
+  for (std::size_t j = 0; j < ret.dimension; ++j) {
+    double *basisVector{ret.basis.data() + j * stride};
+    if (byTemplates) {
+      // u_j = A^T * v_j / sigma_j
+      const double sigma{std::sqrt(eigenvalues[j])};
+      for (std::size_t r = 0; r < nTemplates; ++r) {
+        const double weight{gram[r * m + j] / sigma};
+        const double *row{templateWfs + r * stride};
+        for (std::size_t k = 0; k < n; ++k) {
+          basisVector[k] += weight * row[k];
+        }
+      }
+    } else {
+      for (std::size_t k = 0; k < n; ++k) {
+        basisVector[k] = gram[k * m + j];
+      }
+    }
+  }
+
+  ret.coefficients.resize(nTemplates * ret.dimension);
+  for (std::size_t r = 0; r < nTemplates; ++r) {
+    for (std::size_t j = 0; j < ret.dimension; ++j) {
+      ret.coefficients[r * ret.dimension + j] =
+          dot(templateWfs + r * stride, ret.basis.data() + j * stride);
+    }
+  }
+
+  return ret;
+}
+
+void symmetricEigen(std::vector<double> &a, std::size_t n,
+                    std::vector<double> &eigenvalues) {
+  assert((a.size() == n * n));
+
+  eigenvalues.assign(n, 0);
+  if (!n) {
+    return;
+  }
+
+  const auto nSigned{static_cast<std::ptrdiff_t>(n)};
+  std::vector<double> subdiagonal(n);
+  tridiagonalize(a, nSigned, eigenvalues, subdiagonal);
+  diagonalize(a, nSigned, eigenvalues, subdiagonal);
+
+  // sort in descending order (w.r.t. the eigenvalues)
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&eigenvalues](std::size_t lhs, std::size_t rhs) {
+              return eigenvalues[lhs] > eigenvalues[rhs];
+            });
+
+  std::vector<double> sortedEigenvalues(n);
+  std::vector<double> sortedEigenvectors(n * n);
+  for (std::size_t j = 0; j < n; ++j) {
+    sortedEigenvalues[j] = eigenvalues[order[j]];
+    for (std::size_t i = 0; i < n; ++i) {
+      sortedEigenvectors[i * n + j] = a[i * n + order[j]];
+    }
+  }
+  eigenvalues = std::move(sortedEigenvalues);
+  a = std::move(sortedEigenvectors);
+}
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
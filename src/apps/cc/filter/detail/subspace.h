@@ -0,0 +1,57 @@
+#ifndef SCDETECT_APPS_CC_FILTER_DETAIL_SUBSPACE_H_
+#define SCDETECT_APPS_CC_FILTER_DETAIL_SUBSPACE_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+namespace detail {
+
+// Truncated singular value decomposition based representation of a set of
+// equally sized template waveforms, i.e.
+//
+//   templateWfs[i] ~ sum(coefficients[i * dimension + j] * basis[j])
+//     for j=0 until j=dimension-1
+//
+struct Subspace {
+  // The subspace dimension (i.e. the number of basis vectors)
+  std::size_t dimension{0};
+  // The orthonormal basis vectors (i.e. the right singular vectors
+  // corresponding to the largest singular values) stored row-wise
+  std::vector<double> basis;
+  // The coefficients of the template waveforms w.r.t. the basis vectors
+  // (row-wise, i.e. per template waveform)
+  std::vector<double> coefficients;
+  // The fraction of the template waveforms' energy captured by the subspace
+  double energyFraction{0};
+};
+
+// Computes the subspace spanned by the `nTemplates` template waveforms (of
+// length `n`) stored row-wise in `templateWfs` (with `stride` samples between
+// subsequent rows). The subspace dimension is the smallest dimension
+// capturing at least `energyFraction` of the template waveforms' energy.
+//
+// - the basis vectors are stored with `stride` samples between subsequent
+// rows (zero-padded)
+// - `energyFraction` must be in the range (0, 1]
+Subspace computeSubspace(const double *templateWfs, std::size_t nTemplates,
+                         std::size_t stride, std::size_t n,
+                         double energyFraction);
+
+// Computes the eigenvalues and eigenvectors of the symmetric `n` x `n` matrix
+// `a` (row-major) by means of Householder tridiagonalization followed by the
+// implicit QL algorithm
+//
+// - on return, `a` is overwritten by the eigenvectors (column-wise) and
+// `eigenvalues` holds the corresponding eigenvalues in descending order
+void symmetricEigen(std::vector<double> &a, std::size_t n,
+                    std::vector<double> &eigenvalues);
+
+}  // namespace detail
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_DETAIL_SUBSPACE_H_
@@ -0,0 +1,61 @@
+#ifndef SCDETECT_APPS_CC_FILTER_LOCALMAXIMA_H_
+#define SCDETECT_APPS_CC_FILTER_LOCALMAXIMA_H_
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace filter {
+
+// Detects the local maxima of a sequence of correlation coefficients fed
+// coefficient by coefficient
+//
+// - non-finite coefficients are ignored
+// - local maxima less than `threshold` are not stored (i.e. the threshold
+// acts as a floor)
+struct LocalMaxima {
+  struct Value {
+    double coefficient;
+    std::size_t lagIdx;
+  };
+
+  using Values = std::vector<Value>;
+  Values values;
+
+  // The floor (by default, all local maxima are stored)
+  double threshold{std::numeric_limits<double>::lowest()};
+
+  double prevCoefficient{-1};
+  bool notDecreasing{false};
+
+  void feed(double coefficient, std::size_t lagIdx) {
+    if (!std::isfinite(coefficient)) {
+      return;
+    }
+
+    if (coefficient < prevCoefficient && notDecreasing &&
+        prevCoefficient >= threshold) {
+      values.push_back({prevCoefficient, --lagIdx});
+    }
+
+    notDecreasing = coefficient >= prevCoefficient;
+    prevCoefficient = coefficient;
+  }
+
+  // Resets the detection state and drops the local maxima stored (the
+  // threshold is kept)
+  void reset() {
+    values.clear();
+    prevCoefficient = -1;
+    notDecreasing = false;
+  }
+};
+
+}  // namespace filter
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTER_LOCALMAXIMA_H_
@@ -0,0 +1,71 @@
+#include "filterstore.h"
+
+namespace Seiscomp {
+namespace detect {
+
+FilterStore &FilterStore::Instance() {
+  // guaranteed to be destroyed; instantiated on first use
+  static FilterStore instance;
+  return instance;
+}
+
+std::unique_ptr<DoubleFilter> FilterStore::get(const std::string &filterId,
+                                               std::string *err) {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  auto it{lookup(filterId, err)};
+  if (it == _cache.end()) {
+    return nullptr;
+  }
+
+  ++it->second.instantiations;
+  return std::unique_ptr<DoubleFilter>{it->second.prototype->clone()};
+}
+
+bool FilterStore::validate(const std::string &filterId, std::string *err) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return lookup(filterId, err) != _cache.end();
+}
+
+std::map<std::string, std::size_t> FilterStore::instantiations() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+
+  std::map<std::string, std::size_t> ret;
+  for (const auto &entry : _cache) {
+    ret.emplace(entry.first, entry.second.instantiations);
+  }
+  return ret;
+}
+
+std::size_t FilterStore::compiled() const {
+  std::lock_guard<std::mutex> lock{_mutex};
+  return _cache.size();
+}
+
+void FilterStore::reset() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _cache.clear();
+}
+
+FilterStore::Cache::iterator FilterStore::lookup(const std::string &filterId,
+                                                 std::string *err) {
+  auto it{_cache.find(filterId)};
+  if (it != _cache.end()) {
+    return it;
+  }
+
+  std::string error;
+  std::unique_ptr<DoubleFilter> prototype{
+      DoubleFilter::Create(filterId, &error)};
+  if (!prototype) {
+    if (err) {
+      *err = error;
+    }
+    return _cache.end();
+  }
+
+  return _cache.emplace(filterId, CacheEntry{std::move(prototype), 0}).first;
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,74 @@
+#ifndef SCDETECT_APPS_CC_FILTERSTORE_H_
+#define SCDETECT_APPS_CC_FILTERSTORE_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "def.h"
+
+namespace Seiscomp {
+namespace detect {
+
+// A global store for filter prototypes
+// - implements the Singleton Design Pattern
+// - filters are compiled (i.e. the filter string is parsed) once per filter
+// string; afterwards, filters are cloned from the prototype cached
+// - the number of filters handed out is recorded per filter string (for
+// diagnostic purposes)
+// - thread-safe
+class FilterStore {
+ public:
+  static FilterStore &Instance();
+
+  FilterStore(const FilterStore &) = delete;
+  FilterStore &operator=(const FilterStore &) = delete;
+
+  // Returns a filter (ownership is transferred) for `filterId`. Returns
+  // `nullptr` if the filter cannot be compiled; in that case, `err` (if
+  // passed) is set accordingly.
+  //
+  // - the sampling frequency of the filter returned is not initialized
+  std::unique_ptr<DoubleFilter> get(const std::string &filterId,
+                                    std::string *err = nullptr);
+  // Returns `true` if the filter `filterId` can be compiled, else `false`; in
+  // that case, `err` (if passed) is set accordingly. The filter compiled is
+  // cached (but not accounted for as an instantiation).
+  bool validate(const std::string &filterId, std::string *err = nullptr);
+
+  // Returns the number of filters handed out per filter string
+  std::map<std::string, std::size_t> instantiations() const;
+  // Returns the number of filters compiled
+  std::size_t compiled() const;
+
+  // Reset the store
+  void reset();
+
+ private:
+  FilterStore() = default;
+
+  struct CacheEntry {
+    std::unique_ptr<DoubleFilter> prototype;
+    std::size_t instantiations{0};
+  };
+
+  using Cache = std::unordered_map<std::string, CacheEntry>;
+
+  // Returns the cache entry for `filterId` (compiles the filter if not
+  // cached, yet). Returns `_cache.end()` if the filter cannot be compiled.
+  //
+  // - `_mutex` must be locked
+  Cache::iterator lookup(const std::string &filterId, std::string *err);
+
+  Cache _cache;
+
+  mutable std::mutex _mutex;
+};
+
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_FILTERSTORE_H_
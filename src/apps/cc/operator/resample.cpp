@@ -21,7 +21,9 @@ processing::WaveformProcessor::Status ResamplingOperator::feed(
     return processing::WaveformProcessor::Status::kInProgress;
   }
 
-  return processing::WaveformProcessor::Status::kError;
+  // the record resampler might buffer samples (e.g. due to the filter delay),
+  // i.e. no samples are emitted, yet
+  return processing::WaveformProcessor::Status::kWaitingForData;
 }
 
 void ResamplingOperator::reset() {
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "../log.h"
+#include "../samplestore.h"
 
 namespace Seiscomp {
 namespace detect {
@@ -78,8 +79,8 @@ bool RingBufferOperator::store(processing::StreamState &streamState,
                                const Record *record) {
   if (!record->data()) return false;
 
-  DoubleArrayPtr data{
-      dynamic_cast<DoubleArray *>(record->data()->copy(Array::DOUBLE))};
+  // the samples are read, only
+  const auto data{RecordSampleStore::Instance().get(record)};
 
   if (streamState.lastRecord) {
     if (record == streamState.lastRecord) {
@@ -92,7 +93,7 @@ bool RingBufferOperator::store(processing::StreamState &streamState,
           record->streamID().c_str(), record->samplingFrequency(),
           streamState.samplingFrequency);
       reset(streamState);
-    } else if (!handleGap(streamState, record, data)) {
+    } else if (!handleGap(streamState, record, *data)) {
       return false;
     }
 
@@ -116,11 +117,15 @@ bool RingBufferOperator::store(processing::StreamState &streamState,
   streamState.lastSample = (*data)[data->size() - 1];
   streamState.lastRecord = record;
 
-  return fill(streamState, record, data);
+  return bufferRecord(record);
 }
 
 bool RingBufferOperator::fill(processing::StreamState &streamState,
                               const Record *record, DoubleArrayPtr &data) {
+  return bufferRecord(record);
+}
+
+bool RingBufferOperator::bufferRecord(const Record *record) {
   auto &buffer{_streamConfigs.at(record->streamID()).streamBuffer};
   // buffer record
   auto retval{buffer->feed(record)};
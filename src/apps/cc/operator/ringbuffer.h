@@ -60,6 +60,9 @@ class RingBufferOperator : public processing::WaveformOperator,
   void reset(processing::StreamState &streamState);
 
  private:
+  // Buffers `record`
+  bool bufferRecord(const Record *record);
+
   struct StreamConfig {
     processing::StreamState streamState;
 
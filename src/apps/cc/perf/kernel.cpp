@@ -0,0 +1,151 @@
+#include <boost/program_options/errors.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/value_semantic.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../filter/detail/kernel.h"
+#include "perf.h"
+
+namespace po = boost::program_options;
+
+namespace Seiscomp {
+namespace detect {
+namespace perf {
+
+using InstructionSet = filter::detail::InstructionSet;
+
+// Returns `size` normally distributed random samples
+template <typename T>
+std::vector<T> randomSamples(std::size_t size, std::mt19937 &generator) {
+  std::normal_distribution<T> distribution;
+  std::vector<T> ret(size);
+  for (auto &sample : ret) {
+    sample = distribution(generator);
+  }
+  return ret;
+}
+
+// Returns the time required by the dot products kernel implemented with
+// `instructionSet` to compute the dot products between a template waveform
+// with `templateSize` samples and `numLags` subsequent lags `repetitions`
+// times
+template <typename T>
+PerfTimer::NanosecondType perfKernel(InstructionSet instructionSet,
+                                     std::size_t templateSize,
+                                     std::size_t numLags,
+                                     std::size_t repetitions,
+                                     std::size_t trials) {
+  std::mt19937 generator{42};
+  const auto templateWf{randomSamples<T>(templateSize, generator)};
+  const auto data{randomSamples<T>(templateSize + numLags - 1, generator)};
+  std::vector<double> out(numLags);
+
+  const auto kernel{filter::detail::dotProductsKernel<T>(instructionSet)};
+  PerfTimer timer;
+  for (std::size_t trial{0}; trial < trials; ++trial) {
+    timer.start();
+    for (std::size_t i{0}; i < repetitions; ++i) {
+      kernel(templateWf.data(), templateSize, data.data(), numLags,
+             out.data());
+    }
+    timer.stop();
+  }
+  return timer.minTime();
+}
+
+}  // namespace perf
+}  // namespace detect
+}  // namespace Seiscomp
+
+int main(int argc, char **argv) {
+  // setup commandline arguments
+  std::size_t trials;
+  std::size_t numLags;
+  std::size_t repetitions;
+  std::vector<std::size_t> templateSizes;
+
+  po::options_description generic{"Allowed options"};
+  generic.add_options()("help,h", "show this help message and exit")(
+      "trials", po::value<std::size_t>(&trials)->default_value(5),
+      "number of trials to run")(
+      "lags", po::value<std::size_t>(&numLags)->default_value(512),
+      "number of subsequent lags computed per kernel invocation (i.e. the "
+      "number of samples per record)")(
+      "repetitions",
+      po::value<std::size_t>(&repetitions)->default_value(2000),
+      "number of kernel invocations per trial")(
+      "template-sizes",
+      po::value<std::vector<std::size_t>>(&templateSizes)
+          ->multitoken()
+          ->default_value(std::vector<std::size_t>{200, 400, 800, 1600},
+                          "200 400 800 1600"),
+      "template waveform sizes (in samples)");
+
+  // parse commandline
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, generic), vm);
+    po::notify(vm);
+  } catch (const po::error &e) {
+    std::cout << "ERROR: " << e.what() << std::endl;
+    std::cout << generic << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help")) {
+    std::cout << generic << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  namespace detail = Seiscomp::detect::filter::detail;
+  std::cout << "trials: " << trials << std::endl;
+  std::cout << "lags: " << numLags << std::endl;
+  std::cout << "repetitions: " << repetitions << std::endl;
+  std::cout << "instruction set detected: "
+            << detail::to_string(detail::detectInstructionSet()) << std::endl;
+
+  std::vector<detail::InstructionSet> instructionSets{
+      detail::InstructionSet::kScalar, detail::InstructionSet::kSSE2,
+      detail::InstructionSet::kAVX2, detail::InstructionSet::kAVX512};
+
+  std::cout << "instruction_set,precision,template_size,time_ms,"
+               "gproducts_per_second"
+            << std::endl;
+  for (const auto templateSize : templateSizes) {
+    for (const auto instructionSet : instructionSets) {
+      // kernels not supported by the host fall back to the portable kernel
+      if (static_cast<int>(instructionSet) >
+          static_cast<int>(detail::detectInstructionSet())) {
+        continue;
+      }
+
+      const auto Report = [&](const std::string &precision,
+                              Seiscomp::detect::perf::PerfTimer::NanosecondType
+                                  t) {
+        const double throughput{
+            t > 0 ? static_cast<double>(templateSize * numLags * repetitions) /
+                        static_cast<double>(t)
+                  : 0};
+        std::cout << detail::to_string(instructionSet) << "," << precision
+                  << "," << templateSize << "," << t / 1e6 << ","
+                  << throughput << std::endl;
+      };
+
+      Report("double", Seiscomp::detect::perf::perfKernel<double>(
+                           instructionSet, templateSize, numLags, repetitions,
+                           trials));
+      Report("single", Seiscomp::detect::perf::perfKernel<float>(
+                           instructionSet, templateSize, numLags, repetitions,
+                           trials));
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/core/typedarray.h>
+#include <seiscomp/io/recordfilter/resample.h>
+
+#include <boost/program_options/errors.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/value_semantic.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../polyphase_resampler.h"
+#include "../resamplerstore.h"
+#include "../samplestore.h"
+#include "perf.h"
+
+namespace po = boost::program_options;
+
+namespace Seiscomp {
+namespace detect {
+namespace perf {
+
+using RecordResampler = RecordResamplerStore::RecordResampler;
+
+// Creates `numRecords` contiguous records (each containing `recordSamples`
+// samples) of synthetic data sampled at `samplingFrequency`
+std::vector<GenericRecordPtr> createRecords(double samplingFrequency,
+                                            std::size_t numRecords,
+                                            std::size_t recordSamples) {
+  std::vector<GenericRecordPtr> ret;
+  Core::Time startTime{2021, 1, 1};
+  std::vector<double> samples(recordSamples);
+  for (std::size_t i{0}; i < numRecords; ++i) {
+    for (std::size_t j{0}; j < recordSamples; ++j) {
+      const double t{static_cast<double>(i * recordSamples + j) /
+                     samplingFrequency};
+      samples[j] = std::sin(2 * M_PI * 1.3 * t) +
+                   0.5 * std::sin(2 * M_PI * 0.2 * samplingFrequency * t);
+    }
+
+    GenericRecordPtr record{
+        new GenericRecord{"NET", "STA", "LOC", "CHA", startTime,
+                          samplingFrequency}};
+    record->setData(static_cast<int>(recordSamples), samples.data(),
+                    Array::DOUBLE);
+    ret.push_back(record);
+
+    startTime = record->endTime();
+  }
+  return ret;
+}
+
+// Returns the time required by a resampler (cloned from `prototype`) to
+// resample `records`
+PerfTimer::NanosecondType perfResampler(
+    const RecordResampler &prototype,
+    const std::vector<GenericRecordPtr> &records, std::size_t trials,
+    std::size_t &numSamples) {
+  PerfTimer timer;
+  for (std::size_t trial{0}; trial < trials; ++trial) {
+    // cloning is currently the only way in order to actually reset the record
+    // resampler
+    std::unique_ptr<RecordResampler> resampler{prototype.clone()};
+    numSamples = 0;
+
+    timer.start();
+    for (const auto &record : records) {
+      RecordSampleStore::Scope sampleScope{record.get()};
+      std::unique_ptr<Record> resampled{resampler->feed(record.get())};
+      if (resampled) {
+        numSamples += resampled->sampleCount();
+      }
+    }
+    timer.stop();
+  }
+  return timer.minTime();
+}
+
+}  // namespace perf
+}  // namespace detect
+}  // namespace Seiscomp
+
+int main(int argc, char **argv) {
+  // setup commandline arguments
+  std::size_t trials;
+  std::size_t numRecords;
+  std::size_t recordSamples;
+
+  po::options_description generic{"Allowed options"};
+  generic.add_options()("help,h", "show this help message and exit")(
+      "trials", po::value<std::size_t>(&trials)->default_value(3),
+      "number of trials to run")(
+      "records", po::value<std::size_t>(&numRecords)->default_value(10000),
+      "number of records to resample")(
+      "record-samples",
+      po::value<std::size_t>(&recordSamples)->default_value(512),
+      "number of samples per record");
+
+  // parse commandline
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, generic), vm);
+    po::notify(vm);
+  } catch (const po::error &e) {
+    std::cout << "ERROR: " << e.what() << std::endl;
+    std::cout << generic << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help")) {
+    std::cout << generic << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  std::cout << "trials: " << trials << std::endl;
+  std::cout << "records: " << numRecords << std::endl;
+  std::cout << "samples per record: " << recordSamples << std::endl;
+
+  // sampling frequency ratios (current, target)
+  const std::vector<std::pair<double, double>> ratios{
+      {200, 100}, {100, 50}, {40, 20}, {100, 40}, {50, 100}};
+
+  std::cout << "current_frequency,target_frequency,resampler,time_ms,"
+               "samples_emitted,msamples_per_second"
+            << std::endl;
+  for (const auto &ratio : ratios) {
+    const auto records{Seiscomp::detect::perf::createRecords(
+        ratio.first, numRecords, recordSamples)};
+
+    Seiscomp::IO::RecordResampler<double> lanczos{ratio.second, 0.7, 0.9, 10,
+                                                  3};
+    Seiscomp::detect::PolyphaseRecordResampler polyphase{ratio.second};
+
+    using RecordResampler = Seiscomp::detect::perf::RecordResampler;
+    const std::vector<std::pair<std::string, const RecordResampler *>>
+        resamplers{{"lanczos", &lanczos}, {"polyphase", &polyphase}};
+    for (const auto &resampler : resamplers) {
+      std::size_t numSamples{0};
+      const auto t{Seiscomp::detect::perf::perfResampler(
+          *resampler.second, records, trials, numSamples)};
+
+      const double throughput{
+          t > 0 ? static_cast<double>(numRecords * recordSamples) /
+                      (static_cast<double>(t) / 1e3)
+                : 0};
+      std::cout << ratio.first << "," << ratio.second << ","
+                << resampler.first << "," << t / 1e6 << "," << numSamples
+                << "," << throughput << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+#include "pipeline.h"
+
+#include <cassert>
+#include <exception>
+#include <utility>
+
+#include "log.h"
+#include "settings.h"
+
+namespace Seiscomp {
+namespace detect {
+
+namespace {
+
+std::int64_t toNanoseconds(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+double toSeconds(std::int64_t ns) { return static_cast<double>(ns) * 1e-9; }
+
+void updateMax(std::atomic<std::int64_t> &max, std::int64_t v) {
+  if (v > max.load(std::memory_order_relaxed)) {
+    max.store(v, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+void RecordPipeline::Accumulator::updateDepth(std::size_t depth) {
+  if (depth > maxDepth.load(std::memory_order_relaxed)) {
+    maxDepth.store(depth, std::memory_order_relaxed);
+  }
+}
+
+void RecordPipeline::Accumulator::update(Clock::duration wait,
+                                         Clock::duration service) {
+  const auto w{toNanoseconds(wait)};
+  const auto s{toNanoseconds(service)};
+  waitSum.fetch_add(w, std::memory_order_relaxed);
+  updateMax(waitMax, w);
+  serviceSum.fetch_add(s, std::memory_order_relaxed);
+  updateMax(serviceMax, s);
+  count.fetch_add(1, std::memory_order_relaxed);
+}
+
+RecordPipeline::StageMetrics RecordPipeline::Accumulator::get(
+    std::size_t depth) const {
+  StageMetrics ret;
+  ret.depth = depth;
+  ret.maxDepth = maxDepth.load(std::memory_order_relaxed);
+  ret.count = count.load(std::memory_order_relaxed);
+  if (ret.count > 0) {
+    ret.meanWait = toSeconds(waitSum.load(std::memory_order_relaxed)) /
+                   static_cast<double>(ret.count);
+    ret.meanService = toSeconds(serviceSum.load(std::memory_order_relaxed)) /
+                      static_cast<double>(ret.count);
+  }
+  ret.maxWait = toSeconds(waitMax.load(std::memory_order_relaxed));
+  ret.maxService = toSeconds(serviceMax.load(std::memory_order_relaxed));
+  return ret;
+}
+
+RecordPipeline::RecordPipeline(std::size_t capacity,
+                               ProcessCallback processCallback,
+                               AssembleCallback assembleCallback)
+    : _processCallback{std::move(processCallback)},
+      _assembleCallback{std::move(assembleCallback)},
+      _processingQueue{capacity},
+      _assemblyQueue{capacity} {
+  assert((capacity > 0));
+  assert(_processCallback);
+  assert(_assembleCallback);
+}
+
+RecordPipeline::~RecordPipeline() { stop(); }
+
+void RecordPipeline::start() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    if (!_stopped) {
+      return;
+    }
+    _stopped = false;
+  }
+  _thread = std::thread{[this]() { run(); }};
+}
+
+void RecordPipeline::stop() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    if (_stopped) {
+      return;
+    }
+  }
+
+  flush();
+
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _stopped = true;
+  }
+  _cv.notify_all();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+void RecordPipeline::push(const RecordCPtr &record) {
+  assert(record);
+
+  Item item;
+  item.record = record;
+  item.pushed = Clock::now();
+
+  // backpressure: assemble while waiting for the processing stage
+  while (_processingQueue.size() >= _processingQueue.capacity()) {
+    if (assemble() > 0) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    _cv.wait(lock, [this]() {
+      return _processingQueue.size() < _processingQueue.capacity() ||
+             !_assemblyQueue.empty();
+    });
+  }
+
+  // the queue is not full; thus, pushing succeeds
+  _processingQueue.tryPush(std::move(item));
+  ++_pending;
+  _processingMetrics.updateDepth(_processingQueue.size());
+  notify();
+
+  assemble();
+}
+
+std::size_t RecordPipeline::assemble() {
+  std::size_t ret{0};
+  Item item;
+  while (_assemblyQueue.tryPop(item)) {
+    notify();
+
+    const auto start{Clock::now()};
+    _assembleCallback(item.record.get(), item.detections);
+    const auto end{Clock::now()};
+
+    _assemblyMetrics.update(start - item.dequeued, end - start);
+    const auto latency{toNanoseconds(end - item.pushed)};
+    _latencySum.fetch_add(latency, std::memory_order_relaxed);
+    updateMax(_latencyMax, latency);
+
+    item = Item{};
+    --_pending;
+    ++ret;
+  }
+  return ret;
+}
+
+void RecordPipeline::flush() {
+  while (_pending > 0) {
+    if (assemble() > 0) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    _cv.wait(lock, [this]() { return !_assemblyQueue.empty(); });
+  }
+}
+
+RecordPipeline::Metrics RecordPipeline::metrics() const {
+  Metrics ret;
+  ret.processing = _processingMetrics.get(_processingQueue.size());
+  ret.assembly = _assemblyMetrics.get(_assemblyQueue.size());
+  if (ret.assembly.count > 0) {
+    ret.meanLatency = toSeconds(_latencySum.load(std::memory_order_relaxed)) /
+                      static_cast<double>(ret.assembly.count);
+  }
+  ret.maxLatency = toSeconds(_latencyMax.load(std::memory_order_relaxed));
+  return ret;
+}
+
+void RecordPipeline::run() {
+  Item item;
+  while (true) {
+    if (_processingQueue.empty()) {
+      std::unique_lock<std::mutex> lock{_mutex};
+      _cv.wait(lock,
+               [this]() { return !_processingQueue.empty() || _stopped; });
+      if (_processingQueue.empty()) {
+        // stopped
+        return;
+      }
+    }
+
+    _processingQueue.tryPop(item);
+    notify();
+
+    const auto start{Clock::now()};
+    try {
+      item.detections = _processCallback(item.record.get());
+    } catch (std::exception &e) {
+      SCDETECT_LOG_ERROR("%s: failed to process record: %s",
+                         item.record->streamID().c_str(), e.what());
+    }
+    const auto end{Clock::now()};
+    _processingMetrics.update(start - item.pushed, end - start);
+    item.dequeued = end;
+
+    // backpressure: wait for the assembly stage
+    if (_assemblyQueue.size() >= _assemblyQueue.capacity()) {
+      std::unique_lock<std::mutex> lock{_mutex};
+      _cv.wait(lock, [this]() {
+        return _assemblyQueue.size() < _assemblyQueue.capacity();
+      });
+    }
+
+    // the queue is not full; thus, pushing succeeds
+    _assemblyQueue.tryPush(std::move(item));
+    _assemblyMetrics.updateDepth(_assemblyQueue.size());
+    notify();
+
+    item = Item{};
+  }
+}
+
+void RecordPipeline::notify() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+  }
+  _cv.notify_all();
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,146 @@
+#ifndef SCDETECT_APPS_CC_PIPELINE_H_
+#define SCDETECT_APPS_CC_PIPELINE_H_
+
+#include <seiscomp/core/record.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "detector/worker_pool.h"
+#include "util/concurrent_queue.h"
+
+namespace Seiscomp {
+namespace detect {
+
+// Processes records by means of pipeline stages
+//
+// - the stages are connected by bounded lock-free SPSC queues:
+//   1. ingest: records are pushed by the thread calling `push()` (i.e. the
+//   thread decoding the records)
+//   2. processing: records are processed (i.e. preprocessed, cross-correlated
+//   and linked) by a dedicated thread
+//   3. assembly: the detections returned when processing a record are
+//   assembled together with the record by the thread calling `push()`,
+//   `assemble()` or `flush()` (if detectors are executed by detector
+//   workers, these are the detections of the records processed completely
+//   by the workers so far)
+// - backpressure: if the processing queue is full, `push()` blocks (while
+// assembling); if the assembly queue is full, the processing thread blocks
+// - records are processed and assembled in the order they were pushed
+class RecordPipeline {
+ public:
+  using Detections = detector::WorkerPool::Results;
+  // Processes `record` and returns the detections emitted (so far)
+  using ProcessCallback = std::function<Detections(const Record *record)>;
+  // Assembles `record` together with the `detections` returned when
+  // processing `record`
+  using AssembleCallback =
+      std::function<void(const Record *record, Detections &detections)>;
+
+  // Metrics of a stage
+  struct StageMetrics {
+    // The number of records currently queued
+    std::size_t depth{0};
+    // The maximum number of records queued
+    std::size_t maxDepth{0};
+    // The number of records handled by the stage
+    std::size_t count{0};
+    // The mean and maximum time (in seconds) records were queued
+    double meanWait{0};
+    double maxWait{0};
+    // The mean and maximum time (in seconds) the stage took per record
+    double meanService{0};
+    double maxService{0};
+  };
+
+  struct Metrics {
+    StageMetrics processing;
+    StageMetrics assembly;
+    // The mean and maximum time (in seconds) between pushing and assembling
+    // a record
+    double meanLatency{0};
+    double maxLatency{0};
+  };
+
+  RecordPipeline(std::size_t capacity, ProcessCallback processCallback,
+                 AssembleCallback assembleCallback);
+  ~RecordPipeline();
+
+  RecordPipeline(const RecordPipeline &) = delete;
+  RecordPipeline &operator=(const RecordPipeline &) = delete;
+
+  // Starts the processing thread
+  void start();
+  // Flushes the pipeline and stops the processing thread
+  void stop();
+
+  // Pushes `record` to the pipeline
+  void push(const RecordCPtr &record);
+  // Assembles the records processed so far (does not block). Returns the
+  // number of records assembled.
+  std::size_t assemble();
+  // Blocks until all records pushed are processed and assembled
+  void flush();
+
+  // Returns the pipeline's metrics
+  Metrics metrics() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Item {
+    RecordCPtr record;
+    Detections detections;
+    Clock::time_point pushed;
+    Clock::time_point dequeued;
+  };
+
+  // Metrics of a stage (each metric is updated by a single thread, but read
+  // concurrently)
+  struct Accumulator {
+    void updateDepth(std::size_t depth);
+    void update(Clock::duration wait, Clock::duration service);
+    StageMetrics get(std::size_t depth) const;
+
+    std::atomic<std::size_t> maxDepth{0};
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::int64_t> waitSum{0};
+    std::atomic<std::int64_t> waitMax{0};
+    std::atomic<std::int64_t> serviceSum{0};
+    std::atomic<std::int64_t> serviceMax{0};
+  };
+
+  void run();
+  // Notifies the threads waiting for the queues
+  void notify();
+
+  ProcessCallback _processCallback;
+  AssembleCallback _assembleCallback;
+
+  util::SpscQueue<Item> _processingQueue;
+  util::SpscQueue<Item> _assemblyQueue;
+
+  // The number of records pushed, but not assembled, yet
+  std::size_t _pending{0};
+
+  Accumulator _processingMetrics;
+  Accumulator _assemblyMetrics;
+  std::atomic<std::int64_t> _latencySum{0};
+  std::atomic<std::int64_t> _latencyMax{0};
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::thread _thread;
+  bool _stopped{true};
+};
+
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_PIPELINE_H_
@@ -0,0 +1,151 @@
+#include "polyphase_resampler.h"
+
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/core/typedarray.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "log.h"
+#include "samplestore.h"
+#include "settings.h"
+#include "util/memory.h"
+
+namespace Seiscomp {
+namespace detect {
+
+PolyphaseRecordResampler::PolyphaseRecordResampler(double targetFrequency,
+                                                   double passband,
+                                                   double stopband,
+                                                   double attenuation)
+    : _targetFrequency{targetFrequency},
+      _passband{passband},
+      _stopband{stopband},
+      _attenuation{attenuation} {}
+
+bool PolyphaseRecordResampler::supports(double currentFrequency,
+                                        double targetFrequency) {
+  return currentFrequency > 0 && targetFrequency > 0 &&
+         static_cast<bool>(
+             util::rationalRatio(targetFrequency / currentFrequency,
+                                 settings::kPolyphaseResamplerMaxFactor));
+}
+
+Record *PolyphaseRecordResampler::feed(const Record *record) {
+  const auto samples{RecordSampleStore::Instance().get(record)};
+  if (!samples || samples->size() == 0) {
+    return nullptr;
+  }
+
+  if (!_resampler || record->samplingFrequency() != _currentFrequency) {
+    const auto ratio{
+        util::rationalRatio(_targetFrequency / record->samplingFrequency(),
+                            settings::kPolyphaseResamplerMaxFactor)};
+    if (!ratio) {
+      SCDETECT_LOG_WARNING(
+          "%s: Failed to resample record: sampling frequency not supported "
+          "by the polyphase resampler (sampling_frequency=%f, "
+          "target_sampling_frequency=%f)",
+          record->streamID().c_str(), record->samplingFrequency(),
+          _targetFrequency);
+      return nullptr;
+    }
+
+    _resampler = util::make_unique<util::PolyphaseResampler>(
+        ratio->first, ratio->second, _passband, _stopband, _attenuation);
+    _currentFrequency = record->samplingFrequency();
+    restart(record);
+  } else if (!_expectedStartTime ||
+             std::abs(static_cast<double>(record->startTime() -
+                                          *_expectedStartTime)) >
+                 0.5 / _currentFrequency) {
+    restart(record);
+  }
+
+  _expectedStartTime = record->endTime();
+  _networkCode = record->networkCode();
+  _stationCode = record->stationCode();
+  _locationCode = record->locationCode();
+  _channelCode = record->channelCode();
+
+  _resampled.clear();
+  _resampler->apply(static_cast<std::size_t>(samples->size()),
+                    samples->typedData(), _resampled);
+  _fed += static_cast<std::size_t>(samples->size());
+  return createRecord();
+}
+
+Record *PolyphaseRecordResampler::flush() {
+  if (!_resampler || !_expectedStartTime) {
+    return nullptr;
+  }
+
+  // feed zeros in order to emit the samples referring to positions up to the
+  // last input sample
+  const auto lastIdx{_resampler->firstOutputIndex() +
+                     static_cast<std::int64_t>(_emitted)};
+  const std::vector<double> zeros(
+      static_cast<std::size_t>(std::ceil(_resampler->delay())) + 1, 0);
+  _resampled.clear();
+  _resampler->apply(zeros.size(), zeros.data(), _resampled);
+
+  std::size_t n{0};
+  while (n < _resampled.size() &&
+         position(lastIdx + static_cast<std::int64_t>(n)) <=
+             static_cast<double>(_fed - 1)) {
+    ++n;
+  }
+  _resampled.resize(n);
+
+  auto *ret{createRecord()};
+  // the history is made up of zeros
+  _expectedStartTime = boost::none;
+  return ret;
+}
+
+void PolyphaseRecordResampler::reset() {
+  _resampler.reset();
+  _currentFrequency = 0;
+  _expectedStartTime = boost::none;
+  _emitted = 0;
+  _fed = 0;
+}
+
+IO::RecordFilterInterface *PolyphaseRecordResampler::clone() const {
+  return new PolyphaseRecordResampler{_targetFrequency, _passband, _stopband,
+                                      _attenuation};
+}
+
+void PolyphaseRecordResampler::restart(const Record *record) {
+  _resampler->reset();
+  _streamStartTime = record->startTime();
+  _emitted = 0;
+  _fed = 0;
+}
+
+double PolyphaseRecordResampler::position(std::int64_t idx) const {
+  return static_cast<double>(idx) * static_cast<double>(_resampler->down()) /
+             static_cast<double>(_resampler->up()) -
+         _resampler->delay();
+}
+
+Record *PolyphaseRecordResampler::createRecord() {
+  if (_resampled.empty()) {
+    return nullptr;
+  }
+
+  const auto idx{_resampler->firstOutputIndex() +
+                 static_cast<std::int64_t>(_emitted)};
+  _emitted += _resampled.size();
+
+  auto *ret{new GenericRecord{
+      _networkCode, _stationCode, _locationCode, _channelCode,
+      _streamStartTime + Core::TimeSpan{position(idx) / _currentFrequency},
+      _targetFrequency}};
+  ret->setData(static_cast<int>(_resampled.size()), _resampled.data(),
+               Array::DOUBLE);
+  return ret;
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
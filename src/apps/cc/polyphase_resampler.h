@@ -0,0 +1,96 @@
+#ifndef SCDETECT_APPS_CC_POLYPHASERESAMPLER_H_
+#define SCDETECT_APPS_CC_POLYPHASERESAMPLER_H_
+
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/record.h>
+#include <seiscomp/io/recordfilter.h>
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/polyphase.h"
+
+namespace Seiscomp {
+namespace detect {
+
+// Record resampler implemented by means of a polyphase FIR resampler (see
+// `util::PolyphaseResampler`)
+//
+// - the ratio of the target sampling frequency and the records' sampling
+// frequency must be rational with terms less than or equal to
+// `settings::kPolyphaseResamplerMaxFactor`; otherwise, records are rejected
+// - the filter delay is compensated for by means of the start time of the
+// records emitted
+// - if a record is not contiguous w.r.t. the record previously fed, the
+// stream is restarted
+class PolyphaseRecordResampler : public IO::RecordFilterInterface {
+ public:
+  PolyphaseRecordResampler(double targetFrequency, double passband = 0.7,
+                           double stopband = 0.9, double attenuation = 80);
+
+  // Returns `true` if the polyphase resampler is capable of resampling from
+  // `currentFrequency` to `targetFrequency`, else `false`
+  static bool supports(double currentFrequency, double targetFrequency);
+
+  // Resamples `record`. Returns the resampled record (ownership is
+  // transferred) or `nullptr` if no samples were emitted, yet.
+  Record *feed(const Record *record) override;
+
+  // Emits the samples buffered (i.e. the samples referring to the positions
+  // up to the last sample fed) by means of zero-padding the stream. Returns
+  // `nullptr` if there are no samples buffered. Afterwards, the stream is
+  // restarted with the next record fed.
+  Record *flush() override;
+
+  void reset() override;
+
+  // Returns a resampler with the same configuration (but without any stream
+  // state)
+  IO::RecordFilterInterface *clone() const override;
+
+ private:
+  // Restarts the stream w.r.t. `record`
+  void restart(const Record *record);
+  // Returns the position (in input samples w.r.t. the stream's first input
+  // sample) the output sample `idx` refers to
+  double position(std::int64_t idx) const;
+  // Creates a record from the samples resampled. Returns `nullptr` if there
+  // are no samples resampled.
+  Record *createRecord();
+
+  double _targetFrequency;
+  double _passband;
+  double _stopband;
+  double _attenuation;
+
+  // The resampler engine (configured w.r.t. the current sampling frequency)
+  std::unique_ptr<util::PolyphaseResampler> _resampler;
+  // The sampling frequency of the records currently fed
+  double _currentFrequency{0};
+
+  // The time of the stream's first input sample
+  Core::Time _streamStartTime;
+  // The expected start time of the next record (if any)
+  boost::optional<Core::Time> _expectedStartTime;
+  // The number of samples emitted since the stream was (re)started
+  std::size_t _emitted{0};
+  // The number of samples fed since the stream was (re)started
+  std::size_t _fed{0};
+
+  std::string _networkCode;
+  std::string _stationCode;
+  std::string _locationCode;
+  std::string _channelCode;
+
+  // Scratch buffer for the samples resampled
+  std::vector<double> _resampled;
+};
+
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_POLYPHASERESAMPLER_H_
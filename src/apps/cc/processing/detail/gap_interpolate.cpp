@@ -38,7 +38,7 @@ const Core::TimeSpan &InterpolateGaps::gapTolerance() const {
 }
 
 bool InterpolateGaps::handleGap(StreamState &streamState, const Record *record,
-                                DoubleArrayPtr &data) {
+                                const DoubleArray &data) {
   Core::TimeSpan gap{record->startTime() -
                      streamState.dataTimeWindow.endTime() -
                      /*one usec*/ Core::TimeSpan(0, 1)};
@@ -47,7 +47,7 @@ bool InterpolateGaps::handleGap(StreamState &streamState, const Record *record,
   std::size_t gapSamples{0};
   if (gap > streamState.gapThreshold) {
     gapSamples = std::ceil(streamState.samplingFrequency * gapSeconds);
-    if (fillGap(streamState, record, gap, (*data)[0], gapSamples)) {
+    if (fillGap(streamState, record, gap, data[0], gapSamples)) {
       SCDETECT_LOG_DEBUG("%s: detected gap (%.6f secs, %lu samples) (handled)",
                          record->streamID().c_str(), gapSeconds, gapSamples);
     } else {
@@ -35,7 +35,7 @@ class InterpolateGaps {
                     DoubleArrayPtr &data) = 0;
 
   virtual bool handleGap(StreamState &streamState, const Record *record,
-                         DoubleArrayPtr &data);
+                         const DoubleArray &data);
 
   // Sets the `streamState` specific minimum gap length
   void setMinimumGapThreshold(StreamState &streamState, const Record *record,
@@ -4,6 +4,8 @@
 #include <cmath>
 #include <exception>
 
+#include "../filterstore.h"
+#include "../samplestore.h"
 #include "waveform_operator.h"
 
 namespace Seiscomp {
@@ -97,8 +99,8 @@ bool WaveformProcessor::store(const Record *record) {
     auto *currentStreamState{streamState(record)};
     assert(currentStreamState);
 
-    DoubleArrayPtr data{
-        dynamic_cast<DoubleArray *>(record->data()->copy(Array::DOUBLE))};
+    // the samples are shared read-only
+    const auto samples{RecordSampleStore::Instance().get(record)};
 
     if (currentStreamState->lastRecord) {
       if (record == currentStreamState->lastRecord) {
@@ -113,7 +115,7 @@ bool WaveformProcessor::store(const Record *record) {
             currentStreamState->samplingFrequency);
 
         reset(*currentStreamState);
-      } else if (!handleGap(*currentStreamState, record, data)) {
+      } else if (!handleGap(*currentStreamState, record, *samples)) {
         return false;
       }
 
@@ -129,8 +131,13 @@ bool WaveformProcessor::store(const Record *record) {
         return false;
       }
     }
-    currentStreamState->lastSample = (*data)[data->size() - 1];
+    currentStreamState->lastSample = (*samples)[samples->size() - 1];
 
+    // copy the samples only if they are modified in place
+    DoubleArrayPtr data{
+        modifiesData()
+            ? dynamic_cast<DoubleArray *>(samples->copy(Array::DOUBLE))
+            : const_cast<DoubleArray *>(samples.get())};
     fill(*currentStreamState, record, data);
     if (Status::kInProgress < status()) {
       return false;
@@ -176,6 +183,8 @@ bool WaveformProcessor::fill(
   return true;
 }
 
+bool WaveformProcessor::modifiesData() const { return true; }
+
 bool WaveformProcessor::checkIfSaturated(const DoubleArray &data) {
   assert(_saturationThreshold);
   const auto *samples{data.typedData()};
@@ -249,8 +258,7 @@ void WaveformProcessor::setStatus(Status status, double value) {
 std::unique_ptr<WaveformProcessor::Filter> createFilter(
     const std::string &filter) {
   std::string err;
-  std::unique_ptr<WaveformProcessor::Filter> ret{
-      WaveformProcessor::Filter::Create(filter, &err)};
+  auto ret{FilterStore::Instance().get(filter, &err)};
   if (!ret) {
     throw WaveformProcessor::BaseException{"failed to compile filter (" +
                                            filter + "): " + err};
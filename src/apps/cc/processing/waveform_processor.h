@@ -171,6 +171,11 @@ class WaveformProcessor : public Processor, public detail::InterpolateGaps {
   bool fill(processing::StreamState &streamState, const Record *record,
             DoubleArrayPtr &data) override;
 
+  // Returns `true` if the data passed to `fill()` is modified in place (i.e.
+  // the record's samples must be copied), else `false`. The default
+  // implementation returns `true`.
+  virtual bool modifiesData() const;
+
   // Check whether data exceeds saturation threshold. The default
   // implementation does not perform any check
   //
@@ -207,6 +212,9 @@ class WaveformProcessor : public Processor, public detail::InterpolateGaps {
   double _statusValue{0};
 };
 
+// Returns a filter for `filter` (by means of cloning the filter prototype
+// cached by the `FilterStore`). Throws `WaveformProcessor::BaseException` if
+// the filter cannot be compiled.
 std::unique_ptr<WaveformProcessor::Filter> createFilter(
     const std::string &filter);
 
@@ -3,6 +3,7 @@
 #include <boost/functional/hash.hpp>
 #include <memory>
 
+#include "polyphase_resampler.h"
 #include "util/memory.h"
 
 namespace std {
@@ -41,7 +42,20 @@ RecordResamplerStore &RecordResamplerStore::Instance() {
   return instance;
 }
 
-void RecordResamplerStore::reset() { _cache.clear(); }
+void RecordResamplerStore::reset() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _cache.clear();
+}
+
+void RecordResamplerStore::setPolyphase(bool enabled) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  if (enabled != _polyphase) {
+    _cache.clear();
+  }
+  _polyphase = enabled;
+}
+
+bool RecordResamplerStore::polyphase() const { return _polyphase; }
 
 std::unique_ptr<RecordResamplerStore::RecordResampler>
 RecordResamplerStore::get(const Record *rec, double targetFrequency) {
@@ -53,11 +67,18 @@ RecordResamplerStore::get(double currentFrequency, double targetFrequency) {
   record_resampler_store_detail::CacheKey key{currentFrequency,
                                               targetFrequency};
 
+  std::lock_guard<std::mutex> lock{_mutex};
   if (_cache.find(key) == _cache.end()) {
-    _cache.emplace(
-        key,
-        util::make_unique<RecordResamplerStore::RecordResampler>(
-            targetFrequency, _fp, _fs, _coefficientScale, _lanczosKernelWidth));
+    if (_polyphase && PolyphaseRecordResampler::supports(currentFrequency,
+                                                         targetFrequency)) {
+      _cache.emplace(key, util::make_unique<PolyphaseRecordResampler>(
+                              targetFrequency, _fp, _fs,
+                              _polyphaseAttenuation));
+    } else {
+      _cache.emplace(key, util::make_unique<IO::RecordResampler<double>>(
+                              targetFrequency, _fp, _fs, _coefficientScale,
+                              _lanczosKernelWidth));
+    }
   }
 
   return std::unique_ptr<RecordResamplerStore::RecordResampler>(
@@ -1,12 +1,16 @@
 #ifndef SCDETECT_APPS_CC_RESAMPLERSTORE_H_
 #define SCDETECT_APPS_CC_RESAMPLERSTORE_H_
 
+#include <seiscomp/io/recordfilter.h>
 #include <seiscomp/io/recordfilter/resample.h>
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
+#include "settings.h"
+
 namespace Seiscomp {
 namespace detect {
 namespace record_resampler_store_detail {
@@ -38,9 +42,15 @@ namespace detect {
 
 // A global store for resamplers
 // - implements the Singleton Design Pattern
+// - by default, records are resampled by means of the Lanczos resampler
+// - if polyphase resampling is enabled and the ratio of the target and the
+// current sampling frequency is rational with small terms (see
+// `settings::kPolyphaseResamplerMaxFactor`), records are resampled by means of
+// a polyphase resampler (see `PolyphaseRecordResampler`), instead
+// - thread-safe
 class RecordResamplerStore {
  public:
-  using RecordResampler = IO::RecordResampler<double>;
+  using RecordResampler = IO::RecordFilterInterface;
   static RecordResamplerStore &Instance();
 
   RecordResamplerStore(const RecordResamplerStore &) = delete;
@@ -49,6 +59,13 @@ class RecordResamplerStore {
   // Reset the store
   void reset();
 
+  // Enables (`true`) or disables (`false`) polyphase resampling
+  //
+  // - the resamplers cached are dropped
+  void setPolyphase(bool enabled);
+  // Returns `true` if polyphase resampling is enabled, else `false`
+  bool polyphase() const;
+
   std::unique_ptr<RecordResampler> get(const Record *rec,
                                        double targetFrequency);
 
@@ -67,11 +84,14 @@ class RecordResamplerStore {
                                    std::unique_ptr<RecordResampler>>;
 
   Cache _cache;
+  std::mutex _mutex;
 
   double _fp{0.7};
   double _fs{0.9};
   double _coefficientScale{10};
   int _lanczosKernelWidth{3};
+  double _polyphaseAttenuation{settings::kPolyphaseResamplerAttenuation};
+  bool _polyphase{false};
 };
 
 }  // namespace detect
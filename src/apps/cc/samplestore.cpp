@@ -0,0 +1,92 @@
+#include "samplestore.h"
+
+namespace Seiscomp {
+namespace detect {
+
+RecordSampleStore &RecordSampleStore::Instance() {
+  // guaranteed to be destroyed; instantiated on first use
+  static RecordSampleStore instance;
+  return instance;
+}
+
+RecordSampleStore::Scope::Scope(const Record *record) {
+  auto &store{RecordSampleStore::Instance()};
+  std::lock_guard<std::mutex> lock{store._mutex};
+  _record = store._record;
+  _samples = store._samples;
+
+  store._record = record;
+  store._samples.reset();
+}
+
+RecordSampleStore::Scope::~Scope() {
+  auto &store{RecordSampleStore::Instance()};
+  std::lock_guard<std::mutex> lock{store._mutex};
+  store._record = _record;
+  store._samples = _samples;
+}
+
+DoubleArrayCPtr RecordSampleStore::get(const Record *record) {
+  if (!record || !record->data()) {
+    return nullptr;
+  }
+
+  const auto *data{record->data()};
+  if (data->dataType() == Array::DOUBLE) {
+    ++_shared;
+    return DoubleArray::ConstCast(data);
+  }
+
+  std::unique_lock<std::mutex> lock{_mutex};
+  if (record != _record) {
+    auto it{_pinned.find(record)};
+    if (it != _pinned.end()) {
+      ++_shared;
+      return it->second;
+    }
+    lock.unlock();
+
+    ++_decoded;
+    return dynamic_cast<DoubleArray *>(data->copy(Array::DOUBLE));
+  }
+
+  if (_samples) {
+    ++_shared;
+    return _samples;
+  }
+
+  _samples = dynamic_cast<DoubleArray *>(data->copy(Array::DOUBLE));
+  ++_decoded;
+  return _samples;
+}
+
+void RecordSampleStore::pin(const Record *record) {
+  if (!record || !record->data() ||
+      record->data()->dataType() == Array::DOUBLE) {
+    return;
+  }
+
+  DoubleArrayCPtr samples{
+      dynamic_cast<DoubleArray *>(record->data()->copy(Array::DOUBLE))};
+  ++_decoded;
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  _pinned[record] = samples;
+}
+
+void RecordSampleStore::unpin(const Record *record) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _pinned.erase(record);
+}
+
+std::size_t RecordSampleStore::decoded() const { return _decoded; }
+
+std::size_t RecordSampleStore::shared() const { return _shared; }
+
+void RecordSampleStore::reset() {
+  _decoded = 0;
+  _shared = 0;
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,98 @@
+#ifndef SCDETECT_APPS_CC_SAMPLESTORE_H_
+#define SCDETECT_APPS_CC_SAMPLESTORE_H_
+
+#include <seiscomp/core/record.h>
+#include <seiscomp/core/typedarray.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace Seiscomp {
+namespace detect {
+
+// A global store for the double precision samples of records
+// - implements the Singleton Design Pattern
+// - the samples of records already providing double precision samples are
+// viewed, i.e. the samples are neither copied nor cached
+// - otherwise, the samples of the record a `RecordSampleStore::Scope` is
+// active for are decoded (i.e. converted to double precision) once and shared
+// read-only among all consumers
+// - consumers must not modify the samples; samples which are modified in
+// place (e.g. when filtering) must be copied
+// - alternatively, the samples of a record may be pinned (i.e. decoded once
+// and cached until unpinned), e.g. if the record is consumed by multiple
+// threads
+// - `get()`, `pin()` and `unpin()` are thread-safe; scopes must be managed by
+// a single thread (consumers lagging behind, i.e. requesting the samples of a
+// record the scope is not active for anymore, decode the samples by
+// themselves)
+class RecordSampleStore {
+ public:
+  static RecordSampleStore &Instance();
+
+  RecordSampleStore(const RecordSampleStore &) = delete;
+  RecordSampleStore &operator=(const RecordSampleStore &) = delete;
+
+  // Caches the samples of `record` for the lifetime of the scope (RAII)
+  //
+  // - `record` must outlive the scope
+  // - scopes may be nested; when a scope is left, the scope previously active
+  // is restored
+  class Scope {
+   public:
+    explicit Scope(const Record *record);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    const Record *_record;
+    DoubleArrayCPtr _samples;
+  };
+
+  // Returns a read-only view of the double precision samples of `record`.
+  // Returns `nullptr` if `record` does not provide any data.
+  DoubleArrayCPtr get(const Record *record);
+
+  // Decodes the samples of `record` and caches them until `unpin()` is
+  // called for `record`
+  //
+  // - `record` must outlive being pinned
+  void pin(const Record *record);
+  // Releases the samples cached for `record`
+  void unpin(const Record *record);
+
+  // Returns the number of records decoded
+  std::size_t decoded() const;
+  // Returns the number of requests served without decoding (i.e. either
+  // viewing the record's samples or serving the samples cached)
+  std::size_t shared() const;
+
+  // Reset the store
+  void reset();
+
+ private:
+  RecordSampleStore() = default;
+
+  // The record the scope is active for (if any)
+  const Record *_record{nullptr};
+  // The samples of `_record` (if already decoded)
+  DoubleArrayCPtr _samples;
+
+  // The samples of the records pinned
+  std::unordered_map<const Record *, DoubleArrayCPtr> _pinned;
+
+  // Protects `_record`, decoding the samples of `_record` and `_pinned`
+  std::mutex _mutex;
+
+  std::atomic<std::size_t> _decoded{0};
+  std::atomic<std::size_t> _shared{0};
+};
+
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_SAMPLESTORE_H_
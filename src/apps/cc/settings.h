@@ -1,6 +1,7 @@
 #ifndef SCDETECT_APPS_CC_SETTINGS_H_
 #define SCDETECT_APPS_CC_SETTINGS_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,65 @@ const std::vector<std::string> kValidPrioritizedStationMagnitudeTypes{"MLhc",
 constexpr bool kCacheRawWaveforms{true};
 constexpr double kTemplateWaveformResampleMargin{2};
 
+// Minimum number of template waveform samples for which the cross-correlation
+// is computed in the frequency domain (if not configured explicitly)
+constexpr std::size_t kCrossCorrelationFrequencyDomainMinTemplateSize{2048};
+// Maximum FFT size the frequency domain cross-correlation engine grows to when
+// adapting the overlap-save block size to the length of the data
+constexpr std::size_t kCrossCorrelationFrequencyDomainMaxFftSize{1 << 15};
+// Minimum duration (in seconds) each candidate cross-correlation engine is
+// benchmarked for when auto-tuning the engine
+constexpr double kCorrelationEngineTuneDuration{0.02};
+// Minimum number of repetitions each candidate cross-correlation engine is
+// benchmarked with when auto-tuning the engine
+constexpr std::size_t kCorrelationEngineTuneMinRepetitions{5};
+// Record size (in samples) the cross-correlation engines are auto-tuned for
+// when setting up detectors
+constexpr std::size_t kCorrelationEngineTuneRecordSize{512};
+// Name of the file (within the module's caching directory) the
+// cross-correlation engines selected by means of auto-tuning are cached in
+const std::string kCorrelationEngineCacheFile{"correlation-engines.txt"};
+
+// Minimum number of decimated template waveform samples required for the
+// coarse-to-fine search; if not fulfilled, the coarse search is disabled
+constexpr std::size_t kCoarseSearchMinDecimatedTemplateSize{16};
+// Margin (in units of the decimation factor) around lags selected by the
+// coarse search which are refined by means of the full rate correlation
+constexpr std::size_t kCoarseSearchRefinementMargin{2};
+
+// Maximum up- and downsampling factor (i.e. the terms of the sampling rate
+// ratio in lowest terms) resampling is implemented by means of the polyphase
+// resampler for; otherwise, the Lanczos resampler is used
+constexpr std::size_t kPolyphaseResamplerMaxFactor{16};
+// Stopband attenuation (in dB) of the polyphase resampler's lowpass filter
+constexpr double kPolyphaseResamplerAttenuation{80};
+
+// Default ratio of the target sampling frequency derived automatically and
+// the filter's upper corner frequency
+constexpr double kAutoTargetSamplingFrequencyMargin{3};
+
+// Capacity of the queues records are dispatched to detector workers with
+constexpr std::size_t kDetectorWorkerQueueCapacity{64};
+// Number of attempts (yielding in between) before a detector worker (or the
+// thread waiting for the detector workers) is put to sleep
+constexpr std::size_t kDetectorWorkerSpinCount{256};
+
+// Default capacity of the queues connecting the record processing pipeline
+// stages
+constexpr int kPipelineQueueCapacity{64};
+
+// Default minimum number of template waveform processors per stream required
+// for evaluating the processors of a detector in parallel
+constexpr std::size_t kDetectorParallelMinProcessors{8};
+
+// Number of progress reports while loading templates and constructing the
+// detectors (i.e. progress is reported in steps of 100% / N)
+constexpr std::size_t kTemplateLoadingProgressSteps{10};
+
+// Margin (in seconds) added to the buffer size of cascaded detectors taking
+// the record length and the pre-trigger delay into account
+constexpr double kCascadeBufferMargin{30};
+
 constexpr int kObjectThroughputAverageTimeSpan{10};
 
 }  // namespace settings
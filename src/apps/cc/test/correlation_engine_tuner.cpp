@@ -0,0 +1,158 @@
+#define SEISCOMP_TEST_MODULE test_correlation_engine_tuner
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/filesystem.hpp>
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include "../correlation_engine_tuner.h"
+#include "../filter/crosscorrelation.h"
+#include "../filter/detail/kernel.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr std::size_t templateSize{64};
+
+// Resets the global tuner when going out of scope
+struct TunerGuard {
+  TunerGuard() { reset(); }
+  ~TunerGuard() { reset(); }
+
+  void reset() {
+    auto &tuner{CorrelationEngineTuner::Instance()};
+    tuner.setForced(boost::none);
+    tuner.setAutoTune(false);
+    tuner.setCachePath("");
+    tuner.reset();
+  }
+};
+
+std::size_t countLines(const std::string &path) {
+  std::ifstream ifs{path};
+  std::size_t ret{0};
+  std::string line;
+  while (std::getline(ifs, line)) {
+    ++ret;
+  }
+  return ret;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(record_size_bucket) {
+  BOOST_TEST(CorrelationEngineTuner::recordSizeBucket(0) == 1);
+  BOOST_TEST(CorrelationEngineTuner::recordSizeBucket(1) == 1);
+  BOOST_TEST(CorrelationEngineTuner::recordSizeBucket(300) == 512);
+  BOOST_TEST(CorrelationEngineTuner::recordSizeBucket(512) == 512);
+  BOOST_TEST(CorrelationEngineTuner::recordSizeBucket(513) == 1024);
+}
+
+BOOST_AUTO_TEST_CASE(correlation_engine_disabled) {
+  TunerGuard guard;
+  auto &tuner{CorrelationEngineTuner::Instance()};
+  BOOST_TEST(!tuner.select(filter::Precision::kDouble, templateSize, 512));
+  BOOST_TEST(!tuner.lookup(filter::Precision::kDouble, templateSize, 512));
+}
+
+BOOST_AUTO_TEST_CASE(correlation_engine_forced) {
+  TunerGuard guard;
+  auto &tuner{CorrelationEngineTuner::Instance()};
+  const auto forced{parseCorrelationEngineConfig("timeDomainScalar")};
+  BOOST_TEST_REQUIRE(static_cast<bool>(forced));
+  BOOST_TEST(isSupported(*forced));
+  tuner.setForced(forced);
+  tuner.setAutoTune(true);
+
+  const auto selected{
+      tuner.select(filter::Precision::kDouble, templateSize, 512)};
+  BOOST_TEST_REQUIRE(static_cast<bool>(selected));
+  BOOST_TEST((*selected == *forced));
+  // nothing selected w.r.t. the key, however, the engine is forced
+  const auto lookedUp{
+      tuner.lookup(filter::Precision::kSingle, 2 * templateSize, 100)};
+  BOOST_TEST_REQUIRE(static_cast<bool>(lookedUp));
+  BOOST_TEST((*lookedUp == *forced));
+}
+
+BOOST_AUTO_TEST_CASE(correlation_engine_unsupported) {
+  BOOST_TEST(isSupported(*parseCorrelationEngineConfig("timeDomain")));
+  BOOST_TEST(isSupported(*parseCorrelationEngineConfig("frequencyDomain")));
+  BOOST_TEST(isSupported(*parseCorrelationEngineConfig("timeDomainScalar")));
+  BOOST_TEST(isSupported(*parseCorrelationEngineConfig("timeDomainAVX512")) ==
+             (filter::detail::detectInstructionSet() ==
+              filter::detail::InstructionSet::kAVX512));
+}
+
+BOOST_AUTO_TEST_CASE(correlation_engine_candidates) {
+  TunerGuard guard;
+  auto &tuner{CorrelationEngineTuner::Instance()};
+  tuner.setAutoTune(true);
+
+  for (const auto precision :
+       {filter::Precision::kDouble, filter::Precision::kSingle}) {
+    const auto selected{tuner.select(precision, templateSize, 300)};
+    BOOST_TEST_REQUIRE(static_cast<bool>(selected));
+    // the engine selected is one of the candidates supported by the host
+    BOOST_TEST(isSupported(*selected));
+    BOOST_TEST(static_cast<bool>(parseCorrelationEngineConfig(
+        to_string(*selected))));
+
+    // records of the same bucket use the engine selected
+    const auto lookedUp{tuner.lookup(precision, templateSize, 400)};
+    BOOST_TEST_REQUIRE(static_cast<bool>(lookedUp));
+    BOOST_TEST((*lookedUp == *selected));
+    // records of different buckets use the engine of the nearest bucket
+    const auto nearest{tuner.lookup(precision, templateSize, 4096)};
+    BOOST_TEST_REQUIRE(static_cast<bool>(nearest));
+    BOOST_TEST((*nearest == *selected));
+    // nothing selected w.r.t. the template waveform size
+    BOOST_TEST(!tuner.lookup(precision, templateSize + 1, 400));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(correlation_engine_cache) {
+  TunerGuard guard;
+  const auto path{(boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path())
+                      .string()};
+
+  auto &tuner{CorrelationEngineTuner::Instance()};
+  tuner.setAutoTune(true);
+  tuner.setCachePath(path);
+
+  // records of the same bucket are benchmarked once
+  const auto selected{
+      tuner.select(filter::Precision::kDouble, templateSize, 300)};
+  BOOST_TEST_REQUIRE(static_cast<bool>(selected));
+  BOOST_TEST(countLines(path) == 1);
+  BOOST_TEST((*tuner.select(filter::Precision::kDouble, templateSize, 500) ==
+              *selected));
+  BOOST_TEST(countLines(path) == 1);
+  tuner.select(filter::Precision::kDouble, templateSize, 1000);
+  BOOST_TEST(countLines(path) == 2);
+
+  // an engine cached is selected without benchmarking
+  tuner.reset();
+  {
+    std::ofstream ofs{path, std::ios::app};
+    ofs << CorrelationEngineTuner::cpuModel() << "\tdouble\t" << templateSize
+        << "\t4000\tfrequencyDomain\n";
+  }
+  tuner.setCachePath(path);
+  const auto cached{
+      tuner.select(filter::Precision::kDouble, templateSize, 3000)};
+  BOOST_TEST_REQUIRE(static_cast<bool>(cached));
+  BOOST_TEST((cached->engine == filter::CorrelationEngine::kFrequencyDomain));
+  BOOST_TEST(countLines(path) == 3);
+
+  boost::filesystem::remove(path);
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
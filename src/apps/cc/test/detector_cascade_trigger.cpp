@@ -0,0 +1,143 @@
+#define SEISCOMP_TEST_MODULE test_detector_cascade_trigger
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../detector/cascade_trigger.h"
+#include "../processing/waveform_processor.h"
+#include "utils.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr double samplingFrequency{10};
+constexpr std::size_t recordSize{30};
+constexpr double threshold{3};
+
+// the characteristic function corresponds to the data
+const std::string filterId{"SELF"};
+
+const Core::Time dataStartTime{2021, 1, 1};
+
+// Returns a record with samples exceeding the threshold in between the sample
+// indices `[begin, end)`
+GenericRecordPtr makeTriggerRecord(std::size_t recordIdx, std::size_t begin,
+                                   std::size_t end,
+                                   const std::string &chaCode = "C") {
+  std::vector<double> samples(recordSize, 0);
+  for (std::size_t i = begin; i < end; ++i) {
+    samples[i] = 2 * threshold;
+  }
+  return makeRecord<Array::DOUBLE>(
+      samples,
+      dataStartTime +
+          Core::TimeSpan{recordIdx * recordSize / samplingFrequency},
+      samplingFrequency, chaCode);
+}
+
+Core::Time sampleTime(std::size_t recordIdx, std::size_t sampleIdx) {
+  return dataStartTime +
+         Core::TimeSpan{(recordIdx * recordSize + sampleIdx) /
+                        samplingFrequency};
+}
+
+bool equal(const Core::Time &lhs, const Core::Time &rhs) {
+  return std::abs(static_cast<double>(lhs - rhs)) < 1e-6;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(cascade_trigger_onset) {
+  detector::CascadeTrigger trigger{filterId, threshold};
+  BOOST_TEST(!trigger.onset());
+  BOOST_TEST(!trigger.lastTriggered());
+
+  // not exceeding the threshold
+  auto record{makeTriggerRecord(0, 0, 0)};
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  BOOST_TEST(!trigger.onset());
+  BOOST_TEST(!trigger.lastTriggered());
+
+  record = makeTriggerRecord(1, 10, 13);
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  BOOST_TEST_REQUIRE(static_cast<bool>(trigger.onset()));
+  BOOST_TEST_REQUIRE(static_cast<bool>(trigger.lastTriggered()));
+  BOOST_TEST(equal(*trigger.onset(), sampleTime(1, 10)));
+  BOOST_TEST(equal(*trigger.lastTriggered(), sampleTime(1, 12)));
+
+  // a trigger spanning multiple records keeps its onset
+  record = makeTriggerRecord(2, 25, recordSize);
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  record = makeTriggerRecord(3, 0, 5);
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  BOOST_TEST(equal(*trigger.onset(), sampleTime(2, 25)));
+  BOOST_TEST(equal(*trigger.lastTriggered(), sampleTime(3, 4)));
+
+  // the trigger is off, however, the most recent trigger is kept
+  record = makeTriggerRecord(4, 0, 0);
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  BOOST_TEST(equal(*trigger.onset(), sampleTime(2, 25)));
+  BOOST_TEST(equal(*trigger.lastTriggered(), sampleTime(3, 4)));
+
+  record = makeTriggerRecord(5, 1, 2);
+  BOOST_TEST_REQUIRE(trigger.feed(record.get()));
+  BOOST_TEST(equal(*trigger.onset(), sampleTime(5, 1)));
+  BOOST_TEST(equal(*trigger.lastTriggered(), sampleTime(5, 1)));
+}
+
+BOOST_AUTO_TEST_CASE(cascade_trigger_invalid_filter) {
+  BOOST_CHECK_THROW(detector::CascadeTrigger("STALTA(", threshold),
+                    processing::WaveformProcessor::BaseException);
+}
+
+BOOST_AUTO_TEST_CASE(cascade_trigger_registry) {
+  detector::CascadeTriggerRegistry registry;
+  BOOST_TEST(registry.empty());
+
+  const auto record{makeTriggerRecord(0, 10, 13)};
+  const auto otherRecord{makeTriggerRecord(0, 20, 23, "D")};
+
+  // the triggers are shared w.r.t. the stream, the filter and the threshold
+  const auto *trigger{registry.add(record->streamID(), filterId, threshold)};
+  BOOST_TEST(registry.add(record->streamID(), filterId, threshold) == trigger);
+  const auto *other{
+      registry.add(record->streamID(), filterId, 2 * threshold + 1)};
+  BOOST_TEST(other != trigger);
+  const auto *otherStream{
+      registry.add(otherRecord->streamID(), filterId, threshold)};
+  BOOST_TEST(otherStream != trigger);
+  BOOST_TEST(registry.size() == 3);
+
+  registry.feed(record.get());
+  BOOST_TEST_REQUIRE(static_cast<bool>(trigger->onset()));
+  BOOST_TEST(equal(*trigger->onset(), sampleTime(0, 10)));
+  // not exceeding the threshold
+  BOOST_TEST(!other->onset());
+  // not fed
+  BOOST_TEST(!otherStream->onset());
+
+  registry.feed(otherRecord.get());
+  BOOST_TEST_REQUIRE(static_cast<bool>(otherStream->onset()));
+  BOOST_TEST(equal(*otherStream->onset(), sampleTime(0, 20)));
+  BOOST_TEST(equal(*trigger->onset(), sampleTime(0, 10)));
+
+  // the most recent trigger is kept such that cascaded detectors do not wake up
+  // due to pre-triggers handled, already
+  registry.reset();
+  BOOST_TEST(static_cast<bool>(trigger->lastTriggered()));
+  // the triggers accept data after being reset
+  registry.feed(makeTriggerRecord(1, 0, 1).get());
+  BOOST_TEST(equal(*trigger->onset(), sampleTime(1, 0)));
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,169 @@
+#define SEISCOMP_TEST_MODULE test_detector_preprocessing_chain
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../detector/preprocessing_chain.h"
+#include "../detector/template_waveform_processor.h"
+#include "../template_waveform.h"
+#include "../util/memory.h"
+#include "utils.h"
+
+namespace utf = boost::unit_test;
+
+constexpr double testUnitTolerance{0.000001};
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr double samplingFrequency{10};
+constexpr std::size_t templateSize{50};
+constexpr std::size_t recordSize{100};
+constexpr std::size_t numRecords{10};
+
+const std::string filterId{"BW(2,0.5,2)"};
+const Core::TimeSpan initTime{5.0};
+
+const Core::Time dataStartTime{2021, 1, 1};
+
+struct Match {
+  // The start of the time window the match result refers to
+  Core::Time startTime;
+  Core::Time time;
+  double coefficient;
+};
+
+using Matches = std::vector<Match>;
+using MatchResult = detector::TemplateWaveformProcessor::MatchResult;
+
+std::unique_ptr<detector::TemplateWaveformProcessor> makeProcessor(
+    const std::vector<double> &templateData, Matches &matches) {
+  auto ret{util::make_unique<detector::TemplateWaveformProcessor>(
+      TemplateWaveform{makeRecord<Array::DOUBLE>(
+          templateData, Core::Time{2020, 1, 1}, samplingFrequency)})};
+  ret->setFilter(filterId, initTime);
+  ret->setResultCallback(
+      [&matches](const detector::TemplateWaveformProcessor *, const Record *,
+                 std::unique_ptr<const MatchResult> result) {
+        for (const auto &value : result->localMaxima) {
+          matches.push_back({result->timeWindow.startTime(),
+                             result->timeWindow.startTime() + value.lag,
+                             value.coefficient});
+        }
+      });
+  return ret;
+}
+
+std::vector<GenericRecordCPtr> makeRecords(std::mt19937 &generator) {
+  std::normal_distribution<double> distribution;
+  std::vector<GenericRecordCPtr> ret;
+  for (std::size_t i = 0; i < numRecords; ++i) {
+    ret.push_back(makeRecord<Array::DOUBLE>(
+        randomTimeSeries(recordSize, generator, distribution),
+        dataStartTime + Core::TimeSpan{i * recordSize / samplingFrequency},
+        samplingFrequency));
+  }
+  return ret;
+}
+
+}  // namespace
+
+BOOST_TEST_DECORATOR(*utf::tolerance(testUnitTolerance))
+BOOST_AUTO_TEST_CASE(preprocessing_chain_shared) {
+  std::mt19937 generator{42};
+  std::normal_distribution<double> distribution;
+  const auto templateData{
+      randomTimeSeries(templateSize, generator, distribution)};
+  const auto records{makeRecords(generator)};
+
+  Matches expected;
+  auto standalone{makeProcessor(templateData, expected)};
+
+  Matches matches;
+  auto subscriber{makeProcessor(templateData, matches)};
+  Matches otherMatches;
+  auto other{makeProcessor(templateData, otherMatches)};
+
+  detector::PreprocessingRegistry registry;
+  BOOST_TEST_REQUIRE(registry.add(records.front()->streamID(),
+                                  subscriber.get()));
+  BOOST_TEST_REQUIRE(registry.add(records.front()->streamID(), other.get()));
+  BOOST_TEST(registry.size() == 1);
+  BOOST_TEST(registry.subscribers() == 2);
+
+  for (const auto &record : records) {
+    BOOST_TEST_REQUIRE(standalone->feed(record.get()));
+
+    // the chain does not cross-correlate on behalf of its subscribers
+    const auto numMatches{matches.size()};
+    registry.feed(record.get());
+    BOOST_TEST(matches.size() == numMatches);
+
+    BOOST_TEST_REQUIRE(subscriber->feed(record.get()));
+    BOOST_TEST_REQUIRE(other->feed(record.get()));
+  }
+
+  BOOST_TEST_REQUIRE(!expected.empty());
+  for (const auto *m : {&matches, &otherMatches}) {
+    BOOST_TEST_REQUIRE(m->size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      BOOST_TEST(static_cast<double>((*m)[i].time - expected[i].time) == 0.0);
+      BOOST_TEST((*m)[i].coefficient == expected[i].coefficient);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(preprocessing_chain_subscriber_reset) {
+  std::mt19937 generator{42};
+  std::normal_distribution<double> distribution;
+  const auto templateData{
+      randomTimeSeries(templateSize, generator, distribution)};
+  const auto records{makeRecords(generator)};
+
+  Matches matches;
+  auto subscriber{makeProcessor(templateData, matches)};
+  Matches otherMatches;
+  auto other{makeProcessor(templateData, otherMatches)};
+
+  detector::PreprocessingRegistry registry;
+  BOOST_TEST_REQUIRE(registry.add(records.front()->streamID(),
+                                  subscriber.get()));
+  BOOST_TEST_REQUIRE(registry.add(records.front()->streamID(), other.get()));
+
+  const std::size_t resetIdx{numRecords / 2};
+  for (std::size_t i = 0; i < numRecords; ++i) {
+    if (i == resetIdx) {
+      // the chain keeps on preprocessing; the subscriber reset is
+      // initialized, again
+      subscriber->reset();
+      matches.clear();
+    }
+
+    registry.feed(records[i].get());
+    BOOST_TEST_REQUIRE(subscriber->feed(records[i].get()));
+    BOOST_TEST_REQUIRE(other->feed(records[i].get()));
+  }
+
+  BOOST_TEST_REQUIRE(!matches.empty());
+  const auto initialized{records[resetIdx]->startTime() + initTime};
+  for (const auto &m : matches) {
+    BOOST_TEST(static_cast<double>(m.startTime - initialized) >=
+               -0.5 / samplingFrequency);
+  }
+  // the other subscriber was not affected
+  BOOST_TEST(otherMatches.front().startTime < records[resetIdx]->startTime());
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
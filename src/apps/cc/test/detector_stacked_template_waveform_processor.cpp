@@ -0,0 +1,232 @@
+#define SEISCOMP_TEST_MODULE test_detector_stacked_template_waveform_processor
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/optional/optional.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../detector/arrival.h"
+#include "../detector/detector_impl.h"
+#include "../detector/stacked_template_waveform_processor.h"
+#include "../detector/template_waveform_processor.h"
+#include "../template_waveform.h"
+#include "../util/memory.h"
+#include "utils.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr double samplingFrequency{10};
+constexpr std::size_t templateSize{50};
+constexpr std::size_t dataSize{400};
+// The index of the data sample the template waveform is embedded at
+constexpr std::size_t matchIdx{100};
+
+const Core::Time templateStartTime{2020, 1, 1};
+const Core::Time dataStartTime{2021, 1, 1};
+
+// The template waveform and the data of a component
+struct Component {
+  std::string staCode;
+  std::string chaCode;
+
+  std::vector<double> templateData;
+  // Random data with the template waveform embedded at `matchIdx`
+  std::vector<double> data;
+};
+
+Component makeComponent(const std::string &staCode, const std::string &chaCode,
+                        std::mt19937 &generator) {
+  std::normal_distribution<double> distribution;
+  Component ret{staCode, chaCode,
+                randomTimeSeries(templateSize, generator, distribution),
+                randomTimeSeries(dataSize, generator, distribution)};
+  std::copy(ret.templateData.begin(), ret.templateData.end(),
+            ret.data.begin() + matchIdx);
+  return ret;
+}
+
+std::string waveformStreamId(const Component &component) {
+  return "N." + component.staCode + ".." + component.chaCode;
+}
+
+std::unique_ptr<detector::TemplateWaveformProcessor> makeProcessor(
+    const Component &component) {
+  auto ret{util::make_unique<detector::TemplateWaveformProcessor>(
+      TemplateWaveform{makeRecord<Array::DOUBLE>(
+          component.templateData, templateStartTime, samplingFrequency,
+          component.chaCode, "", component.staCode)})};
+  ret->setId(waveformStreamId(component));
+  return ret;
+}
+
+// Splits the component's data into records of `chunkSizes` samples
+std::vector<GenericRecordCPtr> makeRecords(
+    const Component &component, const std::vector<std::size_t> &chunkSizes) {
+  std::vector<GenericRecordCPtr> ret;
+  std::size_t offset{0};
+  for (const auto &chunkSize : chunkSizes) {
+    std::vector<double> samples{
+        component.data.begin() + offset,
+        component.data.begin() + offset + chunkSize};
+    ret.push_back(makeRecord<Array::DOUBLE>(
+        samples,
+        dataStartTime + Core::TimeSpan{offset / samplingFrequency},
+        samplingFrequency, component.chaCode, "", component.staCode));
+    offset += chunkSize;
+  }
+  return ret;
+}
+
+detector::Arrival makeArrival(const Core::TimeSpan &offset,
+                              const Component &component,
+                              const std::string &phase) {
+  detector::Pick pick;
+  pick.time = templateStartTime + offset;
+  pick.waveformStreamId = waveformStreamId(component);
+  pick.offset = offset;
+  return detector::Arrival{pick, phase};
+}
+
+struct Match {
+  Core::Time time;
+  double coefficient;
+};
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(stacked_local_maxima_chunk_boundary) {
+  std::mt19937 generator{42};
+  const auto z{makeComponent("S", "Z", generator)};
+  const auto n{makeComponent("S", "N", generator)};
+
+  const Core::Time expected{dataStartTime +
+                            Core::TimeSpan{matchIdx / samplingFrequency}};
+  // the maximum coefficient refers to the last sample of the first chunk if
+  // the first chunk ends with the embedded template waveform
+  const auto boundary{matchIdx + templateSize};
+  for (const auto &chunkSizes : std::vector<std::vector<std::size_t>>{
+           {dataSize},
+           {boundary, dataSize - boundary},
+           {boundary - 1, 1, dataSize - boundary},
+           {boundary + 1, dataSize - boundary - 1}}) {
+    detector::StackedTemplateWaveformProcessor stacked{makeProcessor(z),
+                                                       waveformStreamId(z)};
+    stacked.add(makeProcessor(n), waveformStreamId(n));
+
+    std::vector<Match> matches;
+    stacked.setResultCallback(
+        [&matches](const detector::TemplateWaveformProcessor *,
+                   const Record *,
+                   std::unique_ptr<const detector::TemplateWaveformProcessor::
+                                       MatchResult>
+                       result) {
+          for (const auto &value : result->localMaxima) {
+            matches.push_back(
+                {result->timeWindow.startTime() + value.lag,
+                 value.coefficient});
+          }
+        });
+
+    const auto recordsZ{makeRecords(z, chunkSizes)};
+    const auto recordsN{makeRecords(n, chunkSizes)};
+    for (std::size_t i = 0; i < chunkSizes.size(); ++i) {
+      BOOST_TEST_REQUIRE(stacked.feed(recordsZ[i].get()));
+      BOOST_TEST_REQUIRE(stacked.feed(recordsN[i].get()));
+    }
+
+    BOOST_TEST_REQUIRE(!matches.empty());
+    const auto best{std::max_element(matches.begin(), matches.end(),
+                                     [](const Match &lhs, const Match &rhs) {
+                                       return lhs.coefficient <
+                                              rhs.coefficient;
+                                     })};
+    BOOST_TEST(best->coefficient > 0.99);
+    BOOST_TEST(std::abs(static_cast<double>(best->time - expected)) <
+               0.5 / samplingFrequency);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(stacked_detection) {
+  std::mt19937 generator{42};
+  const auto z{makeComponent("S1", "Z", generator)};
+  const auto n{makeComponent("S1", "N", generator)};
+  // a single component station (not fed)
+  const auto other{makeComponent("S2", "Z", generator)};
+
+  detector::DetectorImpl detectorImpl{nullptr};
+  detectorImpl.setTriggerThresholds(0.9);
+  // the stacked processor provides the arrivals required, by itself
+  detectorImpl.setMinArrivals(2);
+
+  std::vector<detector::DetectorImpl::Result> results;
+  detectorImpl.setResultCallback(
+      [&results](const detector::DetectorImpl::Result &result) {
+        results.push_back(result);
+      });
+
+  auto stacked{util::make_unique<detector::StackedTemplateWaveformProcessor>(
+      makeProcessor(z), waveformStreamId(z))};
+  stacked->add(makeProcessor(n), waveformStreamId(n));
+  stacked->setId(waveformStreamId(z));
+  detectorImpl.add(std::move(stacked),
+                   {makeArrival(Core::TimeSpan{1.0}, z, "P"),
+                    makeArrival(Core::TimeSpan{2.0}, n, "S")},
+                   {0, 0, "S1"}, boost::none);
+  detectorImpl.add(makeProcessor(other), waveformStreamId(other),
+                   makeArrival(Core::TimeSpan{1.5}, other, "P"), {1, 1, "S2"},
+                   boost::none);
+
+  BOOST_TEST(detectorImpl.processorCount() == 2);
+  BOOST_TEST(detectorImpl.minArrivals().value_or(0) == 2);
+  BOOST_TEST(detectorImpl.processor(waveformStreamId(n)) != nullptr);
+
+  const std::vector<std::size_t> chunkSizes{matchIdx + templateSize,
+                                            dataSize - matchIdx - templateSize};
+  const auto recordsZ{makeRecords(z, chunkSizes)};
+  const auto recordsN{makeRecords(n, chunkSizes)};
+  for (std::size_t i = 0; i < chunkSizes.size(); ++i) {
+    detectorImpl.feed(recordsZ[i].get());
+    detectorImpl.feed(recordsN[i].get());
+  }
+  detectorImpl.flush();
+
+  BOOST_TEST_REQUIRE(results.size() == 1);
+  const auto &result{results.front()};
+  BOOST_TEST(result.numChannelsUsed == 2);
+  BOOST_TEST(result.numChannelsAssociated == 3);
+  BOOST_TEST(result.numStationsUsed == 1);
+
+  // an arrival per component
+  BOOST_TEST_REQUIRE(result.templateResults.size() == 2);
+  const Core::Time matchTime{dataStartTime +
+                             Core::TimeSpan{matchIdx / samplingFrequency}};
+  const auto checkArrival = [&](const Component &component,
+                                const Core::TimeSpan &offset) {
+    const auto it{result.templateResults.find(waveformStreamId(component))};
+    BOOST_TEST_REQUIRE((it != result.templateResults.end()));
+    const auto &templateResult{it->second};
+    BOOST_TEST(templateResult.processorId == waveformStreamId(component));
+    BOOST_TEST(templateResult.arrival.pick.waveformStreamId ==
+               waveformStreamId(component));
+    BOOST_TEST(std::abs(static_cast<double>(templateResult.arrival.pick.time -
+                                            (matchTime + offset))) <
+               0.5 / samplingFrequency);
+  };
+  checkArrival(z, Core::TimeSpan{1.0});
+  checkArrival(n, Core::TimeSpan{2.0});
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
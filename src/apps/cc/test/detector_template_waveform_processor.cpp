@@ -0,0 +1,109 @@
+#define SEISCOMP_TEST_MODULE test_detector_template_waveform_processor
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../detector/template_waveform_processor.h"
+#include "../filter/local_maxima.h"
+#include "../template_waveform.h"
+#include "../util/memory.h"
+#include "utils.h"
+
+namespace utf = boost::unit_test;
+
+constexpr double testUnitTolerance{0.000001};
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr double samplingFrequency{10};
+constexpr std::size_t templateSize{20};
+constexpr std::size_t recordSize{100};
+constexpr std::size_t numRecords{4};
+
+const std::string filterId{"BW(2,0.5,2)"};
+// processing starts within the first record
+const Core::TimeSpan initTime{5.0};
+
+const Core::Time dataStartTime{2021, 1, 1};
+
+std::unique_ptr<detector::TemplateWaveformProcessor> makeProcessor(
+    const std::vector<double> &templateData) {
+  auto ret{util::make_unique<detector::TemplateWaveformProcessor>(
+      TemplateWaveform{makeRecord<Array::DOUBLE>(
+          templateData, Core::Time{2020, 1, 1}, samplingFrequency)})};
+  ret->setFilter(filterId, initTime);
+  return ret;
+}
+
+}  // namespace
+
+// The local maxima detected while cross-correlating must correspond to the
+// local maxima searched for within the coefficients of each record processed
+// (starting from the first coefficient processed)
+BOOST_TEST_DECORATOR(*utf::tolerance(testUnitTolerance))
+BOOST_AUTO_TEST_CASE(local_maxima_processing_start) {
+  for (unsigned seed = 0; seed < 10; ++seed) {
+    std::mt19937 generator{seed};
+    std::normal_distribution<double> distribution;
+    const auto templateData{
+        randomTimeSeries(templateSize, generator, distribution)};
+
+    std::vector<double> expected;
+    auto reference{makeProcessor(templateData)};
+    reference->setCoefficientsCallback(
+        [&expected](const detector::TemplateWaveformProcessor *,
+                    const Record *,
+                    const detector::TemplateWaveformProcessor::Coefficients
+                        &coefficients) {
+          filter::LocalMaxima maxima;
+          for (std::size_t i = 0; i < coefficients.size; ++i) {
+            maxima.feed(coefficients.data[i], i);
+          }
+          for (const auto &m : maxima.values) {
+            expected.push_back(m.coefficient);
+          }
+        });
+
+    std::vector<double> detected;
+    auto processor{makeProcessor(templateData)};
+    processor->setResultCallback(
+        [&detected](const detector::TemplateWaveformProcessor *,
+                    const Record *,
+                    std::unique_ptr<const detector::TemplateWaveformProcessor::
+                                        MatchResult>
+                        result) {
+          for (const auto &value : result->localMaxima) {
+            detected.push_back(value.coefficient);
+          }
+        });
+
+    for (std::size_t i = 0; i < numRecords; ++i) {
+      const auto record{makeRecord<Array::DOUBLE>(
+          randomTimeSeries(recordSize, generator, distribution),
+          dataStartTime + Core::TimeSpan{i * recordSize / samplingFrequency},
+          samplingFrequency)};
+      BOOST_TEST_REQUIRE(reference->feed(record.get()));
+      BOOST_TEST_REQUIRE(processor->feed(record.get()));
+    }
+
+    BOOST_TEST_REQUIRE(!expected.empty());
+    BOOST_TEST_REQUIRE(detected.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      BOOST_TEST(detected[i] == expected[i]);
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,185 @@
+#define SEISCOMP_TEST_MODULE test_detector_worker_pool
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../detector/worker_pool.h"
+#include "../processing/waveform_processor.h"
+#include "../util/memory.h"
+#include "utils.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+constexpr double samplingFrequency{10};
+constexpr std::size_t recordSize{10};
+
+const Core::Time dataStartTime{2021, 1, 1};
+
+GenericRecordPtr makeStreamRecord(std::size_t recordIdx,
+                                  const std::string &chaCode) {
+  return makeRecord<Array::DOUBLE>(
+      std::vector<double>(recordSize, 0),
+      dataStartTime +
+          Core::TimeSpan{recordIdx * recordSize / samplingFrequency},
+      samplingFrequency, chaCode);
+}
+
+// Counts the records processed concurrently
+struct Concurrency {
+  std::atomic<std::size_t> current{0};
+  std::atomic<std::size_t> max{0};
+};
+
+// A waveform processor emitting a detection per record fed (by means of the
+// `pool`) where the detection's score identifies both the record and the
+// processor
+class Processor : public processing::WaveformProcessor {
+ public:
+  Processor(detector::WorkerPool &pool, std::size_t idx,
+            Concurrency &concurrency, std::size_t waitFor)
+      : _pool(pool),
+        _idx{idx},
+        _concurrency(concurrency),
+        _waitFor{waitFor} {}
+
+  bool feed(const Record *record) override {
+    const auto current{++_concurrency.current};
+    auto max{_concurrency.max.load()};
+    while (max < current &&
+           !_concurrency.max.compare_exchange_weak(max, current)) {
+    }
+
+    // wait (for a limited time) until `_waitFor` records are processed
+    // concurrently
+    const auto deadline{std::chrono::steady_clock::now() +
+                        std::chrono::seconds{5}};
+    while (_concurrency.max < _waitFor &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+
+    auto detection{util::make_unique<detector::Detector::Detection>()};
+    detection->score = static_cast<double>(_fed++ * 100 + _idx);
+    std::unique_ptr<const detector::Detector::Detection> collected{
+        std::move(detection)};
+    _pool.collect(nullptr, record, collected);
+
+    --_concurrency.current;
+    return true;
+  }
+
+ protected:
+  WaveformProcessor::StreamState *streamState(const Record *) override {
+    return nullptr;
+  }
+
+ private:
+  detector::WorkerPool &_pool;
+  std::size_t _idx;
+  Concurrency &_concurrency;
+  std::size_t _waitFor;
+  std::size_t _fed{0};
+};
+
+std::vector<double> scores(const detector::WorkerPool::Results &results) {
+  std::vector<double> ret;
+  for (const auto &result : results) {
+    ret.push_back(result.detection->score);
+  }
+  return ret;
+}
+
+}  // namespace
+
+// Records of different streams are processed concurrently, i.e. feeding
+// does not wait for the records being processed
+BOOST_AUTO_TEST_CASE(worker_pool_multi_stream_overlap) {
+  const auto record{makeStreamRecord(0, "A")};
+  const auto otherRecord{makeStreamRecord(0, "B")};
+
+  detector::WorkerPool pool{2};
+  Concurrency concurrency;
+  // each processor waits until both records are processed concurrently
+  Processor processor{pool, 0, concurrency, 2};
+  Processor otherProcessor{pool, 1, concurrency, 2};
+  pool.add(&processor, std::vector<std::string>{record->streamID()}, 1);
+  pool.add(&otherProcessor, std::vector<std::string>{otherRecord->streamID()},
+           1);
+  pool.start();
+
+  BOOST_TEST(pool.feed(record.get()).empty());
+  pool.feed(otherRecord.get());
+
+  auto results{pool.flush()};
+  pool.stop();
+
+  BOOST_TEST(concurrency.max == 2);
+  // the detections are merged in the order the records were fed
+  BOOST_TEST_REQUIRE(results.size() == 2);
+  BOOST_TEST(scores(results) == std::vector<double>({0, 1}),
+             boost::test_tools::per_element());
+  BOOST_TEST(results[0].record.get() == record.get());
+  BOOST_TEST(results[1].record.get() == otherRecord.get());
+}
+
+// The detections are merged in the order of the single-threaded execution
+// (regardless of the number of workers)
+BOOST_AUTO_TEST_CASE(worker_pool_merge_order) {
+  const std::vector<std::string> chaCodes{"A", "B", "C"};
+  const std::size_t numRecords{50};
+  const std::size_t processorsPerStream{2};
+
+  for (std::size_t numWorkers : {1, 2, 4}) {
+    detector::WorkerPool pool{numWorkers};
+    Concurrency concurrency;
+    std::vector<std::unique_ptr<Processor>> processors;
+    for (std::size_t i = 0; i < chaCodes.size(); ++i) {
+      const auto streamId{makeStreamRecord(0, chaCodes[i])->streamID()};
+      for (std::size_t j = 0; j < processorsPerStream; ++j) {
+        processors.emplace_back(util::make_unique<Processor>(
+            pool, i * processorsPerStream + j, concurrency, 0));
+        pool.add(processors.back().get(), std::vector<std::string>{streamId},
+                 1);
+      }
+    }
+    pool.start();
+
+    std::vector<double> expected;
+    std::vector<double> merged;
+    for (std::size_t i = 0; i < numRecords; ++i) {
+      for (std::size_t j = 0; j < chaCodes.size(); ++j) {
+        for (std::size_t k = 0; k < processorsPerStream; ++k) {
+          expected.push_back(
+              static_cast<double>(i * 100 + j * processorsPerStream + k));
+        }
+
+        const auto record{makeStreamRecord(i, chaCodes[j])};
+        const auto results{scores(pool.feed(record.get()))};
+        merged.insert(std::end(merged), std::begin(results),
+                      std::end(results));
+      }
+    }
+    const auto results{scores(pool.flush())};
+    merged.insert(std::end(merged), std::begin(results), std::end(results));
+    pool.stop();
+
+    BOOST_TEST(merged == expected, boost::test_tools::per_element());
+  }
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
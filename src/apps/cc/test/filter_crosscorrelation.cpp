@@ -6,21 +6,49 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/test/data/dataset.hpp>
+#include <boost/test/data/monomorphic.hpp>
 #include <boost/test/data/test_case.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <random>
 #include <string>
 #include <vector>
 
+#include "../filter/coarse_search.h"
 #include "../filter/crosscorrelation.h"
-#include "../util/memory.h"
+#include "../filter/crosscorrelation_bank.h"
+#include "../filter/detail/cluster.h"
+#include "../filter/local_maxima.h"
+#include "../util/fft.h"
+#include "utils.h"
 
 namespace utf = boost::unit_test;
 namespace utf_data = utf::data;
 namespace utf_tt = boost::test_tools;
 
 constexpr double testUnitTolerance{0.000001};
+// The maximum absolute deviation of correlation coefficients computed in
+// single precision from those computed in double precision
+constexpr double testSinglePrecisionTolerance{1e-5};
 
 namespace Seiscomp {
 namespace detect {
+namespace filter {
+
+std::ostream &operator<<(std::ostream &os, CorrelationEngine engine) {
+  switch (engine) {
+    case CorrelationEngine::kTimeDomain:
+      return os << "time domain";
+    case CorrelationEngine::kFrequencyDomain:
+      return os << "frequency domain";
+  }
+  return os;
+}
+
+}  // namespace filter
+
 namespace test {
 namespace ds {
 
@@ -95,15 +123,51 @@ const Samples dataset{
 
 };
 
-BOOST_TEST_DECORATOR(*utf::tolerance(testUnitTolerance))
-BOOST_DATA_TEST_CASE(crosscorrelation, utf_data::make(dataset)) {
-  // create dummy record
-  auto templateTrace{util::make_smart<GenericRecord>("NET", "STA", "LOC", "CHA",
-                                                     Core::Time::GMT(), 1.0)};
-  templateTrace->setData(static_cast<int>(sample.templateData.size()),
-                         sample.templateData.data(), Array::DOUBLE);
+using Engine = filter::CorrelationEngine;
+const std::vector<Engine> engines{Engine::kTimeDomain,
+                                  Engine::kFrequencyDomain};
 
-  filter::CrossCorrelation<double> xcorr{templateTrace};
+// Fixture providing (pseudo) random data. The generator is seeded with a
+// fixed seed such that test cases are reproducible.
+struct RandomData {
+  using TimeSeries = ds::Sample::TimeSeries;
+
+  // Returns a time series with `size` random samples
+  TimeSeries timeSeries(std::size_t size) {
+    return randomTimeSeries(size, generator, distribution);
+  }
+  // Returns a time series with a random number of random samples less than
+  // `maxSize`
+  TimeSeries chunk(std::size_t maxSize) {
+    return timeSeries(generator() % maxSize);
+  }
+  // Returns a random sample
+  double sample() { return distribution(generator); }
+
+  std::mt19937 generator{42};
+  std::normal_distribution<double> distribution;
+};
+
+// Returns a record with a sampling frequency of 1Hz containing `data`
+GenericRecordPtr makeTrace(const ds::Sample::TimeSeries &data) {
+  return makeRecord<Array::DOUBLE>(data, Core::Time::GMT(), 1.0);
+}
+
+// Checks that the `n` values `computed` deviate from the `expected` values by
+// at most `tolerance` (absolute deviation)
+template <typename TComputed>
+void checkClose(const TComputed *computed, const double *expected,
+                std::size_t n, double tolerance = testUnitTolerance) {
+  for (std::size_t i = 0; i < n; ++i) {
+    BOOST_TEST(std::abs(computed[i] - expected[i]) <= tolerance,
+               "value " << i << ": " << computed[i] << " != " << expected[i]);
+  }
+}
+
+void testCrossCorrelation(const ds::Sample &sample,
+                          filter::CrossCorrelation<double>::Engine engine) {
+  filter::CrossCorrelation<double> xcorr{makeTrace(sample.templateData)};
+  xcorr.setEngine(engine);
 
   std::vector<ds::Sample::TimeSeries> filtered;
   for (auto data : sample.data) {
@@ -116,6 +180,551 @@ BOOST_DATA_TEST_CASE(crosscorrelation, utf_data::make(dataset)) {
   BOOST_TEST(joined == sample.expected, utf_tt::per_element());
 }
 
+BOOST_TEST_DECORATOR(*utf::tolerance(testUnitTolerance))
+BOOST_DATA_TEST_CASE(crosscorrelation,
+                     utf_data::make(dataset) * utf_data::make(engines),
+                     sample, engine) {
+  testCrossCorrelation(sample, engine);
+}
+
+BOOST_AUTO_TEST_CASE(overlap_save_fft_size) {
+  // short data: the smallest FFT size possible
+  BOOST_TEST(util::overlapSaveFftSize(100, 10, 1 << 15) == 256);
+  BOOST_TEST(util::overlapSaveFftSize(100, 100, 1 << 15) == 256);
+  // long data: larger blocks amortize the transforms
+  const auto fftSize{util::overlapSaveFftSize(100, 100000, 1 << 15)};
+  BOOST_TEST(fftSize > 256);
+  BOOST_TEST(fftSize <= (1 << 15));
+  // the maximum FFT size is respected unless it is less than the minimum
+  BOOST_TEST(util::overlapSaveFftSize(100, 100000, 512) <= 512);
+  BOOST_TEST(util::overlapSaveFftSize(100, 100000, 64) == 256);
+}
+
+BOOST_FIXTURE_TEST_CASE(crosscorrelation_frequency_domain_growing_blocks,
+                        RandomData) {
+  const auto templateTrace{makeTrace(timeSeries(50))};
+
+  filter::CrossCorrelation<double> xcorrTimeDomain{templateTrace};
+  xcorrTimeDomain.setEngine(Engine::kTimeDomain);
+  filter::CrossCorrelation<double> xcorrFrequencyDomain{templateTrace};
+  xcorrFrequencyDomain.setEngine(Engine::kFrequencyDomain);
+
+  // chunks both shorter and (much) longer than the initial block size; the
+  // same filters are fed such that the block size grows
+  for (std::size_t chunkSize : {7, 20000, 300, 100000, 1}) {
+    auto expected{timeSeries(chunkSize)};
+    auto filtered{expected};
+    xcorrTimeDomain.apply(expected);
+    xcorrFrequencyDomain.apply(filtered);
+
+    BOOST_TEST_REQUIRE(filtered.size() == expected.size());
+    checkClose(filtered.data(), expected.data(), expected.size());
+  }
+}
+
+void testCrossCorrelationBank(const ds::Sample &sample) {
+  filter::CrossCorrelationBank<double> bank;
+  const auto idx{bank.add(TemplateWaveform{makeTrace(sample.templateData)})};
+  // members with a template waveform of different size do not share the
+  // rolling statistics of the data
+  bank.add(TemplateWaveform{makeTrace({1, 2, 3, 4, 3, 2, 1})});
+  const auto duplicateIdx{
+      bank.add(TemplateWaveform{makeTrace(sample.templateData)})};
+  bank.setSamplingFrequency(1.0);
+
+  std::vector<ds::Sample::TimeSeries> filtered;
+  std::vector<ds::Sample::TimeSeries> filteredDuplicate;
+  for (const auto &data : sample.data) {
+    bank.apply(data.size(), data.data());
+    filtered.emplace_back(bank.coefficients(idx),
+                          bank.coefficients(idx) + data.size());
+    filteredDuplicate.emplace_back(
+        bank.coefficients(duplicateIdx),
+        bank.coefficients(duplicateIdx) + data.size());
+  }
+
+  const auto joined{ds::Join(filtered)};
+  BOOST_TEST_REQUIRE(joined.size() == sample.expected.size());
+  BOOST_TEST(joined == sample.expected, utf_tt::per_element());
+
+  const auto joinedDuplicate{ds::Join(filteredDuplicate)};
+  BOOST_TEST_REQUIRE(joinedDuplicate.size() == sample.expected.size());
+  BOOST_TEST(joinedDuplicate == sample.expected, utf_tt::per_element());
+}
+
+BOOST_TEST_DECORATOR(*utf::tolerance(testUnitTolerance))
+BOOST_DATA_TEST_CASE(crosscorrelation_bank, utf_data::make(dataset)) {
+  testCrossCorrelationBank(sample);
+}
+
+BOOST_DATA_TEST_CASE(crosscorrelation_single_precision,
+                     utf_data::make(dataset) * utf_data::make(engines),
+                     sample, engine) {
+  filter::CrossCorrelation<float> xcorr{makeTrace(sample.templateData)};
+  xcorr.setEngine(engine);
+
+  std::vector<ds::Sample::TimeSeries> filtered;
+  for (const auto &data : sample.data) {
+    std::vector<float> samples{data.begin(), data.end()};
+    xcorr.apply(samples);
+    filtered.emplace_back(samples.begin(), samples.end());
+  }
+
+  const auto joined{ds::Join(filtered)};
+  BOOST_TEST_REQUIRE(joined.size() == sample.expected.size());
+  checkClose(joined.data(), sample.expected.data(), joined.size(),
+             testSinglePrecisionTolerance);
+}
+
+// Compares the correlation coefficients computed in single precision with
+// those computed in double precision for random data with a non-zero mean
+BOOST_DATA_TEST_CASE_F(RandomData, crosscorrelation_single_vs_double_precision,
+                       utf_data::make(engines), engine) {
+  distribution = std::normal_distribution<double>{100, 1000};
+  const auto templateTrace{makeTrace(timeSeries(200))};
+
+  filter::CrossCorrelation<double> xcorrDouble{templateTrace};
+  xcorrDouble.setEngine(engine);
+  filter::CrossCorrelation<float> xcorrSingle{templateTrace};
+  xcorrSingle.setEngine(engine);
+
+  for (std::size_t c = 0; c < 50; ++c) {
+    auto expected{chunk(1000)};
+    std::vector<float> samples{expected.begin(), expected.end()};
+    xcorrDouble.apply(expected);
+    xcorrSingle.apply(samples);
+
+    checkClose(samples.data(), expected.data(), expected.size(),
+               testSinglePrecisionTolerance);
+  }
+}
+
+// The local maxima detected while cross-correlating must correspond to the
+// local maxima detected by rescanning the correlation coefficients
+BOOST_DATA_TEST_CASE_F(RandomData, crosscorrelation_local_maxima,
+                       utf_data::make(engines) * utf_data::make({-1.0, 0.2}),
+                       engine, threshold) {
+  filter::CrossCorrelation<double> xcorr{makeTrace(timeSeries(120))};
+  xcorr.setEngine(engine);
+  xcorr.setLocalMaximaThreshold(threshold);
+
+  for (std::size_t c = 0; c < 40; ++c) {
+    auto data{chunk(900)};
+    xcorr.apply(data);
+
+    filter::LocalMaxima expected;
+    expected.threshold = threshold;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      expected.feed(data[i], i);
+    }
+
+    const auto &detected{xcorr.localMaxima()};
+    BOOST_TEST_REQUIRE(detected.size() == expected.values.size());
+    for (std::size_t i = 0; i < detected.size(); ++i) {
+      BOOST_TEST(detected[i].lagIdx == expected.values[i].lagIdx);
+      BOOST_TEST(detected[i].coefficient == expected.values[i].coefficient);
+      BOOST_TEST(detected[i].coefficient >= threshold);
+    }
+  }
+}
+
+// Template waveforms which are linear combinations of two random time series
+// span a two-dimensional subspace. Thus, the correlation coefficients
+// reconstructed from the subspace must correspond to the ones computed with
+// the template waveforms directly.
+BOOST_FIXTURE_TEST_CASE(crosscorrelation_bank_subspace, RandomData) {
+  const std::size_t templateSize{100};
+  const std::size_t numTemplates{8};
+
+  const auto basis{timeSeries(2 * templateSize)};
+
+  filter::CrossCorrelationBank<double> bank;
+  filter::CrossCorrelationBank<double> subspaceBank;
+  subspaceBank.setSubspaceEnergyFraction(1.0);
+  for (std::size_t i = 0; i < numTemplates; ++i) {
+    const double weight0{sample()};
+    const double weight1{sample()};
+    std::vector<double> templateData(templateSize);
+    for (std::size_t k = 0; k < templateSize; ++k) {
+      templateData[k] = weight0 * basis[k] + weight1 * basis[templateSize + k];
+    }
+
+    const auto templateTrace{makeTrace(templateData)};
+    bank.add(TemplateWaveform{templateTrace});
+    subspaceBank.add(TemplateWaveform{templateTrace});
+  }
+  bank.setSamplingFrequency(1.0);
+  subspaceBank.setSamplingFrequency(1.0);
+
+  for (std::size_t i = 0; i < numTemplates; ++i) {
+    BOOST_TEST(bank.subspaceDimension(i) == 0);
+    BOOST_TEST(subspaceBank.subspaceDimension(i) == 2);
+  }
+
+  for (std::size_t c = 0; c < 20; ++c) {
+    const auto data{chunk(500)};
+    bank.apply(data.size(), data.data());
+    subspaceBank.apply(data.size(), data.data());
+    for (std::size_t i = 0; i < numTemplates; ++i) {
+      checkClose(subspaceBank.coefficients(i), bank.coefficients(i),
+                 data.size());
+    }
+  }
+}
+
+// Template waveforms which are noisy copies of a common random time series
+// form a single cluster. Correlation coefficients greater than or equal to
+// the threshold must correspond to the ones computed without clustering.
+BOOST_FIXTURE_TEST_CASE(crosscorrelation_bank_clustering, RandomData) {
+  const std::size_t templateSize{100};
+  const std::size_t numTemplates{8};
+  const double threshold{0.5};
+
+  const auto master{timeSeries(templateSize)};
+
+  filter::CrossCorrelationBank<double> bank;
+  filter::CrossCorrelationBank<double> clusteredBank;
+  clusteredBank.setClustering(0.8);
+  std::vector<std::vector<double>> templateWaveforms;
+  for (std::size_t i = 0; i < numTemplates; ++i) {
+    std::vector<double> templateData(master);
+    for (auto &s : templateData) {
+      s += 0.2 * sample();
+    }
+    templateWaveforms.push_back(templateData);
+
+    const auto templateTrace{makeTrace(templateData)};
+    bank.add(TemplateWaveform{templateTrace});
+    const auto idx{clusteredBank.add(TemplateWaveform{templateTrace})};
+    clusteredBank.setThreshold(idx, threshold);
+  }
+  bank.setSamplingFrequency(1.0);
+  clusteredBank.setSamplingFrequency(1.0);
+
+  for (std::size_t c = 0; c < 20; ++c) {
+    auto data{chunk(500)};
+    // embed a template waveform
+    if (data.size() > templateSize) {
+      const auto &templateWaveform{
+          templateWaveforms[generator() % numTemplates]};
+      for (std::size_t k = 0; k < templateSize; ++k) {
+        data[k] += 3 * templateWaveform[k];
+      }
+    }
+
+    bank.apply(data.size(), data.data());
+    clusteredBank.apply(data.size(), data.data());
+    for (std::size_t i = 0; i < numTemplates; ++i) {
+      for (std::size_t j = 0; j < data.size(); ++j) {
+        const auto expected{bank.coefficients(i)[j]};
+        const auto computed{clusteredBank.coefficients(i)[j]};
+        if (std::isnan(computed)) {
+          BOOST_TEST(expected < threshold);
+        } else {
+          BOOST_TEST(std::abs(computed - expected) <= testUnitTolerance);
+        }
+      }
+    }
+  }
+
+  const auto clusters{clusteredBank.clusterStatistics()};
+  BOOST_TEST_REQUIRE(clusters.size() == 1);
+  BOOST_TEST(clusters.front().members.size() == numTemplates - 1);
+  BOOST_TEST(clusters.front().coefficientsComputed <
+             clusters.front().lags * numTemplates);
+}
+
+// The clusters must partition the template waveforms such that the
+// similarity of all pairs of template waveforms of a cluster is greater than
+// or equal to the threshold while no pair of clusters could be merged.
+BOOST_FIXTURE_TEST_CASE(cluster_hierarchically, RandomData) {
+  const std::size_t templateSize{50};
+  const std::size_t stride{56};
+  const std::size_t numMasters{4};
+  const std::size_t numTemplates{60};
+  const double threshold{0.7};
+
+  std::vector<std::vector<double>> masters;
+  for (std::size_t i = 0; i < numMasters; ++i) {
+    masters.push_back(timeSeries(templateSize));
+  }
+  std::vector<double> templateWfs(numTemplates * stride, 0);
+  for (std::size_t r = 0; r < numTemplates; ++r) {
+    const auto &master{masters[generator() % numMasters]};
+    const double noise{0.1 * static_cast<double>(generator() % 10)};
+    for (std::size_t k = 0; k < templateSize; ++k) {
+      templateWfs[r * stride + k] = master[k] + noise * sample();
+    }
+  }
+
+  const auto similarities{filter::detail::computeSimilarities(
+      templateWfs.data(), numTemplates, stride, templateSize)};
+  BOOST_TEST_REQUIRE(similarities.size() ==
+                     numTemplates * (numTemplates - 1) / 2);
+  const auto similarity = [&](std::size_t i, std::size_t j) {
+    return static_cast<double>(
+        similarities[filter::detail::condensedIndex(i, j, numTemplates)]);
+  };
+
+  const auto clusters{filter::detail::clusterHierarchically(
+      templateWfs.data(), numTemplates, stride, templateSize, threshold)};
+  BOOST_TEST(clusters.size() < numTemplates);
+
+  std::vector<std::vector<std::size_t>> members;
+  std::vector<std::size_t> counts(numTemplates, 0);
+  for (const auto &cluster : clusters) {
+    BOOST_TEST_REQUIRE(cluster.members.size() == cluster.similarities.size());
+    ++counts[cluster.representative];
+    members.push_back({cluster.representative});
+    for (std::size_t k = 0; k < cluster.members.size(); ++k) {
+      ++counts[cluster.members[k]];
+      members.back().push_back(cluster.members[k]);
+      BOOST_TEST(std::abs(cluster.similarities[k] -
+                          similarity(cluster.representative,
+                                     cluster.members[k])) <=
+                 testSinglePrecisionTolerance);
+    }
+  }
+  BOOST_TEST(std::all_of(counts.begin(), counts.end(),
+                         [](std::size_t count) { return count == 1; }));
+
+  for (std::size_t c = 0; c < members.size(); ++c) {
+    for (std::size_t i = 0; i < members[c].size(); ++i) {
+      for (std::size_t j = i + 1; j < members[c].size(); ++j) {
+        BOOST_TEST(similarity(members[c][i], members[c][j]) >= threshold);
+      }
+    }
+    // complete linkage w.r.t. the remaining clusters
+    for (std::size_t d = c + 1; d < members.size(); ++d) {
+      double linkage{1};
+      for (const auto i : members[c]) {
+        for (const auto j : members[d]) {
+          linkage = std::min(linkage, similarity(i, j));
+        }
+      }
+      BOOST_TEST(linkage < threshold);
+    }
+  }
+}
+
+// Template waveforms embedded into the data must be found by means of the
+// fingerprint based similarity search. Correlation coefficients computed must
+// correspond to the ones computed without the fingerprint based similarity
+// search.
+BOOST_FIXTURE_TEST_CASE(crosscorrelation_bank_fingerprint_search,
+                        RandomData) {
+  const std::size_t templateSize{500};
+  const std::size_t numTemplates{20};
+
+  filter::CrossCorrelationBank<double> bank;
+  filter::CrossCorrelationBank<double> fingerprintBank;
+  fingerprintBank.setFingerprintSearch(5.0);
+  std::vector<std::vector<double>> templateWaveforms;
+  for (std::size_t i = 0; i < numTemplates; ++i) {
+    std::vector<double> templateData(templateSize);
+    for (std::size_t k = 0; k < templateSize; ++k) {
+      templateData[k] = sample() * std::exp(-(k / 150.0));
+    }
+    templateWaveforms.push_back(templateData);
+
+    const auto templateTrace{makeTrace(templateData)};
+    bank.add(TemplateWaveform{templateTrace});
+    fingerprintBank.add(TemplateWaveform{templateTrace});
+  }
+  bank.setSamplingFrequency(1.0);
+  fingerprintBank.setSamplingFrequency(1.0);
+
+  for (std::size_t c = 0; c < 20; ++c) {
+    auto data{timeSeries(600)};
+    for (auto &s : data) {
+      s *= 0.1;
+    }
+    // embed a template waveform such that it ends within the chunk
+    const auto idx{c % numTemplates};
+    for (std::size_t k = 0; k < templateSize; ++k) {
+      data[k] += templateWaveforms[idx][k];
+    }
+
+    bank.apply(data.size(), data.data());
+    fingerprintBank.apply(data.size(), data.data());
+    for (std::size_t i = 0; i < numTemplates; ++i) {
+      for (std::size_t j = 0; j < data.size(); ++j) {
+        const auto computed{fingerprintBank.coefficients(i)[j]};
+        if (!std::isnan(computed)) {
+          BOOST_TEST(std::abs(computed - bank.coefficients(i)[j]) <=
+                     testUnitTolerance);
+        }
+      }
+    }
+
+    const auto match{fingerprintBank.coefficients(idx)[templateSize - 1]};
+    BOOST_TEST_REQUIRE(!std::isnan(match));
+    BOOST_TEST(match > 0.9);
+  }
+
+  const auto statistics{fingerprintBank.fingerprintStatistics()};
+  BOOST_TEST_REQUIRE(statistics.size() == 1);
+  BOOST_TEST(statistics.front().coefficientsComputed <
+             statistics.front().lags * numTemplates);
+}
+
+BOOST_DATA_TEST_CASE_F(RandomData, crosscorrelation_lag_ranges,
+                       utf_data::make(engines), engine) {
+  const auto templateTrace{makeTrace(timeSeries(50))};
+  const auto data{timeSeries(500)};
+
+  const filter::CrossCorrelation<double>::LagRanges lagRanges{
+      {0, 3}, {17, 100}, {250, 251}, {400, 500}};
+
+  filter::CrossCorrelation<double> xcorr{templateTrace};
+  filter::CrossCorrelation<double> xcorrLagRanges{templateTrace};
+  xcorrLagRanges.setEngine(engine);
+
+  auto expected{data};
+  xcorr.apply(expected);
+  auto filtered{data};
+  xcorrLagRanges.apply(filtered.size(), filtered.data(), lagRanges);
+
+  std::size_t i{0};
+  for (const auto &lagRange : lagRanges) {
+    for (; i < lagRange.first; ++i) {
+      BOOST_TEST(filtered[i] == 0);
+    }
+    checkClose(filtered.data() + i, expected.data() + i,
+               lagRange.second - i);
+    i = lagRange.second;
+  }
+}
+
+// Fixture providing band-limited (pseudo) random data such that decimating
+// the data by `decimationFactor` does not alias
+struct CoarseSearchData : RandomData {
+  static constexpr std::size_t templateSize{400};
+  static constexpr std::size_t dataSize{20000};
+  static constexpr std::size_t decimationFactor{4};
+  static constexpr double threshold{0.4};
+
+  // Returns a band-limited time series with `size` random samples (i.e. the
+  // moving average of a random time series)
+  TimeSeries bandLimited(std::size_t size) {
+    const std::size_t width{3 * decimationFactor};
+    const auto data{timeSeries(size)};
+    TimeSeries ret(size);
+    double sum{0};
+    for (std::size_t i = 0; i < size; ++i) {
+      sum += data[i];
+      if (i >= width) {
+        sum -= data[i - width];
+      }
+      ret[i] = sum / width;
+    }
+    return ret;
+  }
+
+  // Embeds the template waveform into the data such that it ends with the
+  // sample `eventIdx`
+  void embed(std::size_t eventIdx) {
+    for (std::size_t k = 0; k < templateSize; ++k) {
+      data[eventIdx + 1 - templateSize + k] += 3 * templateData[k];
+    }
+  }
+
+  filter::CoarseSearch makeCoarseSearch() const {
+    filter::CoarseSearch ret{TemplateWaveform{makeTrace(templateData)},
+                             decimationFactor, threshold};
+    ret.setSamplingFrequency(1.0);
+    return ret;
+  }
+
+  TimeSeries templateData{bandLimited(templateSize)};
+  TimeSeries data{bandLimited(dataSize)};
+};
+
+constexpr std::size_t CoarseSearchData::templateSize;
+constexpr std::size_t CoarseSearchData::dataSize;
+constexpr std::size_t CoarseSearchData::decimationFactor;
+constexpr double CoarseSearchData::threshold;
+
+BOOST_FIXTURE_TEST_CASE(coarse_search, CoarseSearchData) {
+  const std::vector<std::size_t> eventIndices{3000, 7777, 15001};
+  for (auto eventIdx : eventIndices) {
+    embed(eventIdx);
+  }
+
+  const auto templateTrace{makeTrace(templateData)};
+  filter::CrossCorrelation<double> xcorr{templateTrace};
+  filter::CrossCorrelation<double> xcorrRefined{templateTrace};
+  auto coarseSearch{makeCoarseSearch()};
+  BOOST_TEST_REQUIRE(coarseSearch.enabled());
+
+  TimeSeries expected;
+  TimeSeries refined;
+  std::size_t numRefined{0};
+  const std::size_t chunkSize{1000};
+  for (std::size_t offset = 0; offset < dataSize; offset += chunkSize) {
+    TimeSeries chunk{data.begin() + offset, data.begin() + offset + chunkSize};
+    const auto &lagRanges{coarseSearch.search(chunk.size(), chunk.data())};
+    for (const auto &lagRange : lagRanges) {
+      numRefined += lagRange.second - lagRange.first;
+    }
+
+    auto chunkRefined{chunk};
+    xcorrRefined.apply(chunkRefined.size(), chunkRefined.data(), lagRanges);
+    refined.insert(refined.end(), chunkRefined.begin(), chunkRefined.end());
+    xcorr.apply(chunk);
+    expected.insert(expected.end(), chunk.begin(), chunk.end());
+  }
+
+  // the events are found (i.e. refined) at the same lag
+  for (auto eventIdx : eventIndices) {
+    BOOST_TEST(expected[eventIdx] > 0.9);
+    BOOST_TEST(std::abs(refined[eventIdx] - expected[eventIdx]) <=
+               testUnitTolerance);
+  }
+  // the majority of lags is not refined
+  BOOST_TEST(numRefined < dataSize / 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(coarse_search_chunking, CoarseSearchData) {
+  const std::size_t maxChunkSize{500};
+
+  // embed events such that the coarse hits are located close to chunk
+  // boundaries
+  for (std::size_t eventIdx = 1000; eventIdx + 1 < dataSize; eventIdx += 997) {
+    embed(eventIdx);
+  }
+
+  // the lags refined when searching the data at once
+  auto coarseSearch{makeCoarseSearch()};
+  BOOST_TEST_REQUIRE(coarseSearch.enabled());
+  std::vector<bool> expected(dataSize, false);
+  for (const auto &lagRange : coarseSearch.search(data.size(), data.data())) {
+    std::fill(expected.begin() + lagRange.first,
+              expected.begin() + lagRange.second, true);
+  }
+
+  auto chunkedCoarseSearch{makeCoarseSearch()};
+  std::vector<bool> refined(dataSize, false);
+  for (std::size_t offset = 0; offset < dataSize;) {
+    const auto chunkSize{
+        std::min(dataSize - offset, 1 + generator() % maxChunkSize)};
+    const auto &lagRanges{
+        chunkedCoarseSearch.search(chunkSize, data.data() + offset)};
+    for (const auto &lagRange : lagRanges) {
+      BOOST_TEST_REQUIRE(lagRange.second <= chunkSize);
+      std::fill(refined.begin() + offset + lagRange.first,
+                refined.begin() + offset + lagRange.second, true);
+    }
+    offset += chunkSize;
+  }
+
+  for (std::size_t i = 0; i < dataSize; ++i) {
+    if (expected[i]) {
+      BOOST_TEST(refined[i], "lag " << i << " not refined");
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace detect
 }  // namespace Seiscomp
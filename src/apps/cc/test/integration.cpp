@@ -3,7 +3,9 @@
 #include <seiscomp/io/archive/xmlarchive.h>
 #include <seiscomp/unittest/unittests.h>
 
+#include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/path.hpp>
@@ -132,7 +134,12 @@ class FileBasedDataSet {
       }
 
       if (customFlags) {
-        ret.emplace_back(*customFlags);
+        // custom flags are separated by whitespace
+        std::vector<std::string> flags;
+        boost::algorithm::split(flags, *customFlags,
+                                boost::algorithm::is_space(),
+                                boost::algorithm::token_compress_on);
+        ret.insert(std::end(ret), std::begin(flags), std::end(flags));
       }
 
       return ret;
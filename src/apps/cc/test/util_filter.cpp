@@ -0,0 +1,92 @@
+#define SEISCOMP_TEST_MODULE test_util_filter
+
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/optional/optional_io.hpp>
+#include <string>
+#include <vector>
+
+#include "../util/filter.h"
+
+namespace utf = boost::unit_test;
+
+constexpr double testUnitTolerance{0.000001};
+
+namespace Seiscomp {
+namespace detect {
+
+BOOST_AUTO_TEST_CASE(upper_corner_frequency,
+                     *utf::tolerance(testUnitTolerance)) {
+  // the lowpass corner frequency refers to the third argument
+  BOOST_TEST_CHECK(*util::upperCornerFrequency("BW(3,2,20)") == 20.0);
+  BOOST_TEST_CHECK(*util::upperCornerFrequency("BW_BP(2,1.5,15)") == 15.0);
+  BOOST_TEST_CHECK(*util::upperCornerFrequency("BW_HLP(4,1,10)") == 10.0);
+  // the lowpass corner frequency refers to the second argument
+  BOOST_TEST_CHECK(*util::upperCornerFrequency("BW_LP(4,12.5)") == 12.5);
+
+  // case insensitive; whitespace is ignored
+  BOOST_TEST_CHECK(*util::upperCornerFrequency(" bw_bp( 2, 1, 8 ) ") == 8.0);
+
+  // filter chains: the lowest lowpass corner frequency
+  BOOST_TEST_CHECK(
+      *util::upperCornerFrequency("BW_HP(3,1)>>BW_LP(3,20)>>BW(3,1,10)") ==
+      10.0);
+  BOOST_TEST_CHECK(
+      *util::upperCornerFrequency("RMHP(10)>>ITAPER(30)>>BW_LP(3,5)") == 5.0);
+
+  // no lowpass filter
+  BOOST_TEST_CHECK(!util::upperCornerFrequency(""));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_HP(3,1)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("STALTA(1,50)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_HP(3,1)>>RMHP(10)"));
+
+  // invalid arguments
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW(3,2)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_LP(3)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_BP(3,1,abc)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_BP(3,1,0)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_LP(3,-5)"));
+  BOOST_TEST_CHECK(!util::upperCornerFrequency("BW_BP(3,1,10"));
+}
+
+BOOST_AUTO_TEST_CASE(target_sampling_frequency,
+                     *utf::tolerance(testUnitTolerance)) {
+  const double margin{2.5};
+  const std::size_t maxFactor{16};
+
+  // the largest decimation factor such that the target sampling frequency is
+  // greater than or equal to `margin` times the upper corner frequency
+  // (i.e. 200 / 5 = 40 >= 2.5 * 15 = 37.5)
+  BOOST_TEST_CHECK(*util::targetSamplingFrequency(200, {"BW_BP(2,1.5,15)"},
+                                                  margin, maxFactor) == 40.0);
+  // the largest upper corner frequency of all filters
+  BOOST_TEST_CHECK(
+      *util::targetSamplingFrequency(
+          200, {"BW_BP(2,1.5,15)", "BW_LP(3,20)"}, margin, maxFactor) ==
+      200.0 / 4);
+  // the target sampling frequency equals the minimum frequency
+  BOOST_TEST_CHECK(*util::targetSamplingFrequency(100, {"BW_LP(3,10)"},
+                                                  margin, maxFactor) == 25.0);
+  // restricted w.r.t. the maximum decimation factor
+  BOOST_TEST_CHECK(*util::targetSamplingFrequency(200, {"BW_LP(3,1)"}, margin,
+                                                  maxFactor) == 200.0 / 16);
+  BOOST_TEST_CHECK(*util::targetSamplingFrequency(200, {"BW_LP(3,1)"}, margin,
+                                                  3) == 200.0 / 3);
+
+  // decimating is not possible
+  BOOST_TEST_CHECK(!util::targetSamplingFrequency(100, {"BW_BP(2,1.5,30)"},
+                                                  margin, maxFactor));
+  BOOST_TEST_CHECK(!util::targetSamplingFrequency(200, {"BW_LP(3,1)"}, margin,
+                                                  1));
+  // the upper corner frequency of any of the filters cannot be determined
+  BOOST_TEST_CHECK(!util::targetSamplingFrequency(
+      200, {"BW_BP(2,1.5,15)", "BW_HP(3,1)"}, margin, maxFactor));
+  BOOST_TEST_CHECK(
+      !util::targetSamplingFrequency(200, {}, margin, maxFactor));
+  // invalid sampling frequency
+  BOOST_TEST_CHECK(!util::targetSamplingFrequency(0, {"BW_LP(3,10)"}, margin,
+                                                  maxFactor));
+}
+
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,267 @@
+#define SEISCOMP_TEST_MODULE test_util_polyphase
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/core/typedarray.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/test/data/dataset.hpp>
+#include <boost/test/data/test_case.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "../polyphase_resampler.h"
+#include "../resamplerstore.h"
+#include "../util/polyphase.h"
+#include "utils.h"
+
+namespace utf = boost::unit_test;
+namespace utf_data = utf::data;
+
+// The maximum absolute deviation of resampled samples from the expected ones
+// (w.r.t. signals within the passband and of unit amplitude)
+constexpr double testResampleTolerance{1e-3};
+
+namespace Seiscomp {
+namespace detect {
+namespace test {
+
+namespace {
+
+// Sampling rate ratio `up / down`
+struct Ratio {
+  std::size_t up;
+  std::size_t down;
+
+  // Returns the input sample position the output sample `idx` refers to
+  // w.r.t. `resampler`
+  double position(const util::PolyphaseResampler &resampler,
+                  std::int64_t idx) const {
+    return static_cast<double>(idx) * static_cast<double>(down) /
+               static_cast<double>(up) -
+           resampler.delay();
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const Ratio &ratio) {
+    return os << ratio.up << "/" << ratio.down;
+  }
+};
+
+const std::vector<Ratio> ratios{{1, 2}, {4, 5}, {2, 1}, {5, 4}, {3, 16}};
+
+// Returns a sinusoid of `frequency` (in cycles per sample) evaluated at the
+// sample position `position`
+double sinusoid(double frequency, double position) {
+  return std::sin(2 * M_PI * frequency * position);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(rational_ratio) {
+  const auto check = [](double ratio, std::size_t up, std::size_t down) {
+    const auto computed{util::rationalRatio(ratio, 16)};
+    BOOST_TEST_REQUIRE(static_cast<bool>(computed));
+    BOOST_TEST(computed->first == up);
+    BOOST_TEST(computed->second == down);
+  };
+  check(1, 1, 1);
+  check(80.0 / 100.0, 4, 5);
+  check(100.0 / 50.0, 2, 1);
+  check(40.0 / 200.0, 1, 5);
+  // lowest terms
+  check(120.0 / 160.0, 3, 4);
+  check(16.0 / 15.0, 16, 15);
+
+  // terms exceeding the maximum factor
+  BOOST_TEST(!util::rationalRatio(17.0 / 16.0, 16));
+  BOOST_TEST(!util::rationalRatio(1.0 / 17.0, 16));
+  BOOST_TEST(static_cast<bool>(util::rationalRatio(1.0 / 17.0, 17)));
+  // irrational
+  BOOST_TEST(!util::rationalRatio(std::sqrt(2.0), 16));
+  // invalid
+  BOOST_TEST(!util::rationalRatio(0, 16));
+  BOOST_TEST(!util::rationalRatio(-0.5, 16));
+}
+
+BOOST_DATA_TEST_CASE(polyphase_dc_gain, utf_data::make(ratios)) {
+  util::PolyphaseResampler resampler{sample.up, sample.down};
+  BOOST_TEST(resampler.up() == sample.up);
+  BOOST_TEST(resampler.down() == sample.down);
+
+  const std::vector<double> samples(2000, 1);
+  std::vector<double> out;
+  resampler.apply(samples.size(), samples.data(), out);
+  BOOST_TEST_REQUIRE(!out.empty());
+
+  // skip the output samples affected by the zero history
+  const auto idx{resampler.firstOutputIndex()};
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    const double position{
+        sample.position(resampler, idx + static_cast<std::int64_t>(i))};
+    if (position < resampler.delay() + 1) {
+      continue;
+    }
+    if (position > static_cast<double>(samples.size()) - resampler.delay() -
+                       1) {
+      break;
+    }
+    BOOST_TEST(std::abs(out[i] - 1) <= testResampleTolerance);
+  }
+}
+
+// The output sample `m` must refer to the input sample position
+// `m * down / up - delay()`; chunking must not alter the output samples
+BOOST_DATA_TEST_CASE(polyphase_delay, utf_data::make(ratios)) {
+  // a sinusoid well within the passband
+  const double frequency{0.05 *
+                         static_cast<double>(std::min(sample.up, sample.down)) /
+                         static_cast<double>(sample.down)};
+  const std::size_t n{3000};
+  std::vector<double> samples(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    samples[i] = sinusoid(frequency, static_cast<double>(i));
+  }
+
+  util::PolyphaseResampler resampler{sample.up, sample.down};
+  std::vector<double> out;
+  resampler.apply(n, samples.data(), out);
+
+  util::PolyphaseResampler chunked{sample.up, sample.down};
+  std::vector<double> outChunked;
+  for (std::size_t offset = 0, chunkSize = 1; offset < n;
+       offset += chunkSize, chunkSize = chunkSize % 97 + 13) {
+    chunked.apply(std::min(chunkSize, n - offset), samples.data() + offset,
+                  outChunked);
+  }
+  BOOST_TEST_REQUIRE(out.size() == outChunked.size());
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    BOOST_TEST(std::abs(out[i] - outChunked[i]) <= 1e-12);
+  }
+
+  const auto idx{resampler.firstOutputIndex()};
+  // the first output sample refers to the first input sample (or later)
+  BOOST_TEST(sample.position(resampler, idx) >= 0);
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    const double position{
+        sample.position(resampler, idx + static_cast<std::int64_t>(i))};
+    if (position < resampler.delay() + 1) {
+      continue;
+    }
+    BOOST_TEST(std::abs(out[i] - sinusoid(frequency, position)) <=
+               testResampleTolerance);
+  }
+}
+
+// The filter delay must be compensated for by means of the start time of the
+// records emitted; flushing must emit the samples up to the last sample fed
+BOOST_AUTO_TEST_CASE(polyphase_record_resampler) {
+  const double currentFrequency{100};
+  const double targetFrequency{80};
+  // a sinusoid well within the passband (in Hz)
+  const double frequency{2};
+  const std::size_t recordSize{512};
+  const std::size_t numRecords{4};
+  const Core::Time startTime{2020, 1, 1};
+
+  BOOST_TEST(
+      PolyphaseRecordResampler::supports(currentFrequency, targetFrequency));
+  BOOST_TEST(!PolyphaseRecordResampler::supports(currentFrequency, 77));
+
+  PolyphaseRecordResampler resampler{targetFrequency};
+  std::vector<std::unique_ptr<Record>> resampled;
+  for (std::size_t r = 0; r < numRecords; ++r) {
+    std::vector<double> samples(recordSize);
+    for (std::size_t i = 0; i < recordSize; ++i) {
+      samples[i] = sinusoid(frequency / currentFrequency,
+                            static_cast<double>(r * recordSize + i));
+    }
+    const auto record{makeRecord<Array::DOUBLE>(
+        samples,
+        startTime + Core::TimeSpan{static_cast<double>(r * recordSize) /
+                                   currentFrequency},
+        currentFrequency)};
+    std::unique_ptr<Record> out{resampler.feed(record.get())};
+    if (out) {
+      resampled.push_back(std::move(out));
+    }
+  }
+  std::unique_ptr<Record> flushed{resampler.flush()};
+  BOOST_TEST_REQUIRE(static_cast<bool>(flushed));
+  BOOST_TEST(!resampler.flush());
+  resampled.push_back(std::move(flushed));
+
+  // the first sample emitted refers to the first sample fed (or later)
+  BOOST_TEST(static_cast<double>(resampled.front()->startTime() - startTime) >=
+             0);
+  // the last sample emitted refers to the last sample fed (or earlier) but
+  // the samples up to the last sample fed were emitted
+  const Core::Time lastFed{
+      startTime + Core::TimeSpan{static_cast<double>(numRecords * recordSize -
+                                                     1) /
+                                 currentFrequency}};
+  const Core::Time lastEmitted{resampled.back()->endTime() -
+                               Core::TimeSpan{1 / targetFrequency}};
+  BOOST_TEST(static_cast<double>(lastFed - lastEmitted) >= -1e-6);
+  BOOST_TEST(static_cast<double>(lastFed - lastEmitted) <
+             1 / targetFrequency + 1e-6);
+
+  // the filter delay (in seconds) plus a sample
+  const double delay{
+      (util::PolyphaseResampler{4, 5}.delay() + 1) / currentFrequency};
+  for (std::size_t r = 0; r < resampled.size(); ++r) {
+    const auto &record{resampled[r]};
+    BOOST_TEST(record->samplingFrequency() == targetFrequency);
+    // the records emitted are contiguous
+    if (r > 0) {
+      BOOST_TEST(std::abs(static_cast<double>(record->startTime() -
+                                              resampled[r - 1]->endTime())) <
+                 1e-6);
+    }
+
+    const auto *data{DoubleArray::ConstCast(record->data())};
+    BOOST_TEST_REQUIRE(data);
+    for (int i = 0; i < data->size(); ++i) {
+      const double t{static_cast<double>(record->startTime() - startTime) +
+                     i / targetFrequency};
+      // skip the samples affected by zero-padding
+      if (t < delay ||
+          t > static_cast<double>(lastFed - startTime) - delay) {
+        continue;
+      }
+      BOOST_TEST(std::abs(data->get(i) - std::sin(2 * M_PI * frequency * t)) <=
+                 testResampleTolerance);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(resampler_store_polyphase_opt_in) {
+  auto &store{RecordResamplerStore::Instance()};
+  BOOST_TEST(!store.polyphase());
+  {
+    std::unique_ptr<RecordResamplerStore::RecordResampler> resampler{
+        store.get(100, 80)};
+    BOOST_TEST(!dynamic_cast<PolyphaseRecordResampler *>(resampler.get()));
+  }
+
+  store.setPolyphase(true);
+  {
+    std::unique_ptr<RecordResamplerStore::RecordResampler> resampler{
+        store.get(100, 80)};
+    BOOST_TEST(dynamic_cast<PolyphaseRecordResampler *>(resampler.get()));
+    // not supported by the polyphase resampler
+    resampler = store.get(100, 77);
+    BOOST_TEST(!dynamic_cast<PolyphaseRecordResampler *>(resampler.get()));
+  }
+
+  store.setPolyphase(false);
+  store.reset();
+}
+
+}  // namespace test
+}  // namespace detect
+}  // namespace Seiscomp
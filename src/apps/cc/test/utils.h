@@ -4,6 +4,10 @@
 #include <seiscomp/core/array.h>
 #include <seiscomp/core/genericrecord.h>
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 namespace Seiscomp {
 namespace detect {
 namespace test {
@@ -42,6 +46,19 @@ GenericRecordPtr makeRecord(
     std::string chaCode = "C", std::string locCode = "",
     std::string staCode = "S", std::string netCode = "N");
 
+template <Array::DataType TdataType>
+GenericRecordPtr makeRecord(
+    const std::vector<ArrayDataTypeTrait_t<TdataType>> &samples,
+    const Core::Time startTime, double samplingFrequency,
+    std::string chaCode = "C", std::string locCode = "",
+    std::string staCode = "S", std::string netCode = "N");
+
+// Returns a time series with `size` samples drawn from `distribution` by means
+// of `generator`
+template <typename TGenerator, typename TDistribution>
+std::vector<double> randomTimeSeries(std::size_t size, TGenerator &generator,
+                                     TDistribution &distribution);
+
 }  // namespace test
 }  // namespace detect
 }  // namespace Seiscomp
@@ -39,6 +39,29 @@ GenericRecordPtr makeRecord(
   return record;
 }
 
+template <Array::DataType TdataType>
+GenericRecordPtr makeRecord(
+    const std::vector<ArrayDataTypeTrait_t<TdataType>> &samples,
+    const Core::Time startTime, double samplingFrequency, std::string chaCode,
+    std::string locCode, std::string staCode, std::string netCode) {
+  auto record{util::make_smart<GenericRecord>(
+      netCode, staCode, locCode, chaCode, startTime, samplingFrequency, -1,
+      TdataType)};
+
+  record->setData(samples.size(), samples.data(), TdataType);
+  return record;
+}
+
+template <typename TGenerator, typename TDistribution>
+std::vector<double> randomTimeSeries(std::size_t size, TGenerator &generator,
+                                     TDistribution &distribution) {
+  std::vector<double> ret(size);
+  for (auto &sample : ret) {
+    sample = distribution(generator);
+  }
+  return ret;
+}
+
 }  // namespace test
 }  // namespace detect
 }  // namespace Seiscomp
@@ -0,0 +1,145 @@
+#ifndef SCDETECT_APPS_CC_UTIL_CONCURRENTQUEUE_H_
+#define SCDETECT_APPS_CC_UTIL_CONCURRENTQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+// The size (in bytes) indices shared among threads are padded to (in order to
+// avoid false sharing)
+constexpr std::size_t kCacheLineSize{64};
+
+// Bounded lock-free single-producer single-consumer queue (ring buffer)
+//
+// - `tryPush()` must be called by a single producer thread, only; `tryPop()`
+// must be called by a single consumer thread, only
+// - the capacity is rounded up to the next power of two
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(std::size_t capacity)
+      : _buffer(roundUp(capacity)), _mask{_buffer.size() - 1} {}
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  // Pushes `value` to the queue. Returns `false` if the queue is full, else
+  // `true`.
+  bool tryPush(T value) {
+    const auto tail{_tail.load(std::memory_order_relaxed)};
+    if (tail - _head.load(std::memory_order_acquire) == _buffer.size()) {
+      return false;
+    }
+    _buffer[tail & _mask] = std::move(value);
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pops the next value from the queue. Returns `false` if the queue is
+  // empty, else `true`.
+  bool tryPop(T &value) {
+    const auto head{_head.load(std::memory_order_relaxed)};
+    if (head == _tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = std::move(_buffer[head & _mask]);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns the number of values queued (approximation if called
+  // concurrently)
+  std::size_t size() const {
+    return _tail.load(std::memory_order_acquire) -
+           _head.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+
+  std::size_t capacity() const { return _buffer.size(); }
+
+ private:
+  static std::size_t roundUp(std::size_t n) {
+    std::size_t ret{1};
+    while (ret < n) {
+      ret <<= 1;
+    }
+    return ret;
+  }
+
+  std::vector<T> _buffer;
+  const std::size_t _mask;
+
+  // The index of the next value to be popped (modified by the consumer)
+  alignas(kCacheLineSize) std::atomic<std::size_t> _head{0};
+  // The index of the next value to be pushed (modified by the producer)
+  alignas(kCacheLineSize) std::atomic<std::size_t> _tail{0};
+};
+
+// Unbounded lock-free multi-producer single-consumer queue (i.e. D. Vyukov's
+// node based MPSC queue)
+//
+// - `push()` may be called by multiple producer threads concurrently;
+// `tryPop()` must be called by a single consumer thread, only
+// - `tryPop()` may fail spuriously while a producer is pushing; values pushed
+// are guaranteed to be visible once the producer's `push()` happened-before
+// the consumer's `tryPop()`
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : _head{new Node}, _tail{_head.load()} {}
+
+  ~MpscQueue() {
+    T value;
+    while (tryPop(value)) {
+    }
+    delete _tail;
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  void push(T value) {
+    auto *node{new Node};
+    node->value = std::move(value);
+    auto *previous{_head.exchange(node, std::memory_order_acq_rel)};
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  // Pops the next value from the queue. Returns `false` if the queue is
+  // empty, else `true`.
+  bool tryPop(T &value) {
+    auto *tail{_tail};
+    auto *next{tail->next.load(std::memory_order_acquire)};
+    if (!next) {
+      return false;
+    }
+    value = std::move(next->value);
+    _tail = next;
+    delete tail;
+    return true;
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node *> next{nullptr};
+    T value;
+  };
+
+  // The node most recently pushed (modified by the producers)
+  alignas(kCacheLineSize) std::atomic<Node *> _head;
+  // The stub node preceding the next node to be popped (modified by the
+  // consumer)
+  alignas(kCacheLineSize) Node *_tail;
+};
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_UTIL_CONCURRENTQUEUE_H_
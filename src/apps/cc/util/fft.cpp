@@ -0,0 +1,118 @@
+#include "fft.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+std::size_t nextPowerOfTwo(std::size_t n) {
+  std::size_t ret{1};
+  while (ret < n) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+std::size_t overlapSaveFftSize(std::size_t n, std::size_t nData,
+                               std::size_t maxSize) {
+  const auto minSize{nextPowerOfTwo(2 * n)};
+  // there is no benefit in blocks exceeding the lags to be computed
+  const auto upperBound{
+      std::max(minSize, std::min(maxSize, nextPowerOfTwo(n - 1 + nData)))};
+
+  // two subsequent blocks are packed into a single complex FFT; each pair of
+  // blocks requires a forward and an inverse transform (~ 2 * N * log2(N))
+  // and the spectral multiplication (~ N)
+  const auto Cost = [n, nData](std::size_t fftSize) {
+    const auto blockSize{fftSize - n + 1};
+    const auto numTransforms{(nData + 2 * blockSize - 1) / (2 * blockSize)};
+    return static_cast<double>(numTransforms) * fftSize *
+           (2 * std::log2(static_cast<double>(fftSize)) + 1);
+  };
+
+  auto ret{minSize};
+  auto minCost{Cost(minSize)};
+  for (auto fftSize = 2 * minSize; fftSize <= upperBound; fftSize <<= 1) {
+    const auto cost{Cost(fftSize)};
+    if (cost < minCost) {
+      ret = fftSize;
+      minCost = cost;
+    }
+  }
+  return ret;
+}
+
+Fft::Fft(std::size_t n) : _n{n} {
+  if (!_n) {
+    return;
+  }
+
+  assert((nextPowerOfTwo(_n) == _n));
+
+  const double pi{std::acos(-1.0)};
+  _twiddles.resize(_n / 2);
+  for (std::size_t k = 0; k < _twiddles.size(); ++k) {
+    const double phi{-2 * pi * static_cast<double>(k) / _n};
+    _twiddles[k] = Complex{std::cos(phi), std::sin(phi)};
+  }
+
+  std::size_t bits{0};
+  while ((std::size_t{1} << bits) < _n) {
+    ++bits;
+  }
+  _bitReversed.resize(_n);
+  for (std::size_t i = 0; i < _n; ++i) {
+    std::size_t reversed{0};
+    for (std::size_t b = 0; b < bits; ++b) {
+      if (i & (std::size_t{1} << b)) {
+        reversed |= std::size_t{1} << (bits - 1 - b);
+      }
+    }
+    _bitReversed[i] = reversed;
+  }
+}
+
+std::size_t Fft::size() const { return _n; }
+
+void Fft::forward(Complex *data) const { transform(data, false); }
+
+void Fft::inverse(Complex *data) const { transform(data, true); }
+
+void Fft::transform(Complex *data, bool inverse) const {
+  for (std::size_t i = 0; i < _n; ++i) {
+    const auto j{_bitReversed[i]};
+    if (i < j) {
+      std::swap(data[i], data[j]);
+    }
+  }
+
+  const double sign{inverse ? -1.0 : 1.0};
+  for (std::size_t len = 2; len <= _n; len <<= 1) {
+    const auto half{len / 2};
+    const auto step{_n / len};
+    for (std::size_t i = 0; i < _n; i += len) {
+      for (std::size_t k = 0; k < half; ++k) {
+        const auto &w{_twiddles[k * step]};
+        const double wRe{w.real()};
+        const double wIm{sign * w.imag()};
+
+        auto &u{data[i + k]};
+        auto &v{data[i + k + half]};
+        // multiply explicitly in order to bypass the (slow) C99 complex
+        // multiplication special value handling
+        const double tRe{v.real() * wRe - v.imag() * wIm};
+        const double tIm{v.real() * wIm + v.imag() * wRe};
+        v = Complex{u.real() - tRe, u.imag() - tIm};
+        u = Complex{u.real() + tRe, u.imag() + tIm};
+      }
+    }
+  }
+}
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
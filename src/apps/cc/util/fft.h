@@ -0,0 +1,59 @@
+#ifndef SCDETECT_APPS_CC_UTIL_FFT_H_
+#define SCDETECT_APPS_CC_UTIL_FFT_H_
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+// Returns the smallest power of two which is greater or equal to `n`
+std::size_t nextPowerOfTwo(std::size_t n);
+
+// Returns the FFT size minimizing the overall cost of computing the dot
+// products between a template waveform with `n` samples and `nData`
+// subsequent lags by means of (packed) FFT overlap-save. The FFT size is at
+// least `nextPowerOfTwo(2 * n)` and does not exceed
+// `max(nextPowerOfTwo(2 * n), maxSize)`.
+std::size_t overlapSaveFftSize(std::size_t n, std::size_t nData,
+                               std::size_t maxSize);
+
+// Iterative in-place radix-2 complex FFT
+//
+// - twiddle factors and the bit-reversal permutation are precomputed when
+// constructing the transform
+// - the transform size must be a power of two
+// - the inverse transform is unnormalized, i.e. `inverse(forward(x))` results
+// in `size() * x`
+class Fft {
+ public:
+  using Complex = std::complex<double>;
+
+  explicit Fft(std::size_t n = 0);
+
+  // Returns the transform size
+  std::size_t size() const;
+
+  // Computes the forward transform of `data` in place. It is a bug if `data`
+  // does not provide `size()` elements.
+  void forward(Complex *data) const;
+  // Computes the unnormalized inverse transform of `data` in place. It is a
+  // bug if `data` does not provide `size()` elements.
+  void inverse(Complex *data) const;
+
+ private:
+  void transform(Complex *data, bool inverse) const;
+
+  std::size_t _n;
+
+  std::vector<Complex> _twiddles;
+  std::vector<std::size_t> _bitReversed;
+};
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_UTIL_FFT_H_
@@ -1,9 +1,63 @@
 #include "filter.h"
 
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <stdexcept>
+#include <vector>
+
 namespace Seiscomp {
 namespace detect {
 namespace util {
 
+namespace {
+
+// Returns the upper corner frequency of a single filter (i.e. a filter chain
+// element)
+boost::optional<double> upperCornerFrequencyElement(std::string element) {
+  boost::algorithm::trim(element);
+  const auto argsBegin{element.find('(')};
+  const auto argsEnd{element.rfind(')')};
+  if (argsBegin == std::string::npos || argsEnd == std::string::npos ||
+      argsEnd < argsBegin) {
+    return boost::none;
+  }
+
+  auto name{element.substr(0, argsBegin)};
+  boost::algorithm::trim(name);
+  boost::algorithm::to_upper(name);
+
+  std::vector<std::string> args;
+  const auto argsStr{element.substr(argsBegin + 1, argsEnd - argsBegin - 1)};
+  boost::algorithm::split(args, argsStr, boost::algorithm::is_any_of(","));
+
+  // the index of the argument referring to the lowpass corner frequency
+  std::size_t idx;
+  if (name == "BW" || name == "BW_BP" || name == "BW_HLP") {
+    idx = 2;
+  } else if (name == "BW_LP") {
+    idx = 1;
+  } else {
+    return boost::none;
+  }
+
+  if (args.size() <= idx) {
+    return boost::none;
+  }
+  try {
+    const auto ret{std::stod(boost::algorithm::trim_copy(args[idx]))};
+    if (ret > 0) {
+      return ret;
+    }
+  } catch (std::logic_error &) {
+  }
+  return boost::none;
+}
+
+}  // namespace
+
 void reset(std::unique_ptr<DoubleFilter> &filter) {
   // XXX(damb): currently the only way to achieve this is clone the filter
   if (filter) {
@@ -11,6 +65,52 @@ void reset(std::unique_ptr<DoubleFilter> &filter) {
   }
 }
 
+boost::optional<double> upperCornerFrequency(const std::string &filterId) {
+  std::vector<std::string> elements;
+  boost::algorithm::split(elements, filterId, boost::algorithm::is_any_of(">"),
+                          boost::algorithm::token_compress_on);
+
+  boost::optional<double> ret;
+  for (const auto &element : elements) {
+    const auto f{upperCornerFrequencyElement(element)};
+    if (f && (!ret || *f < *ret)) {
+      ret = f;
+    }
+  }
+  return ret;
+}
+
+boost::optional<double> targetSamplingFrequency(
+    double samplingFrequency, const std::vector<std::string> &filterIds,
+    double margin, std::size_t maxDecimationFactor) {
+  // all filters must be bandlimited
+  boost::optional<double> upperCorner;
+  for (const auto &filterId : filterIds) {
+    const auto f{upperCornerFrequency(filterId)};
+    if (!f) {
+      return boost::none;
+    }
+    upperCorner = std::max(upperCorner.value_or(0), *f);
+  }
+  if (!upperCorner || !(samplingFrequency > 0)) {
+    return boost::none;
+  }
+
+  const double minFrequency{margin * *upperCorner};
+  std::size_t decimationFactor{1};
+  for (std::size_t factor{2}; factor <= maxDecimationFactor; ++factor) {
+    if (samplingFrequency / static_cast<double>(factor) < minFrequency) {
+      break;
+    }
+    decimationFactor = factor;
+  }
+
+  if (decimationFactor == 1) {
+    return boost::none;
+  }
+  return samplingFrequency / static_cast<double>(decimationFactor);
+}
+
 }  // namespace util
 }  // namespace detect
 }  // namespace Seiscomp
@@ -1,7 +1,11 @@
 #ifndef SCDETECT_APPS_CC_UTIL_FILTER_H_
 #define SCDETECT_APPS_CC_UTIL_FILTER_H_
 
+#include <boost/optional/optional.hpp>
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "../def.h"
 
@@ -12,6 +16,28 @@ namespace util {
 // Resets `filter`
 void reset(std::unique_ptr<DoubleFilter> &filter);
 
+// Returns the upper corner frequency (in Hz) of the filter identified by
+// `filterId`, i.e. the lowest lowpass corner frequency of the filter chain.
+// Returns `boost::none` if the filter chain does not contain a (known)
+// lowpass filter.
+boost::optional<double> upperCornerFrequency(const std::string &filterId);
+
+// Returns the target sampling frequency (in Hz) data sampled at
+// `samplingFrequency` may be decimated to w.r.t. the filters identified by
+// `filterIds`. The target sampling frequency is the lowest sampling frequency
+// which is
+//
+// - greater than or equal to `margin` times the largest upper corner
+// frequency of the filters,
+// - an integer fraction of `samplingFrequency` (with a decimation factor of
+// at most `maxDecimationFactor`).
+//
+// Returns `boost::none` if decimating is not possible or the upper corner
+// frequency of any of the filters cannot be determined.
+boost::optional<double> targetSamplingFrequency(
+    double samplingFrequency, const std::vector<std::string> &filterIds,
+    double margin, std::size_t maxDecimationFactor);
+
 }  // namespace util
 }  // namespace detect
 }  // namespace Seiscomp
@@ -1,6 +1,7 @@
 #ifndef SCDETECT_APPS_CC_UTIL_MATH_H_
 #define SCDETECT_APPS_CC_UTIL_MATH_H_
 
+#include <cmath>
 #include <cstddef>
 #include <type_traits>
 
@@ -30,6 +31,46 @@ inline T square(T n) {
   return n * n;
 }
 
+// Compensated summation (Kahan-Babuska-Neumaier)
+//
+// - keeps track of the low-order bits lost when adding terms to the running
+// sum; i.e. the rounding error is independent of the number of terms added
+// - use for sums which are updated in a rolling fashion over long periods
+// of time (where the rounding errors of naive summation would accumulate)
+class CompensatedSum {
+ public:
+  explicit CompensatedSum(double value = 0) : _sum{value} {}
+
+  // Adds `value` to the sum
+  void add(double value) {
+    const double sum{_sum + value};
+    if (std::abs(_sum) >= std::abs(value)) {
+      _compensation += (_sum - sum) + value;
+    } else {
+      _compensation += (value - sum) + _sum;
+    }
+    _sum = sum;
+  }
+
+  CompensatedSum &operator+=(double value) {
+    add(value);
+    return *this;
+  }
+
+  // Returns the compensated sum
+  double value() const { return _sum + _compensation; }
+
+  // Resets the sum to `value`
+  void reset(double value = 0) {
+    _sum = value;
+    _compensation = 0;
+  }
+
+ private:
+  double _sum{0};
+  double _compensation{0};
+};
+
 }  // namespace util
 }  // namespace detect
 }  // namespace Seiscomp
@@ -3,7 +3,10 @@
 
 #include <seiscomp/core/defs.h>
 
+#include <cstddef>
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include <utility>
 
 namespace Seiscomp {
@@ -22,6 +25,46 @@ typename Core::SmartPointer<T>::Impl make_smart(Ts &&...params) {
       typename Core::SmartPointer<T>::Impl(new T(std::forward<Ts>(params)...));
 }
 
+// Allocator which aligns allocations to `Alignment` bytes (e.g. in order to
+// align data to cache lines)
+//
+// - `Alignment` must be a power of two and a multiple of `sizeof(void *)`
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(std::size_t n) {
+    void *ret{nullptr};
+    if (posix_memalign(&ret, Alignment, n * sizeof(T)) != 0) {
+      throw std::bad_alloc{};
+    }
+    return static_cast<T *>(ret);
+  }
+
+  void deallocate(T *p, std::size_t) { std::free(p); }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment> &,
+                const AlignedAllocator<U, Alignment> &) {
+  return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment> &,
+                const AlignedAllocator<U, Alignment> &) {
+  return false;
+}
+
 }  // namespace util
 }  // namespace detect
 }  // namespace Seiscomp
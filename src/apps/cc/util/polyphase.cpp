@@ -0,0 +1,200 @@
+#include "polyphase.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+namespace {
+
+std::size_t gcd(std::size_t a, std::size_t b) {
+  while (b) {
+    const auto r{a % b};
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+// Returns the zeroth order modified Bessel function of the first kind
+double besselI0(double x) {
+  double ret{1};
+  double term{1};
+  const double y{x * x / 4};
+  for (std::size_t k{1}; k < 50; ++k) {
+    term *= y / static_cast<double>(k * k);
+    ret += term;
+    if (term < ret * 1e-16) {
+      break;
+    }
+  }
+  return ret;
+}
+
+double sinc(double x) {
+  if (x == 0) {
+    return 1;
+  }
+  const double pix{M_PI * x};
+  return std::sin(pix) / pix;
+}
+
+// Returns the Kaiser window shape parameter achieving the stopband
+// `attenuation` (in dB)
+double kaiserBeta(double attenuation) {
+  if (attenuation > 50) {
+    return 0.1102 * (attenuation - 8.7);
+  }
+  if (attenuation >= 21) {
+    return 0.5842 * std::pow(attenuation - 21, 0.4) +
+           0.07886 * (attenuation - 21);
+  }
+  return 0;
+}
+
+// Floored integer division
+std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+  auto ret{a / b};
+  if ((a % b != 0) && ((a < 0) != (b < 0))) {
+    --ret;
+  }
+  return ret;
+}
+
+}  // namespace
+
+boost::optional<std::pair<std::size_t, std::size_t>> rationalRatio(
+    double ratio, std::size_t maxFactor) {
+  if (!(ratio > 0)) {
+    return boost::none;
+  }
+
+  for (std::size_t down{1}; down <= maxFactor; ++down) {
+    const double exact{ratio * static_cast<double>(down)};
+    const auto up{static_cast<std::size_t>(std::lround(exact))};
+    if (up < 1 || up > maxFactor) {
+      continue;
+    }
+    if (std::abs(static_cast<double>(up) - exact) <= 1e-9 * exact) {
+      const auto divisor{gcd(up, down)};
+      return std::make_pair(up / divisor, down / divisor);
+    }
+  }
+  return boost::none;
+}
+
+PolyphaseResampler::PolyphaseResampler(std::size_t up, std::size_t down,
+                                       double passband, double stopband,
+                                       double attenuation)
+    : _up{up}, _down{down} {
+  assert(up > 0 && down > 0);
+  assert(0 < passband && passband < stopband && stopband <= 1);
+
+  // filter design at the upsampled rate (normalized frequencies in cycles
+  // per sample)
+  const double nyquist{0.5 / static_cast<double>(std::max(_up, _down))};
+  const double transition{(stopband - passband) * nyquist};
+  const double cutoff{0.5 * (passband + stopband) * nyquist};
+
+  const auto n{static_cast<std::size_t>(
+      std::ceil((attenuation - 7.95) / (14.36 * transition))) + 1};
+  _taps = (n + _up - 1) / _up;
+  // prefer an odd filter length (i.e. an integer filter delay)
+  if (_up == 1 && _taps % 2 == 0) {
+    ++_taps;
+  }
+  const auto length{_taps * _up};
+  _delay = 0.5 * static_cast<double>(length - 1);
+
+  std::vector<double> prototype(length);
+  const double beta{kaiserBeta(attenuation)};
+  const double normalization{besselI0(beta)};
+  double sum{0};
+  for (std::size_t k{0}; k < length; ++k) {
+    const double x{static_cast<double>(k) - _delay};
+    const double r{length > 1 ? x / _delay : 0};
+    const double window{
+        besselI0(beta * std::sqrt(std::max(0.0, 1 - r * r))) / normalization};
+    prototype[k] = 2 * cutoff * sinc(2 * cutoff * x) * window;
+    sum += prototype[k];
+  }
+  // unit gain w.r.t. the output (i.e. taking the zero-stuffing into account)
+  const double gain{static_cast<double>(_up) / sum};
+
+  const std::size_t samplesPerLine{kAlignment / sizeof(double)};
+  _stride = (_taps + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+  _coefficients.assign(_stride * _up, 0);
+  for (std::size_t p{0}; p < _up; ++p) {
+    auto *row{_coefficients.data() + p * _stride};
+    for (std::size_t i{0}; i < _taps; ++i) {
+      row[i] = gain * prototype[p + (_taps - 1 - i) * _up];
+    }
+  }
+
+  reset();
+}
+
+std::size_t PolyphaseResampler::up() const { return _up; }
+
+std::size_t PolyphaseResampler::down() const { return _down; }
+
+std::size_t PolyphaseResampler::tapsPerPhase() const { return _taps; }
+
+double PolyphaseResampler::delay() const {
+  return _delay / static_cast<double>(_up);
+}
+
+std::int64_t PolyphaseResampler::firstOutputIndex() const {
+  return static_cast<std::int64_t>(
+      std::ceil(_delay / static_cast<double>(_down)));
+}
+
+void PolyphaseResampler::apply(std::size_t n, const double *samples,
+                               std::vector<double> &out) {
+  _buffer.insert(_buffer.end(), samples, samples + n);
+
+  const auto up{static_cast<std::int64_t>(_up)};
+  const auto down{static_cast<std::int64_t>(_down)};
+  const auto taps{static_cast<std::int64_t>(_taps)};
+  const std::int64_t last{_bufferOffset +
+                          static_cast<std::int64_t>(_buffer.size()) - 1};
+  while (true) {
+    // the position of the next output sample at the upsampled rate
+    const auto t{_next * down};
+    const auto j{floorDiv(t, up)};
+    if (j > last) {
+      break;
+    }
+
+    const auto *row{_coefficients.data() + (t - j * up) * _stride};
+    const auto *x{_buffer.data() + (j - taps + 1 - _bufferOffset)};
+    double y{0};
+    for (std::size_t i{0}; i < _taps; ++i) {
+      y += row[i] * x[i];
+    }
+    out.push_back(y);
+    ++_next;
+  }
+
+  // drop the samples which are not required anymore
+  const auto required{floorDiv(_next * down, up) - taps + 1};
+  const auto drop{
+      std::min(static_cast<std::int64_t>(_buffer.size()),
+               std::max(std::int64_t{0}, required - _bufferOffset))};
+  _buffer.erase(_buffer.begin(), _buffer.begin() + drop);
+  _bufferOffset += drop;
+}
+
+void PolyphaseResampler::reset() {
+  // prime the history with zeros
+  _buffer.assign(_taps - 1, 0);
+  _bufferOffset = -static_cast<std::int64_t>(_taps - 1);
+  _next = firstOutputIndex();
+}
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,98 @@
+#ifndef SCDETECT_APPS_CC_UTIL_POLYPHASE_H_
+#define SCDETECT_APPS_CC_UTIL_POLYPHASE_H_
+
+#include <boost/optional/optional.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "memory.h"
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+// Returns the rational approximation `up / down` (in lowest terms) of `ratio`
+// where both `up` and `down` are less than or equal to `maxFactor`. Returns
+// `boost::none` if `ratio` cannot be represented exactly (i.e. within
+// floating point precision) by means of such terms.
+boost::optional<std::pair<std::size_t, std::size_t>> rationalRatio(
+    double ratio, std::size_t maxFactor);
+
+// Polyphase FIR resampler for rational sampling rate ratios (i.e. upsampling
+// by `up` followed by downsampling by `down`)
+//
+// - the anti-aliasing (and anti-imaging) lowpass is a Kaiser windowed sinc
+// designed at the upsampled rate; its passband extends to `passband`, its
+// stopband starts at `stopband` (both relative to the Nyquist frequency of the
+// lower of the input and output sampling rates)
+// - the filter coefficients are stored as one precomputed (time-reversed)
+// table per phase; the tables are padded and aligned to cache lines such that
+// each output sample is computed by means of a single contiguous dot product
+// - samples are processed in a streaming fashion, i.e. the input history is
+// kept in between subsequent calls to `apply()`
+// - the filter is linear-phase; its delay is available by means of `delay()`
+class PolyphaseResampler {
+ public:
+  PolyphaseResampler(std::size_t up, std::size_t down, double passband = 0.7,
+                     double stopband = 0.9, double attenuation = 80);
+
+  // Returns the upsampling factor
+  std::size_t up() const;
+  // Returns the downsampling factor
+  std::size_t down() const;
+  // Returns the number of filter coefficients per phase
+  std::size_t tapsPerPhase() const;
+
+  // Returns the filter delay in input samples, i.e. the output sample `m`
+  // (counted from the start of the stream) refers to the input sample
+  // position `m * down / up - delay()`
+  double delay() const;
+  // Returns the index of the first output sample emitted (counted from the
+  // start of the stream); preceding output samples would refer to positions
+  // before the first input sample and are not emitted
+  std::int64_t firstOutputIndex() const;
+
+  // Resamples the `n` input samples `samples` and appends the output samples
+  // to `out`
+  void apply(std::size_t n, const double *samples, std::vector<double> &out);
+
+  // Resets the stream
+  void reset();
+
+ private:
+  // The number of bytes the coefficient tables are aligned to
+  static constexpr std::size_t kAlignment{64};
+
+  using AlignedSamples =
+      std::vector<double, util::AlignedAllocator<double, kAlignment>>;
+
+  std::size_t _up;
+  std::size_t _down;
+  // The number of coefficients per phase
+  std::size_t _taps{0};
+  // The padded size of a phase's coefficient table
+  std::size_t _stride{0};
+  // The filter delay at the upsampled rate
+  double _delay{0};
+
+  // The (time-reversed) coefficient tables (row-wise, one row per phase)
+  AlignedSamples _coefficients;
+
+  // The input samples buffered (i.e. the history followed by the samples
+  // not consumed, yet)
+  std::vector<double> _buffer;
+  // The input sample index (counted from the start of the stream) of the
+  // first sample buffered
+  std::int64_t _bufferOffset{0};
+  // The index of the next output sample (counted from the start of the
+  // stream)
+  std::int64_t _next{0};
+};
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_UTIL_POLYPHASE_H_
@@ -0,0 +1,94 @@
+#ifndef SCDETECT_APPS_CC_UTIL_SAMPLEWINDOW_H_
+#define SCDETECT_APPS_CC_UTIL_SAMPLEWINDOW_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+// Sliding window of samples which always exposes the most recent samples as a
+// contiguous range of memory
+//
+// - implemented by means of a linear buffer (with a capacity of at least
+// twice the window size) which is compacted (i.e. the most recent samples are
+// moved to the beginning of the buffer) once it is exhausted; this amortizes
+// the compaction costs
+// - after pushing `n` samples, both the `n` pushed samples and the samples
+// which were part of the window before the push are accessible contiguously,
+// i.e. the range `[data() - n, data() + size())` is valid
+template <typename T>
+class SampleWindow {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  explicit SampleWindow(size_type size = 0, const T &value = T{}) {
+    reset(size, value);
+  }
+
+  // Resets the window to `size` samples with `value`
+  void reset(size_type size, const T &value = T{}) {
+    _size = size;
+    _buffer.assign(std::max(size_type{1}, 2 * _size), value);
+    _end = _size;
+  }
+
+  // Pushes `n` samples to the window
+  void push(const T *samples, size_type n) {
+    if (_end + n > _buffer.size()) {
+      compact(n);
+    }
+    std::copy(samples, samples + n, _buffer.data() + _end);
+    _end += n;
+  }
+
+  // Returns the window size
+  size_type size() const { return _size; }
+
+  // Returns a pointer to the oldest sample of the window. The window's
+  // samples are guaranteed to be stored contiguously.
+  const T *data() const { return _buffer.data() + _end - _size; }
+
+  // Returns the oldest sample of the window
+  const T &front() const { return *data(); }
+  // Returns the most recent sample of the window
+  const T &back() const { return _buffer[_end - 1]; }
+
+  const T &operator[](size_type idx) const {
+    assert((idx < _size));
+    return data()[idx];
+  }
+
+ private:
+  // Moves the window's samples to the beginning of the buffer such that `n`
+  // samples can be pushed
+  void compact(size_type n) {
+    if (_size + n > _buffer.size()) {
+      // grow such that subsequent pushes of similar size do not require the
+      // buffer to be reallocated
+      std::vector<T> buffer(2 * (_size + n));
+      std::copy(data(), data() + _size, buffer.begin());
+      _buffer.swap(buffer);
+    } else {
+      std::copy(data(), data() + _size, _buffer.begin());
+    }
+    _end = _size;
+  }
+
+  std::vector<T> _buffer;
+
+  // The window size
+  size_type _size{0};
+  // The index past the most recent sample
+  size_type _end{0};
+};
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_UTIL_SAMPLEWINDOW_H_
@@ -0,0 +1,143 @@
+#include "work_stealing_pool.h"
+
+#include <cassert>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+WorkStealingPool::Group::Group(std::size_t numTasks)
+    : pending{numTasks}, errors(numTasks) {}
+
+WorkStealingPool::WorkStealingPool(std::size_t numWorkers) {
+  assert((numWorkers > 0));
+  for (std::size_t i{0}; i < numWorkers; ++i) {
+    _workers.emplace_back(new Worker{});
+  }
+  for (auto &worker : _workers) {
+    auto *w{worker.get()};
+    worker->thread = std::thread{[this, w]() { work(*w); }};
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _stopped = true;
+  }
+  _cv.notify_all();
+  for (auto &worker : _workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+void WorkStealingPool::run(std::vector<Task> &tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  Group group{tasks.size()};
+  for (std::size_t i{0}; i < tasks.size(); ++i) {
+    auto &worker{*_workers[_next++ % _workers.size()]};
+    std::lock_guard<std::mutex> lock{worker.mutex};
+    worker.deque.push_back({&tasks[i], &group, i});
+    ++_queued;
+  }
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+  }
+  _cv.notify_all();
+
+  // help executing tasks while waiting
+  Item item;
+  while (group.pending.load(std::memory_order_acquire) > 0) {
+    if (acquire(item, nullptr)) {
+      execute(item);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{group.mutex};
+    group.cv.wait(lock, [&group]() {
+      return group.pending.load(std::memory_order_acquire) == 0;
+    });
+  }
+  // make sure the worker finishing the last task released the group before
+  // destroying it
+  {
+    std::lock_guard<std::mutex> lock{group.mutex};
+  }
+
+  for (const auto &error : group.errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+std::size_t WorkStealingPool::size() const { return _workers.size(); }
+
+std::size_t WorkStealingPool::steals() const { return _steals; }
+
+void WorkStealingPool::work(Worker &worker) {
+  Item item;
+  while (true) {
+    if (acquire(item, &worker)) {
+      execute(item);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{_mutex};
+    _cv.wait(lock, [this]() { return _stopped || _queued > 0; });
+    if (_stopped && _queued == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::acquire(Item &item, Worker *own) {
+  if (own) {
+    std::lock_guard<std::mutex> lock{own->mutex};
+    if (!own->deque.empty()) {
+      item = own->deque.back();
+      own->deque.pop_back();
+      --_queued;
+      return true;
+    }
+  }
+
+  for (auto &worker : _workers) {
+    if (worker.get() == own) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock{worker->mutex};
+    if (!worker->deque.empty()) {
+      item = worker->deque.front();
+      worker->deque.pop_front();
+      --_queued;
+      ++_steals;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::execute(const Item &item) {
+  try {
+    (*item.task)();
+  } catch (...) {
+    item.group->errors[item.idx] = std::current_exception();
+  }
+
+  auto &group{*item.group};
+  std::lock_guard<std::mutex> lock{group.mutex};
+  if (group.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    group.cv.notify_all();
+  }
+}
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
@@ -0,0 +1,96 @@
+#ifndef SCDETECT_APPS_CC_UTIL_WORKSTEALINGPOOL_H_
+#define SCDETECT_APPS_CC_UTIL_WORKSTEALINGPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Seiscomp {
+namespace detect {
+namespace util {
+
+// A pool of worker threads executing groups of tasks by means of work
+// stealing
+//
+// - each worker owns a deque of tasks; workers pop tasks from the back of
+// their own deque and steal tasks from the front of the other workers'
+// deques if their own deque is empty
+// - the thread calling `run()` participates in executing the tasks (i.e. it
+// steals tasks while waiting); thus, `run()` may be called from multiple
+// threads concurrently (including the workers themselves) without risking
+// a deadlock
+class WorkStealingPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(std::size_t numWorkers);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // Executes `tasks` and blocks until all of them are finished
+  //
+  // - if tasks throw, the exception of the first task (w.r.t. the order of
+  // `tasks`) throwing is rethrown once all tasks are finished
+  void run(std::vector<Task> &tasks);
+
+  // Returns the number of workers
+  std::size_t size() const;
+  // Returns the number of tasks stolen
+  std::size_t steals() const;
+
+ private:
+  struct Group {
+    explicit Group(std::size_t numTasks);
+
+    std::atomic<std::size_t> pending;
+    std::vector<std::exception_ptr> errors;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+
+  struct Item {
+    Task *task{nullptr};
+    Group *group{nullptr};
+    std::size_t idx{0};
+  };
+
+  struct Worker {
+    std::deque<Item> deque;
+    std::mutex mutex;
+    std::thread thread;
+  };
+
+  void work(Worker &worker);
+  // Pops an item from the back of the deque of the worker `own` (if any) or
+  // steals an item from the front of the other workers' deques. Returns
+  // `true` if an item was found, else `false`.
+  bool acquire(Item &item, Worker *own);
+  void execute(const Item &item);
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+
+  // The number of items queued (across all workers)
+  std::atomic<std::size_t> _queued{0};
+  std::atomic<std::size_t> _steals{0};
+  // The worker the next item is pushed to
+  std::atomic<std::size_t> _next{0};
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stopped{false};
+};
+
+}  // namespace util
+}  // namespace detect
+}  // namespace Seiscomp
+
+#endif  // SCDETECT_APPS_CC_UTIL_WORKSTEALINGPOOL_H_
@@ -15,6 +15,7 @@
 #include <fstream>
 #include <memory>
 
+#include "filterstore.h"
 #include "log.h"
 #include "resamplerstore.h"
 #include "util/math.h"
@@ -112,8 +113,7 @@ bool filter(DoubleArray &data, const std::string &filterId,
   }
 
   std::string filterError;
-  std::unique_ptr<DoubleFilter> filter{
-      DoubleFilter::Create(filterId, &filterError)};
+  auto filter{FilterStore::Instance().get(filterId, &filterError)};
   if (!filter) {
     SCDETECT_LOG_WARNING("Filter creation failed for '%s': %s",
                          filterId.c_str(), filterError.c_str());
@@ -156,9 +156,19 @@ bool resample(GenericRecord &trace, double targetFrequency) {
     return false;
   }
 
+  std::unique_ptr<Record> flushed{resampler->flush()};
+
   trace.setStartTime(resampled->startTime());
   trace.setSamplingFrequency(targetFrequency);
   trace.setData(resampled->data()->copy(Array::DataType::DOUBLE));
+  if (flushed) {
+    // append the samples buffered by the resampler
+    auto *data{DoubleArray::Cast(trace.data())};
+    DoubleArrayPtr remaining{DoubleArray::Cast(
+        flushed->data()->copy(Array::DataType::DOUBLE))};
+    data->append(remaining->size(), remaining->typedData());
+    trace.dataUpdated();
+  }
   return true;
 }
 
@@ -416,6 +426,30 @@ GenericRecordCPtr Cached::get(
   std::string cache_key;
   makeCacheKey(netCode, staCode, locCode, chaCode, tw, config, cache_key);
 
+  // deduplicate in-flight fetches (i.e. wait for a concurrent fetch of the
+  // same cache key and look up the cache, afterwards)
+  {
+    std::unique_lock<std::mutex> lock{_inFlightMutex};
+    if (_inFlight.count(cache_key) > 0) {
+      ++_deduplicated;
+      _inFlightCv.wait(
+          lock, [this, &cache_key]() { return !_inFlight.count(cache_key); });
+    }
+    _inFlight.insert(cache_key);
+  }
+  struct InFlightGuard {
+    ~InFlightGuard() {
+      {
+        std::lock_guard<std::mutex> lock{cached->_inFlightMutex};
+        cached->_inFlight.erase(key);
+      }
+      cached->_inFlightCv.notify_all();
+    }
+
+    Cached *cached;
+    const std::string &key;
+  } inFlightGuard{this, cache_key};
+
   bool cached = true;
   GenericRecordCPtr trace{get(cache_key)};
   if (!trace) {
@@ -510,6 +544,8 @@ GenericRecordCPtr FileSystemCache::get(const std::string &key) {
 
 bool Cached::cacheProcessed() const { return !_raw; }
 
+std::size_t Cached::deduplicated() const { return _deduplicated; }
+
 bool FileSystemCache::set(const std::string &key, GenericRecordCPtr value) {
   if (!value) return false;
 
@@ -531,17 +567,20 @@ InMemoryCache::InMemoryCache(WaveformHandlerIfacePtr waveformHandler, bool raw)
     : Cached(waveformHandler, raw) {}
 
 GenericRecordCPtr InMemoryCache::get(const std::string &key) {
+  std::lock_guard<std::mutex> lock{_mutex};
   const auto it = _cache.find(key);
   if (_cache.end() == it) return nullptr;
   return it->second;
 }
 
 bool InMemoryCache::set(const std::string &key, GenericRecordCPtr value) {
+  std::lock_guard<std::mutex> lock{_mutex};
   _cache[key] = value;
   return true;
 }
 
 bool InMemoryCache::exists(const std::string &key) {
+  std::lock_guard<std::mutex> lock{_mutex};
   return _cache.find(key) != _cache.end();
 }
 
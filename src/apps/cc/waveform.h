@@ -8,10 +8,14 @@
 #include <seiscomp/core/typedarray.h>
 #include <seiscomp/datamodel/waveformstreamid.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "def.h"
 #include "exception.h"
@@ -126,6 +130,11 @@ class WaveformHandler : public WaveformHandlerIface {
 };
 
 DEFINE_SMARTPOINTER(Cached);
+// Caches the waveforms fetched by means of the wrapped waveform handler
+//
+// - `get()` may be called concurrently; implementations of the cache (i.e.
+// `get(key)`, `set()` and `exists()`) are never called concurrently for the
+// same key
 class Cached : public WaveformHandlerIface {
  public:
   GenericRecordCPtr get(
@@ -149,6 +158,10 @@ class Cached : public WaveformHandlerIface {
       const Core::Time &start, const Core::Time &end,
       const WaveformHandlerIface::ProcessingConfig &config) override;
 
+  // Returns the number of requests which waited for an in-flight fetch of
+  // the same cache key (instead of fetching the waveform by themselves)
+  std::size_t deduplicated() const;
+
  protected:
   explicit Cached(WaveformHandlerIfacePtr waveformHandler, bool raw = false);
 
@@ -173,6 +186,15 @@ class Cached : public WaveformHandlerIface {
   // cached
   bool _raw;
 
+  // The cache keys currently fetched
+  //
+  // - concurrent requests for a cache key being fetched wait for the fetch
+  // to finish and are served from the cache, afterwards
+  std::unordered_set<std::string> _inFlight;
+  std::mutex _inFlightMutex;
+  std::condition_variable _inFlightCv;
+  std::atomic<std::size_t> _deduplicated{0};
+
   static const std::string _cacheKeySep;
 };
 
@@ -204,6 +226,7 @@ class InMemoryCache : public Cached {
 
  private:
   std::unordered_map<std::string, GenericRecordCPtr> _cache;
+  mutable std::mutex _mutex;
 };
 
 }  // namespace detect